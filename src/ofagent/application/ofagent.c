@@ -32,6 +32,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -89,6 +90,7 @@ static int sigterm_eventfd;
 
 static biglist_t *controllers = NULL;
 static biglist_t *listeners = NULL;
+static biglist_t *evictions = NULL;
 
 typedef struct
 {
@@ -109,6 +111,13 @@ static struct argp_option options[] =
 #endif /* OFAGENT_APP */
   { "controller", 't', "IP:PORT", 0,  "Controller" },
   { "listen",   'l',  "IP:PORT", 0,  "Listen" },
+  { "flowstatsttl", 'f', "MS", 0, "How long a flow stats snapshot is reused after it completes, in milliseconds; 0 disables the snapshot." },
+  { "counterrefresh", 'r', "MS", 0, "How often flow counters are refreshed for aggregate stats, in milliseconds; 0, the default, disables the refresh." },
+  { "countermaxage", 'g', "MS", 0, "Without the refresh, how long after a stats request read every flow's counters aggregate stats are answered from them, in milliseconds; 0 disables this." },
+  { "expireaudit", 'x', "MS", 0, "How often to check for timed out flows whose expiry OF-DPA did not report, in milliseconds; 0 disables the check." },
+  { "eviction", 'e', "TABLE:POLICY[:MAX]", 0, "Evict flows from a full table instead of rejecting adds. POLICY is lru, priority or expire. MAX limits the table's flows; without it the table is full when OF-DPA says so." },
+  { "statefile", 's', "FILE", 0, "Save flows and groups to FILE, and on startup restore them from it and reconcile with OF-DPA instead of waiting for the controller to push them again." },
+  { "statesave", 'v', "MS", 0, "How often to save the state file if flows or groups have changed, in milliseconds; 0 saves only on exit." },
   { 0 }
 };
 
@@ -166,6 +175,61 @@ parse_controller(const char *str,
   return 0;
 }
 
+static int
+parse_eviction(const char *str, uint8_t *table_id,
+               ind_core_eviction_t *eviction, int *max_entries)
+{
+  char buf[128];
+  char *strtok_state = NULL;
+  char *table_str, *policy_str, *max_str;
+  char *endptr;
+  long value;
+
+  strncpy(buf, str, sizeof(buf));
+  buf[sizeof(buf) - 1] = '\0';
+  strtok_state = buf;
+
+  table_str = strtok_r(NULL, ":", &strtok_state);
+  policy_str = strtok_r(NULL, ":", &strtok_state);
+  max_str = strtok_r(NULL, ":", &strtok_state);
+  if (table_str == NULL || policy_str == NULL) {
+      AIM_LOG_ERROR("Eviction spec \"%s\" needs a table and a policy", str);
+      return -1;
+  }
+
+  value = strtol(table_str, &endptr, 0);
+  if (*endptr != '\0' || value < 0 || value > 255) {
+      AIM_LOG_ERROR("Invalid table \"%s\"", table_str);
+      return -1;
+  }
+  *table_id = value;
+
+  if (!strcmp(policy_str, "lru")) {
+      *eviction = IND_CORE_EVICTION_LRU;
+  } else if (!strcmp(policy_str, "priority")) {
+      *eviction = IND_CORE_EVICTION_PRIORITY;
+  } else if (!strcmp(policy_str, "expire")) {
+      *eviction = IND_CORE_EVICTION_EXPIRE;
+  } else if (!strcmp(policy_str, "none")) {
+      *eviction = IND_CORE_EVICTION_NONE;
+  } else {
+      AIM_LOG_ERROR("Unknown eviction policy \"%s\"", policy_str);
+      return -1;
+  }
+
+  *max_entries = 0;
+  if (max_str != NULL) {
+      value = strtol(max_str, &endptr, 0);
+      if (*endptr != '\0' || value < 0 || value > INT_MAX) {
+          AIM_LOG_ERROR("Invalid table size \"%s\"", max_str);
+          return -1;
+      }
+      *max_entries = value;
+  }
+
+  return 0;
+}
+
 static void
 sighup_callback(int socket_id, void *cookie,
                 int read_ready, int write_ready, int error_seen)
@@ -214,6 +278,7 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
      know is a pointer to our arguments structure. */
 
   arguments_t *arguments = state->input;
+  uint32_t     ttl_ms;
 #ifdef OFAGENT_APP
   int          component;
 #endif
@@ -268,6 +333,65 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
       listeners = biglist_append(listeners, arg);
       break;
 
+    case 'f':                           /* flow stats snapshot TTL */
+      errno = 0;
+      ttl_ms = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid flowstatsttl \"%s\"", arg);
+        return errno;
+      }
+      ind_ofdpa_flow_stats_ttl_set(ttl_ms);
+      break;
+
+    case 'r':                           /* flow counter refresh period */
+      errno = 0;
+      core_cfg.counter_refresh_ms = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid counterrefresh \"%s\"", arg);
+        return errno;
+      }
+      break;
+
+    case 'g':                           /* flow counter reuse age */
+      errno = 0;
+      core_cfg.counter_max_age_ms = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid countermaxage \"%s\"", arg);
+        return errno;
+      }
+      break;
+
+    case 'x':                           /* flow expiry audit period */
+      errno = 0;
+      core_cfg.expire_audit_ms = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid expireaudit \"%s\"", arg);
+        return errno;
+      }
+      break;
+
+    case 's':                           /* warm restart state file */
+      core_cfg.state_file = arg;
+      break;
+
+    case 'v':                           /* state file save period */
+      errno = 0;
+      core_cfg.state_save_ms = strtoul(arg, NULL, 0);
+      if (errno != 0)
+      {
+        argp_error(state, "Invalid statesave \"%s\"", arg);
+        return errno;
+      }
+      break;
+
+    case 'e':                           /* table eviction policy */
+      evictions = biglist_append(evictions, arg);
+      break;
+
     case ARGP_KEY_NO_ARGS:
     case ARGP_KEY_END:
       break;
@@ -542,6 +666,13 @@ int main(int argc, char *argv[])
    */
   AIM_LOG_MSG("\r\n%s\r\n\r\n", versionBuf);
 
+  core_cfg.counter_refresh_ms = IND_CORE_COUNTER_REFRESH_MS_DEFAULT;
+  core_cfg.counter_max_age_ms = IND_CORE_COUNTER_MAX_AGE_MS_DEFAULT;
+  /* OF-DPA ages flows itself; the state manager only audits */
+  core_cfg.expire_flows = 0;
+  core_cfg.expire_audit_ms = IND_CORE_EXPIRE_AUDIT_MS_DEFAULT;
+  core_cfg.state_save_ms = IND_CORE_STATE_SAVE_MS_DEFAULT;
+
   /* Parse our arguments; every option seen by `parse_opt' will be reflected in
      `arguments'. */
   argp_parse(&argp, argc, argv, 0, 0, &arguments);
@@ -624,6 +755,33 @@ int main(int argc, char *argv[])
       return 1;
   }
 
+  /* Set table eviction policies from command line */
+  {
+      biglist_t *element;
+      char *str;
+      BIGLIST_FOREACH_DATA(element, evictions, char *, str) {
+          uint8_t table_id;
+          ind_core_eviction_t eviction;
+          int max_entries;
+
+          if (parse_eviction(str, &table_id, &eviction, &max_entries) < 0 ||
+              ind_core_table_eviction_set(table_id, eviction,
+                                          max_entries) < 0) {
+              AIM_LOG_FATAL("Failed to set eviction '%s'", str);
+              return 1;
+          }
+      }
+  }
+
+  /* Pick up the flows and groups left in OF-DPA by the last run */
+  if (core_cfg.state_file != NULL) {
+      indigo_error_t rv = ind_core_state_restore(core_cfg.state_file);
+      if (rv != INDIGO_ERROR_NONE && rv != INDIGO_ERROR_NOT_FOUND) {
+          AIM_LOG_ERROR("Failed to restore state file %s: %d",
+                        core_cfg.state_file, rv);
+      }
+  }
+
   /* Enable all modules */
 
   if (ind_soc_enable_set(1) < 0) {
@@ -128,6 +128,15 @@ ind_cxn_message_trace(indigo_cxn_id_t cxn_id, aim_pvs_t* pvs);
 extern void
 ind_cxn_reset(indigo_cxn_id_t cxn_id);
 
+/**
+ * Whether a connection has so much output queued that bulk senders
+ * should hold off until it drains
+ * @param cxn_id The connection ID
+ * @returns Boolean; false for an invalid connection
+ */
+extern int
+ind_cxn_output_congested(indigo_cxn_id_t cxn_id);
+
 
 #endif /* __OFCONNECTIONMANAGER_H__ */
 /** @} */
@@ -26,8 +26,12 @@
 #include "ofconnectionmanager_log.h"
 
 #include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
+#include <limits.h>
 #include <unistd.h>
+#include <sys/uio.h>
 
 #include "cxn_instance.h"
 #include "ofconnectionmanager_int.h"
@@ -71,8 +75,12 @@ state_info_t state_info[INDIGO_CXN_S_COUNT] = {
 };
 
 
-/* Maximum number of messages to send per write callback */
-#define MAX_WRITE_MSGS 32
+/* Maximum number of segments to send per write callback */
+#if defined(IOV_MAX)
+#define CXN_WRITE_IOV_MAX IOV_MAX
+#else
+#define CXN_WRITE_IOV_MAX 1024
+#endif
 
 
 /**
@@ -121,9 +129,130 @@ cxn_data_hexdump(unsigned char *buf, int bytes)
  ****************************************************************/
 
 static void periodic_keepalive(void *cookie);
+static void cxn_rx_resume(void *cookie);
+
+/****************************************************************
+ *
+ * Receive chunks
+ *
+ ****************************************************************/
+
+/**
+ * Receive chunk header.  Message data starts CXN_RX_DATA_OFFSET bytes
+ * into the chunk.  The connection holds one reference on its current
+ * chunk and each OF object bound to a message in the chunk holds one.
+ */
+typedef struct cxn_rx_chunk_s {
+    int refcount;
+} cxn_rx_chunk_t;
+
+#define CXN_RX_DATA_OFFSET 64
+#define CXN_RX_DATA_SIZE (CXN_RX_CHUNK_SIZE - CXN_RX_DATA_OFFSET)
+#define CXN_RX_DATA(chunk) ((uint8_t *)(chunk) + CXN_RX_DATA_OFFSET)
+#define CXN_RX_CHUNK_OF(ptr)                                            \
+    ((cxn_rx_chunk_t *)((uintptr_t)(ptr) & ~((uintptr_t)CXN_RX_CHUNK_SIZE - 1)))
+
+static cxn_rx_chunk_t *
+rx_chunk_alloc(void)
+{
+    void *mem;
+
+    if (posix_memalign(&mem, CXN_RX_CHUNK_SIZE, CXN_RX_CHUNK_SIZE) != 0) {
+        return NULL;
+    }
+
+    ((cxn_rx_chunk_t *)mem)->refcount = 1;
+    return (cxn_rx_chunk_t *)mem;
+}
+
+static void
+rx_chunk_unref(cxn_rx_chunk_t *chunk)
+{
+    INDIGO_ASSERT(chunk->refcount > 0);
+    if (--chunk->refcount == 0) {
+        free(chunk); /* Allocated with posix_memalign */
+    }
+}
+
+/* Wire buffer free function for messages bound in a receive chunk */
+static void
+rx_msg_free(void *buf)
+{
+    rx_chunk_unref(CXN_RX_CHUNK_OF(buf));
+}
 
 #define VERSION_IS_SET(cxn) ((cxn)->status.negotiated_version > 0)
 
+/****************************************************************
+ *
+ * Output queue segments
+ *
+ ****************************************************************/
+
+#define OUT_SEG_IS_CHUNK(seg) ((seg)->data == (uint8_t *)((seg) + 1))
+
+/* Allocate an empty send chunk */
+static cxn_out_seg_t *
+out_seg_chunk_alloc(void)
+{
+    cxn_out_seg_t *seg;
+
+    seg = INDIGO_MEM_ALLOC(sizeof(*seg) + CXN_PACK_CHUNK_SIZE);
+    if (seg == NULL) {
+        return NULL;
+    }
+
+    seg->next = NULL;
+    seg->data = (uint8_t *)(seg + 1);
+    seg->bytes = 0;
+    seg->space = CXN_PACK_CHUNK_SIZE;
+    seg->msgs = 0;
+    seg->pool_class = -1;
+
+    return seg;
+}
+
+/* Allocate a segment that takes ownership of a message buffer */
+static cxn_out_seg_t *
+out_seg_msg_alloc(uint8_t *data, int len, int pool_class)
+{
+    cxn_out_seg_t *seg;
+
+    if ((seg = INDIGO_MEM_ALLOC(sizeof(*seg))) == NULL) {
+        return NULL;
+    }
+
+    seg->next = NULL;
+    seg->data = data;
+    seg->bytes = len;
+    seg->space = 0;
+    seg->msgs = 0;
+    seg->pool_class = pool_class;
+
+    return seg;
+}
+
+static void
+out_seg_free(cxn_out_seg_t *seg)
+{
+    if (!OUT_SEG_IS_CHUNK(seg)) {
+        of_wire_buffer_data_free(seg->data, seg->pool_class);
+    }
+    INDIGO_MEM_FREE(seg);
+}
+
+/* Link a segment at the tail of the output queue */
+static void
+out_seg_append(connection_t *cxn, cxn_out_seg_t *seg)
+{
+    if (cxn->out_tail == NULL) {
+        cxn->out_head = seg;
+    } else {
+        cxn->out_tail->next = seg;
+    }
+    cxn->out_tail = seg;
+}
+
 /**
  * Disconnect and clean up
  *
@@ -132,8 +261,7 @@ static void periodic_keepalive(void *cookie);
 static void
 cleanup_disconnect(connection_t *cxn)
 {
-    uint8_t *data;
-    biglist_t *ble;
+    cxn_out_seg_t *seg;
 
     cxn->status.disconnect_count++;
 
@@ -147,16 +275,23 @@ cleanup_disconnect(connection_t *cxn)
     cxn->generation_id++;
 
     /* @fixme Is it possible there's a message that should be processed? */
-    LOG_VERBOSE(cxn, "Closing connection, current read buf has %d bytes",
-                cxn->read_bytes);
-    cxn->read_bytes = 0;
+    LOG_VERBOSE(cxn, "Closing connection, receive ring has %d bytes",
+                cxn->rx_tail - cxn->rx_head);
+    ind_soc_timer_event_unregister(cxn_rx_resume, (void *)cxn);
+    if (cxn->rx_chunk != NULL) {
+        /* Messages still being processed keep their own reference */
+        rx_chunk_unref(cxn->rx_chunk);
+        cxn->rx_chunk = NULL;
+    }
+    cxn->rx_head = 0;
+    cxn->rx_tail = 0;
     /* Clear write queue */
-    BIGLIST_FOREACH_DATA(ble, cxn->output_list, uint8_t *, data) {
-        LOG_TRACE(cxn, "Freeing outgoing msg %p", data);
-        INDIGO_MEM_FREE(data);
+    while ((seg = cxn->out_head) != NULL) {
+        LOG_TRACE(cxn, "Freeing outgoing segment %p", seg);
+        cxn->out_head = seg->next;
+        out_seg_free(seg);
     }
-    biglist_free(cxn->output_list);
-    cxn->output_list = NULL;
+    cxn->out_tail = NULL;
 
     cxn->bytes_enqueued = 0;
     cxn->pkts_enqueued = 0;
@@ -864,42 +999,72 @@ of_msg_process(connection_t *cxn, of_object_t *obj)
 }
 
 /**
- * Extract bytes from the read buffer
- * @param cxn The connection instance
- * @param len The number of bytes to extract from the read buffer
+ * Is object a message?  Should be if we're sending it
+ */
+#define IS_MSG_OBJ(obj) \
+    ((obj)->object_id >= 0 && (obj)->object_id < OF_MESSAGE_OBJECT_COUNT)
+
+/**
+ * Make room in the receive ring for the next read
  *
- * Returns a pointer to a new buffer containing a copy of the initial
- * segment of the read buffer through len.  The read buffer is then
- * updated so the remainder of the buffer starts at 0.
+ * If the next message cannot fit in the current chunk, or little space
+ * is left at its end, unprocessed data is moved to the front of the
+ * chunk.  When objects still reference the chunk, the data is moved to
+ * a new chunk instead.
  */
-static inline uint8_t *
-extract_read_buffer(connection_t *cxn)
+
+static int
+rx_make_room(connection_t *cxn)
 {
-    uint8_t *new_buf;
-    int len;
+    cxn_rx_chunk_t *chunk = cxn->rx_chunk;
+    cxn_rx_chunk_t *new_chunk;
+    int pending, needed;
+
+    if (chunk == NULL) {
+        if ((cxn->rx_chunk = rx_chunk_alloc()) == NULL) {
+            LOG_ERROR(cxn, "Could not allocate receive chunk");
+            return INDIGO_ERROR_RESOURCE;
+        }
+        cxn->rx_head = cxn->rx_tail = 0;
+        return INDIGO_ERROR_NONE;
+    }
 
-    /* Allocate new buffer; copy data into it; remove from read buffer */
-    len = cxn->read_bytes;
-    if ((new_buf = INDIGO_MEM_ALLOC(len)) == NULL) {
-        LOG_ERROR(cxn, "Could not allocate new buffer to process read buffer");
-        return NULL;
+    pending = cxn->rx_tail - cxn->rx_head;
+    needed = OF_MESSAGE_HEADER_LENGTH;
+    if (pending >= OF_MESSAGE_HEADER_LENGTH) {
+        needed = of_message_length_get(
+            OF_BUFFER_TO_MESSAGE(CXN_RX_DATA(chunk) + cxn->rx_head));
     }
 
-    INDIGO_MEM_COPY(new_buf, cxn->read_buffer, len);
+    if (CXN_RX_DATA_SIZE - cxn->rx_tail >= CXN_RX_MIN_READ &&
+            cxn->rx_head + needed <= CXN_RX_DATA_SIZE) {
+        return INDIGO_ERROR_NONE;
+    }
 
-    return new_buf;
-}
+    if (chunk->refcount == 1) {
+        INDIGO_MEM_MOVE(CXN_RX_DATA(chunk),
+                        CXN_RX_DATA(chunk) + cxn->rx_head, pending);
+    } else {
+        if ((new_chunk = rx_chunk_alloc()) == NULL) {
+            LOG_ERROR(cxn, "Could not allocate receive chunk");
+            return INDIGO_ERROR_RESOURCE;
+        }
+        INDIGO_MEM_COPY(CXN_RX_DATA(new_chunk),
+                        CXN_RX_DATA(chunk) + cxn->rx_head, pending);
+        rx_chunk_unref(chunk);
+        cxn->rx_chunk = new_chunk;
+    }
 
-/**
- * Is object a message?  Should be if we're sending it
- */
-#define IS_MSG_OBJ(obj) \
-    ((obj)->object_id >= 0 && (obj)->object_id < OF_MESSAGE_OBJECT_COUNT)
+    cxn->rx_head = 0;
+    cxn->rx_tail = pending;
 
-#define READING_HEADER(cxn) (((cxn)->read_bytes) < OF_MESSAGE_HEADER_LENGTH)
+    return INDIGO_ERROR_NONE;
+}
 
 /**
- * Read from the cxn, up to cxn->bytes_needed bytes; update bytes needed
+ * Read from the cxn into the receive ring
+ *
+ * A single read fills as much of the current chunk as the socket allows.
  *
  * Return number of bytes read if no error
  * Return < 0, error number, if error.
@@ -914,9 +1079,14 @@ read_from_cxn(connection_t *cxn)
 {
     ssize_t bytes_in;
     uint8_t *inbuf_start;
+    int rv;
+
+    if ((rv = rx_make_room(cxn)) < 0) {
+        return rv;
+    }
 
-    inbuf_start = &cxn->read_buffer[cxn->read_bytes];
-    bytes_in = read(cxn->sd, inbuf_start, cxn->bytes_needed);
+    inbuf_start = CXN_RX_DATA(cxn->rx_chunk) + cxn->rx_tail;
+    bytes_in = read(cxn->sd, inbuf_start, CXN_RX_DATA_SIZE - cxn->rx_tail);
 
     /*
      * Reading 0 bytes indicates connection has closed, although we allow
@@ -941,108 +1111,71 @@ read_from_cxn(connection_t *cxn)
 
     cxn->status.bytes_in += bytes_in;
 #if defined(DUMP_OBJECTS_AND_DATA)
-    cxn_data_hexdump(&cxn->read_buffer[cxn->read_bytes], bytes_in);
+    cxn_data_hexdump(inbuf_start, bytes_in);
 #endif
 
-    INDIGO_ASSERT((int)bytes_in <= cxn->bytes_needed);
-    cxn->read_bytes += bytes_in;
-    cxn->bytes_needed -= bytes_in;
+    cxn->rx_tail += bytes_in;
+    INDIGO_ASSERT(cxn->rx_tail <= CXN_RX_DATA_SIZE);
 
     return bytes_in;
 }
 
 /**
- * Try to read a full message from the connnection
+ * Frame the next message in the receive ring
  *
- * @returns INDIGO_ERROR_NONE if message is ready
- * @returns INDIGO_ERROR_PENDING if message is not ready
- * @returns INDIGO_ERROR_CONNECTION if a read error has occurred
+ * @returns The message length if a complete message is ready
+ * @returns 0 if more data is needed
  * @returns INDIGO_ERROR_PROTOCOL if the data stream has illegal values
- *
- * If INDIGO_ERROR_NONE is returned, a message is ready to be processed
- * in the connection's read buffer.
  */
 
-static inline int
-read_message(connection_t *cxn)
+static int
+rx_next_message(connection_t *cxn, of_message_t *msg)
 {
-    of_message_t msg = NULL;
-    int msg_bytes;
-    int rv = INDIGO_ERROR_NONE;
+    int pending, msg_bytes;
 
-    /* No bytes needed; must be stuck. */
-    if (cxn->bytes_needed == 0) {
-        LOG_TRACE(cxn, "Processing appears to be blocked");
-        return INDIGO_ERROR_PENDING;
+    if (cxn->rx_chunk == NULL) {
+        return 0;
     }
 
-    if (READING_HEADER(cxn)) {
-        INDIGO_ASSERT(cxn->bytes_needed + cxn->read_bytes ==
-                      OF_MESSAGE_HEADER_LENGTH);
-        if ((rv = read_from_cxn(cxn)) < 0) {
-            return rv;
-        }
-
-        if (cxn->bytes_needed != 0) {
-            LOG_TRACE(cxn, "Still need %d bytes for msg hdr",
-                      cxn->bytes_needed);
-            return INDIGO_ERROR_PENDING;
-        }
-
-        msg = (of_message_t)(cxn->read_buffer);
-        msg_bytes = of_message_length_get(msg);
-        if (msg_bytes < OF_MESSAGE_HEADER_LENGTH) {
-            LOG_TRACE(cxn, "Illegal msg length %d. Framing error?", msg_bytes);
-            ++ind_cxn_internal_errors;
-            return INDIGO_ERROR_PROTOCOL;
-        }
-        cxn->bytes_needed = msg_bytes - OF_MESSAGE_HEADER_LENGTH;
+    pending = cxn->rx_tail - cxn->rx_head;
+    if (pending < OF_MESSAGE_HEADER_LENGTH) {
+        return 0;
     }
 
-    /* Check if the message only needed the header */
-    if (cxn->bytes_needed == 0) {
-        return INDIGO_ERROR_NONE;
+    *msg = OF_BUFFER_TO_MESSAGE(CXN_RX_DATA(cxn->rx_chunk) + cxn->rx_head);
+    msg_bytes = of_message_length_get(*msg);
+    if (msg_bytes < OF_MESSAGE_HEADER_LENGTH) {
+        LOG_TRACE(cxn, "Illegal msg length %d. Framing error?", msg_bytes);
+        ++ind_cxn_internal_errors;
+        return INDIGO_ERROR_PROTOCOL;
     }
 
-    /* Read the rest of the message; return if error */
-    if ((rv = read_from_cxn(cxn)) < 0) {
-        return rv;
-    }
-    if (cxn->bytes_needed == 0) { /* Read full message, return ready */
-        return INDIGO_ERROR_NONE;
+    if (pending < msg_bytes) {
+        return 0;
     }
 
-    /* Still need more bytes; return pending */
-    return INDIGO_ERROR_PENDING;
+    return msg_bytes;
 }
 
 /**
- * Process a message from the read buffer
+ * Process a message from the receive ring
  *
- * The read buffer must have a valid message in it to be processed
+ * @param cxn The connection instance
+ * @param new_buf The message, in the connection's current receive chunk
+ * @param len The length of the message
+ *
+ * The message holds its own reference on the receive chunk, which is
+ * passed to the OF object bound to it.
  */
 
 static inline void
-process_message(connection_t *cxn)
+process_message(connection_t *cxn, uint8_t *new_buf, int len)
 {
-    uint8_t *new_buf;
     of_object_t *obj;
-    int len;
     int rv;
 
-    /* Message is ready to be processed */
-    new_buf = extract_read_buffer(cxn);
-    if (new_buf == NULL) {
-        LOG_ERROR(cxn, "Could not alloc buffer to handle message; will block");
-        return;
-    }
-
-    /* Clear read buffer for next read, even if above failed */
-    len = cxn->read_bytes;
-    cxn->read_bytes = 0;
-    cxn->bytes_needed = OF_MESSAGE_HEADER_LENGTH;
-
-    obj = of_object_new_from_message(OF_BUFFER_TO_MESSAGE(new_buf), len);
+    obj = of_object_new_from_message_bind(OF_BUFFER_TO_MESSAGE(new_buf), len,
+                                          rx_msg_free);
     if (obj == NULL) {
         uint32_t xid;
         uint16_t type = OF_REQUEST_FAILED_BAD_TYPE;
@@ -1066,7 +1199,7 @@ process_message(connection_t *cxn)
             LOG_ERROR(cxn, "Error sending error message for failed parsing");
         }
 
-        INDIGO_MEM_FREE(new_buf);
+        rx_msg_free(new_buf);
         return;
     }
 
@@ -1119,23 +1252,84 @@ process_message(connection_t *cxn)
     }
 }
 
+/**
+ * Process complete messages in the receive ring
+ *
+ * At least one message is processed per call.  If the socket manager
+ * asks to yield while messages remain, processing resumes from a timer.
+ *
+ * @returns INDIGO_ERROR_NONE or INDIGO_ERROR_PROTOCOL on a framing error
+ */
+
+static int
+process_messages(connection_t *cxn)
+{
+    uint32_t generation_id = cxn->generation_id;
+    of_message_t msg;
+    int len;
+
+    do {
+        if ((len = rx_next_message(cxn, &msg)) <= 0) {
+            return len;
+        }
+
+        cxn->rx_head += len;
+        cxn->rx_chunk->refcount++;
+        process_message(cxn, OF_MESSAGE_TO_BUFFER(msg), len);
+
+        if (cxn->generation_id != generation_id) {
+            /* Connection was closed while handling the message */
+            return INDIGO_ERROR_NONE;
+        }
+    } while (!ind_soc_should_yield());
+
+    if (rx_next_message(cxn, &msg) != 0) {
+        ind_soc_timer_event_register_with_priority(
+            cxn_rx_resume, (void *)cxn,
+            IND_SOC_TIMER_IMMEDIATE, IND_CXN_EVENT_PRIORITY);
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/**
+ * Timer handler to continue processing the receive ring after yielding
+ */
+
+static void
+cxn_rx_resume(void *cookie)
+{
+    connection_t *cxn = (connection_t *)cookie;
+
+    ind_soc_timer_event_unregister(cxn_rx_resume, cookie);
+
+    if (process_messages(cxn) < 0) {
+        LOG_VERBOSE(cxn, "Error processing receive ring, resetting");
+        ind_cxn_disconnect(cxn);
+    }
+}
+
 /**
  * Process the connection socket for reading
  *
+ * Reads once from the socket, then processes the complete messages
+ * in the receive ring.
+ *
  * @returns INDIGO_ERROR_NONE if no socket error
  * @returns INDIGO_ERROR_CONNECTION if socket error
+ * @returns INDIGO_ERROR_PROTOCOL if the data stream has illegal values
  */
 
 int
 ind_cxn_process_read_buffer(connection_t *cxn)
 {
-    int rv = INDIGO_ERROR_NONE;
+    int rv;
 
-    if ((rv = read_message(cxn)) == INDIGO_ERROR_NONE) {
-        process_message(cxn);
+    if ((rv = read_from_cxn(cxn)) < 0) {
+        return rv;
     }
 
-    return rv;
+    return process_messages(cxn);
 }
 
 /**
@@ -1194,77 +1388,84 @@ write_chunk(connection_t *cxn, uint8_t *start, ssize_t bytes)
 /**
  * Process messages waiting to be sent to a connection socket
  *
+ * Up to CXN_WRITE_IOV_MAX queued segments are sent with one writev.
+ *
  * @returns The number of bytes written or an error code
  */
 
 int
 ind_cxn_process_write_buffer(connection_t *cxn)
 {
-    int written, left;
+    static struct iovec iovecs[CXN_WRITE_IOV_MAX];
+    int written, left, bytes;
     int num_iovecs = 0;
-    struct iovec iovecs[MAX_WRITE_MSGS];
-    biglist_t *cur_node;
+    cxn_out_seg_t *seg;
     struct iovec *iov;
 
-    /* Iterate over cxn->output_list adding buffers to iovecs */
-    cur_node = cxn->output_list;
-    while (cur_node != NULL && num_iovecs < MAX_WRITE_MSGS) {
+    /* Iterate over the output queue adding segments to iovecs */
+    for (seg = cxn->out_head; seg != NULL && num_iovecs < CXN_WRITE_IOV_MAX;
+         seg = seg->next) {
         iov = &iovecs[num_iovecs];
-        iov->iov_base = BIGLIST_CAST(void *, cur_node);
-        iov->iov_len = of_message_length_get(iov->iov_base);
+        iov->iov_base = seg->data;
+        iov->iov_len = seg->bytes;
         if (num_iovecs == 0) {
-            /* First buffer may be partially written */
+            /* First segment may be partially written */
             iov->iov_base += cxn->output_head_offset;
             iov->iov_len -= cxn->output_head_offset;
         }
         num_iovecs++;
-        cur_node = biglist_next(cur_node);
+    }
+
+    if (num_iovecs == 0) {
+        CXN_WRITE_CLEAR(cxn->sd);
+        return 0;
     }
 
     written = writev(cxn->sd, iovecs, num_iovecs);
 
     if (written < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
         /* Error writing to connection socket */
         LOG_ERROR(cxn, "Error writing to socket");
         return INDIGO_ERROR_UNKNOWN;
     }
 
-    /*
-     * Iterate over cxn->output_list and iovecs together, freeing completely
-     * sent messages.
-     */
+    cxn->status.bytes_out += written;
+    cxn->out_stats.flushes++;
+    cxn->out_stats.flush_segments += num_iovecs;
+    cxn->out_stats.flush_bytes += written;
+    if (written > cxn->out_stats.max_flush_bytes) {
+        cxn->out_stats.max_flush_bytes = written;
+    }
+
+    /* Free completely sent segments */
     left = written;
-    iov = iovecs;
     while (left > 0) {
-        int to_write, bytes_out;
-        cur_node = cxn->output_list;
-
-        /* Number of bytes we attempted to send in this message */
-        to_write = iov->iov_len;
-
-        /* Number of bytes we actually sent in this message */
-        bytes_out = aim_imin(left, to_write);
-        cxn->bytes_enqueued -= bytes_out;
-
-        if (bytes_out == to_write) { /* Completed this message */
-            INDIGO_MEM_FREE(BIGLIST_CAST(void *, cur_node));
-            cur_node = cxn->output_list =
-                biglist_remove_link_free(cxn->output_list, cur_node);
-            cxn->pkts_enqueued--;
-            cxn->status.messages_out++;
-            cxn->output_head_offset = 0;
-        } else {
+        seg = cxn->out_head;
+        bytes = seg->bytes - cxn->output_head_offset;
+
+        if (left < bytes) {
             /* Partial write */
-            INDIGO_ASSERT(bytes_out < to_write);
-            cxn->output_head_offset += bytes_out;
+            cxn->output_head_offset += left;
+            cxn->bytes_enqueued -= left;
             break;
         }
 
-        left -= bytes_out;
-        iov++;
+        left -= bytes;
+        cxn->bytes_enqueued -= bytes;
+        cxn->pkts_enqueued -= seg->msgs;
+        cxn->status.messages_out += seg->msgs;
+        cxn->output_head_offset = 0;
+
+        if ((cxn->out_head = seg->next) == NULL) {
+            cxn->out_tail = NULL;
+        }
+        out_seg_free(seg);
     }
 
-    if (cxn->output_list == NULL) { /* Nothing (more) to send */
+    if (cxn->out_head == NULL) { /* Nothing (more) to send */
         LOG_TRACE(cxn, "No more data to write");
         INDIGO_ASSERT(cxn->bytes_enqueued == 0);
         INDIGO_ASSERT(cxn->pkts_enqueued == 0);
@@ -1280,16 +1481,23 @@ ind_cxn_process_write_buffer(connection_t *cxn)
  * @param cxn The connection handle
  * @param data Pointer to a message to be sent
  * @param len Number of bytes to be sent out
+ * @param pool_class Wire buffer pool class of data, or -1
  *
  * @returns Error code
  *
- * Takes ownership of data unless an error is returned.
+ * Takes ownership of data unless an error is returned.  Messages of up
+ * to CXN_PACK_MSG_MAX bytes are copied into the send chunk at the tail
+ * of the queue and data is released immediately; larger messages are
+ * released once written.  Either way data goes back to the wire buffer
+ * pool through of_wire_buffer_data_free.
  */
 
 int
-ind_cxn_instance_enqueue(connection_t *cxn, uint8_t *data, int len)
+ind_cxn_instance_enqueue(connection_t *cxn, uint8_t *data, int len,
+                         int pool_class)
 {
     int msg_len;
+    cxn_out_seg_t *seg;
 
     LOG_TRACE(cxn, "Enqueuing %d bytes", len);
     LOG_TRACE(cxn, "Cur len %d bytes, %d pkts",
@@ -1307,10 +1515,38 @@ ind_cxn_instance_enqueue(connection_t *cxn, uint8_t *data, int len)
                   len, msg_len);
         return INDIGO_ERROR_UNKNOWN;
     }
-    cxn->output_list = biglist_append(cxn->output_list, (void *)data);
+
+    if (len <= CXN_PACK_MSG_MAX) {
+        seg = cxn->out_tail;
+        if (seg == NULL || seg->space < len) {
+            if ((seg = out_seg_chunk_alloc()) == NULL) {
+                return INDIGO_ERROR_RESOURCE;
+            }
+            out_seg_append(cxn, seg);
+        }
+        INDIGO_MEM_COPY(seg->data + seg->bytes, data, len);
+        seg->bytes += len;
+        seg->space -= len;
+        of_wire_buffer_data_free(data, pool_class);
+        cxn->out_stats.packed_msgs++;
+    } else {
+        if ((seg = out_seg_msg_alloc(data, len, pool_class)) == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+        out_seg_append(cxn, seg);
+    }
+
+    seg->msgs++;
     cxn->bytes_enqueued += len;
     cxn->pkts_enqueued += 1;
 
+    if (cxn->bytes_enqueued > cxn->out_stats.max_bytes_enqueued) {
+        cxn->out_stats.max_bytes_enqueued = cxn->bytes_enqueued;
+    }
+    if (cxn->pkts_enqueued > cxn->out_stats.max_pkts_enqueued) {
+        cxn->out_stats.max_pkts_enqueued = cxn->pkts_enqueued;
+    }
+
     /* Indicate data is ready to the socket manager */
     INDIGO_ASSERT(cxn->bytes_enqueued > 0);
     INDIGO_ASSERT(cxn->pkts_enqueued > 0);
@@ -1445,7 +1681,6 @@ ind_cxn_disconnected_init(connection_t *cxn)
     cxn->status.state = INDIGO_CXN_S_DISCONNECTED;
     cxn->status.role = INDIGO_CXN_R_UNKNOWN;
     cxn->status.negotiated_version = OF_VERSION_UNKNOWN;
-    cxn->bytes_needed = OF_MESSAGE_HEADER_LENGTH;
     cxn->flags = 0;
     cxn->outstanding_op_cnt = 0;
     cxn->barrier.pendingf = 0;
@@ -1454,6 +1689,7 @@ ind_cxn_disconnected_init(connection_t *cxn)
     cxn->status.bytes_out = 0;
     cxn->status.messages_in = 0;
     cxn->status.messages_out = 0;
+    INDIGO_MEM_CLEAR(&cxn->out_stats, sizeof(cxn->out_stats));
     cxn->fail_count = 0;
 }
 
@@ -32,7 +32,21 @@
 #include <OFConnectionManager/ofconnectionmanager.h>
 #include <BigList/biglist.h>
 
-#define READ_BUFFER_SIZE (64 * 1024)
+/**
+ * Size of a receive chunk.  Incoming data is read into the connection's
+ * current chunk and each complete message is bound in place to an OF
+ * object, which holds a reference on the chunk until it is deleted.
+ * Chunks are aligned to their size so the chunk can be found from a
+ * message pointer; this must be a power of two well above the maximum
+ * OpenFlow message length.
+ */
+#define CXN_RX_CHUNK_SIZE (256 * 1024)
+
+/**
+ * Minimum free space at the end of the receive chunk before a read.
+ * Below this, unprocessed data is moved to the front of a chunk.
+ */
+#define CXN_RX_MIN_READ (16 * 1024)
 
 /**
  * The write buffer size is artificial in that the original data
@@ -49,6 +63,31 @@
  */
 #define WRITE_BUFFER_SIZE (16 * 1024 * 1024)
 
+/**
+ * Messages no longer than this are copied into a shared send chunk
+ * rather than queued as a segment of their own.
+ */
+#define CXN_PACK_MSG_MAX 1024
+
+/**
+ * Size of a send chunk used to pack small outgoing messages
+ */
+#define CXN_PACK_CHUNK_SIZE (16 * 1024)
+
+/**
+ * Output queue segment.  Either a single (large) message buffer taken
+ * over from the sender, or a send chunk holding several small messages
+ * back to back.  A send chunk's data follows the segment header.
+ */
+typedef struct cxn_out_seg_s {
+    struct cxn_out_seg_s *next;
+    uint8_t *data; /* Start of the data to send */
+    int bytes;     /* Bytes queued in this segment */
+    int space;     /* Bytes left for packing; 0 for a message segment */
+    int msgs;      /* Number of messages in this segment */
+    int pool_class; /* Wire buffer pool class of a message segment's data */
+} cxn_out_seg_t;
+
 /**
  * Connection flag, connection is to be removed pending op completion
  */
@@ -69,22 +108,32 @@ typedef struct connection_s {
     int sd; /* The socket descriptor */
 
     /*
-     * The read buffer is used to buffer a single message.  There
-     * are two steps to the operation: Read the header, then use that
-     * to determine the number of bytes remaining in the message.
-     * Once a message is read in, it is processed and the read buffer
-     * is cleared.
+     * Receive ring.  Each socket read fills as much of the current chunk
+     * as the socket allows; complete messages between rx_head and rx_tail
+     * are then processed without copying.
      */
-    uint8_t read_buffer[READ_BUFFER_SIZE];
-    int read_bytes; /* Number of bytes currently in read buffer */
-    int bytes_needed; /* Num bytes needed for next process step */
+    struct cxn_rx_chunk_s *rx_chunk; /* Current receive chunk */
+    int rx_head; /* Offset of the first unprocessed byte */
+    int rx_tail; /* Offset of the end of received data */
 
     /* Write queue */
-    biglist_t *output_list; /* List of outgoing messages */
-    int output_head_offset; /* Bytes already sent out from head of output_list */
+    cxn_out_seg_t *out_head; /* Oldest segment; may be partially sent */
+    cxn_out_seg_t *out_tail; /* Newest segment; small messages pack here */
+    int output_head_offset; /* Bytes already sent out from out_head */
     int bytes_enqueued;     /* Total bytes queued */
     int pkts_enqueued;      /* Total pkts queued */
 
+    /* Write queue statistics */
+    struct {
+        uint64_t packed_msgs;    /* Messages copied into send chunks */
+        uint64_t flushes;        /* Calls to writev */
+        uint64_t flush_segments; /* Total segments passed to writev */
+        uint64_t flush_bytes;    /* Total bytes written */
+        int max_flush_bytes;     /* Largest single write */
+        int max_bytes_enqueued;  /* Queue depth high water marks */
+        int max_pkts_enqueued;
+    } out_stats;
+
     /* Additional debug info */
     uint64_t messages_in_by_type[OF_MESSAGE_OBJECT_COUNT];
     uint64_t messages_out_by_type[OF_MESSAGE_OBJECT_COUNT];
@@ -135,6 +184,14 @@ typedef struct connection_s {
 #define CXN_DROP_FLOW_REMOVED(cxn, obj)                \
     ((cxn)->pkts_enqueued > FLOW_REMOVED_DROP_QUEUE_MAX)
 
+/**
+ * Should bulk output, such as a flow monitor's initial flows, wait for
+ * the write queue to drain?
+ */
+#define CXN_OUTPUT_CONGESTED_BYTES (WRITE_BUFFER_SIZE / 4)
+#define CXN_OUTPUT_CONGESTED(cxn) \
+    ((cxn)->bytes_enqueued > CXN_OUTPUT_CONGESTED_BYTES)
+
 /**
  * How many bytes in buffer are free
  * See notes above about WRITE_BUFFER_SIZE.
@@ -190,7 +247,8 @@ extern state_info_t state_info[INDIGO_CXN_S_COUNT];
     (CXN_ACTIVE(cxn) &&                                                 \
      (CONNECTION_STATE(cxn) == INDIGO_CXN_S_HANDSHAKE_COMPLETE))
 
-extern int ind_cxn_instance_enqueue(connection_t *cxn, uint8_t *data, int len);
+extern int ind_cxn_instance_enqueue(connection_t *cxn, uint8_t *data, int len,
+                                    int pool_class);
 
 extern int ind_cxn_send_hello(connection_t *cxn);
 
@@ -712,7 +712,7 @@ indigo_error_t
 indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
 {
     uint8_t *data = NULL;
-    int len;
+    int len, pool_class;
     int rv = INDIGO_ERROR_NONE;
     connection_t *cxn;
 
@@ -785,7 +785,7 @@ indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
                 of_object_id_str[obj->object_id], cxn_ip_string(cxn));
     LOG_OBJECT(obj);
 
-    of_object_wire_buffer_steal((of_object_t *)obj, &data);
+    of_object_wire_buffer_steal_pooled((of_object_t *)obj, &data, &pool_class);
     len = obj->length;
 
     if (IS_MSG_OBJ(obj)) {
@@ -795,9 +795,9 @@ indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
         cxn->messages_out_unknown++;
     }
 
-    if (ind_cxn_instance_enqueue(cxn, data, len) < 0) {
+    if (ind_cxn_instance_enqueue(cxn, data, len, pool_class) < 0) {
         LOG_ERROR("Could not enqueue message data, disconnecting");
-        INDIGO_MEM_FREE(data);
+        of_wire_buffer_data_free(data, pool_class);
         rv = INDIGO_ERROR_UNKNOWN;
         ind_cxn_disconnect(cxn);
     }
@@ -1286,6 +1286,16 @@ ind_cxn_reset(indigo_cxn_id_t cxn_id)
     }
 }
 
+int
+ind_cxn_output_congested(indigo_cxn_id_t cxn_id)
+{
+    if (!ACTIVE_ENTRY(cxn_id)) {
+        return 0;
+    }
+
+    return CXN_OUTPUT_CONGESTED(CXN_ID_TO_CONNECTION(cxn_id));
+}
+
 /**
  * Show the stats for each connection.  If details
  * is true, show per-message data
@@ -1299,6 +1309,7 @@ ind_cxn_stats_show(aim_pvs_t *pvs, int details)
     int idx;
     int cxn_count = 0;
     uint64_t counter;
+    of_wire_buffer_pool_stats_t pool_stats;
 
     aim_printf(pvs, "Connection statistics report\n");
     aim_printf(pvs, "    Number of successful connections: %d\n",
@@ -1365,10 +1376,29 @@ ind_cxn_stats_show(aim_pvs_t *pvs, int details)
             aim_printf(pvs, "        Unknown type: %"PRIu64"\n",
                        cxn->messages_out_unknown);
         }
+
+        aim_printf(pvs, "    Output queue: %d bytes, %d msgs "
+                   "(max %d bytes, %d msgs)\n",
+                   cxn->bytes_enqueued, cxn->pkts_enqueued,
+                   cxn->out_stats.max_bytes_enqueued,
+                   cxn->out_stats.max_pkts_enqueued);
+        aim_printf(pvs, "    Output packed msgs: %"PRIu64"\n",
+                   cxn->out_stats.packed_msgs);
+        aim_printf(pvs, "    Output flushes: %"PRIu64", segments %"PRIu64
+                   ", bytes %"PRIu64" (max %d)\n",
+                   cxn->out_stats.flushes, cxn->out_stats.flush_segments,
+                   cxn->out_stats.flush_bytes,
+                   cxn->out_stats.max_flush_bytes);
     }
     if (!cxn_count) {
         aim_printf(pvs, "No active connections\n");
     }
+
+    of_wire_buffer_pool_stats_get(&pool_stats);
+    aim_printf(pvs, "Wire buffer pool: %"PRIu64" hits, %"PRIu64" misses, "
+               "%"PRIu64" recycled, %"PRIu64" released, %"PRIu64" grows\n",
+               pool_stats.hits, pool_stats.misses, pool_stats.recycled,
+               pool_stats.released, pool_stats.grows);
 }
 
 /**
@@ -47,11 +47,55 @@
 #define IND_CORE_DP_DESC_DEFAULT "Virtual forwarding module"
 #define IND_CORE_SERIAL_NUM_DEFAULT "11235813213455"
 
+/**
+ * @brief Default period for refreshing flow counters from forwarding
+ *
+ * Off: each refresh walks every flow, so it is only worth enabling when
+ * aggregate stats requests are frequent.
+ */
+
+#define IND_CORE_COUNTER_REFRESH_MS_DEFAULT 0
+
+/**
+ * @brief Default age up to which running counter totals answer aggregate
+ * stats, after every flow's counters were read
+ */
+
+#define IND_CORE_COUNTER_MAX_AGE_MS_DEFAULT 1000
+
+/**
+ * @brief Default period for auditing flow expiry done by forwarding
+ */
+
+#define IND_CORE_EXPIRE_AUDIT_MS_DEFAULT 60000
+
+/**
+ * @brief Default period for saving the state file for warm restart
+ */
+
+#define IND_CORE_STATE_SAVE_MS_DEFAULT 10000
+
 typedef struct ind_core_config_s {
     int expire_flows;   /**< Boolean, should state mgr manage flow expires */
     int stats_check_ms; /**< How frequently to check stats for expire, etc */
     indigo_core_disconnected_mode_t disconnected_mode;
     int max_flowtable_entries; /**< Maximum number of entries in the flowtable */
+    int counter_refresh_ms; /**< How frequently to refresh flow counters so
+                               aggregate stats can be answered from running
+                               totals; 0 to fetch counters per request */
+    int counter_max_age_ms; /**< Without refreshes, how long after a flow or
+                               aggregate stats request read every flow's
+                               counters the totals answer aggregate stats;
+                               0 to not use them */
+    int expire_audit_ms; /**< When forwarding expires flows (expire_flows
+                            is 0), how frequently to remove flows whose
+                            expiry it failed to report; 0 to never check */
+    const char *state_file; /**< File the flow and group tables are saved
+                               to for warm restart; NULL to not save. Must
+                               stay valid until ind_core_finish */
+    int state_save_ms; /**< How frequently to save the state file if the
+                          tables have changed; 0 to save only from
+                          ind_core_finish */
 } ind_core_config_t;
 
 
@@ -95,6 +139,251 @@ indigo_error_t ind_core_mfr_desc_get(of_desc_str_t desc);
 indigo_error_t ind_core_serial_num_set(of_serial_num_t serial_num);
 indigo_error_t ind_core_serial_num_get(of_serial_num_t serial_num);
 
+/**
+ * @brief How to choose a flow to evict when a table is full
+ */
+
+typedef enum ind_core_eviction_e {
+    IND_CORE_EVICTION_NONE = 0,     /**< Reject adds to a full table */
+    IND_CORE_EVICTION_LRU,          /**< Least recently matched */
+    IND_CORE_EVICTION_PRIORITY,     /**< Lowest priority, oldest first */
+    IND_CORE_EVICTION_EXPIRE,       /**< Soonest to time out; no timeout last */
+} ind_core_eviction_t;
+
+/**
+ * @brief Set a flow table's limit and eviction policy
+ * @param table_id The table
+ * @param eviction The policy
+ * @param max_entries Most flows the table may hold; 0 to be limited only
+ * by forwarding reporting the table full
+ *
+ * An add to a full table with a policy removes the flow the policy picks,
+ * sending a flow removed message with the eviction reason if the flow
+ * asked for one. If the add itself is the flow picked it is rejected.
+ */
+
+indigo_error_t ind_core_table_eviction_set(uint8_t table_id,
+                                           ind_core_eviction_t eviction,
+                                           int max_entries);
+
+/**
+ * @brief Bundles of flow and group mods applied as one unit
+ *
+ * Messages added to a bundle are only checked for their type. On commit
+ * they are all validated against the flow and group tables before any is
+ * applied; they are then applied in the order added, back to back. If
+ * forwarding rejects one, those already applied are undone in reverse
+ * order, an error for the rejected message is sent on the connection and
+ * the tables are left as they were before the commit.
+ *
+ * Supported messages are flow_add, flow_modify_strict, flow_delete_strict
+ * and group_mod for a single group.
+ *
+ * A flow add that would take a table over its limit (see
+ * ind_core_table_eviction_set) fails validation unless the table has an
+ * eviction policy; applying it then evicts the flow the policy picks.
+ * Evicted flows are put back if the bundle is rolled back.
+ */
+
+typedef struct ind_core_bundle_s ind_core_bundle_t;
+
+/**
+ * Create an empty bundle
+ * @returns The bundle, or NULL if out of memory
+ */
+ind_core_bundle_t *ind_core_bundle_create(void);
+
+/**
+ * Stage a message in a bundle
+ * @param bundle The bundle
+ * @param obj The message; ownership is taken, even on error
+ * @returns INDIGO_ERROR_NOT_SUPPORTED for other message types
+ */
+indigo_error_t ind_core_bundle_add(ind_core_bundle_t *bundle, of_object_t *obj);
+
+/**
+ * Apply every message staged in a bundle, or none of them
+ * @param bundle The bundle; empty on return
+ * @param cxn_id Connection for error messages
+ * @returns The error of the message that failed validation or was
+ * rejected by forwarding
+ */
+indigo_error_t ind_core_bundle_commit(ind_core_bundle_t *bundle,
+                                      indigo_cxn_id_t cxn_id);
+
+/**
+ * Free a bundle and any messages still staged in it
+ * @param bundle The bundle
+ */
+void ind_core_bundle_destroy(ind_core_bundle_t *bundle);
+
+/**
+ * @brief Bundle experimenter extension
+ *
+ * Controllers use bundles through the ONF OpenFlow 1.3 bundle extension
+ * (EXT-230), carried in experimenter messages. Bundles belong to the
+ * connection that opened them and are discarded when it closes. All
+ * fields are in network byte order.
+ *
+ * BUNDLE_CONTROL data, 8 bytes; any properties after them are ignored:
+ *   uint32 bundle_id    Chosen by the controller, unique per connection
+ *   uint16 type         IND_CORE_BUNDLE_*_REQUEST, or _REPLY in replies
+ *   uint16 flags        IND_CORE_BUNDLE_FLAG_*
+ *
+ * BUNDLE_ADD_MESSAGE data:
+ *   uint32 bundle_id
+ *   uint16 pad
+ *   uint16 flags
+ *   ofp_header ...      The message to stage, of the request's version
+ *
+ * Each control request is answered with its reply, carrying the request's
+ * xid, bundle_id and flags. Adding to a bundle that is not open opens it.
+ * A commit or discard ends the bundle. Every bundle is applied atomically
+ * and in order, whatever its flags.
+ *
+ * Errors are bad request errors rather than the extension's own: EPERM
+ * for opening an open bundle, for an unknown or closed one and for a
+ * failed commit, BAD_TYPE for a message that cannot be bundled,
+ * BAD_VERSION for one of another version and BAD_LEN for short data. A
+ * failed commit sends the error for the message that failed before the
+ * EPERM for the commit; the bundle is discarded.
+ */
+
+#define IND_CORE_BUNDLE_EXPERIMENTER_ID      0x4f4e4600
+#define IND_CORE_BUNDLE_CONTROL              2300
+#define IND_CORE_BUNDLE_ADD_MESSAGE          2301
+
+#define IND_CORE_BUNDLE_CONTROL_LEN          8
+#define IND_CORE_BUNDLE_ADD_HDR_LEN          8
+
+#define IND_CORE_BUNDLE_OPEN_REQUEST         0
+#define IND_CORE_BUNDLE_OPEN_REPLY           1
+#define IND_CORE_BUNDLE_CLOSE_REQUEST        2
+#define IND_CORE_BUNDLE_CLOSE_REPLY          3
+#define IND_CORE_BUNDLE_COMMIT_REQUEST       4
+#define IND_CORE_BUNDLE_COMMIT_REPLY         5
+#define IND_CORE_BUNDLE_DISCARD_REQUEST      6
+#define IND_CORE_BUNDLE_DISCARD_REPLY        7
+
+#define IND_CORE_BUNDLE_FLAG_ATOMIC          (1 << 0)
+#define IND_CORE_BUNDLE_FLAG_ORDERED         (1 << 1)
+
+/**
+ * @brief Flow monitor experimenter extension
+ *
+ * An OpenFlow 1.3 experimenter message carrying an OF 1.4 style flow
+ * monitor. A controller subscribes with a FLOW_MONITOR_REQUEST and then
+ * receives FLOW_MONITOR_UPDATE messages as flows matching the request's
+ * table, cookie and out_port are added, modified and removed, instead of
+ * repeating full flow stats dumps. Subscriptions end when the connection
+ * closes. All fields are in network byte order.
+ *
+ * FLOW_MONITOR_REQUEST data, 32 bytes:
+ *   uint32 monitor_id   Chosen by the controller, unique per connection
+ *   uint16 command      IND_CORE_FLOW_MONITOR_CMD_*
+ *   uint16 flags        IND_CORE_FLOW_MONITOR_FLAG_*
+ *   uint32 out_port     OFPP_ANY for any
+ *   uint8  table_id     0xff for any
+ *   uint8  pad[3]
+ *   uint64 cookie
+ *   uint64 cookie_mask  0 for any
+ *
+ * FLOW_MONITOR_UPDATE data:
+ *   uint32 monitor_id
+ *   uint16 event        IND_CORE_FLOW_MONITOR_EVENT_*
+ *   uint16 reason       OFPRR_* for REMOVED, otherwise 0
+ *   ofp_flow_stats[]    The flows, as in a flow stats reply, but with
+ *                       packet_count and byte_count always 0
+ *
+ * With the INITIAL flag, the flows already in the table are sent as
+ * INITIAL updates with the request's xid, followed by an empty SYNCED
+ * update; every later change is sent after it. Updates do not carry
+ * counters, as OF 1.4 flow_update_full does not; use flow stats for them.
+ *
+ * An add that replaces a flow with the same match and priority is sent
+ * as MODIFIED, whether or not forwarding could overwrite it in place.
+ */
+
+#define IND_CORE_FLOW_MONITOR_EXPERIMENTER_ID 0x00001018
+#define IND_CORE_FLOW_MONITOR_REQUEST         1
+#define IND_CORE_FLOW_MONITOR_UPDATE          2
+
+#define IND_CORE_FLOW_MONITOR_REQUEST_LEN     32
+#define IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN  8
+
+#define IND_CORE_FLOW_MONITOR_CMD_ADD         0
+#define IND_CORE_FLOW_MONITOR_CMD_MODIFY      1
+#define IND_CORE_FLOW_MONITOR_CMD_DELETE      2
+
+#define IND_CORE_FLOW_MONITOR_FLAG_INITIAL    (1 << 0)
+#define IND_CORE_FLOW_MONITOR_FLAG_ADD        (1 << 1)
+#define IND_CORE_FLOW_MONITOR_FLAG_REMOVED    (1 << 2)
+#define IND_CORE_FLOW_MONITOR_FLAG_MODIFY     (1 << 3)
+
+typedef enum ind_core_flow_monitor_event_e {
+    IND_CORE_FLOW_MONITOR_EVENT_INITIAL = 0,
+    IND_CORE_FLOW_MONITOR_EVENT_ADDED = 1,
+    IND_CORE_FLOW_MONITOR_EVENT_REMOVED = 2,
+    IND_CORE_FLOW_MONITOR_EVENT_MODIFIED = 3,
+    IND_CORE_FLOW_MONITOR_EVENT_SYNCED = 4,
+} ind_core_flow_monitor_event_t;
+
+/**
+ * @brief Warm restart from a saved state file
+ *
+ * The flow and group tables are written to the configured state file
+ * periodically and from ind_core_finish, replacing the file atomically.
+ * After a restart, ind_core_state_restore reloads it before the core is
+ * enabled. Each group and then each flow is offered to forwarding to
+ * reconcile against what it still has installed; those it no longer has
+ * are installed again, and forwarding then removes whatever it holds that
+ * was not restored. Only objects forwarding rejects are dropped, for the
+ * controller to push again. Flows keep their flow
+ * IDs and original insert times.
+ *
+ * The file is in network byte order:
+ *   uint32 magic        IND_CORE_STATE_MAGIC
+ *   uint16 version      IND_CORE_STATE_VERSION
+ *   uint16 pad
+ *   uint32 group_count
+ *   uint32 flow_count
+ * then group_count group records:
+ *   uint32 length
+ *   uint8  group_mod[length]  An OFPGC_ADD group_mod of the group
+ * then flow_count flow records:
+ *   uint64 flow_id
+ *   uint64 packets_base  Forwarding counts when counters were last reset
+ *   uint64 bytes_base
+ *   uint32 age_sec       Seconds since the flow was inserted
+ *   uint32 length
+ *   uint8  flow_add[length]   A flow_add of the flow
+ */
+
+#define IND_CORE_STATE_MAGIC   0x49534654 /* "ISFT" */
+#define IND_CORE_STATE_VERSION 1
+
+/**
+ * Save the flow and group tables
+ * @param path File to replace
+ *
+ * Runs to completion on the caller's thread, waiting for any periodic
+ * save in progress; periodic saves happen in the background.
+ */
+indigo_error_t ind_core_state_save(const char *path);
+
+/**
+ * Restore the flow and group tables and reconcile them with forwarding
+ * @param path File written by ind_core_state_save
+ * @returns INDIGO_ERROR_NOT_FOUND if there is no file, or
+ * INDIGO_ERROR_PARSE if it is not a readable state file. Forwarding is
+ * left with just what was restored, except after INDIGO_ERROR_PARSE: a
+ * truncated or corrupt file keeps forwarding from removing anything.
+ *
+ * Call after ind_core_init and before ind_core_enable_set, with empty
+ * flow and group tables.
+ */
+indigo_error_t ind_core_state_restore(const char *path);
+
 /**
  * Dump all entries in the flow table.
  * This is verbose.
@@ -0,0 +1,1282 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/**
+ * @file
+ * @brief Bundles of flow and group mods applied as one unit
+ *
+ * A commit makes two passes over the staged messages. The first checks
+ * each against the flow and group tables as they will be when it is
+ * reached, without touching forwarding. The second applies them in
+ * order, recording what each one replaced. If forwarding rejects a
+ * message, the messages already applied are undone in reverse order.
+ *
+ * Flow entries deleted or replaced during the commit, including those
+ * forwarding to a deleted group, are detached from the flow table rather
+ * than freed, so they can be put back unchanged.
+ * Flow removed messages for them are only sent once the whole bundle has
+ * been applied.
+ *
+ * Table limits are checked in both passes. Validation counts the flows
+ * the bundle adds to and deletes from each table, and rejects an add that
+ * would take a table with no eviction policy over its limit. Applying an
+ * add checks the table again, as the flow add handler does, and detaches
+ * the flow the policy picks to make room.
+ *
+ * Controllers reach bundles through the experimenter messages described
+ * in ofstatemanager.h; bundles opened by a connection are kept on a list
+ * and discarded when it closes.
+ */
+
+#include "ofstatemanager_log.h"
+
+#include <OFStateManager/ofstatemanager.h>
+#include <OFConnectionManager/ofconnectionmanager.h>
+#include <indigo/indigo.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <indigo/forwarding.h>
+#include <loci/loci.h>
+#include <AIM/aim_list.h>
+#include "ofstatemanager_decs.h"
+#include "ofstatemanager_int.h"
+#include "ft.h"
+
+/* A flow removed along with the group it forwards to */
+typedef struct bundle_group_flow_s {
+    ft_entry_t *entry;
+    indigo_fi_flow_stats_t stats;
+} bundle_group_flow_t;
+
+/**
+ * A staged message and, once applied, what it changed
+ */
+typedef struct ind_core_bundle_msg_s {
+    list_links_t links;            /* In bundle->msgs */
+    of_object_t *obj;
+
+    ft_entry_t *added;             /* Entry added */
+    ft_entry_t *modified;          /* Entry whose effects were replaced */
+    of_flow_modify_t *restore;     /* The replaced effects of modified */
+    ft_entry_t *removed;           /* Entry detached by a delete or add */
+    indigo_fi_flow_stats_t removed_stats;
+    ft_entry_t *evicted;           /* Entry detached to make room for added */
+    indigo_fi_flow_stats_t evicted_stats;
+    of_meta_match_t query;         /* Flow mods: strict query, from validation */
+
+    int group_applied;             /* Boolean */
+    int group_existed;             /* Boolean; group before the message */
+    uint8_t group_type;
+    of_list_bucket_t *group_buckets;
+    bundle_group_flow_t *group_flows;  /* Detached by a group delete */
+    int group_flow_count;
+} ind_core_bundle_msg_t;
+
+struct ind_core_bundle_s {
+    list_head_t msgs;              /* ind_core_bundle_msg_t, in order added */
+};
+
+/* A bundle opened with a BUNDLE_CONTROL or BUNDLE_ADD_MESSAGE */
+typedef struct bundle_cxn_s {
+    list_links_t links;            /* In bundle_cxn_bundles */
+    indigo_cxn_id_t cxn_id;
+    uint32_t id;                   /* Chosen by the controller */
+    int closed;                    /* Boolean; no more adds */
+    ind_core_bundle_t *bundle;
+} bundle_cxn_t;
+
+static LIST_DEFINE(bundle_cxn_bundles);
+
+/****************************************************************
+ * Helpers
+ ****************************************************************/
+
+/* True for a message that installs a flow */
+static int
+bundle_msg_is_flow_add(of_object_t *obj)
+{
+    return obj->object_id == OF_FLOW_ADD ||
+        obj->object_id == OF_FLOW_MODIFY_STRICT;
+}
+
+static void
+bundle_group_error_send(of_object_t *obj, indigo_cxn_id_t cxn_id,
+                        uint16_t code)
+{
+    uint32_t xid;
+
+    of_group_mod_xid_get(obj, &xid);
+    indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                              OF_ERROR_TYPE_GROUP_MOD_FAILED, code, NULL);
+}
+
+static uint16_t
+bundle_group_error_code(of_object_t *obj, indigo_error_t rv)
+{
+    uint16_t command;
+
+    of_group_mod_command_get(obj, &command);
+
+    switch (rv) {
+    case INDIGO_ERROR_EXISTS:
+        return OF_GROUP_MOD_FAILED_GROUP_EXISTS;
+    case INDIGO_ERROR_NOT_FOUND:
+        return OF_GROUP_MOD_FAILED_UNKNOWN_GROUP;
+    case INDIGO_ERROR_RESOURCE:
+        return OF_GROUP_MOD_FAILED_OUT_OF_GROUPS;
+    case INDIGO_ERROR_PARAM:
+        /* See ind_core_group_delete_with_flows */
+        if (command == OF_GROUP_DELETE) {
+            return OF_GROUP_MOD_FAILED_CHAINED_GROUP;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return OF_GROUP_MOD_FAILED_INVALID_GROUP;
+}
+
+/* The last group_mod for the id before the message 'upto', or NULL */
+static ind_core_bundle_msg_t *
+bundle_group_last_msg(ind_core_bundle_t *bundle, ind_core_bundle_msg_t *upto,
+                      uint32_t id)
+{
+    list_links_t *cur;
+    uint32_t msg_id;
+
+    for (cur = upto->links.prev; cur != &bundle->msgs.links; cur = cur->prev) {
+        ind_core_bundle_msg_t *msg =
+            container_of(cur, links, ind_core_bundle_msg_t);
+        if (msg->obj->object_id != OF_GROUP_MOD) {
+            continue;
+        }
+        of_group_mod_group_id_get(msg->obj, &msg_id);
+        if (msg_id == id) {
+            return msg;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Whether a group exists when the message 'upto' is reached: decided by
+ * the last earlier group_mod for the id, else by the group table.
+ */
+static int
+bundle_group_exists(ind_core_bundle_t *bundle, ind_core_bundle_msg_t *upto,
+                    uint32_t id)
+{
+    ind_core_bundle_msg_t *msg;
+    uint16_t command;
+
+    if ((msg = bundle_group_last_msg(bundle, upto, id)) != NULL) {
+        of_group_mod_command_get(msg->obj, &command);
+        return command != OF_GROUP_DELETE;
+    }
+
+    return ind_core_group_get(id, NULL, NULL) == INDIGO_ERROR_NONE;
+}
+
+struct bundle_group_referrer_state {
+    ind_core_bundle_t *bundle;
+    ind_core_bundle_msg_t *upto;
+    uint32_t id;
+    int found;                     /* Boolean */
+};
+
+/* Check a group in the table the bundle has not changed by 'upto' */
+static void
+bundle_group_referrer_check(void *cookie, uint32_t group_id, uint8_t type,
+                            of_list_bucket_t *buckets)
+{
+    struct bundle_group_referrer_state *state = cookie;
+
+    if (!state->found && group_id != state->id &&
+        bundle_group_last_msg(state->bundle, state->upto, group_id) == NULL &&
+        ind_core_group_buckets_forward_to(buckets, state->id)) {
+        state->found = 1;
+    }
+}
+
+/*
+ * Whether another group forwards to a group when the message 'upto' is
+ * reached: either one in the group table the bundle has not changed by
+ * then, or one as added or modified by its last earlier group_mod.
+ */
+static int
+bundle_group_referenced(ind_core_bundle_t *bundle, ind_core_bundle_msg_t *upto,
+                        uint32_t id)
+{
+    struct bundle_group_referrer_state state = {
+        .bundle = bundle, .upto = upto, .id = id, .found = 0
+    };
+    of_list_bucket_t buckets;
+    list_links_t *cur;
+    uint32_t msg_id;
+    uint16_t command;
+
+    ind_core_group_iter(bundle_group_referrer_check, &state);
+    if (state.found) {
+        return 1;
+    }
+
+    for (cur = upto->links.prev; cur != &bundle->msgs.links; cur = cur->prev) {
+        ind_core_bundle_msg_t *msg =
+            container_of(cur, links, ind_core_bundle_msg_t);
+        if (msg->obj->object_id != OF_GROUP_MOD) {
+            continue;
+        }
+        of_group_mod_group_id_get(msg->obj, &msg_id);
+        of_group_mod_command_get(msg->obj, &command);
+        if (msg_id == id || command == OF_GROUP_DELETE ||
+                bundle_group_last_msg(bundle, upto, msg_id) != msg) {
+            continue;
+        }
+        of_group_mod_buckets_bind(msg->obj, &buckets);
+        if (ind_core_group_buckets_forward_to(&buckets, id)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Whether two strict queries select the same flow */
+static int
+bundle_flow_same(of_meta_match_t *a, of_meta_match_t *b)
+{
+    return a->table_id == b->table_id && a->priority == b->priority &&
+        of_match_eq(&a->match, &b->match);
+}
+
+/*
+ * Whether the flow a message's query selects exists when the message is
+ * reached: decided by the last earlier flow mod for it, else by the flow
+ * table. Flows deleted along with a group are still counted.
+ */
+static int
+bundle_flow_exists(ind_core_bundle_t *bundle, ind_core_bundle_msg_t *upto)
+{
+    list_links_t *cur;
+    ft_entry_t *entry;
+
+    for (cur = upto->links.prev; cur != &bundle->msgs.links; cur = cur->prev) {
+        ind_core_bundle_msg_t *msg =
+            container_of(cur, links, ind_core_bundle_msg_t);
+        if (msg->obj->object_id == OF_GROUP_MOD ||
+                !bundle_flow_same(&msg->query, &upto->query)) {
+            continue;
+        }
+        return msg->obj->object_id != OF_FLOW_DELETE_STRICT;
+    }
+
+    return ft_strict_match(ind_core_ft, &upto->query, &entry) ==
+        INDIGO_ERROR_NONE;
+}
+
+/****************************************************************
+ * Validation
+ ****************************************************************/
+
+static indigo_error_t
+bundle_flow_add_validate(of_flow_modify_t *obj, indigo_cxn_id_t cxn_id)
+{
+    of_version_t ver = obj->version;
+    of_meta_match_t query;
+    ft_entry_t *entry;
+    uint16_t flags, idle_timeout, hard_timeout;
+    uint32_t xid;
+    indigo_error_t rv;
+
+    of_flow_modify_flags_get(obj, &flags);
+    of_flow_modify_xid_get(obj, &xid);
+    of_flow_modify_idle_timeout_get(obj, &idle_timeout);
+    of_flow_modify_hard_timeout_get(obj, &hard_timeout);
+
+    if (flags & OF_FLOW_MOD_FLAG_CHECK_OVERLAP_BY_VERSION(ver)) {
+        rv = ind_core_flow_mod_setup_query(obj, &query, OF_MATCH_OVERLAP, 1);
+        if (rv != INDIGO_ERROR_NONE) {
+            return rv;
+        }
+        if (ft_overlap_find(ind_core_ft, &query, &entry) == INDIGO_ERROR_NONE) {
+            LOG_TRACE("Overlap found in bundle flow add");
+            ind_core_send_error_msg(ver, cxn_id, xid,
+                                    OF_ERROR_TYPE_FLOW_MOD_FAILED_BY_VERSION(ver),
+                                    OF_FLOW_MOD_FAILED_OVERLAP_BY_VERSION(ver),
+                                    obj, NULL);
+            return INDIGO_ERROR_EXISTS;
+        }
+    }
+
+    if ((flags & OF_FLOW_MOD_FLAG_EMERG_BY_VERSION(ver)) &&
+        (idle_timeout != 0 || hard_timeout != 0)) {
+        LOG_TRACE("Bundle flow add sets timeout on an emergency flow");
+        ind_core_send_error_msg(ver, cxn_id, xid,
+                                OF_ERROR_TYPE_FLOW_MOD_FAILED_BY_VERSION(ver),
+                                OF_FLOW_MOD_FAILED_BAD_EMERG_TIMEOUT_BY_VERSION(ver),
+                                obj, NULL);
+        return INDIGO_ERROR_PARAM;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/*
+ * Check a flow mod and count the flow it adds to or deletes from its
+ * table in table_delta; an add must leave room or a flow to evict
+ */
+static indigo_error_t
+bundle_flow_validate(ind_core_bundle_t *bundle, ind_core_bundle_msg_t *msg,
+                     int *table_delta, indigo_cxn_id_t cxn_id)
+{
+    of_flow_modify_t *obj = msg->obj;
+    uint8_t table_id;
+    int exists;
+    indigo_error_t rv;
+
+    if (bundle_msg_is_flow_add(obj)) {
+        rv = bundle_flow_add_validate(obj, cxn_id);
+        if (rv != INDIGO_ERROR_NONE) {
+            return rv;
+        }
+    }
+
+    rv = ind_core_flow_mod_setup_query(obj, &msg->query, OF_MATCH_STRICT,
+                                       bundle_msg_is_flow_add(obj));
+    if (rv != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+
+    /* OpenFlow 1.0 flows all go in table 0 */
+    table_id = msg->query.table_id == TABLE_ID_ANY ? 0 : msg->query.table_id;
+    exists = bundle_flow_exists(bundle, msg);
+
+    if (obj->object_id == OF_FLOW_DELETE_STRICT) {
+        table_delta[table_id] -= exists;
+        return INDIGO_ERROR_NONE;
+    }
+    if (exists) {
+        /* Replaced or modified; the table keeps its count */
+        return INDIGO_ERROR_NONE;
+    }
+
+    table_delta[table_id] += 1;
+    if (ft_table_over_limit_after(ind_core_ft, table_id,
+                                  table_delta[table_id]) &&
+            ind_core_ft->tables[table_id].eviction == FT_EVICTION_NONE) {
+        LOG_VERBOSE("Bundle flow add would overfill table %d", table_id);
+        ind_core_ft->status.table_full_errors += 1;
+        ind_core_flow_mod_err_msg_send(INDIGO_ERROR_RESOURCE, obj->version,
+                                       cxn_id, obj);
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+static indigo_error_t
+bundle_group_validate(ind_core_bundle_t *bundle, ind_core_bundle_msg_t *msg,
+                      indigo_cxn_id_t cxn_id)
+{
+    uint16_t command;
+    uint32_t id;
+    int exists;
+
+    of_group_mod_command_get(msg->obj, &command);
+    of_group_mod_group_id_get(msg->obj, &id);
+
+    if (id > OF_GROUP_MAX) {
+        bundle_group_error_send(msg->obj, cxn_id,
+                                OF_GROUP_MOD_FAILED_INVALID_GROUP);
+        return INDIGO_ERROR_PARAM;
+    }
+
+    exists = bundle_group_exists(bundle, msg, id);
+    if (command == OF_GROUP_ADD && exists) {
+        bundle_group_error_send(msg->obj, cxn_id,
+                                OF_GROUP_MOD_FAILED_GROUP_EXISTS);
+        return INDIGO_ERROR_EXISTS;
+    }
+    if (command == OF_GROUP_MODIFY && !exists) {
+        bundle_group_error_send(msg->obj, cxn_id,
+                                OF_GROUP_MOD_FAILED_UNKNOWN_GROUP);
+        return INDIGO_ERROR_NOT_FOUND;
+    }
+    if (command == OF_GROUP_DELETE && exists &&
+            bundle_group_referenced(bundle, msg, id)) {
+        bundle_group_error_send(msg->obj, cxn_id,
+                                OF_GROUP_MOD_FAILED_CHAINED_GROUP);
+        return INDIGO_ERROR_PARAM;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/****************************************************************
+ * Apply and undo
+ ****************************************************************/
+
+/* Delete an entry from forwarding and detach it from the flow table */
+static indigo_error_t
+bundle_flow_remove(ind_core_bundle_msg_t *msg, ft_entry_t *entry)
+{
+    indigo_error_t rv;
+
+    rv = indigo_fwd_flow_delete(entry->id, &msg->removed_stats);
+    if (rv != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+    ft_detach(ind_core_ft, entry);
+    msg->removed = entry;
+
+    return INDIGO_ERROR_NONE;
+}
+
+/*
+ * Detach the flow entry's table policy picks to make room for it, as
+ * flow_evict_for does outside bundles. A message evicts at most one flow.
+ */
+static indigo_error_t
+bundle_flow_evict(ind_core_bundle_msg_t *msg, ft_entry_t *entry)
+{
+    ft_entry_t *victim;
+    indigo_error_t rv;
+
+    victim = ft_eviction_victim(ind_core_ft, entry->table_id);
+    if (msg->evicted != NULL || victim == NULL || victim == entry) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    rv = indigo_fwd_flow_delete(victim->id, &msg->evicted_stats);
+    if (rv != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+    ft_detach(ind_core_ft, victim);
+    msg->evicted = victim;
+
+    return INDIGO_ERROR_NONE;
+}
+
+/* Add a flow, replacing any with the same match and priority */
+static indigo_error_t
+bundle_flow_add_apply(ind_core_bundle_msg_t *msg, of_flow_modify_t *obj,
+                      ft_entry_t *existing)
+{
+    indigo_flow_id_t flow_id;
+    ft_entry_t *entry;
+    uint8_t requested_table_id, table_id;
+    indigo_error_t rv;
+
+    if (existing != NULL) {
+        if ((rv = bundle_flow_remove(msg, existing)) != INDIGO_ERROR_NONE) {
+            return rv;
+        }
+    }
+
+    flow_id = ind_core_flow_id_next();
+    if ((rv = ft_add(ind_core_ft, flow_id, obj, &entry)) != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+    requested_table_id = entry->table_id;
+
+    /* A table at its limit takes the add only if another flow can go */
+    if (ft_table_over_limit(ind_core_ft, entry->table_id) &&
+            bundle_flow_evict(msg, entry) != INDIGO_ERROR_NONE) {
+        LOG_VERBOSE("Table %d is full", entry->table_id);
+        ind_core_ft->status.table_full_errors += 1;
+        ft_delete(ind_core_ft, entry);
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    rv = indigo_fwd_flow_create(flow_id, obj, &table_id);
+    if (rv == INDIGO_ERROR_RESOURCE &&
+            bundle_flow_evict(msg, entry) == INDIGO_ERROR_NONE) {
+        /* Forwarding's table is full, so room must be made first */
+        rv = indigo_fwd_flow_create(flow_id, obj, &table_id);
+    }
+    if (rv != INDIGO_ERROR_NONE) {
+        ind_core_ft->status.forwarding_add_errors += 1;
+        ft_delete(ind_core_ft, entry);
+        return rv;
+    }
+    msg->added = entry;
+
+    if ((rv = ft_entry_set_table_id(ind_core_ft, entry,
+                                    table_id)) != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+
+    /* Only if forwarding placed it in another, full table */
+    if (entry->table_id != requested_table_id &&
+            ft_table_over_limit(ind_core_ft, entry->table_id) &&
+            bundle_flow_evict(msg, entry) != INDIGO_ERROR_NONE) {
+        LOG_VERBOSE("Table %d is full", entry->table_id);
+        ind_core_ft->status.table_full_errors += 1;
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+static indigo_error_t
+bundle_flow_modify_apply(ind_core_bundle_msg_t *msg, of_flow_modify_t *obj,
+                         ft_entry_t *entry)
+{
+    indigo_error_t rv;
+
+    msg->restore = ind_core_flow_mod_from_entry(entry, OF_FLOW_MODIFY_STRICT);
+    if (msg->restore == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    if ((rv = indigo_fwd_flow_modify(entry->id, obj)) != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+    msg->modified = entry;
+
+    return ft_entry_modify_effects(ind_core_ft, entry, obj);
+}
+
+/* Detach a flow forwarding to the group a message deletes */
+static indigo_error_t
+bundle_group_flow_remove(void *cookie, ft_entry_t *entry)
+{
+    ind_core_bundle_msg_t *msg = cookie;
+    bundle_group_flow_t *flows;
+    indigo_error_t rv;
+
+    flows = INDIGO_MEM_REALLOC(msg->group_flows,
+                               (msg->group_flow_count + 1) * sizeof(*flows));
+    if (flows == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    msg->group_flows = flows;
+
+    rv = indigo_fwd_flow_delete(entry->id,
+                                &flows[msg->group_flow_count].stats);
+    if (rv != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+    ft_detach(ind_core_ft, entry);
+    flows[msg->group_flow_count++].entry = entry;
+
+    return INDIGO_ERROR_NONE;
+}
+
+static indigo_error_t
+bundle_group_apply(ind_core_bundle_msg_t *msg)
+{
+    of_list_bucket_t buckets;
+    of_list_bucket_t *old_buckets;
+    uint16_t command;
+    uint8_t type;
+    uint32_t id;
+    indigo_error_t rv;
+
+    of_group_mod_command_get(msg->obj, &command);
+    of_group_mod_group_type_get(msg->obj, &type);
+    of_group_mod_group_id_get(msg->obj, &id);
+    of_group_mod_buckets_bind(msg->obj, &buckets);
+
+    if (ind_core_group_get(id, &msg->group_type,
+                           &old_buckets) == INDIGO_ERROR_NONE) {
+        msg->group_existed = 1;
+        msg->group_buckets = of_object_dup(old_buckets);
+        if (msg->group_buckets == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+    }
+
+    switch (command) {
+    case OF_GROUP_ADD:
+        rv = ind_core_group_add(id, type, &buckets);
+        break;
+    case OF_GROUP_MODIFY:
+        rv = ind_core_group_modify(id, type, &buckets);
+        break;
+    case OF_GROUP_DELETE:
+        rv = msg->group_existed ?
+            ind_core_group_delete_with_flows(id, bundle_group_flow_remove, msg) :
+            INDIGO_ERROR_NONE;
+        break;
+    default:
+        rv = INDIGO_ERROR_PARAM;
+        break;
+    }
+
+    if (rv == INDIGO_ERROR_NONE) {
+        msg->group_applied = 1;
+    }
+
+    return rv;
+}
+
+static indigo_error_t
+bundle_msg_apply(ind_core_bundle_msg_t *msg)
+{
+    of_flow_modify_t *obj = msg->obj;
+    ft_entry_t *entry;
+
+    if (msg->obj->object_id == OF_GROUP_MOD) {
+        return bundle_group_apply(msg);
+    }
+
+    /* The query was set up by validation */
+    if (ft_strict_match(ind_core_ft, &msg->query, &entry) != INDIGO_ERROR_NONE) {
+        entry = NULL;
+    }
+
+    switch (obj->object_id) {
+    case OF_FLOW_ADD:
+        return bundle_flow_add_apply(msg, obj, entry);
+    case OF_FLOW_MODIFY_STRICT:
+        if (entry == NULL) {
+            /* OpenFlow 1.0.0, section 4.6, page 14.  Treat as an add */
+            return bundle_flow_add_apply(msg, obj, NULL);
+        }
+        return bundle_flow_modify_apply(msg, obj, entry);
+    case OF_FLOW_DELETE_STRICT:
+        return entry != NULL ? bundle_flow_remove(msg, entry) :
+            INDIGO_ERROR_NONE;
+    default:
+        return INDIGO_ERROR_NOT_SUPPORTED;
+    }
+}
+
+/* Reinstall a detached flow, or free it if that fails */
+static void
+bundle_flow_restore(ft_entry_t *entry)
+{
+    of_flow_modify_t *restore;
+    uint8_t table_id;
+    indigo_error_t rv;
+
+    restore = ind_core_flow_mod_from_entry(entry, OF_FLOW_ADD);
+    rv = restore != NULL ?
+        indigo_fwd_flow_create(entry->id, restore, &table_id) :
+        INDIGO_ERROR_RESOURCE;
+    if (rv == INDIGO_ERROR_NONE) {
+        /* Forwarding counts the new flow from zero, in its own table */
+        entry->cold->packets_base = 0;
+        entry->cold->bytes_base = 0;
+        entry->cold->packets = 0;
+        entry->cold->bytes = 0;
+        entry->table_id = table_id;
+        rv = ft_reattach(ind_core_ft, entry);
+    }
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Bundle undo: failed to reinstall flow "
+                  INDIGO_FLOW_ID_PRINTF_FORMAT ": %d",
+                  INDIGO_FLOW_ID_PRINTF_ARG(entry->id), rv);
+        ft_free(ind_core_ft, entry);
+    }
+    if (restore != NULL) {
+        of_object_delete(restore);
+    }
+}
+
+/* Undo whatever part of a message was applied; failures are logged */
+static void
+bundle_msg_undo(ind_core_bundle_msg_t *msg)
+{
+    indigo_fi_flow_stats_t flow_stats;
+    uint32_t id;
+    int idx;
+    indigo_error_t rv;
+
+    if (msg->added != NULL) {
+        rv = indigo_fwd_flow_delete(msg->added->id, &flow_stats);
+        if (rv != INDIGO_ERROR_NONE) {
+            LOG_ERROR("Bundle undo: failed to delete flow "
+                      INDIGO_FLOW_ID_PRINTF_FORMAT ": %d",
+                      INDIGO_FLOW_ID_PRINTF_ARG(msg->added->id), rv);
+        }
+        ft_delete(ind_core_ft, msg->added);
+        msg->added = NULL;
+    }
+
+    if (msg->modified != NULL) {
+        rv = indigo_fwd_flow_modify(msg->modified->id, msg->restore);
+        if (rv != INDIGO_ERROR_NONE) {
+            LOG_ERROR("Bundle undo: failed to restore flow "
+                      INDIGO_FLOW_ID_PRINTF_FORMAT ": %d",
+                      INDIGO_FLOW_ID_PRINTF_ARG(msg->modified->id), rv);
+        }
+        ft_entry_modify_effects(ind_core_ft, msg->modified, msg->restore);
+        msg->modified = NULL;
+    }
+
+    if (msg->removed != NULL) {
+        bundle_flow_restore(msg->removed);
+        msg->removed = NULL;
+    }
+
+    if (msg->evicted != NULL) {
+        bundle_flow_restore(msg->evicted);
+        msg->evicted = NULL;
+    }
+
+    if (msg->group_applied) {
+        uint16_t command;
+        of_group_mod_command_get(msg->obj, &command);
+        of_group_mod_group_id_get(msg->obj, &id);
+        if (!msg->group_existed) {
+            rv = command == OF_GROUP_ADD ? ind_core_group_delete(id) :
+                INDIGO_ERROR_NONE;
+        } else if (command == OF_GROUP_DELETE) {
+            rv = ind_core_group_add(id, msg->group_type, msg->group_buckets);
+        } else {
+            rv = ind_core_group_modify(id, msg->group_type, msg->group_buckets);
+        }
+        if (rv != INDIGO_ERROR_NONE) {
+            LOG_ERROR("Bundle undo: failed to restore group %u: %d", id, rv);
+        }
+        msg->group_applied = 0;
+    }
+
+    /* After the group, which they forward to */
+    for (idx = 0; idx < msg->group_flow_count; idx++) {
+        bundle_flow_restore(msg->group_flows[idx].entry);
+    }
+    msg->group_flow_count = 0;
+}
+
+/*
+ * Notify flow monitors of a committed message's changes, and notify and
+ * free the flows it removed
+ */
+static void
+bundle_msg_finish(ind_core_bundle_msg_t *msg)
+{
+    int idx;
+
+    if (msg->added != NULL) {
+        /* An add that replaced a flow is a modify, as outside bundles */
+        ind_core_flow_monitor_notify(msg->added, msg->removed != NULL ?
+                                     IND_CORE_FLOW_MONITOR_EVENT_MODIFIED :
+                                     IND_CORE_FLOW_MONITOR_EVENT_ADDED,
+                                     INDIGO_FLOW_REMOVED_NONE);
+    }
+    if (msg->modified != NULL) {
+        ind_core_flow_monitor_notify(msg->modified,
+                                     IND_CORE_FLOW_MONITOR_EVENT_MODIFIED,
+                                     INDIGO_FLOW_REMOVED_NONE);
+    }
+    if (msg->removed != NULL) {
+        ind_core_flow_removed_notify(msg->removed, &msg->removed_stats,
+                                     msg->obj->object_id == OF_FLOW_ADD ?
+                                     INDIGO_FLOW_REMOVED_OVERWRITE :
+                                     INDIGO_FLOW_REMOVED_DELETE);
+        ft_free(ind_core_ft, msg->removed);
+        msg->removed = NULL;
+    }
+    if (msg->evicted != NULL) {
+        ind_core_ft->status.evictions += 1;
+        ind_core_flow_removed_notify(msg->evicted, &msg->evicted_stats,
+                                     INDIGO_FLOW_REMOVED_EVICTION);
+        ft_free(ind_core_ft, msg->evicted);
+        msg->evicted = NULL;
+    }
+    for (idx = 0; idx < msg->group_flow_count; idx++) {
+        ind_core_flow_removed_notify(msg->group_flows[idx].entry,
+                                     &msg->group_flows[idx].stats,
+                                     INDIGO_FLOW_REMOVED_GROUP_DELETE);
+        ft_free(ind_core_ft, msg->group_flows[idx].entry);
+    }
+    msg->group_flow_count = 0;
+}
+
+static void
+bundle_msg_free(ind_core_bundle_msg_t *msg)
+{
+    list_remove(&msg->links);
+    of_object_delete(msg->obj);
+    if (msg->restore != NULL) {
+        of_object_delete(msg->restore);
+    }
+    if (msg->group_buckets != NULL) {
+        of_object_delete(msg->group_buckets);
+    }
+    if (msg->group_flows != NULL) {
+        INDIGO_MEM_FREE(msg->group_flows);
+    }
+    INDIGO_MEM_FREE(msg);
+}
+
+/****************************************************************
+ * API
+ ****************************************************************/
+
+ind_core_bundle_t *
+ind_core_bundle_create(void)
+{
+    ind_core_bundle_t *bundle;
+
+    bundle = INDIGO_MEM_ALLOC(sizeof(*bundle));
+    if (bundle == NULL) {
+        return NULL;
+    }
+    list_init(&bundle->msgs);
+
+    return bundle;
+}
+
+indigo_error_t
+ind_core_bundle_add(ind_core_bundle_t *bundle, of_object_t *obj)
+{
+    ind_core_bundle_msg_t *msg;
+    uint16_t command;
+    uint32_t id;
+
+    switch (obj->object_id) {
+    case OF_FLOW_ADD:
+    case OF_FLOW_MODIFY_STRICT:
+    case OF_FLOW_DELETE_STRICT:
+        break;
+    case OF_GROUP_MOD:
+        of_group_mod_command_get(obj, &command);
+        of_group_mod_group_id_get(obj, &id);
+        if (id == OF_GROUP_ALL || command > OF_GROUP_DELETE) {
+            of_object_delete(obj);
+            return INDIGO_ERROR_NOT_SUPPORTED;
+        }
+        break;
+    default:
+        LOG_TRACE("Message type %d not supported in bundles", obj->object_id);
+        of_object_delete(obj);
+        return INDIGO_ERROR_NOT_SUPPORTED;
+    }
+
+    msg = INDIGO_MEM_ALLOC(sizeof(*msg));
+    if (msg == NULL) {
+        of_object_delete(obj);
+        return INDIGO_ERROR_RESOURCE;
+    }
+    INDIGO_MEM_SET(msg, 0, sizeof(*msg));
+    msg->obj = obj;
+    list_push(&bundle->msgs, &msg->links);
+
+    return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t
+ind_core_bundle_commit(ind_core_bundle_t *bundle, indigo_cxn_id_t cxn_id)
+{
+    ind_core_bundle_msg_t *msg = NULL;
+    list_links_t *cur, *next;
+    int table_delta[FT_TABLE_COUNT];
+    indigo_error_t rv = INDIGO_ERROR_NONE;
+
+    /* Validate everything before touching forwarding */
+    INDIGO_MEM_SET(table_delta, 0, sizeof(table_delta));
+    LIST_FOREACH(&bundle->msgs, cur) {
+        msg = container_of(cur, links, ind_core_bundle_msg_t);
+        if (msg->obj->object_id == OF_GROUP_MOD) {
+            rv = bundle_group_validate(bundle, msg, cxn_id);
+        } else {
+            rv = bundle_flow_validate(bundle, msg, table_delta, cxn_id);
+        }
+        if (rv != INDIGO_ERROR_NONE) {
+            LOG_VERBOSE("Bundle rejected by validation: %d", rv);
+            goto done;
+        }
+    }
+
+    /* Apply in order */
+    LIST_FOREACH(&bundle->msgs, cur) {
+        msg = container_of(cur, links, ind_core_bundle_msg_t);
+        if ((rv = bundle_msg_apply(msg)) != INDIGO_ERROR_NONE) {
+            break;
+        }
+    }
+
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_VERBOSE("Bundle rejected by forwarding: %d; rolling back", rv);
+        if (msg->obj->object_id == OF_GROUP_MOD) {
+            bundle_group_error_send(msg->obj, cxn_id,
+                                    bundle_group_error_code(msg->obj, rv));
+        } else {
+            ind_core_flow_mod_err_msg_send(rv, msg->obj->version, cxn_id,
+                                           msg->obj);
+        }
+
+        /* The failed message may be partly applied */
+        for (cur = &msg->links; cur != &bundle->msgs.links; cur = cur->prev) {
+            bundle_msg_undo(container_of(cur, links, ind_core_bundle_msg_t));
+        }
+        goto done;
+    }
+
+    LIST_FOREACH(&bundle->msgs, cur) {
+        bundle_msg_finish(container_of(cur, links, ind_core_bundle_msg_t));
+    }
+
+done:
+    LIST_FOREACH_SAFE(&bundle->msgs, cur, next) {
+        bundle_msg_free(container_of(cur, links, ind_core_bundle_msg_t));
+    }
+
+    return rv;
+}
+
+void
+ind_core_bundle_destroy(ind_core_bundle_t *bundle)
+{
+    list_links_t *cur, *next;
+
+    if (bundle == NULL) {
+        return;
+    }
+
+    LIST_FOREACH_SAFE(&bundle->msgs, cur, next) {
+        bundle_msg_free(container_of(cur, links, ind_core_bundle_msg_t));
+    }
+    INDIGO_MEM_FREE(bundle);
+}
+
+/****************************************************************
+ * Experimenter messages
+ ****************************************************************/
+
+static uint16_t
+get_u16(const uint8_t *p)
+{
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static uint32_t
+get_u32(const uint8_t *p)
+{
+    return ((uint32_t)get_u16(p) << 16) | get_u16(p + 2);
+}
+
+static void
+put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v;
+}
+
+static void
+put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, v >> 16);
+    put_u16(p + 2, v);
+}
+
+static bundle_cxn_t *
+bundle_cxn_lookup(indigo_cxn_id_t cxn_id, uint32_t id)
+{
+    bundle_cxn_t *open;
+    list_links_t *cur;
+
+    LIST_FOREACH(&bundle_cxn_bundles, cur) {
+        open = container_of(cur, links, bundle_cxn_t);
+        if (open->cxn_id == cxn_id && open->id == id) {
+            return open;
+        }
+    }
+
+    return NULL;
+}
+
+static bundle_cxn_t *
+bundle_cxn_open(indigo_cxn_id_t cxn_id, uint32_t id)
+{
+    bundle_cxn_t *open;
+
+    if ((open = INDIGO_MEM_ALLOC(sizeof(*open))) == NULL) {
+        return NULL;
+    }
+    if ((open->bundle = ind_core_bundle_create()) == NULL) {
+        INDIGO_MEM_FREE(open);
+        return NULL;
+    }
+    open->cxn_id = cxn_id;
+    open->id = id;
+    open->closed = 0;
+    list_push(&bundle_cxn_bundles, &open->links);
+
+    return open;
+}
+
+static void
+bundle_cxn_free(bundle_cxn_t *open)
+{
+    list_remove(&open->links);
+    ind_core_bundle_destroy(open->bundle);
+    INDIGO_MEM_FREE(open);
+}
+
+static void
+bundle_request_error_send(of_experimenter_t *obj, indigo_cxn_id_t cxn_id,
+                          uint32_t xid, uint16_t code)
+{
+    indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                              OF_ERROR_TYPE_BAD_REQUEST, code, NULL);
+}
+
+/* Answer a BUNDLE_CONTROL request with the reply for its type */
+static void
+bundle_reply_send(of_experimenter_t *req, indigo_cxn_id_t cxn_id,
+                  uint32_t xid, uint32_t id, uint16_t type, uint16_t flags)
+{
+    of_experimenter_t *msg;
+    uint8_t buf[IND_CORE_BUNDLE_CONTROL_LEN];
+    of_octets_t data = { buf, sizeof(buf) };
+
+    if ((msg = of_experimenter_new(req->version)) == NULL) {
+        LOG_ERROR("Failed to allocate bundle control reply");
+        return;
+    }
+
+    put_u32(buf, id);
+    put_u16(buf + 4, type + 1);
+    put_u16(buf + 6, flags);
+
+    of_experimenter_xid_set(msg, xid);
+    of_experimenter_experimenter_set(msg, IND_CORE_BUNDLE_EXPERIMENTER_ID);
+    of_experimenter_subtype_set(msg, IND_CORE_BUNDLE_CONTROL);
+    if (of_experimenter_data_set(msg, &data) < 0) {
+        LOG_ERROR("Failed to set bundle control reply data");
+        of_object_delete(msg);
+        return;
+    }
+
+    if (IND_CORE_MSG_SEND(cxn_id, msg) < 0) {
+        LOG_ERROR("Failed to send bundle control reply to cxn %d", cxn_id);
+    }
+}
+
+static void
+bundle_control_handle(of_experimenter_t *obj, indigo_cxn_id_t cxn_id,
+                      uint32_t xid, of_octets_t *data)
+{
+    bundle_cxn_t *open;
+    uint32_t id;
+    uint16_t type, flags;
+    indigo_error_t rv;
+
+    if (data->bytes < IND_CORE_BUNDLE_CONTROL_LEN) {
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_BAD_LEN);
+        return;
+    }
+
+    id = get_u32(data->data);
+    type = get_u16(data->data + 4);
+    flags = get_u16(data->data + 6);
+    open = bundle_cxn_lookup(cxn_id, id);
+
+    LOG_TRACE("Bundle %u control %u from cxn %d", id, type, cxn_id);
+
+    switch (type) {
+    case IND_CORE_BUNDLE_OPEN_REQUEST:
+        if (open != NULL) {
+            break;
+        }
+        if (bundle_cxn_open(cxn_id, id) == NULL) {
+            LOG_ERROR("Failed to allocate bundle");
+            break;
+        }
+        bundle_reply_send(obj, cxn_id, xid, id, type, flags);
+        return;
+    case IND_CORE_BUNDLE_CLOSE_REQUEST:
+        if (open == NULL || open->closed) {
+            break;
+        }
+        open->closed = 1;
+        bundle_reply_send(obj, cxn_id, xid, id, type, flags);
+        return;
+    case IND_CORE_BUNDLE_COMMIT_REQUEST:
+        if (open == NULL) {
+            break;
+        }
+        /* The message that failed has had its own error sent first */
+        rv = ind_core_bundle_commit(open->bundle, cxn_id);
+        bundle_cxn_free(open);
+        if (rv != INDIGO_ERROR_NONE) {
+            break;
+        }
+        bundle_reply_send(obj, cxn_id, xid, id, type, flags);
+        return;
+    case IND_CORE_BUNDLE_DISCARD_REQUEST:
+        if (open == NULL) {
+            break;
+        }
+        bundle_cxn_free(open);
+        bundle_reply_send(obj, cxn_id, xid, id, type, flags);
+        return;
+    default:
+        bundle_request_error_send(obj, cxn_id, xid,
+                                  OF_REQUEST_FAILED_BAD_EXPERIMENTER_TYPE);
+        return;
+    }
+
+    /* Opening an open bundle, or acting on an unknown or failed one */
+    bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_EPERM);
+}
+
+static void
+bundle_add_handle(of_experimenter_t *obj, indigo_cxn_id_t cxn_id,
+                  uint32_t xid, of_octets_t *data)
+{
+    bundle_cxn_t *open;
+    of_object_t *msg;
+    uint8_t *inner, *buf;
+    uint32_t id;
+    int len;
+    indigo_error_t rv;
+
+    if (data->bytes < IND_CORE_BUNDLE_ADD_HDR_LEN + OF_MESSAGE_MIN_LENGTH) {
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_BAD_LEN);
+        return;
+    }
+
+    id = get_u32(data->data);
+    inner = data->data + IND_CORE_BUNDLE_ADD_HDR_LEN;
+    len = get_u16(inner + 2);
+    if (len < OF_MESSAGE_MIN_LENGTH ||
+            len > data->bytes - IND_CORE_BUNDLE_ADD_HDR_LEN) {
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_BAD_LEN);
+        return;
+    }
+    if (inner[0] != obj->version) {
+        bundle_request_error_send(obj, cxn_id, xid,
+                                  OF_REQUEST_FAILED_BAD_VERSION);
+        return;
+    }
+
+    LOG_TRACE("Bundle %u add from cxn %d", id, cxn_id);
+
+    /* Adding to a bundle opens it */
+    if ((open = bundle_cxn_lookup(cxn_id, id)) == NULL &&
+            (open = bundle_cxn_open(cxn_id, id)) == NULL) {
+        LOG_ERROR("Failed to allocate bundle");
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_EPERM);
+        return;
+    }
+    if (open->closed) {
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_EPERM);
+        return;
+    }
+
+    if ((buf = INDIGO_MEM_ALLOC(len)) == NULL) {
+        LOG_ERROR("Failed to allocate bundled message");
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_EPERM);
+        return;
+    }
+    INDIGO_MEM_COPY(buf, inner, len);
+    if ((msg = of_object_new_from_message(OF_BUFFER_TO_MESSAGE(buf),
+                                          len)) == NULL) {
+        INDIGO_MEM_FREE(buf);
+        bundle_request_error_send(obj, cxn_id, xid, OF_REQUEST_FAILED_BAD_TYPE);
+        return;
+    }
+
+    rv = ind_core_bundle_add(open->bundle, msg);
+    if (rv != INDIGO_ERROR_NONE) {
+        bundle_request_error_send(obj, cxn_id, xid,
+                                  rv == INDIGO_ERROR_NOT_SUPPORTED ?
+                                  OF_REQUEST_FAILED_BAD_TYPE :
+                                  OF_REQUEST_FAILED_EPERM);
+    }
+}
+
+int
+ind_core_bundle_handler(of_experimenter_t *obj, indigo_cxn_id_t cxn_id)
+{
+    uint32_t experimenter;
+    uint32_t subtype;
+    uint32_t xid;
+    of_octets_t data;
+
+    if (obj->version < OF_VERSION_1_3) {
+        return 0;
+    }
+
+    of_experimenter_experimenter_get(obj, &experimenter);
+    if (experimenter != IND_CORE_BUNDLE_EXPERIMENTER_ID) {
+        return 0;
+    }
+
+    of_experimenter_xid_get(obj, &xid);
+    of_experimenter_subtype_get(obj, &subtype);
+    of_experimenter_data_get(obj, &data);
+
+    switch (subtype) {
+    case IND_CORE_BUNDLE_CONTROL:
+        bundle_control_handle(obj, cxn_id, xid, &data);
+        break;
+    case IND_CORE_BUNDLE_ADD_MESSAGE:
+        bundle_add_handle(obj, cxn_id, xid, &data);
+        break;
+    default:
+        bundle_request_error_send(obj, cxn_id, xid,
+                                  OF_REQUEST_FAILED_BAD_EXPERIMENTER_TYPE);
+        break;
+    }
+
+    return 1;
+}
+
+/****************************************************************
+ * Connections
+ ****************************************************************/
+
+/* Discard the bundles of a connection that is going away */
+static void
+bundle_cxn_status_change(indigo_cxn_id_t cxn_id,
+                         indigo_cxn_protocol_params_t *cxn_proto_params,
+                         indigo_cxn_state_t state,
+                         void *cookie)
+{
+    bundle_cxn_t *open;
+    list_links_t *cur, *next;
+
+    if (state != INDIGO_CXN_S_DISCONNECTED && state != INDIGO_CXN_S_CLOSING) {
+        return;
+    }
+
+    LIST_FOREACH_SAFE(&bundle_cxn_bundles, cur, next) {
+        open = container_of(cur, links, bundle_cxn_t);
+        if (open->cxn_id == cxn_id) {
+            bundle_cxn_free(open);
+        }
+    }
+}
+
+indigo_error_t
+ind_core_bundle_init(void)
+{
+    return indigo_cxn_status_change_register(bundle_cxn_status_change, NULL);
+}
+
+void
+ind_core_bundle_finish(void)
+{
+    list_links_t *cur, *next;
+
+    indigo_cxn_status_change_unregister(bundle_cxn_status_change, NULL);
+
+    LIST_FOREACH_SAFE(&bundle_cxn_bundles, cur, next) {
+        bundle_cxn_free(container_of(cur, links, bundle_cxn_t));
+    }
+}
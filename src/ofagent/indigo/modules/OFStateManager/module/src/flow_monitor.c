@@ -0,0 +1,642 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/**
+ * @file
+ * @brief Flow monitor subscriptions
+ *
+ * See ofstatemanager.h for the experimenter message layouts. Monitors
+ * are kept on a single list; the flow table calls in here whenever an
+ * entry is added, modified or removed, and each monitor whose filter
+ * selects the entry gets an update. With no monitors a notification is
+ * a single list check.
+ *
+ * Updates are built from the flow table alone, so resyncing a controller
+ * costs no forwarding calls. The agent's copy of a flow's counters can be
+ * arbitrarily old, so updates carry zero counters rather than stale ones. The INITIAL updates for a request are sent
+ * from a task that pauses while the connection's output is backed up.
+ */
+
+#include "ofstatemanager_log.h"
+
+#include <OFStateManager/ofstatemanager.h>
+#include <indigo/indigo.h>
+#include <indigo/of_state_manager.h>
+#include <indigo/of_connection_manager.h>
+#include <OFConnectionManager/ofconnectionmanager.h>
+#include <loci/loci.h>
+#include <AIM/aim_list.h>
+#include "ofstatemanager_decs.h"
+#include "ofstatemanager_int.h"
+#include "ft.h"
+
+/* An INITIAL update is sent once its flows reach this many bytes */
+#define FLOW_MONITOR_BATCH_BYTES (32 * 1024)
+
+/* Experimenter header: ofp_header, experimenter and subtype */
+#define FLOW_MONITOR_EXPERIMENTER_HDR_LEN 16
+
+/* Most bytes of flows one update can carry in a 16-bit message length */
+#define FLOW_MONITOR_FLOWS_MAX \
+    (0xffff - FLOW_MONITOR_EXPERIMENTER_HDR_LEN - \
+     IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN)
+
+/* How often an initial sync waiting on a backed up connection retries */
+#define FLOW_MONITOR_CONGESTED_RETRY_MS 10
+
+struct flow_monitor_sync_s;
+
+typedef struct ind_core_flow_monitor_s {
+    list_links_t links;            /* In ind_core_flow_monitors */
+    indigo_cxn_id_t cxn_id;
+    of_version_t version;          /* Of the request; used for updates */
+    uint32_t id;                   /* Chosen by the controller */
+    uint16_t flags;                /* IND_CORE_FLOW_MONITOR_FLAG_* */
+    of_meta_match_t query;         /* Table, cookie and out_port filter */
+    struct flow_monitor_sync_s *sync; /* INITIAL updates in progress */
+} ind_core_flow_monitor_t;
+
+/*
+ * Sending the INITIAL updates for a request. The monitor is cleared when
+ * the sync is cancelled; the task or timer running it then frees it.
+ */
+typedef struct flow_monitor_sync_s {
+    ind_core_flow_monitor_t *monitor;
+    uint32_t xid;                  /* Of the request */
+    ft_iterator_t iter;
+    int used;                      /* Bytes of flows batched in buf */
+    uint8_t buf[IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN + FLOW_MONITOR_FLOWS_MAX];
+} flow_monitor_sync_t;
+
+static LIST_DEFINE(ind_core_flow_monitors);
+
+static uint8_t flow_monitor_buf[IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN +
+                                FLOW_MONITOR_FLOWS_MAX];
+
+/****************************************************************
+ * Wire helpers
+ ****************************************************************/
+
+static uint16_t
+get_u16(const uint8_t *p)
+{
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static uint32_t
+get_u32(const uint8_t *p)
+{
+    return ((uint32_t)get_u16(p) << 16) | get_u16(p + 2);
+}
+
+static uint64_t
+get_u64(const uint8_t *p)
+{
+    return ((uint64_t)get_u32(p) << 32) | get_u32(p + 4);
+}
+
+static void
+put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v;
+}
+
+static void
+put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, v >> 16);
+    put_u16(p + 2, v);
+}
+
+/****************************************************************
+ * Updates
+ ****************************************************************/
+
+/* Event flag a monitor needs set to receive the event */
+static uint16_t
+flow_monitor_event_flag(ind_core_flow_monitor_event_t event)
+{
+    switch (event) {
+    case IND_CORE_FLOW_MONITOR_EVENT_ADDED:
+        return IND_CORE_FLOW_MONITOR_FLAG_ADD;
+    case IND_CORE_FLOW_MONITOR_EVENT_REMOVED:
+        return IND_CORE_FLOW_MONITOR_FLAG_REMOVED;
+    case IND_CORE_FLOW_MONITOR_EVENT_MODIFIED:
+        return IND_CORE_FLOW_MONITOR_FLAG_MODIFY;
+    default:
+        return IND_CORE_FLOW_MONITOR_FLAG_INITIAL;
+    }
+}
+
+/**
+ * Encode an entry as an ofp_flow_stats
+ * @returns The number of bytes written, 0 if it does not fit in space,
+ * or -1 on error
+ */
+
+static int
+flow_monitor_entry_encode(of_version_t version, ft_entry_t *entry,
+                          uint8_t *buf, int space)
+{
+    of_flow_stats_entry_t *stats_entry;
+    int len;
+
+    if ((stats_entry = of_flow_stats_entry_new(version)) == NULL) {
+        LOG_ERROR("Failed to allocate flow monitor stats entry");
+        return -1;
+    }
+
+    if (ind_core_flow_stats_entry_populate(stats_entry, entry,
+                                           INDIGO_CURRENT_TIME,
+                                           0, 0) < 0) {
+        of_flow_stats_entry_delete(stats_entry);
+        return -1;
+    }
+
+    len = stats_entry->length;
+    if (len <= space) {
+        INDIGO_MEM_COPY(buf, OF_OBJECT_BUFFER_INDEX(stats_entry, 0), len);
+    } else {
+        len = 0;
+    }
+
+    of_flow_stats_entry_delete(stats_entry);
+
+    return len;
+}
+
+/**
+ * Send an update to a monitor's connection
+ * @param flows Encoded ofp_flow_stats, after room for the update header
+ * @param flows_len Bytes of flows
+ *
+ * The header is written into the bytes just before flows.
+ */
+
+static void
+flow_monitor_update_send(ind_core_flow_monitor_t *monitor, uint32_t xid,
+                         ind_core_flow_monitor_event_t event,
+                         uint16_t reason, uint8_t *flows, int flows_len)
+{
+    of_experimenter_t *msg;
+    of_octets_t data;
+    uint8_t *hdr = flows - IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN;
+
+    if ((msg = of_experimenter_new(monitor->version)) == NULL) {
+        LOG_ERROR("Failed to allocate flow monitor update");
+        return;
+    }
+
+    put_u32(hdr, monitor->id);
+    put_u16(hdr + 4, event);
+    put_u16(hdr + 6, reason);
+
+    data.data = hdr;
+    data.bytes = IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN + flows_len;
+
+    of_experimenter_xid_set(msg, xid);
+    of_experimenter_experimenter_set(msg,
+                                     IND_CORE_FLOW_MONITOR_EXPERIMENTER_ID);
+    of_experimenter_subtype_set(msg, IND_CORE_FLOW_MONITOR_UPDATE);
+    if (of_experimenter_data_set(msg, &data) < 0) {
+        LOG_ERROR("Failed to set flow monitor update data");
+        of_object_delete(msg);
+        return;
+    }
+
+    if (IND_CORE_MSG_SEND(monitor->cxn_id, msg) < 0) {
+        LOG_ERROR("Failed to send flow monitor update to cxn %d",
+                  monitor->cxn_id);
+    }
+}
+
+/* Report an entry too big to fit in any update */
+static void
+flow_monitor_entry_too_big(ind_core_flow_monitor_t *monitor, uint32_t xid,
+                           ft_entry_t *entry)
+{
+    LOG_ERROR("Flow " INDIGO_FLOW_ID_PRINTF_FORMAT " is too big for a "
+              "flow monitor update to cxn %d", entry->id, monitor->cxn_id);
+    indigo_cxn_send_error_msg(monitor->version, monitor->cxn_id, xid,
+                              OF_ERROR_TYPE_BAD_REQUEST,
+                              OF_REQUEST_FAILED_MULTIPART_BUFFER_OVERFLOW,
+                              NULL);
+}
+
+static void
+flow_monitor_sync_flush(flow_monitor_sync_t *sync)
+{
+    if (sync->used > 0) {
+        flow_monitor_update_send(sync->monitor, sync->xid,
+                                 IND_CORE_FLOW_MONITOR_EVENT_INITIAL, 0,
+                                 sync->buf + IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN,
+                                 sync->used);
+        sync->used = 0;
+    }
+}
+
+/*
+ * Batch an entry. One that does not fit behind the batched flows goes
+ * in an update of its own.
+ */
+static void
+flow_monitor_sync_add(flow_monitor_sync_t *sync, ft_entry_t *entry)
+{
+    ind_core_flow_monitor_t *monitor = sync->monitor;
+    uint8_t *flows = sync->buf + IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN;
+    int len;
+
+    len = flow_monitor_entry_encode(monitor->version, entry,
+                                    flows + sync->used,
+                                    FLOW_MONITOR_FLOWS_MAX - sync->used);
+    if (len == 0 && sync->used > 0) {
+        flow_monitor_sync_flush(sync);
+        len = flow_monitor_entry_encode(monitor->version, entry,
+                                        flows, FLOW_MONITOR_FLOWS_MAX);
+    }
+
+    if (len == 0) {
+        flow_monitor_entry_too_big(monitor, sync->xid, entry);
+    } else if (len > 0) {
+        sync->used += len;
+        if (sync->used >= FLOW_MONITOR_BATCH_BYTES) {
+            flow_monitor_sync_flush(sync);
+        }
+    }
+}
+
+static void
+flow_monitor_sync_free(flow_monitor_sync_t *sync)
+{
+    ft_iterator_cleanup(&sync->iter);
+    INDIGO_MEM_FREE(sync);
+}
+
+/* Stop a monitor's initial sync, if any; it lets go of the table now */
+static void
+flow_monitor_sync_cancel(ind_core_flow_monitor_t *monitor)
+{
+    if (monitor->sync != NULL) {
+        ft_iterator_cleanup(&monitor->sync->iter);
+        monitor->sync->monitor = NULL;
+        monitor->sync = NULL;
+    }
+}
+
+static void flow_monitor_sync_timer(void *cookie);
+
+static ind_soc_task_status_t
+flow_monitor_sync_task(void *cookie)
+{
+    flow_monitor_sync_t *sync = cookie;
+    ft_entry_t *entry;
+
+    while (sync->monitor != NULL) {
+        if (ind_cxn_output_congested(sync->monitor->cxn_id)) {
+            /* Wait for the connection to drain without spinning */
+            if (ind_soc_timer_event_register(
+                    flow_monitor_sync_timer, sync,
+                    FLOW_MONITOR_CONGESTED_RETRY_MS) == INDIGO_ERROR_NONE) {
+                return IND_SOC_TASK_FINISHED;
+            }
+            return IND_SOC_TASK_CONTINUE;
+        }
+
+        if (ind_soc_should_yield()) {
+            return IND_SOC_TASK_CONTINUE;
+        }
+
+        if ((entry = ft_iterator_next(&sync->iter)) == NULL) {
+            flow_monitor_sync_flush(sync);
+            flow_monitor_update_send(sync->monitor, sync->xid,
+                                     IND_CORE_FLOW_MONITOR_EVENT_SYNCED, 0,
+                                     sync->buf +
+                                     IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN, 0);
+            sync->monitor->sync = NULL;
+            break;
+        }
+
+        flow_monitor_sync_add(sync, entry);
+    }
+
+    flow_monitor_sync_free(sync);
+    return IND_SOC_TASK_FINISHED;
+}
+
+static void
+flow_monitor_sync_timer(void *cookie)
+{
+    flow_monitor_sync_t *sync = cookie;
+
+    if (sync->monitor != NULL &&
+            ind_cxn_output_congested(sync->monitor->cxn_id)) {
+        return;
+    }
+
+    ind_soc_timer_event_unregister(flow_monitor_sync_timer, sync);
+
+    if (sync->monitor == NULL) {
+        flow_monitor_sync_free(sync);
+    } else if (ind_soc_task_register(flow_monitor_sync_task, sync,
+                                     IND_SOC_DEFAULT_PRIORITY) < 0) {
+        LOG_ERROR("Failed to resume flow monitor %u initial updates",
+                  sync->monitor->id);
+        sync->monitor->sync = NULL;
+        flow_monitor_sync_free(sync);
+    }
+}
+
+/**
+ * Start sending the flows a monitor selects, then the end of them.
+ * Replaces any sync already running for the monitor.
+ */
+
+static void
+flow_monitor_initial_send(ind_core_flow_monitor_t *monitor, uint32_t xid)
+{
+    flow_monitor_sync_t *sync;
+
+    flow_monitor_sync_cancel(monitor);
+
+    if ((sync = INDIGO_MEM_ALLOC(sizeof(*sync))) == NULL) {
+        LOG_ERROR("Failed to allocate flow monitor initial sync");
+        indigo_cxn_send_error_msg(monitor->version, monitor->cxn_id, xid,
+                                  OF_ERROR_TYPE_BAD_REQUEST,
+                                  OF_REQUEST_FAILED_EPERM, NULL);
+        return;
+    }
+
+    sync->monitor = monitor;
+    sync->xid = xid;
+    sync->used = 0;
+    ft_iterator_init(&sync->iter, ind_core_ft, &monitor->query);
+
+    if (ind_soc_task_register(flow_monitor_sync_task, sync,
+                              IND_SOC_DEFAULT_PRIORITY) < 0) {
+        LOG_ERROR("Failed to start flow monitor %u initial updates",
+                  monitor->id);
+        flow_monitor_sync_free(sync);
+        indigo_cxn_send_error_msg(monitor->version, monitor->cxn_id, xid,
+                                  OF_ERROR_TYPE_BAD_REQUEST,
+                                  OF_REQUEST_FAILED_EPERM, NULL);
+        return;
+    }
+
+    monitor->sync = sync;
+}
+
+/* Forget a monitor, stopping its initial sync */
+static void
+flow_monitor_free(ind_core_flow_monitor_t *monitor)
+{
+    flow_monitor_sync_cancel(monitor);
+    list_remove(&monitor->links);
+    INDIGO_MEM_FREE(monitor);
+}
+
+void
+ind_core_flow_monitor_notify(ft_entry_t *entry,
+                             ind_core_flow_monitor_event_t event,
+                             indigo_fi_flow_removed_t reason)
+{
+    uint8_t *flows = flow_monitor_buf + IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN;
+    uint16_t flag = flow_monitor_event_flag(event);
+    uint16_t wire_reason = 0;
+    of_version_t encoded = OF_VERSION_UNKNOWN;
+    ind_core_flow_monitor_t *monitor;
+    list_links_t *cur;
+    int len = 0;
+
+    if (list_empty(&ind_core_flow_monitors)) {
+        return;
+    }
+
+    if (event == IND_CORE_FLOW_MONITOR_EVENT_REMOVED) {
+        /* Normalize as for flow removed messages */
+        wire_reason = reason > INDIGO_FLOW_REMOVED_DELETE ?
+            INDIGO_FLOW_REMOVED_DELETE : reason;
+    }
+
+    LIST_FOREACH(&ind_core_flow_monitors, cur) {
+        monitor = container_of(cur, links, ind_core_flow_monitor_t);
+
+        if (!(monitor->flags & flag) ||
+                !ft_entry_meta_match(&monitor->query, entry)) {
+            continue;
+        }
+
+        /* Monitors on the same version share the encoding */
+        if (monitor->version != encoded) {
+            len = flow_monitor_entry_encode(monitor->version, entry,
+                                            flows, FLOW_MONITOR_FLOWS_MAX);
+            encoded = len > 0 ? monitor->version : OF_VERSION_UNKNOWN;
+        }
+        if (len == 0) {
+            flow_monitor_entry_too_big(monitor, ind_core_xid_alloc(), entry);
+        }
+        if (len <= 0) {
+            continue;
+        }
+
+        flow_monitor_update_send(monitor, ind_core_xid_alloc(), event,
+                                 wire_reason, flows, len);
+    }
+}
+
+/****************************************************************
+ * Requests
+ ****************************************************************/
+
+static ind_core_flow_monitor_t *
+flow_monitor_lookup(indigo_cxn_id_t cxn_id, uint32_t id)
+{
+    ind_core_flow_monitor_t *monitor;
+    list_links_t *cur;
+
+    LIST_FOREACH(&ind_core_flow_monitors, cur) {
+        monitor = container_of(cur, links, ind_core_flow_monitor_t);
+        if (monitor->cxn_id == cxn_id && monitor->id == id) {
+            return monitor;
+        }
+    }
+
+    return NULL;
+}
+
+/* Fill in a monitor's filter and flags from request data */
+static void
+flow_monitor_parse(ind_core_flow_monitor_t *monitor, of_version_t version,
+                   const uint8_t *req)
+{
+    monitor->version = version;
+    monitor->flags = get_u16(req + 6);
+
+    INDIGO_MEM_SET(&monitor->query, 0, sizeof(monitor->query));
+    monitor->query.match.version = version;
+    monitor->query.mode = OF_MATCH_NON_STRICT;
+    monitor->query.out_port = get_u32(req + 8);
+    monitor->query.table_id = req[12];
+    monitor->query.cookie = get_u64(req + 16);
+    monitor->query.cookie_mask = get_u64(req + 24);
+}
+
+int
+ind_core_flow_monitor_handler(of_experimenter_t *obj, indigo_cxn_id_t cxn_id)
+{
+    ind_core_flow_monitor_t *monitor;
+    uint32_t experimenter;
+    uint32_t subtype;
+    uint32_t xid;
+    uint32_t id;
+    uint16_t command;
+    of_octets_t data;
+
+    if (obj->version < OF_VERSION_1_3) {
+        return 0;
+    }
+
+    of_experimenter_experimenter_get(obj, &experimenter);
+    if (experimenter != IND_CORE_FLOW_MONITOR_EXPERIMENTER_ID) {
+        return 0;
+    }
+
+    of_experimenter_xid_get(obj, &xid);
+    of_experimenter_subtype_get(obj, &subtype);
+    of_experimenter_data_get(obj, &data);
+
+    if (subtype != IND_CORE_FLOW_MONITOR_REQUEST) {
+        indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                                  OF_ERROR_TYPE_BAD_REQUEST,
+                                  OF_REQUEST_FAILED_BAD_EXPERIMENTER_TYPE,
+                                  NULL);
+        return 1;
+    }
+
+    if (data.bytes != IND_CORE_FLOW_MONITOR_REQUEST_LEN) {
+        indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                                  OF_ERROR_TYPE_BAD_REQUEST,
+                                  OF_REQUEST_FAILED_BAD_LEN, NULL);
+        return 1;
+    }
+
+    id = get_u32(data.data);
+    command = get_u16(data.data + 4);
+    monitor = flow_monitor_lookup(cxn_id, id);
+
+    LOG_TRACE("Flow monitor %u command %u from cxn %d", id, command, cxn_id);
+
+    switch (command) {
+    case IND_CORE_FLOW_MONITOR_CMD_ADD:
+        if (monitor != NULL) {
+            break;
+        }
+        monitor = INDIGO_MEM_ALLOC(sizeof(*monitor));
+        if (monitor == NULL) {
+            LOG_ERROR("Failed to allocate flow monitor");
+            indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                                      OF_ERROR_TYPE_BAD_REQUEST,
+                                      OF_REQUEST_FAILED_EPERM, NULL);
+            return 1;
+        }
+        monitor->cxn_id = cxn_id;
+        monitor->id = id;
+        monitor->sync = NULL;
+        flow_monitor_parse(monitor, obj->version, data.data);
+        list_push(&ind_core_flow_monitors, &monitor->links);
+        if (monitor->flags & IND_CORE_FLOW_MONITOR_FLAG_INITIAL) {
+            flow_monitor_initial_send(monitor, xid);
+        }
+        return 1;
+    case IND_CORE_FLOW_MONITOR_CMD_MODIFY:
+        if (monitor == NULL) {
+            break;
+        }
+        flow_monitor_parse(monitor, obj->version, data.data);
+        if (monitor->flags & IND_CORE_FLOW_MONITOR_FLAG_INITIAL) {
+            flow_monitor_initial_send(monitor, xid);
+        }
+        return 1;
+    case IND_CORE_FLOW_MONITOR_CMD_DELETE:
+        if (monitor == NULL) {
+            break;
+        }
+        flow_monitor_free(monitor);
+        return 1;
+    default:
+        indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                                  OF_ERROR_TYPE_BAD_REQUEST,
+                                  OF_REQUEST_FAILED_BAD_EXPERIMENTER_TYPE,
+                                  NULL);
+        return 1;
+    }
+
+    /* Adding an existing monitor or changing an unknown one */
+    indigo_cxn_send_error_msg(obj->version, cxn_id, xid,
+                              OF_ERROR_TYPE_BAD_REQUEST,
+                              OF_REQUEST_FAILED_EPERM, NULL);
+    return 1;
+}
+
+/****************************************************************
+ * Connections
+ ****************************************************************/
+
+/* Drop the monitors of a connection that is going away */
+static void
+flow_monitor_cxn_status_change(indigo_cxn_id_t cxn_id,
+                               indigo_cxn_protocol_params_t *cxn_proto_params,
+                               indigo_cxn_state_t state,
+                               void *cookie)
+{
+    ind_core_flow_monitor_t *monitor;
+    list_links_t *cur, *next;
+
+    if (state != INDIGO_CXN_S_DISCONNECTED && state != INDIGO_CXN_S_CLOSING) {
+        return;
+    }
+
+    LIST_FOREACH_SAFE(&ind_core_flow_monitors, cur, next) {
+        monitor = container_of(cur, links, ind_core_flow_monitor_t);
+        if (monitor->cxn_id == cxn_id) {
+            flow_monitor_free(monitor);
+        }
+    }
+}
+
+indigo_error_t
+ind_core_flow_monitor_init(void)
+{
+    return indigo_cxn_status_change_register(flow_monitor_cxn_status_change,
+                                             NULL);
+}
+
+void
+ind_core_flow_monitor_finish(void)
+{
+    ind_core_flow_monitor_t *monitor;
+    list_links_t *cur, *next;
+
+    indigo_cxn_status_change_unregister(flow_monitor_cxn_status_change, NULL);
+
+    LIST_FOREACH_SAFE(&ind_core_flow_monitors, cur, next) {
+        monitor = container_of(cur, links, ind_core_flow_monitor_t);
+        flow_monitor_free(monitor);
+    }
+}
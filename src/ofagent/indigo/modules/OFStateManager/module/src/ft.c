@@ -29,12 +29,20 @@
 #include "ofstatemanager_log.h"
 #include "ft.h"
 
-static indigo_error_t ft_entry_create(indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry_p);
+static indigo_error_t ft_entry_create(ft_instance_t ft, indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry_p);
 static void ft_entry_destroy(ft_instance_t ft, ft_entry_t *entry);
-static indigo_error_t ft_entry_set_effects(ft_entry_t *entry, of_flow_modify_t *flow_mod);
-static void ft_entry_link(ft_instance_t ft, ft_entry_t *entry);
+static indigo_error_t ft_entry_set_effects(ft_instance_t ft, ft_entry_t *entry, of_flow_modify_t *flow_mod, bool linked);
+static void ft_effects_put(ft_instance_t ft, ft_effects_t *effects);
+static indigo_error_t ft_entry_link(ft_instance_t ft, ft_entry_t *entry);
 static void ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry);
 static int ft_entry_has_out_port(ft_entry_t *entry, of_port_no_t port);
+static int ft_entry_meta_match_attrs(of_meta_match_t *query, ft_entry_t *entry);
+static int ft_entry_out_port_match(of_meta_match_t *query, ft_entry_t *entry);
+static indigo_error_t ft_evict_heap_reserve(ft_table_t *table);
+static void ft_evict_heap_insert(ft_table_t *table, ft_entry_t *entry);
+static void ft_evict_heap_remove(ft_table_t *table, ft_entry_t *entry);
+static void ft_evict_heap_update(ft_instance_t ft, ft_entry_t *entry);
+static void ft_iterator_skip_entry(ft_entry_t *entry, bool by_group, bool by_out_port, bool by_cookie);
 
 #define FT_HASH_SEED 0
 
@@ -43,28 +51,1057 @@ static int ft_entry_has_out_port(ft_entry_t *entry, of_port_no_t port);
  * hash calculations.  Multiplying by a prime is a good option
  */
 
+/* The present bitmap in ft_match_key_t has one bit per word */
+typedef char ft_match_key_size_check_t[FT_MATCH_KEY_WORDS <= 64 ? 1 : -1];
+
+static inline uint64_t
+ft_match_word(of_match_t *match, int idx)
+{
+    uint64_t word;
+    INDIGO_MEM_COPY(&word, (uint8_t *)match + idx * sizeof(word),
+                    sizeof(word));
+    return word;
+}
+
+static void
+ft_match_key_init(ft_match_key_t *key, of_match_t *match)
+{
+    uint64_t word;
+    int idx;
+
+    key->present = 0;
+    key->count = 0;
+    for (idx = 0; idx < FT_MATCH_KEY_WORDS; idx++) {
+        if ((word = ft_match_word(match, idx)) != 0) {
+            key->present |= (uint64_t)1 << idx;
+            key->words[key->count++] = word;
+        }
+    }
+}
+
+static uint32_t
+ft_strict_match_hash(ft_match_key_t *key, uint16_t priority)
+{
+    uint32_t h = FT_HASH_SEED;
+    h = murmur_hash(&key->present, sizeof(key->present), h);
+    h = murmur_hash(key->words, key->count * sizeof(key->words[0]), h);
+    h = murmur_hash(&priority, sizeof(priority), h);
+    return h;
+}
+
+/* Number of match words named by a present bitmap */
+static int
+ft_match_word_count(uint64_t present)
+{
+    int count = 0;
+
+    for (; present; present &= present - 1) {
+        count++;
+    }
+
+    return count;
+}
+
+/* Slab for the cold record of an entry with count match words */
+static ft_slab_t *
+ft_cold_slab(ft_instance_t ft, int count)
+{
+    return &ft->cold_slabs[(count + FT_COLD_SLAB_WORDS - 1) /
+                           FT_COLD_SLAB_WORDS];
+}
+
+/* The compact match key of an entry */
+static void
+ft_entry_match_key(ft_entry_t *entry, ft_match_key_t *key)
+{
+    key->present = entry->match_present;
+    key->count = ft_match_word_count(key->present);
+    INDIGO_MEM_COPY(key->words, entry->cold->match_words,
+                    key->count * sizeof(key->words[0]));
+}
+
+/* Equivalent to of_match_eq on entry's match, where key is match's key */
+static int
+ft_entry_match_key_eq(ft_entry_t *entry, ft_match_key_t *key)
+{
+    if (entry->match_present != key->present) {
+        return 0;
+    }
+
+    return INDIGO_MEM_COMPARE(entry->cold->match_words, key->words,
+                              key->count * sizeof(key->words[0])) == 0;
+}
+
+void
+ft_entry_match_get(ft_entry_t *entry, of_match_t *match)
+{
+    uint64_t present;
+    int idx, count = 0;
+
+    INDIGO_MEM_SET(match, 0, sizeof(*match));
+    for (idx = 0, present = entry->match_present; present;
+         idx++, present >>= 1) {
+        if (present & 1) {
+            INDIGO_MEM_COPY((uint8_t *)match + idx * sizeof(uint64_t),
+                            &entry->cold->match_words[count++],
+                            sizeof(uint64_t));
+        }
+    }
+}
+
+static uint32_t
+ft_flow_id_hash(indigo_flow_id_t *flow_id)
+{
+    return murmur_hash(flow_id, sizeof(*flow_id), FT_HASH_SEED);
+}
+
+static uint32_t
+ft_cookie_hash(uint64_t cookie)
+{
+    return murmur_hash(&cookie, sizeof(cookie), FT_HASH_SEED);
+}
+
+static uint32_t
+ft_entry_strict_match_hash(void *obj)
+{
+    ft_entry_t *entry = obj;
+    return entry->strict_match_hash;
+}
+
+static uint32_t
+ft_entry_flow_id_hash(void *obj)
+{
+    ft_entry_t *entry = obj;
+    return ft_flow_id_hash(&entry->id);
+}
+
+static uint32_t
+ft_cookie_group_hash(void *obj)
+{
+    ft_cookie_group_t *group = obj;
+    return ft_cookie_hash(group->cookie);
+}
+
+static uint32_t
+ft_effects_hash(void *obj)
+{
+    ft_effects_t *effects = obj;
+    return effects->hash;
+}
+
+/****************************************************************
+ * Resizable hash indexes
+ ****************************************************************/
+
+#define FT_INDEX_LINKS(_index, _obj) \
+    ((list_links_t *)(((char *)(_obj)) + (_index)->links_offset))
+#define FT_INDEX_OBJECT(_index, _links) \
+    ((void *)(((char *)(_links)) - (_index)->links_offset))
+
+static list_head_t *
+ft_index_buckets_alloc(int count)
+{
+    list_head_t *buckets;
+    int idx;
+
+    buckets = INDIGO_MEM_ALLOC(sizeof(list_head_t) * count);
+    if (buckets == NULL) {
+        return NULL;
+    }
+    for (idx = 0; idx < count; idx++) {
+        list_init(&buckets[idx]);
+    }
+
+    return buckets;
+}
+
+indigo_error_t
+ft_index_init(ft_index_t *index, int bucket_count, int links_offset,
+              uint32_t (*hash)(void *obj))
+{
+    int count = FT_INDEX_BUCKETS_MIN;
+
+    while (count < bucket_count) {
+        count *= 2;
+    }
+
+    INDIGO_MEM_SET(index, 0, sizeof(*index));
+    index->links_offset = links_offset;
+    index->hash = hash;
+    index->bucket_count = count;
+    index->buckets = ft_index_buckets_alloc(count);
+    if (index->buckets == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+void
+ft_index_cleanup(ft_index_t *index)
+{
+    INDIGO_MEM_FREE(index->buckets);
+    INDIGO_MEM_FREE(index->old_buckets);
+    index->buckets = index->old_buckets = NULL;
+}
+
+/*
+ * Fill heads with the buckets that may hold entries with hash h; the new
+ * bucket first, then the old one while it has not been migrated.
+ */
+int
+ft_index_lookup_buckets(ft_index_t *index, uint32_t h, list_head_t *heads[2])
+{
+    int n = 0;
+
+    heads[n++] = &index->buckets[h & (index->bucket_count - 1)];
+    if (index->old_buckets != NULL) {
+        int old_idx = h & (index->old_bucket_count - 1);
+        if (old_idx >= index->migrate_idx) {
+            heads[n++] = &index->old_buckets[old_idx];
+        }
+    }
+
+    return n;
+}
+
+/* Move up to FT_INDEX_REHASH_WORK worth of old buckets into the new array */
+static void
+ft_index_migrate(ft_index_t *index)
+{
+    int work = 0;
+
+    while (index->old_buckets != NULL && work < FT_INDEX_REHASH_WORK) {
+        list_head_t *old = &index->old_buckets[index->migrate_idx];
+        list_links_t *cur;
+
+        while ((cur = list_shift(old)) != NULL) {
+            uint32_t h = index->hash(FT_INDEX_OBJECT(index, cur));
+            list_push(&index->buckets[h & (index->bucket_count - 1)], cur);
+            work++;
+        }
+        work++;
+
+        if (++index->migrate_idx == index->old_bucket_count) {
+            INDIGO_MEM_FREE(index->old_buckets);
+            index->old_buckets = NULL;
+            index->old_bucket_count = 0;
+            index->migrate_idx = 0;
+        }
+    }
+}
+
+/*
+ * Start a resize if the load is out of range and none is in progress,
+ * then advance any migration.
+ */
+void
+ft_index_maintain(ft_index_t *index, int count)
+{
+    int new_count = 0;
+
+    if (index->old_buckets == NULL) {
+        if (count > index->bucket_count) {
+            new_count = index->bucket_count * 2;
+        } else if (count < index->bucket_count / 4 &&
+                   index->bucket_count > FT_INDEX_BUCKETS_MIN) {
+            new_count = index->bucket_count / 2;
+        }
+    }
+
+    if (new_count != 0) {
+        list_head_t *buckets = ft_index_buckets_alloc(new_count);
+        if (buckets == NULL) {
+            LOG_VERBOSE("Flow table index resize to %d buckets failed",
+                        new_count);
+        } else {
+            if (new_count > index->bucket_count) {
+                index->grows++;
+            } else {
+                index->shrinks++;
+            }
+            index->old_buckets = index->buckets;
+            index->old_bucket_count = index->bucket_count;
+            index->migrate_idx = 0;
+            index->buckets = buckets;
+            index->bucket_count = new_count;
+        }
+    }
+
+    ft_index_migrate(index);
+}
+
+void
+ft_index_insert(ft_index_t *index, void *obj)
+{
+    uint32_t h = index->hash(obj);
+    list_push(&index->buckets[h & (index->bucket_count - 1)],
+              FT_INDEX_LINKS(index, obj));
+}
+
+void
+ft_index_chain_histogram(ft_index_t *index, uint32_t *hist, int *max_chain)
+{
+    int idx, len, max = 0;
+
+    INDIGO_MEM_SET(hist, 0, sizeof(*hist) * FT_INDEX_CHAIN_HIST_SIZE);
+
+    for (idx = 0; idx < index->bucket_count; idx++) {
+        len = list_length(&index->buckets[idx]);
+        hist[len < FT_INDEX_CHAIN_HIST_SIZE ? len : FT_INDEX_CHAIN_HIST_SIZE - 1]++;
+        max = len > max ? len : max;
+    }
+
+    if (index->old_buckets != NULL) {
+        for (idx = index->migrate_idx; idx < index->old_bucket_count; idx++) {
+            len = list_length(&index->old_buckets[idx]);
+            hist[len < FT_INDEX_CHAIN_HIST_SIZE ? len : FT_INDEX_CHAIN_HIST_SIZE - 1]++;
+            max = len > max ? len : max;
+        }
+    }
+
+    if (max_chain != NULL) {
+        *max_chain = max;
+    }
+}
+
+static int
+ft_cookie_to_bucket_index(ft_instance_t ft, uint64_t cookie)
+{
+    return cookie >> (64-FT_COOKIE_PREFIX_LEN);
+}
+
+/****************************************************************
+ * Mask groups
+ ****************************************************************/
+
+static uint32_t
+ft_mask_group_hash(uint8_t table_id, of_match_fields_t *masks)
+{
+    uint32_t h = FT_HASH_SEED;
+    h = murmur_hash(masks, sizeof(*masks), h);
+    h = murmur_hash(&table_id, sizeof(table_id), h);
+    return h;
+}
+
+/* Is every mask bit set in general also set in specific? */
 static int
-ft_strict_match_to_bucket_index(ft_instance_t ft,
-                                of_match_t *match,
-                                uint16_t priority)
+ft_masks_more_specific(of_match_fields_t *specific, of_match_fields_t *general)
+{
+    uint8_t *s = (uint8_t *)specific;
+    uint8_t *g = (uint8_t *)general;
+    int idx;
+
+    for (idx = 0; idx < sizeof(of_match_fields_t); idx++) {
+        if (~s[idx] & g[idx]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Can any entry in the group satisfy the query? This only looks at the
+ * table ID and masks; ft_entry_meta_match still checks each entry.
+ */
+static int
+ft_mask_group_may_match(ft_mask_group_t *group, of_meta_match_t *query)
+{
+    if (query->table_id != TABLE_ID_ANY && query->table_id != group->table_id) {
+        return 0;
+    }
+
+    switch (query->mode) {
+    case OF_MATCH_NON_STRICT:
+        return ft_masks_more_specific(&group->masks, &query->match.masks);
+    case OF_MATCH_STRICT:
+        return INDIGO_MEM_COMPARE(&group->masks, &query->match.masks,
+                                  sizeof(group->masks)) == 0;
+    default:
+        return 1;
+    }
+}
+
+/* Find the group for a table ID and masks, creating it if needed */
+static ft_mask_group_t *
+ft_mask_group_get(ft_instance_t ft, uint8_t table_id, of_match_fields_t *masks)
+{
+    uint32_t h = ft_mask_group_hash(table_id, masks);
+    list_head_t *bucket = &ft->mask_group_buckets[h % FT_MASK_GROUP_BUCKETS];
+    ft_mask_group_t *group;
+    list_links_t *cur;
+
+    LIST_FOREACH(bucket, cur) {
+        group = container_of(cur, hash_links, ft_mask_group_t);
+        if (group->hash == h && group->table_id == table_id &&
+                INDIGO_MEM_COMPARE(&group->masks, masks,
+                                   sizeof(*masks)) == 0) {
+            return group;
+        }
+    }
+
+    group = INDIGO_MEM_ALLOC(sizeof(*group));
+    if (group == NULL) {
+        return NULL;
+    }
+    INDIGO_MEM_SET(group, 0, sizeof(*group));
+    group->hash = h;
+    group->table_id = table_id;
+    group->masks = *masks;
+    list_init(&group->entries);
+    list_push(&ft->mask_groups, &group->links);
+    list_push(bucket, &group->hash_links);
+    ft->mask_group_count++;
+
+    return group;
+}
+
+static void
+ft_mask_group_link(ft_mask_group_t *group, ft_entry_t *entry)
+{
+    list_push(&group->entries, &entry->mask_group_links);
+    group->entry_count++;
+    entry->mask_group = group;
+}
+
+/* Free a group if it has no entries */
+static void
+ft_mask_group_put(ft_instance_t ft, ft_mask_group_t *group)
+{
+    if (group->entry_count == 0) {
+        list_remove(&group->links);
+        list_remove(&group->hash_links);
+        INDIGO_MEM_FREE(group);
+        ft->mask_group_count--;
+    }
+}
+
+/* Remove an entry from its group, freeing the group if it is now empty */
+static void
+ft_mask_group_unlink(ft_instance_t ft, ft_entry_t *entry)
+{
+    ft_mask_group_t *group = entry->mask_group;
+
+    list_remove(&entry->mask_group_links);
+    entry->mask_group = NULL;
+    group->entry_count--;
+    ft_mask_group_put(ft, group);
+}
+
+/****************************************************************
+ * Running aggregates
+ ****************************************************************/
+
+/*
+ * Cookie groups double as the per cookie aggregates; see
+ * ft_cookie_group_t
+ */
+
+static ft_cookie_group_t *
+ft_cookie_group_lookup(ft_instance_t ft, uint64_t cookie)
+{
+    list_head_t *buckets[2];
+    list_links_t *cur;
+    int i, n;
+
+    n = ft_index_lookup_buckets(&ft->cookie_index, ft_cookie_hash(cookie),
+                                buckets);
+    for (i = 0; i < n; i++) {
+        LIST_FOREACH(buckets[i], cur) {
+            ft_cookie_group_t *group =
+                container_of(cur, hash_links, ft_cookie_group_t);
+            if (group->cookie == cookie) {
+                return group;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* Find or create the group for a cookie; NULL on allocation failure */
+static ft_cookie_group_t *
+ft_cookie_group_get(ft_instance_t ft, uint64_t cookie)
+{
+    ft_cookie_group_t *group;
+
+    if ((group = ft_cookie_group_lookup(ft, cookie)) != NULL) {
+        return group;
+    }
+
+    group = INDIGO_MEM_ALLOC(sizeof(*group));
+    if (group == NULL) {
+        return NULL;
+    }
+    INDIGO_MEM_SET(group, 0, sizeof(*group));
+    group->cookie = cookie;
+    list_init(&group->entries);
+    ft_index_insert(&ft->cookie_index, group);
+    ft->cookie_group_count++;
+
+    return group;
+}
+
+/* Free a cookie group if it has no entries */
+static void
+ft_cookie_group_put(ft_instance_t ft, ft_cookie_group_t *group)
+{
+    if (list_empty(&group->entries)) {
+        list_remove(&group->hash_links);
+        INDIGO_MEM_FREE(group);
+        ft->cookie_group_count--;
+    }
+}
+
+static void
+ft_aggregate_add(ft_aggregate_t *agg, int flows,
+                 uint64_t packets, uint64_t bytes)
+{
+    agg->flow_count += flows;
+    agg->packets += packets;
+    agg->bytes += bytes;
+}
+
+/*
+ * Add to every aggregate the entry counts toward. Decrements are passed
+ * as negated unsigned values and wrap back to the right totals.
+ */
+static void
+ft_entry_aggregates_add(ft_instance_t ft, ft_entry_t *entry, int flows,
+                        uint64_t packets, uint64_t bytes)
+{
+    ft_aggregate_add(&ft->aggregate, flows, packets, bytes);
+    ft_aggregate_add(&ft->table_aggregates[entry->table_id],
+                     flows, packets, bytes);
+    ft_aggregate_add(&entry->cookie_group->aggregate,
+                     flows, packets, bytes);
+}
+
+static void
+ft_entry_aggregates_unlink(ft_instance_t ft, ft_entry_t *entry)
+{
+    ft_entry_aggregates_add(ft, entry, -1, -entry->cold->packets,
+                            -entry->cold->bytes);
+    list_remove(&entry->cookie_group_links);
+    ft_cookie_group_put(ft, entry->cookie_group);
+    entry->cookie_group = NULL;
+}
+
+static int
+ft_masks_wildcard(of_match_fields_t *masks)
+{
+    static const of_match_fields_t wildcard;
+
+    return INDIGO_MEM_COMPARE(masks, &wildcard, sizeof(wildcard)) == 0;
+}
+
+indigo_error_t
+ft_aggregate_get(ft_instance_t ft, of_meta_match_t *query,
+                 ft_aggregate_t *aggregate)
+{
+    ft_cookie_group_t *group;
+
+    if (query->mode != OF_MATCH_NON_STRICT || query->check_priority ||
+            query->out_port != OF_PORT_DEST_WILDCARD ||
+            !ft_masks_wildcard(&query->match.masks)) {
+        return INDIGO_ERROR_NOT_SUPPORTED;
+    }
+
+    if (query->cookie_mask == 0) {
+        if (query->table_id == TABLE_ID_ANY) {
+            *aggregate = ft->aggregate;
+        } else {
+            *aggregate = ft->table_aggregates[query->table_id];
+        }
+        return INDIGO_ERROR_NONE;
+    }
+
+    if (query->cookie_mask == (uint64_t)-1 &&
+            query->table_id == TABLE_ID_ANY) {
+        group = ft_cookie_group_lookup(ft, query->cookie);
+        if (group != NULL) {
+            *aggregate = group->aggregate;
+        } else {
+            INDIGO_MEM_SET(aggregate, 0, sizeof(*aggregate));
+        }
+        return INDIGO_ERROR_NONE;
+    }
+
+    return INDIGO_ERROR_NOT_SUPPORTED;
+}
+
+bool
+ft_query_all(of_meta_match_t *query)
+{
+    return query->mode == OF_MATCH_NON_STRICT && !query->check_priority &&
+        query->out_port == OF_PORT_DEST_WILDCARD &&
+        query->table_id == TABLE_ID_ANY && query->cookie_mask == 0 &&
+        ft_masks_wildcard(&query->match.masks);
+}
+
+/****************************************************************
+ * Output port index
+ ****************************************************************/
+
+static list_head_t *
+ft_out_port_bucket(ft_instance_t ft, of_port_no_t port)
+{
+    uint32_t h = murmur_hash(&port, sizeof(port), FT_HASH_SEED);
+    return &ft->out_port_buckets[h % FT_OUT_PORT_BUCKETS];
+}
+
+static ft_out_port_t *
+ft_out_port_lookup(ft_instance_t ft, of_port_no_t port)
+{
+    list_links_t *cur;
+
+    LIST_FOREACH(ft_out_port_bucket(ft, port), cur) {
+        ft_out_port_t *out_port = container_of(cur, hash_links, ft_out_port_t);
+        if (out_port->port == port) {
+            return out_port;
+        }
+    }
+
+    return NULL;
+}
+
+/* Free a port list if it has no references */
+static void
+ft_out_port_put(ft_out_port_t *out_port)
+{
+    if (out_port->entry_count == 0) {
+        list_remove(&out_port->hash_links);
+        INDIGO_MEM_FREE(out_port);
+    }
+}
+
+/*
+ * Find or create the port lists for each of the refs. On failure, lists
+ * created here are freed again and nothing is linked.
+ */
+static indigo_error_t
+ft_out_ports_get(ft_instance_t ft, ft_out_port_ref_t *refs, int count)
+{
+    int idx;
+
+    for (idx = 0; idx < count; idx++) {
+        ft_out_port_t *out_port = ft_out_port_lookup(ft, refs[idx].port);
+        if (out_port == NULL) {
+            out_port = INDIGO_MEM_ALLOC(sizeof(*out_port));
+            if (out_port == NULL) {
+                while (--idx >= 0) {
+                    ft_out_port_put(refs[idx].out_port);
+                    refs[idx].out_port = NULL;
+                }
+                return INDIGO_ERROR_RESOURCE;
+            }
+            INDIGO_MEM_SET(out_port, 0, sizeof(*out_port));
+            out_port->port = refs[idx].port;
+            list_init(&out_port->refs);
+            list_push(ft_out_port_bucket(ft, out_port->port),
+                      &out_port->hash_links);
+        }
+        refs[idx].out_port = out_port;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/* Link refs whose port lists were found by ft_out_ports_get */
+static void
+ft_out_ports_link(ft_entry_t *entry, ft_out_port_ref_t *refs, int count)
+{
+    int idx;
+
+    for (idx = 0; idx < count; idx++) {
+        refs[idx].entry = entry;
+        list_push(&refs[idx].out_port->refs, &refs[idx].links);
+        refs[idx].out_port->entry_count++;
+    }
+}
+
+static void
+ft_out_ports_unlink(ft_entry_t *entry)
+{
+    int idx;
+
+    for (idx = 0; idx < entry->out_port_count; idx++) {
+        ft_out_port_ref_t *ref = &entry->out_port_refs[idx];
+        if (ref->out_port != NULL) {
+            list_remove(&ref->links);
+            ref->out_port->entry_count--;
+            ft_out_port_put(ref->out_port);
+            ref->out_port = NULL;
+        }
+    }
+}
+
+static ft_out_port_ref_t *
+ft_entry_out_port_ref(ft_entry_t *entry, of_port_no_t port)
+{
+    int idx;
+
+    for (idx = 0; idx < entry->out_port_count; idx++) {
+        if (entry->out_port_refs[idx].port == port) {
+            return &entry->out_port_refs[idx];
+        }
+    }
+
+    return NULL;
+}
+
+/****************************************************************
+ * Output group index
+ ****************************************************************/
+
+static uint32_t
+ft_out_group_id_hash(uint32_t group_id)
+{
+    return murmur_hash(&group_id, sizeof(group_id), FT_HASH_SEED);
+}
+
+static uint32_t
+ft_out_group_hash(void *obj)
+{
+    ft_out_group_t *out_group = obj;
+    return ft_out_group_id_hash(out_group->group_id);
+}
+
+static ft_out_group_t *
+ft_out_group_lookup(ft_instance_t ft, uint32_t group_id)
+{
+    list_head_t *buckets[2];
+    list_links_t *cur;
+    int i, n;
+
+    n = ft_index_lookup_buckets(&ft->out_group_index,
+                                ft_out_group_id_hash(group_id), buckets);
+    for (i = 0; i < n; i++) {
+        LIST_FOREACH(buckets[i], cur) {
+            ft_out_group_t *out_group =
+                container_of(cur, hash_links, ft_out_group_t);
+            if (out_group->group_id == group_id) {
+                return out_group;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* Free a group list if it has no references */
+static void
+ft_out_group_put(ft_instance_t ft, ft_out_group_t *out_group)
+{
+    if (out_group->entry_count == 0) {
+        list_remove(&out_group->hash_links);
+        INDIGO_MEM_FREE(out_group);
+        ft->out_group_count--;
+        ft_index_maintain(&ft->out_group_index, ft->out_group_count);
+    }
+}
+
+/*
+ * Find or create the group lists for each of the refs. On failure, lists
+ * created here are freed again and nothing is linked.
+ */
+static indigo_error_t
+ft_out_groups_get(ft_instance_t ft, ft_out_group_ref_t *refs, int count)
+{
+    int idx;
+
+    for (idx = 0; idx < count; idx++) {
+        ft_out_group_t *out_group = ft_out_group_lookup(ft, refs[idx].group_id);
+        if (out_group == NULL) {
+            out_group = INDIGO_MEM_ALLOC(sizeof(*out_group));
+            if (out_group == NULL) {
+                while (--idx >= 0) {
+                    ft_out_group_put(ft, refs[idx].out_group);
+                    refs[idx].out_group = NULL;
+                }
+                return INDIGO_ERROR_RESOURCE;
+            }
+            INDIGO_MEM_SET(out_group, 0, sizeof(*out_group));
+            out_group->group_id = refs[idx].group_id;
+            list_init(&out_group->refs);
+            ft_index_insert(&ft->out_group_index, out_group);
+            ft->out_group_count++;
+            ft_index_maintain(&ft->out_group_index, ft->out_group_count);
+        }
+        refs[idx].out_group = out_group;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/* Link refs whose group lists were found by ft_out_groups_get */
+static void
+ft_out_groups_link(ft_entry_t *entry, ft_out_group_ref_t *refs, int count)
+{
+    int idx;
+
+    for (idx = 0; idx < count; idx++) {
+        refs[idx].entry = entry;
+        list_push(&refs[idx].out_group->refs, &refs[idx].links);
+        refs[idx].out_group->entry_count++;
+    }
+}
+
+static void
+ft_out_groups_unlink(ft_instance_t ft, ft_entry_t *entry)
+{
+    int idx;
+
+    for (idx = 0; idx < entry->out_group_count; idx++) {
+        ft_out_group_ref_t *ref = &entry->out_group_refs[idx];
+        if (ref->out_group != NULL) {
+            list_remove(&ref->links);
+            ref->out_group->entry_count--;
+            ft_out_group_put(ft, ref->out_group);
+            ref->out_group = NULL;
+        }
+    }
+}
+
+int
+ft_out_group_entry_count(ft_instance_t ft, uint32_t group_id)
+{
+    ft_out_group_t *out_group = ft_out_group_lookup(ft, group_id);
+
+    return out_group == NULL ? 0 : out_group->entry_count;
+}
+
+ft_entry_t *
+ft_out_group_first(ft_instance_t ft, uint32_t group_id)
+{
+    ft_out_group_t *out_group = ft_out_group_lookup(ft, group_id);
+    ft_out_group_ref_t *ref;
+
+    if (out_group == NULL || list_empty(&out_group->refs)) {
+        return NULL;
+    }
+
+    ref = container_of(out_group->refs.links.next, links, ft_out_group_ref_t);
+    return ref->entry;
+}
+
+/****************************************************************
+ * Overlap index
+ ****************************************************************/
+
+static uint32_t
+ft_overlap_hash(uint8_t table_id, uint16_t priority,
+                of_match_fields_t *masks, of_match_fields_t *fields)
 {
+    of_match_fields_t masked;
+    uint8_t *m = (uint8_t *)masks;
+    uint8_t *f = (uint8_t *)fields;
+    uint8_t *v = (uint8_t *)&masked;
     uint32_t h = FT_HASH_SEED;
-    h = murmur_hash(match, sizeof(*match), h);
+    int idx;
+
+    for (idx = 0; idx < sizeof(of_match_fields_t); idx++) {
+        v[idx] = f[idx] & m[idx];
+    }
+
+    h = murmur_hash(&masked, sizeof(masked), h);
+    h = murmur_hash(masks, sizeof(*masks), h);
     h = murmur_hash(&priority, sizeof(priority), h);
-    return h % ft->config.strict_match_bucket_count;
+    h = murmur_hash(&table_id, sizeof(table_id), h);
+    return h;
 }
 
-static int
-ft_flow_id_to_bucket_index(ft_instance_t ft, indigo_flow_id_t *flow_id)
+static uint32_t
+ft_entry_overlap_hash(void *obj)
 {
-    return (murmur_hash(flow_id, sizeof(*flow_id), FT_HASH_SEED) %
-            ft->config.flow_id_bucket_count);
+    ft_entry_t *entry = obj;
+    return entry->overlap_hash;
 }
 
-static int
-ft_cookie_to_bucket_index(ft_instance_t ft, uint64_t cookie)
+static list_head_t *
+ft_overlap_part_bucket(ft_instance_t ft, uint8_t table_id, uint16_t priority)
 {
-    return cookie >> (64-FT_COOKIE_PREFIX_LEN);
+    uint32_t key = ((uint32_t)table_id << 16) | priority;
+    uint32_t h = murmur_hash(&key, sizeof(key), FT_HASH_SEED);
+    return &ft->overlap_part_buckets[h % FT_OVERLAP_PART_BUCKETS];
+}
+
+static ft_overlap_part_t *
+ft_overlap_part_lookup(ft_instance_t ft, uint8_t table_id, uint16_t priority)
+{
+    list_links_t *cur;
+
+    LIST_FOREACH(ft_overlap_part_bucket(ft, table_id, priority), cur) {
+        ft_overlap_part_t *part = container_of(cur, links, ft_overlap_part_t);
+        if (part->table_id == table_id && part->priority == priority) {
+            return part;
+        }
+    }
+
+    return NULL;
+}
+
+/* Free a group if it has no entries, and its partition if it has no groups */
+static void
+ft_overlap_group_put(ft_overlap_group_t *group)
+{
+    ft_overlap_part_t *part = group->part;
+
+    if (group->entry_count == 0) {
+        list_remove(&group->links);
+        INDIGO_MEM_FREE(group);
+    }
+
+    if (list_empty(&part->groups)) {
+        list_remove(&part->links);
+        INDIGO_MEM_FREE(part);
+    }
+}
+
+/* Find the overlap group for a table, priority and masks, creating it if needed */
+static ft_overlap_group_t *
+ft_overlap_group_get(ft_instance_t ft, uint8_t table_id, uint16_t priority,
+                     of_match_fields_t *masks)
+{
+    ft_overlap_part_t *part;
+    ft_overlap_group_t *group;
+    list_links_t *cur;
+
+    part = ft_overlap_part_lookup(ft, table_id, priority);
+    if (part == NULL) {
+        part = INDIGO_MEM_ALLOC(sizeof(*part));
+        if (part == NULL) {
+            return NULL;
+        }
+        INDIGO_MEM_SET(part, 0, sizeof(*part));
+        part->table_id = table_id;
+        part->priority = priority;
+        list_init(&part->groups);
+        list_push(ft_overlap_part_bucket(ft, table_id, priority), &part->links);
+    }
+
+    LIST_FOREACH(&part->groups, cur) {
+        group = container_of(cur, links, ft_overlap_group_t);
+        if (INDIGO_MEM_COMPARE(&group->masks, masks, sizeof(*masks)) == 0) {
+            return group;
+        }
+    }
+
+    group = INDIGO_MEM_ALLOC(sizeof(*group));
+    if (group == NULL) {
+        if (list_empty(&part->groups)) {
+            list_remove(&part->links);
+            INDIGO_MEM_FREE(part);
+        }
+        return NULL;
+    }
+    INDIGO_MEM_SET(group, 0, sizeof(*group));
+    group->part = part;
+    group->masks = *masks;
+    list_init(&group->entries);
+    list_push(&part->groups, &group->links);
+
+    return group;
+}
+
+static void
+ft_overlap_link(ft_instance_t ft, ft_overlap_group_t *group, ft_entry_t *entry)
+{
+    of_match_t match;
+
+    list_push(&group->entries, &entry->overlap_group_links);
+    group->entry_count++;
+    entry->overlap_group = group;
+
+    ft_entry_match_get(entry, &match);
+    entry->overlap_hash = ft_overlap_hash(entry->table_id, entry->priority,
+                                          &match.masks, &match.fields);
+    ft_index_insert(&ft->overlap_index, entry);
+}
+
+static void
+ft_overlap_unlink(ft_instance_t ft, ft_entry_t *entry)
+{
+    ft_overlap_group_t *group = entry->overlap_group;
+
+    list_remove(&entry->overlap_links);
+    list_remove(&entry->overlap_group_links);
+    entry->overlap_group = NULL;
+    group->entry_count--;
+    ft_overlap_group_put(group);
+}
+
+/* Search one partition; see ft_overlap_part_t */
+static ft_entry_t *
+ft_overlap_part_find(ft_instance_t ft, ft_overlap_part_t *part,
+                     of_meta_match_t *query)
+{
+    list_links_t *gcur, *cur;
+
+    LIST_FOREACH(&part->groups, gcur) {
+        ft_overlap_group_t *group = container_of(gcur, links, ft_overlap_group_t);
+
+        if (ft_masks_more_specific(&query->match.masks, &group->masks)) {
+            /* Candidates must equal the query under the group masks */
+            list_head_t *buckets[2];
+            uint32_t h;
+            int n, i;
+
+            h = ft_overlap_hash(part->table_id, part->priority,
+                                &group->masks, &query->match.fields);
+            n = ft_index_lookup_buckets(&ft->overlap_index, h, buckets);
+            for (i = 0; i < n; i++) {
+                LIST_FOREACH(buckets[i], cur) {
+                    ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, overlap);
+                    if (entry->overlap_hash != h ||
+                            entry->overlap_group != group) {
+                        continue;
+                    }
+                    ft->status.overlap_visits++;
+                    if (ft_entry_meta_match(query, entry)) {
+                        return entry;
+                    }
+                }
+            }
+        } else {
+            LIST_FOREACH(&group->entries, cur) {
+                ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, overlap_group);
+                ft->status.overlap_visits++;
+                if (ft_entry_meta_match(query, entry)) {
+                    return entry;
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+indigo_error_t
+ft_overlap_find(ft_instance_t ft, of_meta_match_t *query, ft_entry_t **entry_p)
+{
+    ft_overlap_part_t *part;
+    ft_entry_t *entry;
+    int table_id;
+
+    INDIGO_ASSERT(query->mode == OF_MATCH_OVERLAP && query->check_priority);
+
+    ft->status.overlap_checks++;
+
+    for (table_id = 0; table_id < TABLE_ID_ANY; table_id++) {
+        if (query->table_id != TABLE_ID_ANY && query->table_id != table_id) {
+            continue;
+        }
+        part = ft_overlap_part_lookup(ft, table_id, query->priority);
+        if (part != NULL &&
+                (entry = ft_overlap_part_find(ft, part, query)) != NULL) {
+            *entry_p = entry;
+            return INDIGO_ERROR_NONE;
+        }
+    }
+
+    return INDIGO_ERROR_NOT_FOUND;
 }
 
 ft_instance_t
@@ -84,30 +1121,61 @@ ft_create(ft_config_t *config)
     INDIGO_MEM_COPY(&ft->config,  config, sizeof(ft_config_t));
 
     list_init(&ft->all_list);
+    ft_slab_init(&ft->entry_slab, sizeof(ft_entry_t));
+    for (idx = 0; idx < FT_COLD_SLAB_CLASSES; idx++) {
+        ft_slab_init(&ft->cold_slabs[idx], sizeof(ft_entry_cold_t) +
+                     idx * FT_COLD_SLAB_WORDS * sizeof(uint64_t));
+    }
 
     /* Allocate and init buckets for each search type */
-    bytes = sizeof(list_head_t) * config->strict_match_bucket_count;
-    ft->strict_match_buckets = INDIGO_MEM_ALLOC(bytes);
-    if (ft->strict_match_buckets == NULL) {
+    if (ft_index_init(&ft->strict_match_index,
+                      config->strict_match_bucket_count,
+                      offsetof(ft_entry_t, strict_match_links),
+                      ft_entry_strict_match_hash) < 0) {
         LOG_ERROR("ERROR: Flow table, strict_match bucket alloc failed");
         ft_destroy(ft);
         return NULL;
     }
-    INDIGO_MEM_SET(ft->strict_match_buckets, 0, bytes);
-    for (idx = 0; idx < config->strict_match_bucket_count; idx++) {
-        list_init(&ft->strict_match_buckets[idx]);
-    }
 
-    bytes = sizeof(list_head_t) * config->flow_id_bucket_count;
-    ft->flow_id_buckets = INDIGO_MEM_ALLOC(bytes);
-    if (ft->flow_id_buckets == NULL) {
+    if (ft_index_init(&ft->flow_id_index,
+                      config->flow_id_bucket_count,
+                      offsetof(ft_entry_t, flow_id_links),
+                      ft_entry_flow_id_hash) < 0) {
         LOG_ERROR("ERROR: Flow table, flow id bucket alloc failed");
         ft_destroy(ft);
         return NULL;
     }
-    INDIGO_MEM_SET(ft->flow_id_buckets, 0, bytes);
-    for (idx = 0; idx < config->flow_id_bucket_count; idx++) {
-        list_init(&ft->flow_id_buckets[idx]);
+
+    if (ft_index_init(&ft->overlap_index, 0,
+                      offsetof(ft_entry_t, overlap_links),
+                      ft_entry_overlap_hash) < 0) {
+        LOG_ERROR("ERROR: Flow table, overlap bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+
+    if (ft_index_init(&ft->cookie_index, 0,
+                      offsetof(ft_cookie_group_t, hash_links),
+                      ft_cookie_group_hash) < 0) {
+        LOG_ERROR("ERROR: Flow table, cookie bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+
+    if (ft_index_init(&ft->effects_index, 0,
+                      offsetof(ft_effects_t, hash_links),
+                      ft_effects_hash) < 0) {
+        LOG_ERROR("ERROR: Flow table, effects bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+
+    if (ft_index_init(&ft->out_group_index, 0,
+                      offsetof(ft_out_group_t, hash_links),
+                      ft_out_group_hash) < 0) {
+        LOG_ERROR("ERROR: Flow table, out group bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
     }
 
     bytes = sizeof(list_head_t) * (1 << FT_COOKIE_PREFIX_LEN);
@@ -122,19 +1190,64 @@ ft_create(ft_config_t *config)
         list_init(&ft->cookie_buckets[idx]);
     }
 
+    list_init(&ft->mask_groups);
+    bytes = sizeof(list_head_t) * FT_MASK_GROUP_BUCKETS;
+    ft->mask_group_buckets = INDIGO_MEM_ALLOC(bytes);
+    if (ft->mask_group_buckets == NULL) {
+        LOG_ERROR("ERROR: Flow table, mask group bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+    for (idx = 0; idx < FT_MASK_GROUP_BUCKETS; idx++) {
+        list_init(&ft->mask_group_buckets[idx]);
+    }
+
+    bytes = sizeof(list_head_t) * FT_OVERLAP_PART_BUCKETS;
+    ft->overlap_part_buckets = INDIGO_MEM_ALLOC(bytes);
+    if (ft->overlap_part_buckets == NULL) {
+        LOG_ERROR("ERROR: Flow table, overlap partition bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+    for (idx = 0; idx < FT_OVERLAP_PART_BUCKETS; idx++) {
+        list_init(&ft->overlap_part_buckets[idx]);
+    }
+
+    bytes = sizeof(list_head_t) * FT_OUT_PORT_BUCKETS;
+    ft->out_port_buckets = INDIGO_MEM_ALLOC(bytes);
+    if (ft->out_port_buckets == NULL) {
+        LOG_ERROR("ERROR: Flow table, out port bucket alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+    for (idx = 0; idx < FT_OUT_PORT_BUCKETS; idx++) {
+        list_init(&ft->out_port_buckets[idx]);
+    }
+
+    bytes = sizeof(list_head_t) * FT_EXPIRE_WHEEL_SLOTS;
+    ft->expire_wheel = INDIGO_MEM_ALLOC(bytes);
+    if (ft->expire_wheel == NULL) {
+        LOG_ERROR("ERROR: Flow table, expire wheel alloc failed");
+        ft_destroy(ft);
+        return NULL;
+    }
+    for (idx = 0; idx < FT_EXPIRE_WHEEL_SLOTS; idx++) {
+        list_init(&ft->expire_wheel[idx]);
+    }
+    ft->expire_cursor = INDIGO_CURRENT_TIME / FT_EXPIRE_SLOT_MS;
+
     return ft;
 }
 
 /* Macro for checking bucket lists are empty */
 #if !defined(FT_NO_ERROR_CHECKING)
 #define CHECK_BUCKETS(type) do {                                           \
-        int idx, cnt;                                                      \
-        for (idx = 0; idx < ft->config.type##_bucket_count; idx++) {       \
-            if ((cnt = list_length(&ft->type##_buckets[idx])) != 0) {      \
-                LOG_ERROR("ERROR: bucket list %s has len %d on delete",    \
-                          #type, cnt);                                     \
-                break;                                                     \
-            }                                                              \
+        uint32_t hist[FT_INDEX_CHAIN_HIST_SIZE];                           \
+        int max_chain;                                                     \
+        ft_index_chain_histogram(&ft->type##_index, hist, &max_chain);     \
+        if (max_chain != 0) {                                              \
+            LOG_ERROR("ERROR: bucket list %s has len %d on delete",        \
+                      #type, max_chain);                                   \
         }                                                                  \
     } while (0)
 #else
@@ -146,6 +1259,7 @@ ft_destroy(ft_instance_t ft)
 {
     ft_entry_t *entry;
     list_links_t *cur, *next;
+    int idx;
 
     if (ft == NULL) {
         return;
@@ -156,20 +1270,62 @@ ft_destroy(ft_instance_t ft)
         ft_entry_destroy(ft, entry);
     }
 
-    if (ft->strict_match_buckets != NULL) {
+    if (ft->strict_match_index.buckets != NULL) {
         CHECK_BUCKETS(strict_match);
-        INDIGO_MEM_FREE(ft->strict_match_buckets);
-        ft->strict_match_buckets = NULL;
     }
-    if (ft->flow_id_buckets != NULL) {
+    ft_index_cleanup(&ft->strict_match_index);
+    if (ft->flow_id_index.buckets != NULL) {
         CHECK_BUCKETS(flow_id);
-        INDIGO_MEM_FREE(ft->flow_id_buckets);
-        ft->flow_id_buckets = NULL;
     }
+    ft_index_cleanup(&ft->flow_id_index);
+    if (ft->overlap_index.buckets != NULL) {
+        CHECK_BUCKETS(overlap);
+    }
+    ft_index_cleanup(&ft->overlap_index);
+    if (ft->cookie_index.buckets != NULL) {
+        INDIGO_ASSERT(ft->cookie_group_count == 0);
+        CHECK_BUCKETS(cookie);
+    }
+    ft_index_cleanup(&ft->cookie_index);
+    if (ft->effects_index.buckets != NULL) {
+        INDIGO_ASSERT(ft->effects_count == 0);
+        CHECK_BUCKETS(effects);
+    }
+    ft_index_cleanup(&ft->effects_index);
+    if (ft->out_group_index.buckets != NULL) {
+        INDIGO_ASSERT(ft->out_group_count == 0);
+        CHECK_BUCKETS(out_group);
+    }
+    ft_index_cleanup(&ft->out_group_index);
     if (ft->cookie_buckets != NULL) {
         INDIGO_MEM_FREE(ft->cookie_buckets);
         ft->cookie_buckets = NULL;
     }
+    if (ft->mask_group_buckets != NULL) {
+        INDIGO_ASSERT(ft->mask_group_count == 0);
+        INDIGO_MEM_FREE(ft->mask_group_buckets);
+        ft->mask_group_buckets = NULL;
+    }
+    if (ft->overlap_part_buckets != NULL) {
+        INDIGO_MEM_FREE(ft->overlap_part_buckets);
+        ft->overlap_part_buckets = NULL;
+    }
+    if (ft->out_port_buckets != NULL) {
+        INDIGO_MEM_FREE(ft->out_port_buckets);
+        ft->out_port_buckets = NULL;
+    }
+    if (ft->expire_wheel != NULL) {
+        INDIGO_MEM_FREE(ft->expire_wheel);
+        ft->expire_wheel = NULL;
+    }
+    for (idx = 0; idx < FT_TABLE_COUNT; idx++) {
+        INDIGO_ASSERT(ft->tables[idx].heap_count == 0);
+        INDIGO_MEM_FREE(ft->tables[idx].heap);
+    }
+    ft_slab_cleanup(&ft->entry_slab);
+    for (idx = 0; idx < FT_COLD_SLAB_CLASSES; idx++) {
+        ft_slab_cleanup(&ft->cold_slabs[idx]);
+    }
 
     INDIGO_MEM_FREE(ft);
 }
@@ -188,14 +1344,22 @@ ft_add(ft_instance_t ft, indigo_flow_id_t id,
         return INDIGO_ERROR_EXISTS;
     }
 
-    if ((rv = ft_entry_create(id, flow_add, &entry)) < 0) {
+    if ((rv = ft_entry_create(ft, id, flow_add, &entry)) < 0) {
         return rv;
     }
 
-    ft_entry_link(ft, entry);
+    if ((rv = ft_entry_link(ft, entry)) < 0) {
+        ft_entry_destroy(ft, entry);
+        return rv;
+    }
     ft->status.adds += 1;
     ft->status.current_count += 1;
 
+    ft_index_maintain(&ft->strict_match_index, ft->status.current_count);
+    ft_index_maintain(&ft->flow_id_index, ft->status.current_count);
+    ft_index_maintain(&ft->overlap_index, ft->status.current_count);
+    ft_index_maintain(&ft->cookie_index, ft->cookie_group_count);
+
     if (entry_p != NULL) {
         *entry_p = entry;
     }
@@ -208,15 +1372,55 @@ ft_delete(ft_instance_t ft, ft_entry_t *entry)
 {
     LOG_TRACE("Delete flow " INDIGO_FLOW_ID_PRINTF_FORMAT, entry->id);
 
+    ft_detach(ft, entry);
+    ft_free(ft, entry);
+
+    return INDIGO_ERROR_NONE;
+}
+
+void
+ft_detach(ft_instance_t ft, ft_entry_t *entry)
+{
     ft_entry_unlink(ft, entry);
-    ft_entry_destroy(ft, entry);
 
     ft->status.current_count -= 1;
-    ft->status.deletes += 1;
+
+    ft_index_maintain(&ft->strict_match_index, ft->status.current_count);
+    ft_index_maintain(&ft->flow_id_index, ft->status.current_count);
+    ft_index_maintain(&ft->overlap_index, ft->status.current_count);
+    ft_index_maintain(&ft->cookie_index, ft->cookie_group_count);
+}
+
+indigo_error_t
+ft_reattach(ft_instance_t ft, ft_entry_t *entry)
+{
+    indigo_error_t rv;
+
+    if (ft_lookup(ft, entry->id) != NULL) {
+        return INDIGO_ERROR_EXISTS;
+    }
+
+    if ((rv = ft_entry_link(ft, entry)) < 0) {
+        return rv;
+    }
+
+    ft->status.current_count += 1;
+
+    ft_index_maintain(&ft->strict_match_index, ft->status.current_count);
+    ft_index_maintain(&ft->flow_id_index, ft->status.current_count);
+    ft_index_maintain(&ft->overlap_index, ft->status.current_count);
+    ft_index_maintain(&ft->cookie_index, ft->cookie_group_count);
 
     return INDIGO_ERROR_NONE;
 }
 
+void
+ft_free(ft_instance_t ft, ft_entry_t *entry)
+{
+    ft_entry_destroy(ft, entry);
+    ft->status.deletes += 1;
+}
+
 indigo_error_t
 ft_delete_id(ft_instance_t ft,
                        indigo_flow_id_t id)
@@ -236,20 +1440,28 @@ ft_strict_match(ft_instance_t instance,
                of_meta_match_t *query,
                ft_entry_t **entry_ptr)
 {
-    int bucket_idx;
+    list_head_t *buckets[2];
     list_links_t *cur;
+    ft_match_key_t key;
+    uint32_t h;
+    int n, i;
 
     INDIGO_ASSERT(query->mode == OF_MATCH_STRICT);
 
-    bucket_idx = ft_strict_match_to_bucket_index(instance, &query->match,
-                                                 query->priority);
-    list_head_t *bucket = &instance->strict_match_buckets[bucket_idx];
-
-    LIST_FOREACH(bucket, cur) {
-        ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, strict_match);
-        if (ft_entry_meta_match(query, entry)) {
-            *entry_ptr = entry;
-            return INDIGO_ERROR_NONE;
+    ft_match_key_init(&key, &query->match);
+    h = ft_strict_match_hash(&key, query->priority);
+    n = ft_index_lookup_buckets(&instance->strict_match_index, h, buckets);
+
+    for (i = 0; i < n; i++) {
+        LIST_FOREACH(buckets[i], cur) {
+            ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, strict_match);
+            if (entry->strict_match_hash == h &&
+                    ft_entry_match_key_eq(entry, &key) &&
+                    ft_entry_meta_match_attrs(query, entry) &&
+                    ft_entry_out_port_match(query, entry)) {
+                *entry_ptr = entry;
+                return INDIGO_ERROR_NONE;
+            }
         }
     }
 
@@ -259,65 +1471,90 @@ ft_strict_match(ft_instance_t instance,
 ft_entry_t *
 ft_lookup(ft_instance_t ft, indigo_flow_id_t id)
 {
-    int bucket_idx = ft_flow_id_to_bucket_index(ft, &id);
-    list_head_t *bucket = &ft->flow_id_buckets[bucket_idx];
+    list_head_t *buckets[2];
     list_links_t *cur;
+    int n, i;
 
-    LIST_FOREACH(bucket, cur) {
-        ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, flow_id);
-        if (entry->id == id) {
-            return entry;
+    n = ft_index_lookup_buckets(&ft->flow_id_index, ft_flow_id_hash(&id),
+                                buckets);
+
+    for (i = 0; i < n; i++) {
+        LIST_FOREACH(buckets[i], cur) {
+            ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, flow_id);
+            if (entry->id == id) {
+                return entry;
+            }
         }
     }
 
     return NULL;
 }
 
-int
-ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry)
+/* Cookie, table and priority criteria of a query */
+static int
+ft_entry_meta_match_attrs(of_meta_match_t *query, ft_entry_t *entry)
 {
     uint64_t mask;
-    int rv = 0; /* Default is no match */
 
     if ((mask = query->cookie_mask)) {
         if ((query->cookie & mask) != (entry->cookie & mask)) {
-            return rv;
+            return 0;
         }
     }
 
     if (query->table_id != TABLE_ID_ANY) {
         if (query->table_id != entry->table_id) {
-            return rv;
+            return 0;
         }
     }
 
     if (query->check_priority) {
         if (entry->priority != query->priority) {
-            return rv;
+            return 0;
         }
     }
 
+    return 1;
+}
+
+static int
+ft_entry_out_port_match(of_meta_match_t *query, ft_entry_t *entry)
+{
+    return query->out_port == OF_PORT_DEST_WILDCARD ||
+        ft_entry_has_out_port(entry, query->out_port);
+}
+
+int
+ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry)
+{
+    int rv = 0; /* Default is no match */
+    of_match_t match;
+
+    if (!ft_entry_meta_match_attrs(query, entry)) {
+        return rv;
+    }
+
+    if (query->mode != OF_MATCH_COOKIE_ONLY) {
+        ft_entry_match_get(entry, &match);
+    }
+
     switch (query->mode) {
     case OF_MATCH_NON_STRICT:
         /* Check if the entry's match is more specific than the query's */
-        if (!of_match_more_specific(&entry->match, &query->match)) {
+        if (!of_match_more_specific(&match, &query->match)) {
             break;
         }
-        if (query->out_port != OF_PORT_DEST_WILDCARD) {
-            if (!ft_entry_has_out_port(entry, query->out_port)) {
-                break;
-            }
+        if (!ft_entry_out_port_match(query, entry)) {
+            break;
         }
         rv = 1;
         break;
     case OF_MATCH_STRICT:
-        if (!of_match_eq(&entry->match, &query->match)) {
+        if (!of_match_eq(&match, &query->match)) {
             break;
         }
-        if (query->out_port != OF_PORT_DEST_WILDCARD) {
-            if (!ft_entry_has_out_port(entry, query->out_port)) {
-                break;
-            }
+        if (!ft_entry_out_port_match(query, entry)) {
+            break;
         }
         rv = 1;
         break;
@@ -326,7 +1563,7 @@ ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry)
         rv = 1;
         break;
     case OF_MATCH_OVERLAP:
-        if (!of_match_overlap(&entry->match, &query->match)) {
+        if (!of_match_overlap(&match, &query->match)) {
             break;
         }
         rv = 1;
@@ -350,7 +1587,7 @@ ft_entry_modify_effects(ft_instance_t instance,
     LOG_TRACE("Modifying effects of entry " INDIGO_FLOW_ID_PRINTF_FORMAT,
               entry->id);
 
-    err = ft_entry_set_effects(entry, flow_mod);
+    err = ft_entry_set_effects(instance, entry, flow_mod, true);
     if (err == INDIGO_ERROR_NONE) {
         instance->status.updates += 1;
     }
@@ -358,22 +1595,525 @@ ft_entry_modify_effects(ft_instance_t instance,
     return err;
 }
 
+/* Move an entry to another cookie's group and bucket */
+static void
+ft_entry_move_cookie(ft_instance_t ft, ft_entry_t *entry,
+                     ft_cookie_group_t *cookie_group)
+{
+    int idx;
+
+    ft_iterator_skip_entry(entry, false, false, true);
+
+    ft_entry_aggregates_unlink(ft, entry);
+    if (ft->cookie_buckets) {
+        list_remove(&entry->cookie_links);
+    }
+
+    entry->cookie = cookie_group->cookie;
+
+    entry->cookie_group = cookie_group;
+    list_push(&cookie_group->entries, &entry->cookie_group_links);
+    ft_entry_aggregates_add(ft, entry, 1, entry->cold->packets,
+                            entry->cold->bytes);
+    if (ft->cookie_buckets) {
+        idx = ft_cookie_to_bucket_index(ft, entry->cookie);
+        list_push(&ft->cookie_buckets[idx], &entry->cookie_links);
+    }
+}
+
+indigo_error_t
+ft_entry_overwrite(ft_instance_t ft, ft_entry_t *entry,
+                   of_flow_add_t *flow_add, bool reset_counters)
+{
+    ft_cookie_group_t *cookie_group = NULL;
+    indigo_time_t now;
+    uint64_t cookie;
+    indigo_error_t err;
+
+    LOG_TRACE("Overwriting entry " INDIGO_FLOW_ID_PRINTF_FORMAT, entry->id);
+
+    /* The steps that can fail come first */
+    of_flow_add_cookie_get(flow_add, &cookie);
+    if (cookie != entry->cookie) {
+        if ((cookie_group = ft_cookie_group_get(ft, cookie)) == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+    }
+
+    err = ft_entry_set_effects(ft, entry, flow_add, true);
+    if (err != INDIGO_ERROR_NONE) {
+        if (cookie_group != NULL) {
+            ft_cookie_group_put(ft, cookie_group);
+        }
+        return err;
+    }
+
+    if (cookie_group != NULL) {
+        ft_entry_move_cookie(ft, entry, cookie_group);
+    }
+
+    of_flow_add_flags_get(flow_add, &entry->flags);
+    of_flow_add_idle_timeout_get(flow_add, &entry->idle_timeout);
+    of_flow_add_hard_timeout_get(flow_add, &entry->hard_timeout);
+
+    if (reset_counters) {
+        entry->cold->packets_base += entry->cold->packets;
+        entry->cold->bytes_base += entry->cold->bytes;
+        ft_entry_clear_counters(ft, entry, NULL, NULL);
+    }
+
+    now = INDIGO_CURRENT_TIME;
+    entry->insert_time = now;
+    entry->last_counter_change = now;
+    ft_expire_reschedule(ft, entry, now, true);
+    ft_evict_heap_update(ft, entry);
+
+    ft->status.overwrites += 1;
+    ft_index_maintain(&ft->cookie_index, ft->cookie_group_count);
+
+    return INDIGO_ERROR_NONE;
+}
+
 indigo_error_t
-ft_entry_clear_counters(ft_entry_t *entry, uint64_t *packets, uint64_t *bytes)
+ft_entry_clear_counters(ft_instance_t ft, ft_entry_t *entry,
+                        uint64_t *packets, uint64_t *bytes)
 {
     if (packets) {
-        *packets = entry->packets;
+        *packets = entry->cold->packets;
     }
     if (bytes) {
-        *bytes = entry->bytes;
+        *bytes = entry->cold->bytes;
     }
 
-    entry->packets = 0;
-    entry->bytes = 0;
+    ft_entry_aggregates_add(ft, entry, 0, -entry->cold->packets,
+                            -entry->cold->bytes);
+    entry->cold->packets = 0;
+    entry->cold->bytes = 0;
 
     /* @fixme Update last counter update/change? */
 
-    return INDIGO_ERROR_NONE;
+    return INDIGO_ERROR_NONE;
+}
+
+bool
+ft_entry_counters_set(ft_instance_t ft, ft_entry_t *entry,
+                      uint64_t packets, uint64_t bytes, indigo_time_t now)
+{
+    /* A forwarding count below the base means the counter restarted */
+    if (packets != (uint64_t)-1) {
+        if (packets < entry->cold->packets_base) {
+            entry->cold->packets_base = 0;
+        }
+        packets -= entry->cold->packets_base;
+    }
+    if (bytes != (uint64_t)-1) {
+        if (bytes < entry->cold->bytes_base) {
+            entry->cold->bytes_base = 0;
+        }
+        bytes -= entry->cold->bytes_base;
+    }
+
+    if (entry->cold->packets == packets && entry->cold->bytes == bytes) {
+        return false;
+    }
+
+    /* A detached entry counts toward no aggregate */
+    if (entry->cookie_group != NULL) {
+        ft_entry_aggregates_add(ft, entry, 0, packets - entry->cold->packets,
+                                bytes - entry->cold->bytes);
+    }
+    entry->cold->packets = packets;
+    entry->cold->bytes = bytes;
+    entry->last_counter_change = now;
+    ft_evict_heap_update(ft, entry);
+
+    return true;
+}
+
+indigo_error_t
+ft_entry_set_table_id(ft_instance_t ft, ft_entry_t *entry, uint8_t table_id)
+{
+    ft_mask_group_t *group;
+    ft_overlap_group_t *overlap_group;
+
+    if (table_id == entry->table_id) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    if (ft_evict_heap_reserve(&ft->tables[table_id]) < 0) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    group = ft_mask_group_get(ft, table_id, &entry->mask_group->masks);
+    if (group == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    overlap_group = ft_overlap_group_get(ft, table_id, entry->priority,
+                                         &entry->mask_group->masks);
+    if (overlap_group == NULL) {
+        ft_mask_group_put(ft, group);
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    /* Advance iterators walking the old group past this entry */
+    ft_iterator_skip_entry(entry, true, false, false);
+
+    ft_mask_group_unlink(ft, entry);
+    ft_overlap_unlink(ft, entry);
+    ft_evict_heap_remove(&ft->tables[entry->table_id], entry);
+    ft_aggregate_add(&ft->table_aggregates[entry->table_id], -1,
+                     -entry->cold->packets, -entry->cold->bytes);
+    entry->table_id = table_id;
+    ft_aggregate_add(&ft->table_aggregates[entry->table_id], 1,
+                     entry->cold->packets, entry->cold->bytes);
+    ft_mask_group_link(group, entry);
+    ft_overlap_link(ft, overlap_group, entry);
+    ft_evict_heap_insert(&ft->tables[entry->table_id], entry);
+
+    return INDIGO_ERROR_NONE;
+}
+
+void
+ft_entry_restore(ft_instance_t ft, ft_entry_t *entry,
+                 indigo_time_t insert_time,
+                 uint64_t packets_base, uint64_t bytes_base)
+{
+    indigo_time_t now = INDIGO_CURRENT_TIME;
+
+    entry->insert_time = insert_time;
+    entry->last_counter_change = now;
+    entry->cold->packets_base = packets_base;
+    entry->cold->bytes_base = bytes_base;
+    ft_expire_reschedule(ft, entry, now, true);
+    ft_evict_heap_update(ft, entry);
+}
+
+/*
+ * Eviction heaps
+ *
+ * A table with an eviction policy keeps its entries in a binary min-heap
+ * under the policy's order, so the victim is always heap[0]. Entries move
+ * in the heap when the fields their policy reads change: counters for LRU
+ * and expire, timeouts and insert time on overwrite.
+ */
+
+/* When an entry times out; (indigo_time_t)-1 if never */
+static indigo_time_t
+ft_entry_deadline(ft_entry_t *entry)
+{
+    indigo_time_t deadline = (indigo_time_t)-1;
+    indigo_time_t t;
+
+    if (entry->hard_timeout > 0) {
+        deadline = entry->insert_time + (indigo_time_t)entry->hard_timeout * 1000;
+    }
+    if (entry->idle_timeout > 0) {
+        t = entry->last_counter_change + (indigo_time_t)entry->idle_timeout * 1000;
+        if (t < deadline) {
+            deadline = t;
+        }
+    }
+
+    return deadline;
+}
+
+/* Whether a should be evicted before b; ties go to the older flow ID */
+static bool
+ft_evict_before(ft_eviction_t eviction, ft_entry_t *a, ft_entry_t *b)
+{
+    indigo_time_t ta, tb;
+
+    switch (eviction) {
+    case FT_EVICTION_LRU:
+        ta = a->last_counter_change;
+        tb = b->last_counter_change;
+        break;
+    case FT_EVICTION_PRIORITY:
+        if (a->priority != b->priority) {
+            return a->priority < b->priority;
+        }
+        ta = a->insert_time;
+        tb = b->insert_time;
+        break;
+    case FT_EVICTION_EXPIRE:
+        ta = ft_entry_deadline(a);
+        tb = ft_entry_deadline(b);
+        break;
+    default:
+        ta = tb = 0;
+        break;
+    }
+
+    if (ta != tb) {
+        return ta < tb;
+    }
+    return a->id < b->id;
+}
+
+static void
+ft_evict_heap_set(ft_table_t *table, int idx, ft_entry_t *entry)
+{
+    table->heap[idx] = entry;
+    entry->evict_idx = idx;
+}
+
+static void
+ft_evict_heap_sift(ft_table_t *table, int idx)
+{
+    ft_entry_t *entry = table->heap[idx];
+    int parent, child;
+
+    /* Up */
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!ft_evict_before(table->eviction, entry, table->heap[parent])) {
+            break;
+        }
+        ft_evict_heap_set(table, idx, table->heap[parent]);
+        idx = parent;
+    }
+
+    /* Down */
+    while ((child = 2 * idx + 1) < table->heap_count) {
+        if (child + 1 < table->heap_count &&
+                ft_evict_before(table->eviction, table->heap[child + 1],
+                                table->heap[child])) {
+            child += 1;
+        }
+        if (!ft_evict_before(table->eviction, table->heap[child], entry)) {
+            break;
+        }
+        ft_evict_heap_set(table, idx, table->heap[child]);
+        idx = child;
+    }
+
+    ft_evict_heap_set(table, idx, entry);
+}
+
+/* Make room for one more entry so ft_evict_heap_insert cannot fail */
+static indigo_error_t
+ft_evict_heap_reserve(ft_table_t *table)
+{
+    ft_entry_t **heap;
+    int size;
+
+    if (table->eviction == FT_EVICTION_NONE ||
+            table->heap_count < table->heap_size) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    size = table->heap_size ? table->heap_size * 2 : 64;
+    heap = INDIGO_MEM_REALLOC(table->heap, size * sizeof(*heap));
+    if (heap == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    table->heap = heap;
+    table->heap_size = size;
+
+    return INDIGO_ERROR_NONE;
+}
+
+static void
+ft_evict_heap_insert(ft_table_t *table, ft_entry_t *entry)
+{
+    if (table->eviction == FT_EVICTION_NONE) {
+        return;
+    }
+    INDIGO_ASSERT(table->heap_count < table->heap_size);
+    ft_evict_heap_set(table, table->heap_count++, entry);
+    ft_evict_heap_sift(table, entry->evict_idx);
+}
+
+static void
+ft_evict_heap_remove(ft_table_t *table, ft_entry_t *entry)
+{
+    int idx = entry->evict_idx;
+
+    if (idx < 0) {
+        return;
+    }
+    entry->evict_idx = -1;
+
+    if (--table->heap_count > idx) {
+        ft_evict_heap_set(table, idx, table->heap[table->heap_count]);
+        ft_evict_heap_sift(table, idx);
+    }
+}
+
+/* Reposition an entry after the fields its table's policy reads changed */
+static void
+ft_evict_heap_update(ft_instance_t ft, ft_entry_t *entry)
+{
+    if (entry->evict_idx >= 0) {
+        ft_evict_heap_sift(&ft->tables[entry->table_id], entry->evict_idx);
+    }
+}
+
+indigo_error_t
+ft_table_eviction_set(ft_instance_t ft, uint8_t table_id,
+                      ft_eviction_t eviction, int max_entries)
+{
+    ft_table_t *table = &ft->tables[table_id];
+    ft_entry_t **heap = NULL;
+    ft_entry_t *entry;
+    list_links_t *cur, *next;
+    int heap_size = 0;
+    int count;
+
+    /* Build the new heap first, so failure leaves the table as it was */
+    if (eviction != FT_EVICTION_NONE) {
+        heap_size = ft->table_aggregates[table_id].flow_count;
+    }
+    if (heap_size > 0) {
+        heap = INDIGO_MEM_ALLOC(heap_size * sizeof(*heap));
+        if (heap == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+    }
+
+    /* Drop the old heap */
+    for (count = 0; count < table->heap_count; count++) {
+        table->heap[count]->evict_idx = -1;
+    }
+    INDIGO_MEM_FREE(table->heap);
+    table->heap = heap;
+    table->heap_count = 0;
+    table->heap_size = heap_size;
+    table->eviction = eviction;
+    table->max_entries = max_entries;
+
+    if (eviction == FT_EVICTION_NONE) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    FT_ITER(ft, entry, cur, next) {
+        if (entry->table_id == table_id) {
+            ft_evict_heap_insert(table, entry);
+        }
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+bool
+ft_table_over_limit(ft_instance_t ft, uint8_t table_id)
+{
+    return ft_table_over_limit_after(ft, table_id, 0);
+}
+
+bool
+ft_table_over_limit_after(ft_instance_t ft, uint8_t table_id, int count)
+{
+    int max_entries = ft->tables[table_id].max_entries;
+
+    return max_entries > 0 &&
+        (int64_t)ft->table_aggregates[table_id].flow_count + count >
+        max_entries;
+}
+
+ft_entry_t *
+ft_eviction_victim(ft_instance_t ft, uint8_t table_id)
+{
+    ft_table_t *table = &ft->tables[table_id];
+
+    return table->heap_count > 0 ? table->heap[0] : NULL;
+}
+
+/*
+ * Expiration timing wheel
+ *
+ * An entry with a hard or idle timeout sits in the wheel slot for its
+ * expire_time. Slots are indexed by absolute slot number modulo the wheel
+ * size, so a slot may also hold entries due on a later rotation; those are
+ * left in place when the slot is visited.
+ */
+
+static void
+ft_expire_link(ft_instance_t ft, ft_entry_t *entry, indigo_time_t deadline)
+{
+    uint64_t slot = deadline / FT_EXPIRE_SLOT_MS;
+
+    /* Slots before the cursor have been visited; use the next one visited */
+    if (slot < ft->expire_cursor) {
+        slot = ft->expire_cursor;
+    }
+
+    entry->expire_time = deadline;
+    list_push(&ft->expire_wheel[slot % FT_EXPIRE_WHEEL_SLOTS],
+              &entry->expire_links);
+}
+
+static void
+ft_expire_unlink(ft_entry_t *entry)
+{
+    if (entry->expire_time != 0) {
+        list_remove(&entry->expire_links);
+        entry->expire_time = 0;
+    }
+}
+
+void
+ft_expire_reschedule(ft_instance_t ft, ft_entry_t *entry,
+                     indigo_time_t now, bool counters_changed)
+{
+    indigo_time_t deadline = 0;
+
+    ft_expire_unlink(entry);
+
+    if (entry->hard_timeout > 0) {
+        deadline = entry->insert_time + (indigo_time_t)entry->hard_timeout * 1000;
+    }
+
+    if (entry->idle_timeout > 0) {
+        indigo_time_t idle_ms = (indigo_time_t)entry->idle_timeout * 1000;
+        indigo_time_t next;
+
+        if (counters_changed) {
+            next = now + idle_ms / FT_IDLE_CHECKS_PER_TIMEOUT;
+        } else {
+            next = entry->last_counter_change + idle_ms;
+        }
+
+        if (deadline == 0 || next < deadline) {
+            deadline = next;
+        }
+    }
+
+    if (deadline != 0) {
+        ft_expire_link(ft, entry, deadline);
+    }
+}
+
+void
+ft_expire_collect(ft_instance_t ft, indigo_time_t now, list_head_t *due)
+{
+    uint64_t now_slot = now / FT_EXPIRE_SLOT_MS;
+    uint64_t slot = ft->expire_cursor;
+    list_links_t *cur, *next;
+
+    list_init(due);
+
+    if (now_slot < slot) {
+        /* Clock went backwards; revisit the cursor slot only */
+        now_slot = slot;
+    } else if (now_slot - slot >= FT_EXPIRE_WHEEL_SLOTS) {
+        /* More than a full rotation has passed; visit each slot once */
+        slot = now_slot - FT_EXPIRE_WHEEL_SLOTS + 1;
+    }
+
+    for (; slot <= now_slot; slot++) {
+        list_head_t *bucket = &ft->expire_wheel[slot % FT_EXPIRE_WHEEL_SLOTS];
+        LIST_FOREACH_SAFE(bucket, cur, next) {
+            ft_entry_t *entry = FT_ENTRY_CONTAINER(cur, expire);
+            if (entry->expire_time <= now) {
+                list_remove(cur);
+                list_push(due, cur);
+            }
+        }
+    }
+
+    /* Entries in the current slot may not be due yet; revisit it next time */
+    ft->expire_cursor = now_slot;
 }
 
 /*
@@ -389,6 +2129,7 @@ ft_entry_clear_counters(ft_entry_t *entry, uint64_t *packets, uint64_t *bytes)
 
 struct ft_iter_task_state {
     ft_iter_task_callback_f callback;
+    ft_wait_iter_task_callback_f wait_callback;  /* Instead of callback */
     void *cookie;
     ft_iterator_t iter;
 };
@@ -402,22 +2143,35 @@ ft_iter_task_callback(void *cookie)
         ft_entry_t *entry = ft_iterator_next(&state->iter);
         if (entry == NULL) {
             /* Finished */
-            state->callback(state->cookie, NULL);
+            if (state->wait_callback != NULL) {
+                (void)state->wait_callback(state->cookie, NULL);
+            } else {
+                state->callback(state->cookie, NULL);
+            }
             ft_iterator_cleanup(&state->iter);
             INDIGO_MEM_FREE(state);
             return IND_SOC_TASK_FINISHED;
-        } else {
+        } else if (state->wait_callback == NULL) {
             state->callback(state->cookie, entry);
+        } else if (state->wait_callback(state->cookie, entry) ==
+                   INDIGO_ERROR_PENDING) {
+            /* Offer the entry again once other events have run */
+            if (ft_iterator_hold(&state->iter, entry) == INDIGO_ERROR_NONE) {
+                return IND_SOC_TASK_CONTINUE;
+            }
+            LOG_ERROR("Failed to hold flow " INDIGO_FLOW_ID_PRINTF_FORMAT
+                      " for an iterator task", entry->id);
         }
     } while (!ind_soc_should_yield());
 
     return IND_SOC_TASK_CONTINUE;
 }
 
-indigo_error_t
-ft_spawn_iter_task(ft_instance_t instance,
+static indigo_error_t
+ft_iter_task_spawn(ft_instance_t instance,
                    of_meta_match_t *query,
                    ft_iter_task_callback_f callback,
+                   ft_wait_iter_task_callback_f wait_callback,
                    void *cookie,
                    int priority)
 {
@@ -429,6 +2183,7 @@ ft_spawn_iter_task(ft_instance_t instance,
     }
 
     state->callback = callback;
+    state->wait_callback = wait_callback;
     state->cookie = cookie;
 
     ft_iterator_init(&state->iter, instance, query);
@@ -442,18 +2197,61 @@ ft_spawn_iter_task(ft_instance_t instance,
     return INDIGO_ERROR_NONE;
 }
 
+indigo_error_t
+ft_spawn_iter_task(ft_instance_t instance,
+                   of_meta_match_t *query,
+                   ft_iter_task_callback_f callback,
+                   void *cookie,
+                   int priority)
+{
+    return ft_iter_task_spawn(instance, query, callback, NULL, cookie,
+                              priority);
+}
+
+indigo_error_t
+ft_spawn_wait_iter_task(ft_instance_t instance,
+                        of_meta_match_t *query,
+                        ft_wait_iter_task_callback_f callback,
+                        void *cookie,
+                        int priority)
+{
+    return ft_iter_task_spawn(instance, query, NULL, callback, cookie,
+                              priority);
+}
+
 static ft_entry_t *
 ft_iterator_links_to_entry(ft_iterator_t *iter, list_links_t *links)
 {
+    if (iter->out_port != NULL) {
+        ft_out_port_ref_t *ref = container_of(links, links, ft_out_port_ref_t);
+        return ref->entry;
+    }
     return (ft_entry_t *)(((char *)links) - iter->links_offset);
 }
 
 static list_links_t *
 ft_iterator_entry_to_links(ft_iterator_t *iter, ft_entry_t *entry)
 {
+    if (iter->out_port != NULL) {
+        return &ft_entry_out_port_ref(entry, iter->out_port->port)->links;
+    }
     return (list_links_t *)(((char *)entry) + iter->links_offset);
 }
 
+/* Find the first group from cur on that may satisfy the iterator's query */
+static ft_mask_group_t *
+ft_iterator_find_group(ft_iterator_t *iter, list_links_t *cur)
+{
+    for (; cur != &iter->groups->links; cur = cur->next) {
+        ft_mask_group_t *group = container_of(cur, links, ft_mask_group_t);
+        if (ft_mask_group_may_match(group, &iter->query)) {
+            return group;
+        }
+    }
+
+    return NULL;
+}
+
 void
 ft_iterator_init(ft_iterator_t *iter, ft_instance_t ft, of_meta_match_t *query)
 {
@@ -464,47 +2262,148 @@ ft_iterator_init(ft_iterator_t *iter, ft_instance_t ft, of_meta_match_t *query)
         iter->use_query = false;
     }
 
-    if (query && (query->cookie_mask & FT_COOKIE_PREFIX_MASK) == FT_COOKIE_PREFIX_MASK) {
+    iter->next_ref.iter = iter;
+    list_init(&iter->pending);
+    iter->held = NULL;
+    iter->groups = NULL;
+    iter->group = NULL;
+    iter->out_port = NULL;
+
+    if (query && query->cookie_mask == (uint64_t)-1) {
+        /* Using the exact cookie's group; groups are never empty */
+        ft_cookie_group_t *group = ft_cookie_group_lookup(ft, query->cookie);
+        if (group == NULL) {
+            iter->head = NULL;
+            iter->next_entry = NULL;
+            return;
+        }
+        iter->head = &group->entries;
+        iter->links_offset = offsetof(ft_entry_t, cookie_group_links);
+    } else if (query && query->out_port != OF_PORT_DEST_WILDCARD &&
+            (query->mode == OF_MATCH_NON_STRICT || query->mode == OF_MATCH_STRICT)) {
+        /* Using output port index; lists are never empty */
+        iter->out_port = ft_out_port_lookup(ft, query->out_port);
+        if (iter->out_port == NULL) {
+            iter->head = NULL;
+            iter->next_entry = NULL;
+            return;
+        }
+        iter->head = &iter->out_port->refs;
+        iter->links_offset = 0;
+    } else if (query && (query->cookie_mask & FT_COOKIE_PREFIX_MASK) == FT_COOKIE_PREFIX_MASK) {
         /* Using cookie bucket */
         iter->head = &ft->cookie_buckets[ft_cookie_to_bucket_index(ft, query->cookie)];
         iter->links_offset = offsetof(ft_entry_t, cookie_links);
+    } else if (query) {
+        /* Using mask groups; groups are never empty */
+        iter->groups = &ft->mask_groups;
+        iter->group = ft_iterator_find_group(iter, ft->mask_groups.links.next);
+        iter->head = iter->group ? &iter->group->entries : &ft->mask_groups;
+        iter->links_offset = offsetof(ft_entry_t, mask_group_links);
     } else {
         iter->head = &ft->all_list;
         iter->links_offset = offsetof(ft_entry_t, table_links);
     }
 
-    if (list_empty(iter->head)) {
+    if (list_empty(iter->head) || (iter->groups && iter->group == NULL)) {
         iter->next_entry = NULL;
     } else {
         iter->next_entry = ft_iterator_links_to_entry(iter, iter->head->links.next);
-        list_push(&iter->next_entry->iterators, &iter->entry_links);
+        list_push(&iter->next_entry->iterators, &iter->next_ref.links);
     }
 }
 
-ft_entry_t *
-ft_iterator_next(ft_iterator_t *iter)
+/* Move an iterator's position past next_entry, which is not yet returned */
+static void
+ft_iterator_step(ft_iterator_t *iter)
 {
+    list_links_t *next_links = ft_iterator_entry_to_links(iter, iter->next_entry)->next;
+
+    list_remove(&iter->next_ref.links);
+
+    if (next_links != &iter->head->links) {
+        iter->next_entry = ft_iterator_links_to_entry(iter, next_links);
+    } else if (iter->group != NULL &&
+               (iter->group = ft_iterator_find_group(
+                    iter, iter->group->links.next)) != NULL) {
+        /* Continue with the next candidate group */
+        iter->head = &iter->group->entries;
+        iter->next_entry = ft_iterator_links_to_entry(iter, iter->head->links.next);
+    } else {
+        /* Finished iteration */
+        iter->next_entry = NULL;
+    }
+
     if (iter->next_entry != NULL) {
-        list_remove(&iter->entry_links);
+        list_push(&iter->next_entry->iterators, &iter->next_ref.links);
+    }
+}
+
+static ft_iterator_pending_t *
+ft_iterator_pending_find(ft_iterator_t *iter, ft_entry_t *entry)
+{
+    list_links_t *cur;
+
+    LIST_FOREACH(&entry->iterators, cur) {
+        ft_iterator_ref_t *ref = container_of(cur, links, ft_iterator_ref_t);
+        if (ref->iter == iter && ref != &iter->next_ref) {
+            return container_of(ref, ref, ft_iterator_pending_t);
+        }
     }
 
-    while (iter->next_entry != NULL) {
-        ft_entry_t *entry = iter->next_entry;
+    return NULL;
+}
 
-        list_links_t *next_links = ft_iterator_entry_to_links(iter, iter->next_entry)->next;
-        if (next_links == &iter->head->links) {
-            /* Finished iteration */
-            iter->next_entry = NULL;
-        } else {
-            iter->next_entry = ft_iterator_links_to_entry(iter, next_links);
+static void
+ft_iterator_pending_free(ft_iterator_pending_t *pending)
+{
+    if (pending->ref.iter->held == pending) {
+        pending->ref.iter->held = NULL;
+    }
+    list_remove(&pending->ref.links);
+    list_remove(&pending->links);
+    INDIGO_MEM_FREE(pending);
+}
+
+ft_entry_t *
+ft_iterator_next(ft_iterator_t *iter)
+{
+    ft_iterator_pending_t *pending;
+    ft_entry_t *entry;
+
+    if ((pending = iter->held) != NULL) {
+        entry = pending->entry;
+        ft_iterator_pending_free(pending);
+        if (!iter->use_query || ft_entry_meta_match(&iter->query, entry)) {
+            return entry;
         }
+    }
+
+    while ((entry = iter->next_entry) != NULL) {
+        ft_iterator_step(iter);
 
         if (iter->use_query && !ft_entry_meta_match(&iter->query, entry)) {
             continue;
         }
 
-        if (iter->next_entry != NULL) {
-            list_push(&iter->next_entry->iterators, &iter->entry_links);
+        /* It moved ahead of the iterator and is returned here instead */
+        if (!list_empty(&iter->pending) &&
+                (pending = ft_iterator_pending_find(iter, entry)) != NULL) {
+            ft_iterator_pending_free(pending);
+        }
+
+        return entry;
+    }
+
+    /* Then the entries that moved off the walked lists */
+    while (!list_empty(&iter->pending)) {
+        pending = container_of(iter->pending.links.next, links,
+                               ft_iterator_pending_t);
+        entry = pending->entry;
+        ft_iterator_pending_free(pending);
+
+        if (iter->use_query && !ft_entry_meta_match(&iter->query, entry)) {
+            continue;
         }
 
         return entry;
@@ -513,46 +2412,185 @@ ft_iterator_next(ft_iterator_t *iter)
     return NULL;
 }
 
+/*
+ * Step the iterators whose next entry is about to leave the lists they
+ * walk: mask group iterators if by_group, output port iterators if
+ * by_out_port, cookie group and cookie bucket iterators if by_cookie.
+ * The entry is not counted as visited; each such iterator keeps it
+ * pending and returns it later.
+ */
+static void
+ft_iterator_skip_entry(ft_entry_t *entry, bool by_group, bool by_out_port,
+                       bool by_cookie)
+{
+    list_links_t *cur, *next;
+
+    LIST_FOREACH_SAFE(&entry->iterators, cur, next) {
+        ft_iterator_ref_t *ref = container_of(cur, links, ft_iterator_ref_t);
+        ft_iterator_t *iter = ref->iter;
+        ft_iterator_pending_t *pending;
+
+        if (ref != &iter->next_ref) {
+            continue;
+        }
+
+        if ((by_group && iter->group != NULL) ||
+                (by_out_port && iter->out_port != NULL) ||
+                (by_cookie && iter->out_port == NULL &&
+                 (iter->links_offset == offsetof(ft_entry_t, cookie_group_links) ||
+                  iter->links_offset == offsetof(ft_entry_t, cookie_links)))) {
+            ft_iterator_step(iter);
+
+            if (ft_iterator_pending_find(iter, entry) != NULL) {
+                continue;
+            }
+
+            pending = INDIGO_MEM_ALLOC(sizeof(*pending));
+            if (pending == NULL) {
+                LOG_ERROR("Failed to keep flow " INDIGO_FLOW_ID_PRINTF_FORMAT
+                          " for an iterator", entry->id);
+                continue;
+            }
+            pending->ref.iter = iter;
+            pending->entry = entry;
+            list_push(&entry->iterators, &pending->ref.links);
+            list_push(&iter->pending, &pending->links);
+        }
+    }
+}
+
+indigo_error_t
+ft_iterator_hold(ft_iterator_t *iter, ft_entry_t *entry)
+{
+    ft_iterator_pending_t *pending;
+
+    INDIGO_ASSERT(iter->held == NULL);
+
+    /* Pending already; it only has to come first */
+    if ((pending = ft_iterator_pending_find(iter, entry)) == NULL) {
+        pending = INDIGO_MEM_ALLOC(sizeof(*pending));
+        if (pending == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+        pending->ref.iter = iter;
+        pending->entry = entry;
+        list_push(&entry->iterators, &pending->ref.links);
+        list_push(&iter->pending, &pending->links);
+    }
+
+    iter->held = pending;
+
+    return INDIGO_ERROR_NONE;
+}
+
 void
 ft_iterator_cleanup(ft_iterator_t *iter)
 {
     if (iter->next_entry != NULL) {
-        list_remove(&iter->entry_links);
+        list_remove(&iter->next_ref.links);
         iter->next_entry = NULL;
     }
+
+    while (!list_empty(&iter->pending)) {
+        ft_iterator_pending_free(container_of(iter->pending.links.next, links,
+                                              ft_iterator_pending_t));
+    }
 }
 
 /**
  * Link an entry into the appropriate lists for the FT
  */
 
-static void
+static indigo_error_t
 ft_entry_link(ft_instance_t ft, ft_entry_t *entry)
 {
+    ft_cookie_group_t *cookie_group;
+    ft_mask_group_t *group;
+    ft_overlap_group_t *overlap_group;
+    ft_match_key_t key;
+    of_match_t match;
     int idx;
 
     if (ft == NULL || entry == NULL) {
         INDIGO_ASSERT(!"ft_entry_link called with NULL ft or entry");
-        return;
+        return INDIGO_ERROR_PARAM;
+    }
+
+    /*
+     * Cookie, mask and overlap groups, port and group lists; the only
+     * steps that can fail, so do them first
+     */
+    if (ft_evict_heap_reserve(&ft->tables[entry->table_id]) < 0) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    cookie_group = ft_cookie_group_get(ft, entry->cookie);
+    if (cookie_group == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    ft_entry_match_get(entry, &match);
+    group = ft_mask_group_get(ft, entry->table_id, &match.masks);
+    if (group == NULL) {
+        ft_cookie_group_put(ft, cookie_group);
+        return INDIGO_ERROR_RESOURCE;
     }
+    overlap_group = ft_overlap_group_get(ft, entry->table_id, entry->priority,
+                                         &match.masks);
+    if (overlap_group == NULL) {
+        ft_mask_group_put(ft, group);
+        ft_cookie_group_put(ft, cookie_group);
+        return INDIGO_ERROR_RESOURCE;
+    }
+    if (ft_out_ports_get(ft, entry->out_port_refs,
+                         entry->out_port_count) < 0) {
+        ft_overlap_group_put(overlap_group);
+        ft_mask_group_put(ft, group);
+        ft_cookie_group_put(ft, cookie_group);
+        return INDIGO_ERROR_RESOURCE;
+    }
+    if (ft_out_groups_get(ft, entry->out_group_refs,
+                          entry->out_group_count) < 0) {
+        for (idx = 0; idx < entry->out_port_count; idx++) {
+            ft_out_port_put(entry->out_port_refs[idx].out_port);
+            entry->out_port_refs[idx].out_port = NULL;
+        }
+        ft_overlap_group_put(overlap_group);
+        ft_mask_group_put(ft, group);
+        ft_cookie_group_put(ft, cookie_group);
+        return INDIGO_ERROR_RESOURCE;
+    }
+    ft_mask_group_link(group, entry);
+    ft_overlap_link(ft, overlap_group, entry);
+    ft_out_ports_link(entry, entry->out_port_refs, entry->out_port_count);
+    ft_out_groups_link(entry, entry->out_group_refs, entry->out_group_count);
+
+    entry->cookie_group = cookie_group;
+    list_push(&cookie_group->entries, &entry->cookie_group_links);
+    ft_entry_aggregates_add(ft, entry, 1, entry->cold->packets,
+                            entry->cold->bytes);
 
     /* Link to full table iteration */
     list_push(&ft->all_list, &entry->table_links);
 
-    if (ft->strict_match_buckets) { /* Strict match hash */
-        idx = ft_strict_match_to_bucket_index(ft, &entry->match, entry->priority);
-        list_push(&ft->strict_match_buckets[idx], &entry->strict_match_links);
-    }
-    if (ft->flow_id_buckets) { /* Flow ID hash */
-        idx = ft_flow_id_to_bucket_index(ft, &entry->id);
-        list_push(&ft->flow_id_buckets[idx], &entry->flow_id_links);
-    }
+    /* Strict match hash */
+    ft_entry_match_key(entry, &key);
+    entry->strict_match_hash = ft_strict_match_hash(&key, entry->priority);
+    ft_index_insert(&ft->strict_match_index, entry);
+
+    /* Flow ID hash */
+    ft_index_insert(&ft->flow_id_index, entry);
     if (ft->cookie_buckets) { /* Cookie prefix */
         idx = ft_cookie_to_bucket_index(ft, entry->cookie);
         list_push(&ft->cookie_buckets[idx], &entry->cookie_links);
     }
 
+    /* Timeouts; a new entry is treated as active for its first idle check */
+    ft_expire_reschedule(ft, entry, entry->insert_time, true);
+
+    ft_evict_heap_insert(&ft->tables[entry->table_id], entry);
+
     list_init(&entry->iterators);
+
+    return INDIGO_ERROR_NONE;
 }
 
 /**
@@ -569,30 +2607,37 @@ ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry)
 
     INDIGO_ASSERT(!list_empty(&ft->all_list));
 
-    /* Advance iterators pointing to this entry */
+    /* Advance iterators pointing to this entry, and forget it as pending */
     list_links_t *cur, *next;
     LIST_FOREACH_SAFE(&entry->iterators, cur, next) {
-        ft_iterator_next(container_of(cur, entry_links, ft_iterator_t));
+        ft_iterator_ref_t *ref = container_of(cur, links, ft_iterator_ref_t);
+        if (ref == &ref->iter->next_ref) {
+            ft_iterator_step(ref->iter);
+        } else {
+            ft_iterator_pending_free(container_of(ref, ref, ft_iterator_pending_t));
+        }
     }
 
     /* Remove from full table iteration */
     list_remove(&entry->table_links);
 
-    if (ft->strict_match_buckets) { /* Strict match hash */
-        INDIGO_ASSERT(!list_empty(&ft->strict_match_buckets[
-            ft_strict_match_to_bucket_index(ft, &entry->match, entry->priority)]));
-        list_remove(&entry->strict_match_links);
-    }
-    if (ft->flow_id_buckets) { /* Flow ID hash */
-        INDIGO_ASSERT(!list_empty(&ft->flow_id_buckets[ft_flow_id_to_bucket_index(ft,
-            &entry->id)]));
-        list_remove(&entry->flow_id_links);
-    }
+    /* Strict match and flow ID hashes */
+    list_remove(&entry->strict_match_links);
+    list_remove(&entry->flow_id_links);
     if (ft->cookie_buckets) { /* Cookie prefix */
         INDIGO_ASSERT(!list_empty(&ft->cookie_buckets[ft_cookie_to_bucket_index(ft,
             entry->cookie)]));
         list_remove(&entry->cookie_links);
     }
+
+    ft_mask_group_unlink(ft, entry);
+    ft_overlap_unlink(ft, entry);
+    ft_out_ports_unlink(entry);
+    ft_out_groups_unlink(ft, entry);
+    ft_entry_aggregates_unlink(ft, entry);
+
+    ft_expire_unlink(entry);
+    ft_evict_heap_remove(&ft->tables[entry->table_id], entry);
 }
 
 /**
@@ -605,32 +2650,51 @@ ft_entry_unlink(ft_instance_t ft, ft_entry_t *entry)
  * The list links are not modified by this call.
  */
 static indigo_error_t
-ft_entry_create(indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry_p)
+ft_entry_create(ft_instance_t ft, indigo_flow_id_t id, of_flow_add_t *flow_add,
+                ft_entry_t **entry_p)
 {
     indigo_error_t err;
     ft_entry_t *entry;
+    ft_entry_cold_t *cold;
+    of_match_t match;
+    ft_match_key_t key;
+
+    if (of_flow_add_match_get(flow_add, &match) < 0) {
+        return INDIGO_ERROR_UNKNOWN;
+    }
+    ft_match_key_init(&key, &match);
 
-    entry = INDIGO_MEM_ALLOC(sizeof(*entry));
+    entry = ft_slab_alloc(&ft->entry_slab);
     if (entry == NULL) {
         return INDIGO_ERROR_RESOURCE;
     }
+    cold = ft_slab_alloc(ft_cold_slab(ft, key.count));
+    if (cold == NULL) {
+        ft_slab_free(&ft->entry_slab, entry);
+        return INDIGO_ERROR_RESOURCE;
+    }
     INDIGO_MEM_SET(entry, 0, sizeof(*entry));
+    INDIGO_MEM_SET(cold, 0, sizeof(*cold));
 
     entry->id = id;
-
-    if (of_flow_add_match_get(flow_add, &entry->match) < 0) {
-        INDIGO_MEM_FREE(entry);
-        return INDIGO_ERROR_UNKNOWN;
-    }
+    entry->evict_idx = -1;
+    entry->cold = cold;
+    entry->match_present = key.present;
+    INDIGO_MEM_COPY(cold->match_words, key.words,
+                    key.count * sizeof(key.words[0]));
     of_flow_add_cookie_get(flow_add, &entry->cookie);
     of_flow_add_priority_get(flow_add, &entry->priority);
     of_flow_add_flags_get(flow_add, &entry->flags);
     of_flow_add_idle_timeout_get(flow_add, &entry->idle_timeout);
     of_flow_add_hard_timeout_get(flow_add, &entry->hard_timeout);
+    if (flow_add->version >= OF_VERSION_1_1) {
+        of_flow_add_table_id_get(flow_add, &entry->table_id);
+    }
 
-    err = ft_entry_set_effects(entry, flow_add);
+    err = ft_entry_set_effects(ft, entry, flow_add, false);
     if (err != INDIGO_ERROR_NONE) {
-        INDIGO_MEM_FREE(entry);
+        ft_slab_free(ft_cold_slab(ft, key.count), cold);
+        ft_slab_free(&ft->entry_slab, entry);
         return err;
     }
 
@@ -652,62 +2716,103 @@ ft_entry_create(indigo_flow_id_t id, of_flow_add_t *flow_add, ft_entry_t **entry
 static void
 ft_entry_destroy(ft_instance_t ft, ft_entry_t *entry)
 {
-    if (entry->effects.actions != NULL) {
-        of_list_action_delete(entry->effects.actions);
-        entry->effects.actions = NULL;
+    ft_entry_cold_t *cold = entry->cold;
+
+    if (cold->shared_effects != NULL) {
+        ft_effects_put(ft, cold->shared_effects);
+        cold->shared_effects = NULL;
+        cold->effects.actions = NULL;
     }
 
-    INDIGO_MEM_FREE(entry);
+    INDIGO_MEM_FREE(entry->out_port_refs);
+    INDIGO_MEM_FREE(entry->out_group_refs);
+    ft_slab_free(ft_cold_slab(ft, ft_match_word_count(entry->match_present)),
+                 cold);
+    entry->cold = NULL;
+    ft_slab_free(&ft->entry_slab, entry);
 }
 
-/* Populate the output port list and effects */
+/* Add port to the refs array unless already present */
 static indigo_error_t
-ft_entry_set_effects(ft_entry_t *entry,
-                    of_flow_modify_t *flow_mod)
-{
-    if (flow_mod->version == OF_VERSION_1_0)
-    {
-        of_list_action_t *actions;
-        if ((actions = of_flow_modify_actions_get(flow_mod)) == NULL) {
-            LOG_ERROR("Could not get action list");
-            return INDIGO_ERROR_RESOURCE;
+out_ports_add(of_port_no_t port, ft_out_port_ref_t **refs, int *count)
+{
+    ft_out_port_ref_t *new_refs;
+    int idx;
+
+    for (idx = 0; idx < *count; idx++) {
+        if ((*refs)[idx].port == port) {
+            return INDIGO_ERROR_NONE;
         }
-        of_list_action_delete(entry->effects.actions);
-        entry->effects.actions = actions;
-    } else {
-        of_list_instruction_t *instructions;
-        if ((instructions = of_flow_modify_instructions_get(flow_mod)) == NULL) {
-            LOG_ERROR("Could not get instruction list");
-            return INDIGO_ERROR_RESOURCE;
+    }
+
+    new_refs = INDIGO_MEM_REALLOC(*refs, sizeof(**refs) * (*count + 1));
+    if (new_refs == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    INDIGO_MEM_SET(&new_refs[*count], 0, sizeof(**refs));
+    new_refs[*count].port = port;
+    *refs = new_refs;
+    *count += 1;
+
+    return INDIGO_ERROR_NONE;
+}
+
+/* Add group_id to the refs array unless already present */
+static indigo_error_t
+out_groups_add(uint32_t group_id, ft_out_group_ref_t **refs, int *count)
+{
+    ft_out_group_ref_t *new_refs;
+    int idx;
+
+    for (idx = 0; idx < *count; idx++) {
+        if ((*refs)[idx].group_id == group_id) {
+            return INDIGO_ERROR_NONE;
         }
-        of_list_instruction_delete(entry->effects.instructions);
-        entry->effects.instructions = instructions;
     }
 
+    new_refs = INDIGO_MEM_REALLOC(*refs, sizeof(**refs) * (*count + 1));
+    if (new_refs == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    INDIGO_MEM_SET(&new_refs[*count], 0, sizeof(**refs));
+    new_refs[*count].group_id = group_id;
+    *refs = new_refs;
+    *count += 1;
+
     return INDIGO_ERROR_NONE;
 }
 
-static int
-action_list_has_out_port(of_list_action_t *actions, of_port_no_t port)
+/* Collect the output ports and groups of an action list into effects */
+static indigo_error_t
+action_list_refs(of_list_action_t *actions, ft_effects_t *effects)
 {
     of_action_t act;
     int loop_rv;
     of_port_no_t out_port;
+    uint32_t group_id;
 
     OF_LIST_ACTION_ITER(actions, &act, loop_rv) {
         if (act.header.object_id == OF_ACTION_OUTPUT) {
             of_action_output_port_get(&act.output, &out_port);
-            if (out_port == port) {
-                return 1;
+            if (out_ports_add(out_port, &effects->out_port_refs,
+                              &effects->out_port_count) < 0) {
+                return INDIGO_ERROR_RESOURCE;
+            }
+        } else if (act.header.object_id == OF_ACTION_GROUP) {
+            of_action_group_group_id_get(&act.group, &group_id);
+            if (out_groups_add(group_id, &effects->out_group_refs,
+                               &effects->out_group_count) < 0) {
+                return INDIGO_ERROR_RESOURCE;
             }
         }
     }
 
-    return 0;
+    return INDIGO_ERROR_NONE;
 }
 
-static int
-instruction_list_has_out_port(of_list_instruction_t *instructions, of_port_no_t port)
+static indigo_error_t
+instruction_list_refs(of_list_instruction_t *instructions,
+                      ft_effects_t *effects)
 {
     of_instruction_t inst;
     int loop_rv;
@@ -716,19 +2821,206 @@ instruction_list_has_out_port(of_list_instruction_t *instructions, of_port_no_t
         if (inst.header.object_id == OF_INSTRUCTION_APPLY_ACTIONS) {
             of_list_action_t actions;
             of_instruction_apply_actions_actions_bind(&inst.apply_actions, &actions);
-            if (action_list_has_out_port(&actions, port)) {
-                return 1;
+            if (action_list_refs(&actions, effects) < 0) {
+                return INDIGO_ERROR_RESOURCE;
             }
         } else if (inst.header.object_id == OF_INSTRUCTION_WRITE_ACTIONS) {
             of_list_action_t actions;
             of_instruction_write_actions_actions_bind(&inst.write_actions, &actions);
-            if (action_list_has_out_port(&actions, port)) {
-                return 1;
+            if (action_list_refs(&actions, effects) < 0) {
+                return INDIGO_ERROR_RESOURCE;
+            }
+        }
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/****************************************************************
+ * Shared effects
+ ****************************************************************/
+
+static int
+ft_effects_equal(ft_effects_t *effects, of_object_t *list)
+{
+    of_object_t *shared = effects->list.actions;
+
+    return shared->version == list->version &&
+        shared->length == list->length &&
+        memcmp(OF_OBJECT_BUFFER_INDEX(shared, 0),
+               OF_OBJECT_BUFFER_INDEX(list, 0), list->length) == 0;
+}
+
+/*
+ * Find or create the shared effects for the actions (OF 1.0) or
+ * instructions of a flow mod. Returns a new reference, or NULL on
+ * allocation failure.
+ */
+static ft_effects_t *
+ft_effects_get(ft_instance_t ft, of_flow_modify_t *flow_mod)
+{
+    of_object_t list;
+    ft_effects_t *effects;
+    list_head_t *buckets[2];
+    list_links_t *cur;
+    indigo_error_t err;
+    uint32_t h;
+    int i, n;
+
+    if (flow_mod->version == OF_VERSION_1_0) {
+        of_flow_modify_actions_bind(flow_mod, &list);
+    } else {
+        of_flow_modify_instructions_bind(flow_mod, &list);
+    }
+
+    h = murmur_hash(OF_OBJECT_BUFFER_INDEX(&list, 0), list.length,
+                    FT_HASH_SEED + list.version);
+
+    n = ft_index_lookup_buckets(&ft->effects_index, h, buckets);
+    for (i = 0; i < n; i++) {
+        LIST_FOREACH(buckets[i], cur) {
+            effects = container_of(cur, hash_links, ft_effects_t);
+            if (effects->hash == h && ft_effects_equal(effects, &list)) {
+                effects->refcount++;
+                ft->status.effects_shares += 1;
+                return effects;
+            }
+        }
+    }
+
+    effects = INDIGO_MEM_ALLOC(sizeof(*effects));
+    if (effects == NULL) {
+        return NULL;
+    }
+    INDIGO_MEM_SET(effects, 0, sizeof(*effects));
+    effects->hash = h;
+    effects->refcount = 1;
+
+    if ((effects->list.actions = of_object_dup(&list)) == NULL) {
+        INDIGO_MEM_FREE(effects);
+        return NULL;
+    }
+
+    if (list.version == OF_VERSION_1_0) {
+        err = action_list_refs(effects->list.actions, effects);
+    } else {
+        err = instruction_list_refs(effects->list.instructions, effects);
+    }
+    if (err != INDIGO_ERROR_NONE) {
+        of_object_delete(effects->list.actions);
+        INDIGO_MEM_FREE(effects->out_port_refs);
+        INDIGO_MEM_FREE(effects->out_group_refs);
+        INDIGO_MEM_FREE(effects);
+        return NULL;
+    }
+
+    ft_index_insert(&ft->effects_index, effects);
+    ft->effects_count++;
+    ft_index_maintain(&ft->effects_index, ft->effects_count);
+
+    return effects;
+}
+
+/* Drop a reference, freeing the effects with the last one */
+static void
+ft_effects_put(ft_instance_t ft, ft_effects_t *effects)
+{
+    if (--effects->refcount == 0) {
+        list_remove(&effects->hash_links);
+        of_object_delete(effects->list.actions);
+        INDIGO_MEM_FREE(effects->out_port_refs);
+        INDIGO_MEM_FREE(effects->out_group_refs);
+        INDIGO_MEM_FREE(effects);
+        ft->effects_count--;
+        ft_index_maintain(&ft->effects_index, ft->effects_count);
+    }
+}
+
+/*
+ * Point the entry at the shared effects of flow_mod and copy their output
+ * ports and groups. If the entry is linked, its references move as well.
+ */
+static indigo_error_t
+ft_entry_set_effects(ft_instance_t ft, ft_entry_t *entry,
+                     of_flow_modify_t *flow_mod, bool linked)
+{
+    ft_effects_t *effects;
+    ft_out_port_ref_t *refs = NULL;
+    ft_out_group_ref_t *group_refs = NULL;
+    int count, group_count;
+    int idx;
+    indigo_error_t err = INDIGO_ERROR_NONE;
+
+    if ((effects = ft_effects_get(ft, flow_mod)) == NULL) {
+        LOG_ERROR("Could not get effects");
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    count = effects->out_port_count;
+    if (count > 0) {
+        refs = INDIGO_MEM_ALLOC(sizeof(*refs) * count);
+        if (refs == NULL) {
+            err = INDIGO_ERROR_RESOURCE;
+        } else {
+            INDIGO_MEM_COPY(refs, effects->out_port_refs,
+                            sizeof(*refs) * count);
+        }
+    }
+
+    group_count = effects->out_group_count;
+    if (err == INDIGO_ERROR_NONE && group_count > 0) {
+        group_refs = INDIGO_MEM_ALLOC(sizeof(*group_refs) * group_count);
+        if (group_refs == NULL) {
+            err = INDIGO_ERROR_RESOURCE;
+        } else {
+            INDIGO_MEM_COPY(group_refs, effects->out_group_refs,
+                            sizeof(*group_refs) * group_count);
+        }
+    }
+
+    /* Entries in the table move to the new port and group lists */
+    if (err == INDIGO_ERROR_NONE && linked) {
+        err = ft_out_ports_get(ft, refs, count);
+        if (err == INDIGO_ERROR_NONE) {
+            err = ft_out_groups_get(ft, group_refs, group_count);
+            if (err != INDIGO_ERROR_NONE) {
+                for (idx = 0; idx < count; idx++) {
+                    ft_out_port_put(refs[idx].out_port);
+                }
             }
         }
     }
 
-    return 0;
+    if (err != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Could not index output ports and groups");
+        INDIGO_MEM_FREE(refs);
+        INDIGO_MEM_FREE(group_refs);
+        ft_effects_put(ft, effects);
+        return err;
+    }
+
+    if (linked) {
+        ft_iterator_skip_entry(entry, false, true, false);
+        ft_out_ports_link(entry, refs, count);
+        ft_out_ports_unlink(entry);
+        ft_out_groups_link(entry, group_refs, group_count);
+        ft_out_groups_unlink(ft, entry);
+    }
+    INDIGO_MEM_FREE(entry->out_port_refs);
+    entry->out_port_refs = refs;
+    entry->out_port_count = count;
+    INDIGO_MEM_FREE(entry->out_group_refs);
+    entry->out_group_refs = group_refs;
+    entry->out_group_count = group_count;
+
+    /* Taken before the old reference is dropped, so equal effects stay */
+    if (entry->cold->shared_effects != NULL) {
+        ft_effects_put(ft, entry->cold->shared_effects);
+    }
+    entry->cold->shared_effects = effects;
+    entry->cold->effects.actions = effects->list.actions;
+
+    return INDIGO_ERROR_NONE;
 }
 
 /**
@@ -737,11 +3029,5 @@ instruction_list_has_out_port(of_list_instruction_t *instructions, of_port_no_t
 static int
 ft_entry_has_out_port(ft_entry_t *entry, of_port_no_t port)
 {
-    if (entry->effects.actions->version == OF_VERSION_1_0) {
-        return action_list_has_out_port(entry->effects.actions, port);
-    } else {
-        return instruction_list_has_out_port(entry->effects.instructions, port);
-    }
-
-    return 0;
+    return ft_entry_out_port_ref(entry, port) != NULL;
 }
@@ -55,6 +55,7 @@
 #include <stdbool.h>
 
 #include "ft_entry.h"
+#include "ft_slab.h"
 
 /**
  * Length of the prefix used for bucketing flows by cookie.
@@ -62,6 +63,66 @@
 #define FT_COOKIE_PREFIX_LEN 8
 #define FT_COOKIE_PREFIX_MASK (~(uint64_t)0 << (64-FT_COOKIE_PREFIX_LEN))
 
+/**
+ * Expiration timing wheel geometry. Entries with timeouts are kept in the
+ * slot for their next deadline; deadlines further out than one rotation
+ * share a slot with nearer ones and are skipped until due.
+ */
+#define FT_EXPIRE_WHEEL_SLOTS 4096
+#define FT_EXPIRE_SLOT_MS 100
+
+/**
+ * Number of idle checks per idle timeout while a flow's counters keep
+ * changing. This bounds how late an idle timeout can fire.
+ */
+#define FT_IDLE_CHECKS_PER_TIMEOUT 4
+
+/**
+ * Hash index sizing. Indexes start at the configured bucket count (at
+ * least FT_INDEX_BUCKETS_MIN), double when the average chain length
+ * exceeds one and halve when it drops below one quarter.
+ *
+ * A resize allocates the new bucket array and then migrates old buckets
+ * on each following add or delete, doing at most FT_INDEX_REHASH_WORK
+ * units of work (buckets visited plus entries moved) per operation.
+ */
+#define FT_INDEX_BUCKETS_MIN 64
+#define FT_INDEX_REHASH_WORK 32
+
+/**
+ * Number of buckets in a chain length histogram; the last one counts
+ * chains of FT_INDEX_CHAIN_HIST_SIZE-1 or more entries.
+ */
+#define FT_INDEX_CHAIN_HIST_SIZE 8
+
+/**
+ * Number of hash buckets used to find the mask group for a new entry.
+ */
+#define FT_MASK_GROUP_BUCKETS 256
+
+/**
+ * Number of hash buckets for the (table_id, priority) overlap partitions.
+ */
+#define FT_OVERLAP_PART_BUCKETS 1024
+
+/**
+ * Number of hash buckets for the output port index.
+ */
+#define FT_OUT_PORT_BUCKETS 256
+
+/**
+ * Number of table IDs
+ */
+#define FT_TABLE_COUNT 256
+
+/**
+ * Cold entry records are allocated from one slab per FT_COLD_SLAB_WORDS
+ * match words.
+ */
+#define FT_COLD_SLAB_WORDS 2
+#define FT_COLD_SLAB_CLASSES \
+    ((FT_MATCH_KEY_WORDS + FT_COLD_SLAB_WORDS - 1) / FT_COLD_SLAB_WORDS + 1)
+
 /**
  * Forward declaration of flowtable handle for other typedefs
  */
@@ -80,9 +141,11 @@ typedef ft_public_t *ft_instance_t;
 
 /**
  * Flow table configuration structure
- * @param max_entries Maximum number of entries to support
- * @param strict_match_bucket_count How many buckets for strict_match hash table
- * @param flow_id_bucket_count How many buckets for flow_id hash table
+ * @param strict_match_bucket_count Initial buckets for strict_match hash table
+ * @param flow_id_bucket_count Initial buckets for flow_id hash table
+ *
+ * Bucket counts are rounded up to a power of two; 0 selects the minimum.
+ * The indexes resize themselves as the number of entries changes.
  */
 
 typedef struct ft_config_s {
@@ -99,12 +162,19 @@ typedef struct ft_config_s {
  * @param deletes Number of delete operation called
  * @param hard_expires Number of hard timeouts
  * @param idle_expires Number of idle timeouts
+ * @param audit_expires Number of the hard and idle timeouts found by the
+ * expiry audit rather than reported by forwarding
  * @param updates Number of calls that modified a flow entry including
  * effects_modify and clear_counters.
+ * @param overwrites Number of adds that replaced an existing entry in place
+ * @param effects_shares Number of times effects were found already interned
+ * @param evictions Number of entries removed to make room for an add
  * @param table_full_errors Number of adds that failed due to no space
  * in the table.
  * @param forwarding_add_errors Number of adds that failed due to a
  * failure in the forwarding layer.
+ * @param overlap_checks Number of ft_overlap_find calls
+ * @param overlap_visits Number of entries compared by ft_overlap_find
  */
 
 typedef struct ft_status_s {
@@ -113,11 +183,212 @@ typedef struct ft_status_s {
     uint64_t deletes;
     uint64_t hard_expires;
     uint64_t idle_expires;
+    uint64_t audit_expires;
     uint64_t updates;
+    uint64_t overwrites;
+    uint64_t effects_shares;
+    uint64_t evictions;
     uint64_t table_full_errors;
     uint64_t forwarding_add_errors;
+    uint64_t overlap_checks;
+    uint64_t overlap_visits;
 } ft_status_t;
 
+/**
+ * A resizable hash index over flow table entries, cookie groups or
+ * shared effects
+ *
+ * Objects are chained through the list links at links_offset. While a
+ * resize is in progress, old_buckets is non-NULL and objects from old
+ * buckets before migrate_idx have been moved to buckets; lookups check
+ * both arrays.
+ */
+typedef struct ft_index_s {
+    list_head_t *buckets;          /* Current bucket array */
+    int bucket_count;              /* Power of two */
+    list_head_t *old_buckets;      /* Bucket array being migrated, or NULL */
+    int old_bucket_count;
+    int migrate_idx;               /* Next old bucket to migrate */
+    int links_offset;              /* Offset of list links in the object */
+    uint32_t (*hash)(void *obj);
+    uint64_t grows;                /* Number of resizes started */
+    uint64_t shrinks;
+} ft_index_t;
+
+/**
+ * A group of entries sharing a table ID and match masks
+ *
+ * Whether an entry can satisfy a non-strict query depends first on its
+ * masks being at least as specific as the query's and on its table ID.
+ * Both are the same for every entry in a group, so queries skip whole
+ * groups that cannot match.
+ *
+ * A group is freed when its last entry is removed.
+ */
+typedef struct ft_mask_group_s {
+    list_links_t links;            /* In ft->mask_groups */
+    list_links_t hash_links;       /* In ft->mask_group_buckets */
+    uint32_t hash;                 /* Hash of table_id and masks */
+    uint8_t table_id;
+    of_match_fields_t masks;
+    list_head_t entries;           /* Entries, through mask_group_links */
+    int entry_count;
+} ft_mask_group_t;
+
+/**
+ * Overlap index
+ *
+ * Two entries can only overlap if they share a table and priority, so
+ * entries are partitioned by (table_id, priority). Within a partition,
+ * entries with the same masks form an overlap group.
+ *
+ * For a group whose masks are covered by the query's, an entry overlaps
+ * exactly when its masked values equal the query's values under the
+ * group masks. Those candidates are found through the overlap hash index
+ * keyed on table_id, priority, masks and masked values; other groups are
+ * scanned.
+ */
+typedef struct ft_overlap_part_s {
+    list_links_t links;            /* In ft->overlap_part_buckets */
+    uint8_t table_id;
+    uint16_t priority;
+    list_head_t groups;            /* ft_overlap_group_t list */
+} ft_overlap_part_t;
+
+typedef struct ft_overlap_group_s {
+    list_links_t links;            /* In part->groups */
+    ft_overlap_part_t *part;
+    of_match_fields_t masks;
+    list_head_t entries;           /* Entries, through overlap_group_links */
+    int entry_count;
+} ft_overlap_group_t;
+
+/**
+ * Output port index
+ *
+ * The output ports of an entry's apply/write actions are extracted when
+ * its effects are set. Each entry has one reference per distinct port,
+ * linked into the list for that port, so queries naming an out_port only
+ * visit the entries that output to it.
+ *
+ * A port list is freed when its last reference is removed.
+ */
+typedef struct ft_out_port_s {
+    list_links_t hash_links;       /* In ft->out_port_buckets */
+    of_port_no_t port;
+    list_head_t refs;              /* ft_out_port_ref_t list */
+    int entry_count;
+} ft_out_port_t;
+
+typedef struct ft_out_port_ref_s {
+    list_links_t links;            /* In out_port->refs */
+    ft_entry_t *entry;
+    ft_out_port_t *out_port;       /* NULL until linked */
+    of_port_no_t port;
+} ft_out_port_ref_t;
+
+/**
+ * Output group index
+ *
+ * Like the output port index, for the groups named by group actions in an
+ * entry's apply/write actions, so the flows forwarding to a group are
+ * found without a table scan when it is deleted. Group lists are kept in
+ * ft->out_group_index by group ID and freed with their last reference.
+ */
+typedef struct ft_out_group_s {
+    list_links_t hash_links;       /* In ft->out_group_index */
+    uint32_t group_id;
+    list_head_t refs;              /* ft_out_group_ref_t list */
+    int entry_count;
+} ft_out_group_t;
+
+typedef struct ft_out_group_ref_s {
+    list_links_t links;            /* In out_group->refs */
+    ft_entry_t *entry;
+    ft_out_group_t *out_group;     /* NULL until linked */
+    uint32_t group_id;
+} ft_out_group_ref_t;
+
+/**
+ * Shared effects
+ *
+ * Many flows have the same actions or instructions. Each distinct list
+ * is kept once, keyed by version and wire bytes and found through
+ * ft->effects_index, and entries hold a reference to it. The output
+ * ports and groups of the list are extracted once too; entries copy
+ * out_port_refs and out_group_refs before linking them.
+ *
+ * The list must not be modified while shared. It is freed with its last
+ * reference.
+ */
+typedef struct ft_effects_s {
+    list_links_t hash_links;       /* In ft->effects_index */
+    uint32_t hash;                 /* Hash of version and wire bytes */
+    int refcount;
+    union {
+        of_list_action_t *actions;
+        of_list_instruction_t *instructions;
+    } list;
+    ft_out_port_ref_t *out_port_refs;  /* Ports only; never linked */
+    int out_port_count;
+    ft_out_group_ref_t *out_group_refs;  /* Groups only; never linked */
+    int out_group_count;
+} ft_effects_t;
+
+/**
+ * Running flow, packet and byte counts
+ *
+ * The flow table keeps these for the whole table, per table ID and per
+ * cookie, summed from each entry's packets and bytes as entries are
+ * added and removed and as their counters are set. Aggregate queries of
+ * those shapes are answered without visiting any entry; see
+ * ft_aggregate_get. The totals are only as fresh as the entry counters.
+ */
+typedef struct ft_aggregate_s {
+    uint32_t flow_count;
+    uint64_t packets;
+    uint64_t bytes;
+} ft_aggregate_t;
+
+/**
+ * The entries with one cookie, and their aggregate
+ *
+ * Groups are found through ft->cookie_index by the full 64-bit cookie,
+ * so queries for an exact cookie visit only its entries. A group is
+ * freed when its last entry is removed.
+ */
+typedef struct ft_cookie_group_s {
+    list_links_t hash_links;       /* In ft->cookie_index */
+    uint64_t cookie;
+    list_head_t entries;           /* Entries with this cookie */
+    ft_aggregate_t aggregate;
+} ft_cookie_group_t;
+
+/**
+ * How to choose a flow to evict from a full table
+ */
+typedef enum ft_eviction_e {
+    FT_EVICTION_NONE = 0,          /* Reject adds to a full table */
+    FT_EVICTION_LRU,               /* Least recently matched */
+    FT_EVICTION_PRIORITY,          /* Lowest priority, then oldest */
+    FT_EVICTION_EXPIRE,            /* Soonest to time out; never last */
+} ft_eviction_t;
+
+/**
+ * Per table limits and eviction state
+ *
+ * When the table has an eviction policy its entries are kept in a binary
+ * heap ordered by that policy, so the victim is heap[0]. An entry's
+ * evict_idx is its position in the heap.
+ */
+typedef struct ft_table_s {
+    ft_eviction_t eviction;
+    int max_entries;               /* 0 if forwarding alone limits the table */
+    ft_entry_t **heap;
+    int heap_count;
+    int heap_size;                 /* Allocated slots */
+} ft_table_t;
+
 /**
  * The public view of the instance for easier dereference
  *
@@ -129,15 +400,51 @@ struct ft_public_s {
     ft_status_t status;
 
     list_head_t all_list;          /* Single list of all current entries */
-
-    list_head_t *strict_match_buckets;  /* Array of strict match based buckets */
-    list_head_t *flow_id_buckets;  /* Array of flow_id based buckets */
+    ft_slab_t entry_slab;          /* Allocator for ft_entry_t */
+    ft_slab_t cold_slabs[FT_COLD_SLAB_CLASSES];  /* ft_entry_cold_t by
+                                                    match word count */
+
+    ft_index_t strict_match_index; /* Strict match hash */
+    ft_index_t flow_id_index;      /* Flow ID hash */
+    ft_index_t overlap_index;      /* Masked match hash, see ft_overlap_find */
+    ft_index_t cookie_index;       /* Cookie groups by full cookie hash */
+    int cookie_group_count;
     list_head_t *cookie_buckets;   /* Array of cookie (prefix) based buckets */
+    ft_index_t effects_index;      /* Shared effects by content hash */
+    int effects_count;
+
+    list_head_t mask_groups;       /* List of all mask groups */
+    list_head_t *mask_group_buckets; /* Mask groups by hash */
+    int mask_group_count;
+
+    list_head_t *overlap_part_buckets; /* Overlap partitions by hash */
+
+    list_head_t *out_port_buckets; /* Output port lists by hash */
+    ft_index_t out_group_index;    /* Output group lists by group ID */
+    int out_group_count;
+
+    ft_aggregate_t aggregate;      /* All entries */
+    ft_aggregate_t table_aggregates[FT_TABLE_COUNT];
+    ft_table_t tables[FT_TABLE_COUNT];
+
+    list_head_t *expire_wheel;     /* Array of expiration timing wheel slots */
+    uint64_t expire_cursor;        /* Next wheel slot to visit, absolute */
 };
 
 #define FT_CONFIG(_ft) (&(_ft)->config)
 #define FT_STATUS(_ft) (&(_ft)->status)
 
+/**
+ * An iterator's hold on an entry, linked into the entry's iterators list
+ *
+ * Either the iterator's position, or an entry that moved off the list the
+ * iterator walks before it was returned (see ft_iterator_pending_t).
+ */
+typedef struct ft_iterator_ref_s {
+    list_links_t links;
+    struct ft_iterator_s *iter;
+} ft_iterator_ref_t;
+
 /**
  * Safe iterator for the flowtable
  *
@@ -147,13 +454,25 @@ struct ft_public_s {
  */
 typedef struct ft_iterator_s {
     list_head_t *head;             /* List head for this iteration */
+    list_head_t *groups;           /* Mask group list, if iterating by group */
+    ft_mask_group_t *group;        /* Mask group of next_entry */
+    ft_out_port_t *out_port;       /* Port list, if iterating by out_port */
     ft_entry_t *next_entry;        /* Entry to be returned on next() */
     int links_offset;              /* Offset of the links we're using in the flowtable entry */
-    list_links_t entry_links;      /* Linked into next_entry->iterators if next_entry != NULL */
+    ft_iterator_ref_t next_ref;    /* Linked into next_entry->iterators if next_entry != NULL */
+    list_head_t pending;           /* ft_iterator_pending_t, returned after the walk */
+    struct ft_iterator_pending_s *held;  /* Returned before anything else */
     bool use_query;                /* Whether 'query' is valid */
     of_meta_match_t query;         /* Optional query to filter by */
 } ft_iterator_t;
 
+/* An entry that left an iterator's list before the iterator returned it */
+typedef struct ft_iterator_pending_s {
+    ft_iterator_ref_t ref;         /* In entry->iterators */
+    list_links_t links;            /* In iter->pending */
+    ft_entry_t *entry;
+} ft_iterator_pending_t;
+
 /**
  * Safe iterator for entire flow table
  *
@@ -230,6 +549,37 @@ indigo_error_t ft_delete(ft_instance_t ft,
 indigo_error_t ft_delete_id(ft_instance_t ft,
                             indigo_flow_id_t id);
 
+/**
+ * Remove a flow entry from the table without freeing it
+ * @param ft The flow table handle
+ * @param entry Pointer to the entry to be removed
+ *
+ * A detached entry is found by no lookup or iterator and counts toward no
+ * aggregate, but keeps its match, effects, counters and insert time. It
+ * must be either put back with ft_reattach or freed with ft_free.
+ * ft_delete is ft_detach followed by ft_free.
+ */
+
+void ft_detach(ft_instance_t ft, ft_entry_t *entry);
+
+/**
+ * Put a detached flow entry back in the table
+ * @param ft The flow table handle
+ * @param entry Pointer to an entry removed by ft_detach
+ * @returns INDIGO_ERROR_EXISTS if its flow ID has been reused, or
+ * INDIGO_ERROR_RESOURCE; the entry stays detached on error
+ */
+
+indigo_error_t ft_reattach(ft_instance_t ft, ft_entry_t *entry);
+
+/**
+ * Free a detached flow entry
+ * @param ft The flow table handle
+ * @param entry Pointer to an entry removed by ft_detach
+ */
+
+void ft_free(ft_instance_t ft, ft_entry_t *entry);
+
 /**
  * Query the flow table (strict match) and return the first match if found
  * @param ft Handle for a flow table instance
@@ -266,8 +616,28 @@ ft_entry_modify_effects(ft_instance_t instance,
                         ft_entry_t *entry,
                         of_flow_modify_t *flow_mod);
 
+/**
+ * Replace an entry with the flow from an add with the same strict match
+ * @param ft The flow table handle
+ * @param entry The entry to overwrite
+ * @param flow_add The add; its match and priority equal the entry's
+ * @param reset_counters Whether the entry's counters start again from zero
+ *
+ * The entry keeps its flow ID and its place in the match indexes. The
+ * cookie, flags, timeouts and effects are taken from the add and the
+ * duration restarts. Counters are reset against the last counts read
+ * from forwarding.
+ *
+ * On error the entry is unchanged.
+ */
+
+indigo_error_t
+ft_entry_overwrite(ft_instance_t ft, ft_entry_t *entry,
+                   of_flow_add_t *flow_add, bool reset_counters);
+
 /**
  * Clear the counters associated with a specific entry in the table
+ * @param ft The flow table handle
  * @param entry The entry to update
  * @param packets (out) If non-NULL, store current packet count here
  * @param bytes (out) If non-NULL, store current byte count here
@@ -276,7 +646,228 @@ ft_entry_modify_effects(ft_instance_t instance,
  */
 
 indigo_error_t
-ft_entry_clear_counters(ft_entry_t *entry, uint64_t *packets, uint64_t *bytes);
+ft_entry_clear_counters(ft_instance_t ft, ft_entry_t *entry,
+                        uint64_t *packets, uint64_t *bytes);
+
+/**
+ * Record an entry's counters as read from the forwarding layer
+ * @param ft The flow table handle
+ * @param entry The entry to update
+ * @param packets Current packet count
+ * @param bytes Current byte count
+ * @param now Current time; becomes last_counter_change if either changed
+ * @returns Boolean, true if either counter changed
+ *
+ * The counts are relative to the entry's packets_base and bytes_base,
+ * except for the (uint64_t)-1 "unknown" value. A count below its base
+ * means the forwarding counter restarted, so the base is dropped. The
+ * running aggregates are adjusted by the difference.
+ */
+
+bool
+ft_entry_counters_set(ft_instance_t ft, ft_entry_t *entry,
+                      uint64_t packets, uint64_t bytes, indigo_time_t now);
+
+/**
+ * Get the running aggregate for a query, if it has one
+ * @param ft The flow table handle
+ * @param query A non-strict query
+ * @param aggregate (out) Flow, packet and byte counts
+ * @returns INDIGO_ERROR_NONE, or INDIGO_ERROR_NOT_SUPPORTED if the query
+ * must be answered by visiting entries
+ *
+ * Supported queries match everything and check neither priority nor
+ * out_port, and either ignore the cookie (any table or one table) or
+ * require an exact cookie (any table).
+ */
+
+indigo_error_t
+ft_aggregate_get(ft_instance_t ft, of_meta_match_t *query,
+                 ft_aggregate_t *aggregate);
+
+/**
+ * Whether a non-strict query selects every entry in the flow table
+ */
+
+bool
+ft_query_all(of_meta_match_t *query);
+
+/**
+ * Find an entry that overlaps a flow being added
+ * @param ft The flow table handle
+ * @param query Query in OF_MATCH_OVERLAP mode with check_priority set
+ * @param entry_p (out) An overlapping entry, if found
+ * @returns INDIGO_ERROR_NONE if found; otherwise INDIGO_ERROR_NOT_FOUND
+ *
+ * Only the entries with the query's table (or any table, if TABLE_ID_ANY)
+ * and priority are considered; see ft_overlap_part_t.
+ */
+
+indigo_error_t
+ft_overlap_find(ft_instance_t ft, of_meta_match_t *query, ft_entry_t **entry_p);
+
+/**
+ * Record the table an entry was placed in
+ * @param ft The flow table handle
+ * @param entry The entry to update
+ * @param table_id The table ID reported by the forwarding layer
+ *
+ * Moves the entry to the mask group for its new table. Iterators over
+ * mask groups skip the entry if they have not yet returned it.
+ */
+
+indigo_error_t
+ft_entry_set_table_id(ft_instance_t ft, ft_entry_t *entry, uint8_t table_id);
+
+/**
+ * Carry over an entry's history from before a restart
+ * @param ft The flow table handle
+ * @param entry The entry, just added again from saved state
+ * @param insert_time When the entry was originally inserted
+ * @param packets_base Forwarding packet count when counters were last reset
+ * @param bytes_base Forwarding byte count when counters were last reset
+ *
+ * The hard timeout and eviction order count from the original insert
+ * time; the entry is treated as active for its next idle check.
+ */
+
+void
+ft_entry_restore(ft_instance_t ft, ft_entry_t *entry,
+                 indigo_time_t insert_time,
+                 uint64_t packets_base, uint64_t bytes_base);
+
+/**
+ * Set a table's entry limit and how to choose entries to evict from it
+ * @param ft The flow table handle
+ * @param table_id The table
+ * @param eviction The policy; FT_EVICTION_NONE never evicts
+ * @param max_entries Most entries the table may hold; 0 for no limit
+ * other than forwarding's
+ * @returns INDIGO_ERROR_RESOURCE if the eviction heap cannot be built,
+ * leaving the table's limit and policy unchanged
+ */
+
+indigo_error_t
+ft_table_eviction_set(ft_instance_t ft, uint8_t table_id,
+                      ft_eviction_t eviction, int max_entries);
+
+/**
+ * Whether a table holds more entries than its limit
+ */
+
+bool
+ft_table_over_limit(ft_instance_t ft, uint8_t table_id);
+
+/**
+ * Whether a table would hold more entries than its limit once count more
+ * were added; count may be negative
+ */
+
+bool
+ft_table_over_limit_after(ft_instance_t ft, uint8_t table_id, int count);
+
+/**
+ * The entry its table's eviction policy would remove first
+ * @returns NULL if the table has no policy or no entries
+ *
+ * Victims are chosen in O(1); keeping the order costs O(log n) per add,
+ * delete and counter change in a table with a policy.
+ */
+
+ft_entry_t *
+ft_eviction_victim(ft_instance_t ft, uint8_t table_id);
+
+/**
+ * Compute the chain length histogram of a flow table index
+ * @param index The index, e.g. &ft->flow_id_index
+ * @param hist (out) Array of FT_INDEX_CHAIN_HIST_SIZE bucket counts
+ * @param max_chain (out) If non-NULL, the longest chain
+ *
+ * Both bucket arrays are included while a resize is in progress.
+ */
+
+void
+ft_index_chain_histogram(ft_index_t *index, uint32_t *hist, int *max_chain);
+
+/**
+ * Hash index operations, also used for indexes kept outside the flow table
+ *
+ * An object is linked into one index through the list links at
+ * links_offset, and hash must return the same value for it while it is
+ * linked. Objects are unlinked with list_remove. After each insert or
+ * removal the owner calls ft_index_maintain with its object count.
+ * Lookups hash the key and walk the (at most two) buckets returned by
+ * ft_index_lookup_buckets.
+ */
+
+indigo_error_t
+ft_index_init(ft_index_t *index, int bucket_count, int links_offset,
+              uint32_t (*hash)(void *obj));
+
+void
+ft_index_cleanup(ft_index_t *index);
+
+void
+ft_index_insert(ft_index_t *index, void *obj);
+
+void
+ft_index_maintain(ft_index_t *index, int count);
+
+int
+ft_index_lookup_buckets(ft_index_t *index, uint32_t h, list_head_t *heads[2]);
+
+/**
+ * Count the entries whose actions forward to a group
+ * @param ft The flow table handle
+ * @param group_id The group
+ */
+
+int
+ft_out_group_entry_count(ft_instance_t ft, uint32_t group_id);
+
+/**
+ * Get an entry whose actions forward to a group
+ * @param ft The flow table handle
+ * @param group_id The group
+ * @returns The first such entry, or NULL if there is none
+ *
+ * Deleting the returned entry and calling again visits each entry once.
+ */
+
+ft_entry_t *
+ft_out_group_first(ft_instance_t ft, uint32_t group_id);
+
+/**
+ * Collect entries whose timeouts need checking
+ * @param ft The flow table handle
+ * @param now The current time
+ * @param due (out) List of due entries, linked through expire_links
+ *
+ * Only the wheel slots between the previous call and now are visited.
+ *
+ * Each entry left on the due list must either be deleted or passed to
+ * ft_expire_reschedule; both take it off the list.
+ */
+
+void
+ft_expire_collect(ft_instance_t ft, indigo_time_t now, list_head_t *due);
+
+/**
+ * Schedule the next timeout check for an entry
+ * @param ft The flow table handle
+ * @param entry The entry to schedule
+ * @param now The current time
+ * @param counters_changed Whether the entry's counters changed at now
+ *
+ * The next check is the hard deadline or the next idle check, whichever
+ * is first. An active flow has its idle timeout rechecked every
+ * idle_timeout / FT_IDLE_CHECKS_PER_TIMEOUT; otherwise it is checked when
+ * it would become idle.
+ */
+
+void
+ft_expire_reschedule(ft_instance_t ft, ft_entry_t *entry,
+                     indigo_time_t now, bool counters_changed);
 
 /*
  * Spawn a task that iterates over the flowtable
@@ -289,7 +880,8 @@ ft_entry_clear_counters(ft_entry_t *entry, uint64_t *packets, uint64_t *bytes);
  * This function does not guarantee a consistent view of the
  * flowtable over the course of the task.
  *
- * This function does not use any indexes on the flowtable.
+ * Queries are served from the cookie groups, the output port index, the
+ * cookie buckets or the mask groups; see ft_iterator_init.
  *
  * The callback function will be called with a NULL entry argument at
  * the end of the iteration.
@@ -306,6 +898,25 @@ ft_spawn_iter_task(ft_instance_t instance,
                    void *cookie,
                    int priority);
 
+/*
+ * Spawn a task that iterates over the flowtable and can wait on forwarding
+ *
+ * As ft_spawn_iter_task, but a callback returning INDIGO_ERROR_PENDING for
+ * an entry ends the task's run; the entry is passed again on the next run
+ * unless it was deleted meanwhile. The return value of the final NULL
+ * entry callback is ignored.
+ */
+
+typedef indigo_error_t (*ft_wait_iter_task_callback_f)(void *cookie,
+                                                       ft_entry_t *entry);
+
+indigo_error_t
+ft_spawn_wait_iter_task(ft_instance_t instance,
+                        of_meta_match_t *query,
+                        ft_wait_iter_task_callback_f callback,
+                        void *cookie,
+                        int priority);
+
 /**
  * Initialize a flowtable iterator
  *
@@ -316,6 +927,17 @@ ft_spawn_iter_task(ft_instance_t instance,
  * This iterator does not guarantee a consistent view of the flowtable over
  * the course of the iteration. Flows added during the iteration may or may
  * not be returned by the iterator.
+ *
+ * A query for an exact cookie visits only the entries with that cookie.
+ * Otherwise a query naming an out_port visits only the entries outputting
+ * to that port, and a query that fixes the whole cookie prefix visits
+ * only its cookie bucket. Other queries visit only the mask groups that can satisfy
+ * them, in group creation order; entries within a group are returned in
+ * insertion order.
+ *
+ * An entry whose cookie, table or output ports change while the iterator
+ * is about to return it moves off the walked list; it is returned once,
+ * where it lands or after the walk, if it still satisfies the query.
  */
 void
 ft_iterator_init(ft_iterator_t *iter, ft_instance_t ft, of_meta_match_t *query);
@@ -328,6 +950,15 @@ ft_iterator_init(ft_iterator_t *iter, ft_instance_t ft, of_meta_match_t *query);
 ft_entry_t *
 ft_iterator_next(ft_iterator_t *iter);
 
+/**
+ * Have an iterator return an entry it just returned again
+ *
+ * The entry is the next one returned, unless it is deleted first or no
+ * longer satisfies the query.
+ */
+indigo_error_t
+ft_iterator_hold(ft_iterator_t *iter, ft_entry_t *entry);
+
 /**
  * Cleanup a flowtable iterator
  */
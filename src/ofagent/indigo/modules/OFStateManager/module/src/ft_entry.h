@@ -34,65 +34,148 @@
  * The data in a flow table entry
  *
  * @param id The externally determined flow ID; primary key
- * @param match The match structure recorded from the original add
+ * @param cold Counters, effects and match; see ft_entry_cold_t
  * @param priority The priority, from the original add
  * @param idle_timeout The idle_timeout, from the original add
  * @param hard_timeout The hard_timeout, from the original add
  * @param cookie The cookie, from the original or as updated
- * @param effects The actions or instructions from the add or as updated.
- * See below.
  * @param insert_time The timestamp when the entry was inserted
- * @param packets Number of packets matched by the entry
- * @param bytes Number of bytes matched by the entry
  * @param last_counter_change Last update when counters changed
+ * @param expire_time Next time the timeouts need checking; 0 if none
  * @param table_links For iterating across the flow table
  * @param prio_links Search by priority
+ * @param strict_match_hash Cached hash of match and priority
+ * @param match_present Nonzero words of match; see ft_match_key_t
  * @param match_links Search by strict match
  * @param flow_id_links Search by flow id
+ * @param expire_links Expiration timing wheel slot
+ * @param mask_group Group of entries with the same table and match masks
+ * @param mask_group_links Iteration within mask_group
+ * @param cookie_group Entries with the same cookie, and their running counts
+ * @param cookie_group_links Iteration within cookie_group
+ * @param overlap_group Group of entries with the same table, priority
+ * and match masks
+ * @param overlap_group_links Iteration within overlap_group
+ * @param overlap_hash Cached hash of table, priority and masked match
+ * @param overlap_links Search by masked match
+ * @param out_port_refs Output port index references, one per distinct
+ * port the effects output to
+ * @param out_port_count Number of out_port_refs
+ * @param out_group_refs Output group index references, one per distinct
+ * group the effects forward to
+ * @param out_group_count Number of out_group_refs
+ * @param evict_idx Position in the table's eviction heap; -1 if none
  *
- * The effects (actions or instructions) are tied to a specific OpenFlow
- * version. For example, a flow may be added using OpenFlow 1.0 but
- * modified using OpenFlow 1.3. Either union member may be used to check
- * the version and LOCI object type.
+ * The match and priority are invariant once the entry has been added to
+ * the table.  The cookie and effects may be updated by modify commands;
+ * an add that overwrites the entry also replaces its timeouts and flags.
  *
- * The match, priority, timeouts and flags are invariant once the entry
- * has been added to the table.  The cookie and effects may be updated by
- * modify commands.
+ * Entries are allocated from the flow table's entry slab and hold only
+ * what index walks, queries and timers read. Fields are ordered by how
+ * often lookups touch them rather than by role.
  */
 
 typedef struct ft_entry_s {
-    /* Key */
-    indigo_flow_id_t     id;
+    /*
+     * Hot: hash chain links with the keys compared while walking them,
+     * so a chain walk touches only the start of each entry.
+     */
+    list_links_t flow_id_links;    /* Search by flow id */
+    indigo_flow_id_t     id;       /* Key */
+    uint32_t strict_match_hash;    /* Hash of match and priority */
+    uint32_t overlap_hash;         /* Hash of table, priority, masked match */
+    uint64_t match_present;        /* Nonzero words of match */
+    struct ft_entry_cold_s *cold;  /* Holds the match words */
+    list_links_t strict_match_links;  /* Search by strict match */
+    list_links_t overlap_links;    /* Search by masked match */
+    struct ft_overlap_group_s *overlap_group;  /* Same table_id, priority
+                                                  and match masks */
 
-    /* Invariant */
-    of_match_t match;
-    uint16_t priority;
+    /* Warm: metadata checked by queries, and the other index links */
+    uint16_t priority;             /* Invariant */
     uint16_t idle_timeout;
     uint16_t hard_timeout;
     uint16_t flags;
+    uint8_t table_id;              /* Updated by implementation */
+    int out_port_count;
+    uint64_t cookie;               /* Modifiable thru API calls */
+    struct ft_out_port_ref_s *out_port_refs;  /* Search by output port */
+    int out_group_count;
+    struct ft_out_group_ref_s *out_group_refs;  /* Search by output group */
+    struct ft_mask_group_s *mask_group;  /* Same table_id and match masks */
+    struct ft_cookie_group_s *cookie_group;  /* Same cookie */
+    list_links_t cookie_group_links;  /* Iteration within cookie_group */
+    list_links_t mask_group_links; /* Iteration within mask_group */
+    list_links_t overlap_group_links;  /* Iteration within overlap_group */
+    list_links_t table_links;      /* For iterating across the flow table */
+    list_links_t cookie_links;     /* Search by cookie */
+    list_head_t iterators;         /* List of ft_iterator_ref_t objects
+                                      pointing to this entry */
+    int evict_idx;                 /* In the table's eviction heap */
 
-    /* Modifiable thru API calls */
-    uint64_t cookie;
+    /* Timers, read by expiry and eviction */
+    indigo_time_t insert_time;
+    indigo_time_t last_counter_change;
+    indigo_time_t expire_time;
+    list_links_t expire_links;     /* Expiration timing wheel slot */
+} ft_entry_t;
+
+/**
+ * The cold part of a flow table entry
+ *
+ * @param packets Number of packets matched by the entry
+ * @param bytes Number of bytes matched by the entry
+ * @param packets_base Forwarding packet count when counters were last reset
+ * @param bytes_base Forwarding byte count when counters were last reset
+ * @param effects The actions or instructions from the add or as updated.
+ * See below.
+ * @param shared_effects The shared copy that effects points into
+ * @param match_words The nonzero words of the match, in order; the
+ * entry's match_present says which words they are
+ *
+ * The effects (actions or instructions) are tied to a specific OpenFlow
+ * version. For example, a flow may be added using OpenFlow 1.0 but
+ * modified using OpenFlow 1.3. Either union member may be used to check
+ * the version and LOCI object type. The list belongs to shared_effects and
+ * may be referenced by other entries, so it must be treated as read-only.
+ *
+ * Most of an of_match_t is zero, so the match is kept in the compact
+ * form of ft_match_key_t and expanded with ft_entry_match_get. Cold
+ * records are variable length and come from the flow table's cold slab
+ * for their word count.
+ */
+
+typedef struct ft_entry_cold_s {
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t packets_base;         /* Subtracted from forwarding counts */
+    uint64_t bytes_base;
     union { /* May not be maintained by some implementations */
         of_list_action_t *actions;
         of_list_instruction_t *instructions;
-    } effects;
+    } effects;                     /* Modifiable thru API calls */
+    struct ft_effects_s *shared_effects;  /* Holds the effects list */
+    uint64_t match_words[];        /* Invariant */
+} ft_entry_cold_t;
 
-    /* Updated by implementation */
-    uint8_t table_id;
-    indigo_time_t insert_time;
-    uint64_t packets;
-    uint64_t bytes;
-    indigo_time_t last_counter_change;
+/**
+ * Compact strict match key
+ *
+ * Most of an of_match_t is zero. The key records which 64-bit words of
+ * the match are nonzero and keeps only those words, in order. Two
+ * matches have equal keys exactly when of_match_eq holds, so strict
+ * lookups hash and compare a handful of words instead of the whole
+ * structure. Entries keep the present bitmap and their cold record
+ * keeps the words.
+ */
 
-    /* For linked list maintance */
-    list_links_t table_links;      /* For iterating across the flow table */
-    list_links_t strict_match_links;  /* Search by strict match */
-    list_links_t flow_id_links;    /* Search by flow id */
-    list_links_t cookie_links;     /* Search by cookie */
-    list_head_t iterators;         /* List of ft_iterator_t objects
-                                      pointing to this entry */
-} ft_entry_t;
+#define FT_MATCH_KEY_WORDS (sizeof(of_match_t) / sizeof(uint64_t))
+
+typedef struct ft_match_key_s {
+    uint64_t present;              /* Bit i set if word i is nonzero */
+    int count;                     /* Number of bits set in present */
+    uint64_t words[FT_MATCH_KEY_WORDS];
+} ft_match_key_t;
 
 /**
  * Get the container of a links pointer
@@ -173,4 +256,12 @@ typedef struct of_meta_match_s {
 
 extern int ft_entry_meta_match(of_meta_match_t *query, ft_entry_t *entry);
 
+/**
+ * @brief Expand an entry's match
+ * @param entry Pointer to the flow table entry
+ * @param match Filled in with the match from the original add
+ */
+
+extern void ft_entry_match_get(ft_entry_t *entry, of_match_t *match);
+
 #endif /* _OFSTATEMANAGER_FT_ENTRY_H_ */
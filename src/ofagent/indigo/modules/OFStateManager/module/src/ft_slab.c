@@ -0,0 +1,226 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/**
+ * @file
+ * @brief Fixed size object allocator for flow table entries
+ */
+
+#include <OFStateManager/ofstatemanager_config.h>
+#include <indigo/indigo.h>
+
+#include "ofstatemanager_log.h"
+#include "ft_slab.h"
+
+/*
+ * Chunk header; objects follow, aligned for any member type. Objects
+ * past carved have never been handed out and are not on free_list.
+ */
+struct ft_slab_chunk_s {
+    list_links_t partial_links;    /* On slab->partial while not full */
+    void *free_list;               /* Freed objects, linked through first word */
+    int carved;                    /* Objects handed out at least once */
+    int in_use;                    /* Objects allocated and not freed */
+};
+
+#define FT_SLAB_ALIGN sizeof(uint64_t)
+
+#define FT_SLAB_CHUNK_OBJ(_slab, _chunk, _idx)                          \
+    ((void *)((char *)((_chunk) + 1) + (size_t)(_idx) * (_slab)->obj_size))
+
+#define FT_SLAB_CHUNK_CONTAINS(_slab, _chunk, _obj)                     \
+    ((char *)(_obj) >= (char *)((_chunk) + 1) &&                        \
+     (char *)(_obj) < (char *)FT_SLAB_CHUNK_OBJ(_slab, _chunk,          \
+                                                (_slab)->objs_per_chunk))
+
+void
+ft_slab_init(ft_slab_t *slab, int obj_size)
+{
+    INDIGO_MEM_SET(slab, 0, sizeof(*slab));
+    list_init(&slab->partial);
+
+    if (obj_size < sizeof(void *)) {
+        obj_size = sizeof(void *);
+    }
+    slab->obj_size = (obj_size + FT_SLAB_ALIGN - 1) & ~(FT_SLAB_ALIGN - 1);
+    slab->objs_per_chunk =
+        (FT_SLAB_CHUNK_BYTES - sizeof(ft_slab_chunk_t)) / slab->obj_size;
+    if (slab->objs_per_chunk < 1) {
+        slab->objs_per_chunk = 1;
+    }
+}
+
+void
+ft_slab_cleanup(ft_slab_t *slab)
+{
+    int idx;
+
+    for (idx = 0; idx < slab->chunk_count; idx++) {
+        INDIGO_MEM_FREE(slab->chunks[idx]);
+    }
+    INDIGO_MEM_FREE(slab->chunks);
+
+    slab->chunks = NULL;
+    slab->chunk_count = 0;
+    slab->chunk_slots = 0;
+    list_init(&slab->partial);
+    slab->in_use = 0;
+}
+
+/*
+ * Index of the chunk holding obj, or of the first chunk above obj if
+ * none does
+ */
+static int
+ft_slab_chunk_search(ft_slab_t *slab, void *obj)
+{
+    int lo = 0, hi = slab->chunk_count;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if ((char *)slab->chunks[mid] < (char *)obj) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    /* The chunk holding obj starts below it */
+    if (lo > 0 && FT_SLAB_CHUNK_CONTAINS(slab, slab->chunks[lo - 1], obj)) {
+        return lo - 1;
+    }
+
+    return lo;
+}
+
+static ft_slab_chunk_t *
+ft_slab_chunk_add(ft_slab_t *slab)
+{
+    ft_slab_chunk_t *chunk;
+    int idx;
+
+    if (slab->chunk_count == slab->chunk_slots) {
+        int slots = slab->chunk_slots ? slab->chunk_slots * 2 : 16;
+        ft_slab_chunk_t **chunks =
+            INDIGO_MEM_REALLOC(slab->chunks, slots * sizeof(*chunks));
+        if (chunks == NULL) {
+            return NULL;
+        }
+        slab->chunks = chunks;
+        slab->chunk_slots = slots;
+    }
+
+    chunk = INDIGO_MEM_ALLOC(
+        sizeof(*chunk) + (size_t)slab->objs_per_chunk * slab->obj_size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->free_list = NULL;
+    chunk->carved = 0;
+    chunk->in_use = 0;
+
+    idx = ft_slab_chunk_search(slab, chunk);
+    INDIGO_MEM_MOVE(&slab->chunks[idx + 1], &slab->chunks[idx],
+                    (slab->chunk_count - idx) * sizeof(slab->chunks[0]));
+    slab->chunks[idx] = chunk;
+    slab->chunk_count++;
+    list_push(&slab->partial, &chunk->partial_links);
+
+    return chunk;
+}
+
+static void
+ft_slab_chunk_remove(ft_slab_t *slab, int idx)
+{
+    ft_slab_chunk_t *chunk = slab->chunks[idx];
+
+    list_remove(&chunk->partial_links);
+    slab->chunk_count--;
+    INDIGO_MEM_MOVE(&slab->chunks[idx], &slab->chunks[idx + 1],
+                    (slab->chunk_count - idx) * sizeof(slab->chunks[0]));
+    INDIGO_MEM_FREE(chunk);
+}
+
+void *
+ft_slab_alloc(ft_slab_t *slab)
+{
+    ft_slab_chunk_t *chunk;
+    void *obj;
+
+    if (list_empty(&slab->partial)) {
+        if (ft_slab_chunk_add(slab) == NULL) {
+            return NULL;
+        }
+    }
+
+    /* Most recently freed into chunk first */
+    chunk = container_of(slab->partial.links.next, partial_links,
+                         ft_slab_chunk_t);
+
+    if (chunk->free_list != NULL) {
+        obj = chunk->free_list;
+        chunk->free_list = *(void **)obj;
+    } else {
+        obj = FT_SLAB_CHUNK_OBJ(slab, chunk, chunk->carved);
+        chunk->carved++;
+    }
+
+    if (++chunk->in_use == slab->objs_per_chunk) {
+        list_remove(&chunk->partial_links);
+    }
+    slab->in_use++;
+
+    return obj;
+}
+
+void
+ft_slab_free(ft_slab_t *slab, void *obj)
+{
+    ft_slab_chunk_t *chunk;
+    int idx;
+
+    INDIGO_ASSERT(slab->in_use > 0);
+
+    idx = ft_slab_chunk_search(slab, obj);
+    INDIGO_ASSERT(idx < slab->chunk_count &&
+                  FT_SLAB_CHUNK_CONTAINS(slab, slab->chunks[idx], obj));
+    chunk = slab->chunks[idx];
+
+    slab->in_use--;
+
+    if (chunk->in_use-- == slab->objs_per_chunk) {
+        /* Was full; allocate from it again before emptier chunks */
+        list_unshift(&slab->partial, &chunk->partial_links);
+    }
+
+    if (chunk->in_use == 0) {
+        ft_slab_chunk_remove(slab, idx);
+        return;
+    }
+
+    *(void **)obj = chunk->free_list;
+    chunk->free_list = obj;
+}
+
+uint64_t
+ft_slab_bytes(ft_slab_t *slab)
+{
+    return (uint64_t)slab->chunk_count *
+        (sizeof(ft_slab_chunk_t) + (size_t)slab->objs_per_chunk * slab->obj_size);
+}
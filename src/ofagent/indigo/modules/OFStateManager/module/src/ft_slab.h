@@ -0,0 +1,78 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc. 
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/**
+ * @file
+ * @brief Fixed size object allocator for flow table entries
+ *
+ * Objects are carved out of chunks of FT_SLAB_CHUNK_BYTES, packed with no
+ * per-object header. Each chunk keeps its own free list and use count;
+ * allocations are served from chunks that already hold objects, and a
+ * chunk is released as soon as its last object is freed.
+ */
+
+#ifndef _OFSTATEMANAGER_FT_SLAB_H_
+#define _OFSTATEMANAGER_FT_SLAB_H_
+
+#include <indigo/indigo.h>
+#include <AIM/aim_list.h>
+
+#define FT_SLAB_CHUNK_BYTES (64 * 1024)
+
+typedef struct ft_slab_chunk_s ft_slab_chunk_t;
+
+typedef struct ft_slab_s {
+    int obj_size;                  /* Object stride in bytes */
+    int objs_per_chunk;
+    ft_slab_chunk_t **chunks;      /* All chunks, sorted by address */
+    int chunk_count;
+    int chunk_slots;               /* Allocated length of chunks */
+    list_head_t partial;           /* Chunks with free objects */
+    int in_use;                    /* Objects allocated and not freed */
+} ft_slab_t;
+
+/**
+ * Initialize a slab
+ * @param slab The slab
+ * @param obj_size Size of each object; rounded up to pointer alignment
+ */
+void ft_slab_init(ft_slab_t *slab, int obj_size);
+
+/**
+ * Release all chunks; objects still in use become invalid
+ */
+void ft_slab_cleanup(ft_slab_t *slab);
+
+/**
+ * Allocate an object; the contents are undefined
+ * @returns The object or NULL if out of memory
+ */
+void *ft_slab_alloc(ft_slab_t *slab);
+
+/**
+ * Return an object to its slab; its chunk is released if now unused
+ */
+void ft_slab_free(ft_slab_t *slab, void *obj);
+
+/**
+ * Bytes of chunk memory held by the slab
+ */
+uint64_t ft_slab_bytes(ft_slab_t *slab);
+
+#endif /* _OFSTATEMANAGER_FT_SLAB_H_ */
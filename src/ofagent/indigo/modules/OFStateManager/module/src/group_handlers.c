@@ -33,33 +33,296 @@
 #include <indigo/forwarding.h>
 #include <loci/loci.h>
 #include <AIM/aim_list.h>
+#include <murmur/murmur.h>
 #include "ofstatemanager_decs.h"
 #include "ofstatemanager_int.h"
 #include "handlers.h"
 
+/*
+ * Groups are found by ID through ind_core_group_index and kept in
+ * ind_core_groups_list in the order they were added.
+ *
+ * Each group has one reference per distinct other group its buckets
+ * forward to, linked into the referenced group's referrers. A reference
+ * to a group that does not exist waits on ind_core_group_dangling_refs
+ * until the group is added. The flows forwarding to a group are found
+ * through the flow table's output group index.
+ */
+
+struct ind_core_group_s;
+
+typedef struct ind_core_group_ref_s {
+    list_links_t links;            /* In target->referrers, or dangling */
+    struct ind_core_group_s *referrer;
+    struct ind_core_group_s *target;  /* NULL while dangling */
+    uint32_t group_id;             /* Of the target */
+} ind_core_group_ref_t;
+
 typedef struct ind_core_group_s {
     list_links_t links;
+    list_links_t hash_links;       /* In ind_core_group_index */
     uint32_t id;
     uint32_t type;
     of_list_bucket_t *buckets;
     indigo_time_t creation_time;
+    ind_core_group_ref_t *refs;    /* Groups the buckets forward to */
+    int ref_count;
+    list_head_t referrers;         /* Refs of groups forwarding here */
+    int referrer_count;
 } ind_core_group_t;
 
 static LIST_DEFINE(ind_core_groups_list);
+static LIST_DEFINE(ind_core_group_dangling_refs);
+static ft_index_t ind_core_group_index;
+static int ind_core_group_count;
+
+/* Bumped on every change to the group table, for the state file */
+static uint64_t ind_core_group_change_count;
+
+static uint32_t
+ind_core_group_id_hash(uint32_t id)
+{
+    return murmur_hash(&id, sizeof(id), 0);
+}
+
+static uint32_t
+ind_core_group_hash(void *obj)
+{
+    ind_core_group_t *group = obj;
+    return ind_core_group_id_hash(group->id);
+}
 
 static ind_core_group_t *
 ind_core_group_lookup(uint32_t id)
 {
+    list_head_t *buckets[2];
     list_links_t *cur;
-    LIST_FOREACH(&ind_core_groups_list, cur) {
-        ind_core_group_t *group = container_of(cur, links, ind_core_group_t);
-        if (group->id == id) {
-            return group;
+    int i, n;
+
+    if (ind_core_group_index.buckets == NULL) {
+        return NULL;
+    }
+
+    n = ft_index_lookup_buckets(&ind_core_group_index,
+                                ind_core_group_id_hash(id), buckets);
+    for (i = 0; i < n; i++) {
+        LIST_FOREACH(buckets[i], cur) {
+            ind_core_group_t *group =
+                container_of(cur, hash_links, ind_core_group_t);
+            if (group->id == id) {
+                return group;
+            }
         }
     }
     return NULL;
 }
 
+/* Record the distinct groups, other than itself, the buckets forward to */
+static indigo_error_t
+ind_core_group_refs_build(ind_core_group_t *group)
+{
+    ind_core_group_ref_t *refs;
+    of_bucket_t bucket;
+    of_list_action_t actions;
+    of_action_t act;
+    uint32_t group_id;
+    int bucket_rv, action_rv, idx;
+
+    group->refs = NULL;
+    group->ref_count = 0;
+
+    OF_LIST_BUCKET_ITER(group->buckets, &bucket, bucket_rv) {
+        of_bucket_actions_bind(&bucket, &actions);
+        OF_LIST_ACTION_ITER(&actions, &act, action_rv) {
+            if (act.header.object_id != OF_ACTION_GROUP) {
+                continue;
+            }
+            of_action_group_group_id_get(&act.group, &group_id);
+            if (group_id == group->id) {
+                continue;
+            }
+            for (idx = 0; idx < group->ref_count; idx++) {
+                if (group->refs[idx].group_id == group_id) {
+                    break;
+                }
+            }
+            if (idx < group->ref_count) {
+                continue;
+            }
+            refs = INDIGO_MEM_REALLOC(group->refs,
+                (group->ref_count + 1) * sizeof(*group->refs));
+            if (refs == NULL) {
+                INDIGO_MEM_FREE(group->refs);
+                group->refs = NULL;
+                group->ref_count = 0;
+                return INDIGO_ERROR_RESOURCE;
+            }
+            group->refs = refs;
+            INDIGO_MEM_SET(&group->refs[group->ref_count], 0,
+                           sizeof(*group->refs));
+            group->refs[group->ref_count].group_id = group_id;
+            group->ref_count++;
+        }
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/**
+ * Whether any of the buckets forwards to group 'id'
+ */
+
+int
+ind_core_group_buckets_forward_to(of_list_bucket_t *buckets, uint32_t id)
+{
+    of_bucket_t bucket;
+    of_list_action_t actions;
+    of_action_t act;
+    uint32_t group_id;
+    int bucket_rv, action_rv;
+
+    OF_LIST_BUCKET_ITER(buckets, &bucket, bucket_rv) {
+        of_bucket_actions_bind(&bucket, &actions);
+        OF_LIST_ACTION_ITER(&actions, &act, action_rv) {
+            if (act.header.object_id != OF_ACTION_GROUP) {
+                continue;
+            }
+            of_action_group_group_id_get(&act.group, &group_id);
+            if (group_id == id) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void
+ind_core_group_refs_link(ind_core_group_t *group)
+{
+    int idx;
+
+    for (idx = 0; idx < group->ref_count; idx++) {
+        ind_core_group_ref_t *ref = &group->refs[idx];
+        ref->referrer = group;
+        ref->target = ind_core_group_lookup(ref->group_id);
+        if (ref->target != NULL) {
+            list_push(&ref->target->referrers, &ref->links);
+            ref->target->referrer_count++;
+        } else {
+            list_push(&ind_core_group_dangling_refs, &ref->links);
+        }
+    }
+}
+
+static void
+ind_core_group_refs_unlink(ind_core_group_t *group)
+{
+    int idx;
+
+    for (idx = 0; idx < group->ref_count; idx++) {
+        ind_core_group_ref_t *ref = &group->refs[idx];
+        list_remove(&ref->links);
+        if (ref->target != NULL) {
+            ref->target->referrer_count--;
+            ref->target = NULL;
+        }
+    }
+
+    INDIGO_MEM_FREE(group->refs);
+    group->refs = NULL;
+    group->ref_count = 0;
+}
+
+/**
+ * Allocate an unlinked group record, with a copy of the buckets and the
+ * references they make. Done before forwarding is changed, so running
+ * out of memory fails the request rather than the table.
+ */
+static indigo_error_t
+ind_core_group_new(uint32_t id, uint8_t type, of_list_bucket_t *buckets,
+                   ind_core_group_t **group_out)
+{
+    ind_core_group_t *group;
+
+    group = INDIGO_MEM_ALLOC(sizeof(*group));
+    if (group == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    INDIGO_MEM_SET(group, 0, sizeof(*group));
+    group->id = id;
+    group->type = type;
+    list_init(&group->referrers);
+
+    if ((group->buckets = of_object_dup(buckets)) == NULL) {
+        INDIGO_MEM_FREE(group);
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    if (ind_core_group_refs_build(group) < 0) {
+        of_object_delete(group->buckets);
+        INDIGO_MEM_FREE(group);
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    *group_out = group;
+    return INDIGO_ERROR_NONE;
+}
+
+/* Free a record from ind_core_group_new that was never inserted */
+static void
+ind_core_group_discard(ind_core_group_t *group)
+{
+    INDIGO_MEM_FREE(group->refs);
+    of_object_delete(group->buckets);
+    INDIGO_MEM_FREE(group);
+}
+
+/*
+ * Replace the type and buckets, and the references made by the buckets,
+ * with those of a record from ind_core_group_new, which is consumed
+ */
+static void
+ind_core_group_buckets_set(ind_core_group_t *group,
+                           ind_core_group_t *replacement)
+{
+    ind_core_group_refs_unlink(group);
+
+    group->type = replacement->type;
+    of_object_delete(group->buckets);
+    group->buckets = replacement->buckets;
+    group->refs = replacement->refs;
+    group->ref_count = replacement->ref_count;
+    INDIGO_MEM_FREE(replacement);
+
+    ind_core_group_refs_link(group);
+    ind_core_group_change_count++;
+}
+
+/* Unlink and free a group; groups still forwarding to it become dangling */
+static void
+ind_core_group_remove(ind_core_group_t *group)
+{
+    list_links_t *cur, *next;
+
+    ind_core_group_refs_unlink(group);
+
+    LIST_FOREACH_SAFE(&group->referrers, cur, next) {
+        ind_core_group_ref_t *ref = container_of(cur, links, ind_core_group_ref_t);
+        list_remove(&ref->links);
+        ref->target = NULL;
+        list_push(&ind_core_group_dangling_refs, &ref->links);
+    }
+
+    of_object_delete(group->buckets);
+    list_remove(&group->links);
+    list_remove(&group->hash_links);
+    INDIGO_MEM_FREE(group);
+    ind_core_group_count--;
+    ft_index_maintain(&ind_core_group_index, ind_core_group_count);
+    ind_core_group_change_count++;
+}
+
 #ifdef OFDPA_FIXUP
 static indigo_error_t
 ind_core_group_delete_one(ind_core_group_t *group)
@@ -67,9 +330,7 @@ ind_core_group_delete_one(ind_core_group_t *group)
     indigo_error_t result;
     result = indigo_fwd_group_delete(group->id);
     if (result >= 0) {
-      of_object_delete(group->buckets);
-      list_remove(&group->links);
-      INDIGO_MEM_FREE(group);
+      ind_core_group_remove(group);
     }
     return result;
 }
@@ -78,11 +339,375 @@ static void
 ind_core_group_delete_one(ind_core_group_t *group)
 {
     indigo_fwd_group_delete(group->id);
-    of_object_delete(group->buckets);
-    list_remove(&group->links);
-    INDIGO_MEM_FREE(group);
+    ind_core_group_remove(group);
+}
+#endif
+
+/*
+ * Remove the flows forwarding to a group, as deleting it requires. The
+ * count bounds the loop should a flow fail to leave the table.
+ */
+static indigo_error_t
+ind_core_group_flows_remove(uint32_t id, ind_core_group_flow_remove_f remove_flow,
+                            void *cookie)
+{
+    ft_entry_t *entry;
+    int count = ft_out_group_entry_count(ind_core_ft, id);
+    indigo_error_t result;
+
+    while (count-- > 0 && (entry = ft_out_group_first(ind_core_ft, id)) != NULL) {
+        result = remove_flow(cookie, entry);
+        if (result < 0) {
+            return result;
+        }
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/* Flow removal for a group_mod delete; cookie is the connection ID */
+static indigo_error_t
+ind_core_group_flow_delete(void *cookie, ft_entry_t *entry)
+{
+    ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_GROUP_DELETE,
+                               *(indigo_cxn_id_t *)cookie);
+    return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t
+ind_core_group_get(uint32_t id, uint8_t *type, of_list_bucket_t **buckets)
+{
+    ind_core_group_t *group;
+
+    if (id > OF_GROUP_MAX || (group = ind_core_group_lookup(id)) == NULL) {
+        return INDIGO_ERROR_NOT_FOUND;
+    }
+
+    if (type != NULL) {
+        *type = group->type;
+    }
+    if (buckets != NULL) {
+        *buckets = group->buckets;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+/*
+ * Make sure the group index exists, before the first group goes in.
+ * Forwarding is not touched if this fails.
+ */
+static indigo_error_t
+ind_core_group_index_ready(void)
+{
+    if (ind_core_group_index.buckets != NULL) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    return ft_index_init(&ind_core_group_index, 0,
+                         offsetof(ind_core_group_t, hash_links),
+                         ind_core_group_hash);
+}
+
+/* Record a group forwarding has installed, from ind_core_group_new */
+static void
+ind_core_group_insert(ind_core_group_t *group)
+{
+    list_links_t *cur, *next;
+    uint32_t id = group->id;
+
+    group->creation_time = INDIGO_CURRENT_TIME;
+
+    ft_index_insert(&ind_core_group_index, group);
+    ind_core_group_count++;
+    ft_index_maintain(&ind_core_group_index, ind_core_group_count);
+    list_push(&ind_core_groups_list, &group->links);
+
+    /* Groups added earlier may already forward to this one */
+    LIST_FOREACH_SAFE(&ind_core_group_dangling_refs, cur, next) {
+        ind_core_group_ref_t *ref = container_of(cur, links, ind_core_group_ref_t);
+        if (ref->group_id == id) {
+            list_remove(&ref->links);
+            ref->target = group;
+            list_push(&group->referrers, &ref->links);
+            group->referrer_count++;
+        }
+    }
+
+    ind_core_group_refs_link(group);
+    ind_core_group_change_count++;
+}
+
+/**
+ * Add a group to forwarding and the table
+ *
+ * Returns INDIGO_ERROR_RESOURCE, leaving forwarding untouched, if the
+ * table's records cannot be allocated.
+ */
+
+indigo_error_t
+ind_core_group_add(uint32_t id, uint8_t type, of_list_bucket_t *buckets)
+{
+    ind_core_group_t *group;
+    indigo_error_t result;
+
+    if ((result = ind_core_group_index_ready()) < 0 ||
+            (result = ind_core_group_new(id, type, buckets, &group)) < 0) {
+        return result;
+    }
+
+    result = indigo_fwd_group_add(id, type, buckets);
+    if (result < 0) {
+        ind_core_group_discard(group);
+        return result;
+    }
+
+    ind_core_group_insert(group);
+
+    return INDIGO_ERROR_NONE;
+}
+
+/**
+ * Record a group restored from the state file
+ *
+ * Forwarding reconciles it, adding it again if it no longer has it. On
+ * failure the group is dropped and the controller must add it again.
+ */
+
+indigo_error_t
+ind_core_group_restore(uint32_t id, uint8_t type, of_list_bucket_t *buckets)
+{
+    ind_core_group_t *group;
+    indigo_error_t result;
+
+    if (id > OF_GROUP_MAX || ind_core_group_lookup(id) != NULL) {
+        return INDIGO_ERROR_PARAM;
+    }
+
+    if ((result = ind_core_group_index_ready()) < 0 ||
+            (result = ind_core_group_new(id, type, buckets, &group)) < 0) {
+        return result;
+    }
+
+    result = indigo_fwd_group_reconcile(id, type, buckets);
+    if (result < 0) {
+        ind_core_group_discard(group);
+        return result;
+    }
+
+    ind_core_group_insert(group);
+
+    return INDIGO_ERROR_NONE;
+}
+
+/**
+ * Call a function on each group, in the order they were added
+ */
+
+void
+ind_core_group_iter(ind_core_group_iter_f callback, void *cookie)
+{
+    list_links_t *cur;
+
+    LIST_FOREACH(&ind_core_groups_list, cur) {
+        ind_core_group_t *group = container_of(cur, links, ind_core_group_t);
+        callback(cookie, group->id, group->type, group->buckets);
+    }
+}
+
+uint64_t
+ind_core_group_changes(void)
+{
+    return ind_core_group_change_count;
+}
+
+indigo_error_t
+ind_core_group_modify(uint32_t id, uint8_t type, of_list_bucket_t *buckets)
+{
+    ind_core_group_t *group;
+    ind_core_group_t *replacement;
+    indigo_error_t result;
+
+    if (id > OF_GROUP_MAX || (group = ind_core_group_lookup(id)) == NULL) {
+        return INDIGO_ERROR_NOT_FOUND;
+    }
+
+    result = ind_core_group_new(id, type, buckets, &replacement);
+    if (result < 0) {
+        return result;
+    }
+
+    if (group->type == type) {
+        result = indigo_fwd_group_modify(id, buckets);
+    } else {
+#ifdef OFDPA_FIXUP
+        result = indigo_fwd_group_delete(id);
+        if (result < 0) {
+            ind_core_group_discard(replacement);
+            return result;
+        }
+#else
+        indigo_fwd_group_delete(id);
+#endif
+        result = indigo_fwd_group_add(id, type, buckets);
+    }
+
+    if (result < 0) {
+        ind_core_group_discard(replacement);
+        return result;
+    }
+
+    ind_core_group_buckets_set(group, replacement);
+
+    return INDIGO_ERROR_NONE;
+}
+
+/**
+ * Delete a group
+ *
+ * Fails with INDIGO_ERROR_PARAM while other groups forward to it. Flows
+ * forwarding to it are not removed; see ind_core_group_mod_handler.
+ */
+
+indigo_error_t
+ind_core_group_delete(uint32_t id)
+{
+    ind_core_group_t *group;
+
+    if (id > OF_GROUP_MAX || (group = ind_core_group_lookup(id)) == NULL) {
+        return INDIGO_ERROR_NOT_FOUND;
+    }
+
+    if (group->referrer_count > 0) {
+        return INDIGO_ERROR_PARAM;
+    }
+
+#ifdef OFDPA_FIXUP
+    return ind_core_group_delete_one(group);
+#else
+    ind_core_group_delete_one(group);
+    return INDIGO_ERROR_NONE;
+#endif
+}
+
+/**
+ * Delete a group along with the flows forwarding to them, as a group_mod
+ * delete does
+ *
+ * remove_flow is called on each flow forwarding to the group and must
+ * take it out of the flow table. Fails with INDIGO_ERROR_PARAM, removing
+ * nothing, while other groups forward to it. If remove_flow or forwarding
+ * fails, the flows already removed stay removed.
+ */
+
+indigo_error_t
+ind_core_group_delete_with_flows(uint32_t id,
+                                 ind_core_group_flow_remove_f remove_flow,
+                                 void *cookie)
+{
+    ind_core_group_t *group;
+    indigo_error_t result;
+
+    if (id > OF_GROUP_MAX || (group = ind_core_group_lookup(id)) == NULL) {
+        return INDIGO_ERROR_NOT_FOUND;
+    }
+
+    if (group->referrer_count > 0) {
+        return INDIGO_ERROR_PARAM;
+    }
+
+    result = ind_core_group_flows_remove(id, remove_flow, cookie);
+    if (result < 0) {
+        return result;
+    }
+
+#ifdef OFDPA_FIXUP
+    return ind_core_group_delete_one(group);
+#else
+    ind_core_group_delete_one(group);
+    return INDIGO_ERROR_NONE;
+#endif
 }
+
+/*
+ * Delete every group along with the flows forwarding to them. A group is
+ * deleted once no remaining group forwards to it, so chains go from the
+ * head (e.g. ECMP) down to the L2 interface groups in one pass.
+ */
+static indigo_error_t
+ind_core_group_delete_all(indigo_cxn_id_t cxn_id)
+{
+    ind_core_group_t **ready;
+    ind_core_group_t *group;
+    ind_core_group_t *target;
+    list_links_t *cur, *next;
+    int ready_count = 0;
+    int idx;
+    indigo_error_t result = INDIGO_ERROR_NONE;
+
+    if (ind_core_group_count == 0) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    /* Each group is pushed once, when nothing forwards to it any more */
+    ready = INDIGO_MEM_ALLOC(ind_core_group_count * sizeof(*ready));
+    if (ready == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    LIST_FOREACH(&ind_core_groups_list, cur) {
+        group = container_of(cur, links, ind_core_group_t);
+        (void)ind_core_group_flows_remove(group->id, ind_core_group_flow_delete,
+                                          &cxn_id);
+    }
+
+    LIST_FOREACH(&ind_core_groups_list, cur) {
+        group = container_of(cur, links, ind_core_group_t);
+        if (group->referrer_count == 0) {
+            ready[ready_count++] = group;
+        }
+    }
+
+    while (ready_count > 0) {
+        group = ready[--ready_count];
+
+        /* Its targets lose a referrer as it goes */
+        for (idx = 0; idx < group->ref_count; idx++) {
+            target = group->refs[idx].target;
+            if (target != NULL && target->referrer_count == 1) {
+                ready[ready_count++] = target;
+            }
+        }
+
+#ifdef OFDPA_FIXUP
+        result = ind_core_group_delete_one(group);
+        if (result < 0) {
+            goto done;
+        }
+#else
+        ind_core_group_delete_one(group);
 #endif
+    }
+
+    /* Only groups forwarding to each other in a cycle are left */
+    LIST_FOREACH_SAFE(&ind_core_groups_list, cur, next) {
+        group = container_of(cur, links, ind_core_group_t);
+#ifdef OFDPA_FIXUP
+        result = ind_core_group_delete_one(group);
+        if (result < 0) {
+            goto done;
+        }
+#else
+        ind_core_group_delete_one(group);
+#endif
+    }
+
+#ifdef OFDPA_FIXUP
+done:
+#endif
+    INDIGO_MEM_FREE(ready);
+    return result;
+}
 
 indigo_error_t
 ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
@@ -94,6 +719,7 @@ ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     uint32_t id;
     of_list_bucket_t buckets;
     ind_core_group_t *group = NULL;
+    ind_core_group_t *replacement;
     uint16_t err_type = OF_ERROR_TYPE_GROUP_MOD_FAILED;
     uint16_t err_code = OF_GROUP_MOD_FAILED_EPERM;
     indigo_error_t result;
@@ -117,32 +743,31 @@ ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
             goto error;
         }
 
-        result = indigo_fwd_group_add(id, type, &buckets);
-        if (result < 0) {
+        result = ind_core_group_add(id, type, &buckets);
+        if (result == INDIGO_ERROR_RESOURCE) {
+            err_code = OF_GROUP_MOD_FAILED_OUT_OF_GROUPS;
+            goto error;
+        } else if (result < 0) {
             err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
             goto error;
         }
-
-        group = INDIGO_MEM_ALLOC(sizeof(*group));
-        AIM_TRUE_OR_DIE(group != NULL);
-        group->id = id;
-        group->type = type;
-        group->buckets = of_object_dup(&buckets);
-        AIM_TRUE_OR_DIE(group->buckets != NULL);
-        group->creation_time = INDIGO_CURRENT_TIME;
-
-        list_push(&ind_core_groups_list, &group->links);
     } else if (command == OF_GROUP_MODIFY) {
         if (group == NULL) {
             err_code = OF_GROUP_MOD_FAILED_UNKNOWN_GROUP;
             goto error;
         }
 
+        if (ind_core_group_new(id, type, &buckets, &replacement) < 0) {
+            err_code = OF_GROUP_MOD_FAILED_OUT_OF_GROUPS;
+            goto error;
+        }
+
         if (group->type == type) {
             result = indigo_fwd_group_modify(id, &buckets);
 #ifdef OFDPA_FIXUP
             if (result < 0) {
                 err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
+                ind_core_group_discard(replacement);
                 ind_core_group_delete_one(group);
                 goto error;
             }
@@ -152,6 +777,7 @@ ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
           result = indigo_fwd_group_delete(id);
             if (result < 0) {
                 err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
+                ind_core_group_discard(replacement);
                 goto error;
             }
 #else
@@ -162,36 +788,29 @@ ind_core_group_mod_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
 
         if (result < 0) {
             err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
+            ind_core_group_discard(replacement);
             goto error;
         }
 
-        group->type = type;
-        of_object_delete(group->buckets);
-        group->buckets = of_object_dup(&buckets);
-        AIM_TRUE_OR_DIE(group->buckets != NULL);
+        ind_core_group_buckets_set(group, replacement);
     } else if (command == OF_GROUP_DELETE) {
         if (id == OF_GROUP_ALL) {
-            list_links_t *cur, *next;
-            LIST_FOREACH_SAFE(&ind_core_groups_list, cur, next) {
-                group = container_of(cur, links, ind_core_group_t);
-#ifdef OFDPA_FIXUP
-                result = ind_core_group_delete_one(group);
-                if (result < 0) {
-                    err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
-                    goto error;
-                }
-#endif
+            result = ind_core_group_delete_all(cxn_id);
+            if (result < 0) {
+                err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
+                goto error;
             }
         } else if (group != NULL) {
-#ifdef OFDPA_FIXUP
-            result = ind_core_group_delete_one(group);
-            if (result < 0) {
+            result = ind_core_group_delete_with_flows(id,
+                                                      ind_core_group_flow_delete,
+                                                      &cxn_id);
+            if (result == INDIGO_ERROR_PARAM) {
+                err_code = OF_GROUP_MOD_FAILED_CHAINED_GROUP;
+                goto error;
+            } else if (result < 0) {
                 err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
                 goto error;
             }
-#else
-            ind_core_group_delete_one(group);
-#endif
         } else if (id > OF_GROUP_MAX) {
             err_code = OF_GROUP_MOD_FAILED_INVALID_GROUP;
             goto error;
@@ -39,10 +39,6 @@
 #include "handlers.h"
 #include "ft.h"
 
-static void
-flow_mod_err_msg_send(indigo_error_t indigo_err, of_version_t ver,
-                      indigo_cxn_id_t cxn_id, of_flow_modify_t *flow_mod);
-
 /****************************************************************
  *
  * Utility functions
@@ -356,11 +352,11 @@ ind_core_queue_stats_request_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
 
 /****************************************************************/
 
-static indigo_error_t
-flow_mod_setup_query(of_flow_modify_t *obj, /* Works with add, mod, del */
-                     of_meta_match_t *query,
-                     int query_mode,
-                     int force_wildcard_port)
+indigo_error_t
+ind_core_flow_mod_setup_query(of_flow_modify_t *obj, /* Works with add, mod, del */
+                              of_meta_match_t *query,
+                              int query_mode,
+                              int force_wildcard_port)
 {
     INDIGO_MEM_SET(query, 0, sizeof(*query));
     if (obj->version > OF_VERSION_1_0) {
@@ -398,25 +394,18 @@ static int
 overlap_found(of_flow_modify_t *obj)
 {
     ft_entry_t *entry;
-    list_links_t *cur, *next;
     of_meta_match_t query;
 
-    _TRY(flow_mod_setup_query(obj, &query, OF_MATCH_OVERLAP, 1));
-
-    FT_ITER(ind_core_ft, entry, cur, next) {
-        if (ft_entry_meta_match(&query, entry)) {
-            return 1;
-        }
-    }
+    _TRY(ind_core_flow_mod_setup_query(obj, &query, OF_MATCH_OVERLAP, 1));
 
-    return 0;
+    return ft_overlap_find(ind_core_ft, &query, &entry) == INDIGO_ERROR_NONE;
 }
 
-static indigo_flow_id_t
-flow_id_next(void)
-{
-    static indigo_flow_id_t next_flow_id = 1;
+static indigo_flow_id_t next_flow_id = 1;
 
+indigo_flow_id_t
+ind_core_flow_id_next(void)
+{
     indigo_flow_id_t result = next_flow_id;
 
     if (++next_flow_id == 0)  next_flow_id = 1;
@@ -424,6 +413,109 @@ flow_id_next(void)
     return (result);
 }
 
+/**
+ * Keep ind_core_flow_id_next from handing out an ID already in use,
+ * such as one restored from a saved state file
+ */
+
+void
+ind_core_flow_id_reserve(indigo_flow_id_t id)
+{
+    if (id >= next_flow_id) {
+        next_flow_id = id + 1;
+        if (next_flow_id == 0)  next_flow_id = 1;
+    }
+}
+
+/**
+ * @brief Overwrite an entry with a strict-match flow add in place
+ *
+ * The entry keeps its flow ID and forwarding modifies the installed flow,
+ * so traffic is not interrupted and no flow removed message is sent.
+ * Counters are reset unless the version has OFPFF_RESET_COUNTS and the add
+ * leaves it clear.
+ *
+ * Return 1 if the add was handled, 0 if forwarding cannot modify the
+ * flow in place and it must be deleted and added again.
+ */
+
+static int
+flow_overwrite(ft_entry_t *entry, of_flow_modify_t *obj,
+               indigo_cxn_id_t cxn_id)
+{
+    indigo_error_t rv;
+    uint16_t flags;
+    bool reset_counters;
+
+    rv = indigo_fwd_flow_modify(entry->id, obj);
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_TRACE("Forwarding cannot overwrite flow "
+                  INDIGO_FLOW_ID_PRINTF_FORMAT " in place: %d",
+                  INDIGO_FLOW_ID_PRINTF_ARG(entry->id), rv);
+        return 0;
+    }
+
+    of_flow_modify_flags_get(obj, &flags);
+    reset_counters = !OF_FLOW_MOD_FLAG_RESET_COUNTS_SUPPORTED(obj->version) ||
+        (flags & OF_FLOW_MOD_FLAG_RESET_COUNTS_BY_VERSION(obj->version));
+
+    rv = ft_entry_overwrite(ind_core_ft, entry, obj, reset_counters);
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Failed to overwrite flow " INDIGO_FLOW_ID_PRINTF_FORMAT,
+                  INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+        ind_core_flow_mod_err_msg_send(rv, obj->version, cxn_id, obj);
+        /*
+         * Forwarding has the new flow but the table the old; drop both.
+         * Nothing replaces it, so it is reported as deleted.
+         */
+        ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_DELETE, cxn_id);
+    } else {
+        ind_core_flow_monitor_notify(entry,
+                                     IND_CORE_FLOW_MONITOR_EVENT_MODIFIED,
+                                     INDIGO_FLOW_REMOVED_NONE);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Whether a flow other than entry could be evicted from its table
+ */
+
+static int
+flow_evictable_for(ft_entry_t *entry)
+{
+    ft_entry_t *victim = ft_eviction_victim(ind_core_ft, entry->table_id);
+
+    return victim != NULL && victim != entry;
+}
+
+/**
+ * @brief Evict a flow to make room for a new entry in its table
+ *
+ * Return 1 if a flow was evicted, 0 if the table has no eviction policy
+ * or its policy picks the new entry itself.
+ */
+
+static int
+flow_evict_for(ft_entry_t *entry, indigo_cxn_id_t cxn_id)
+{
+    ft_entry_t *victim;
+
+    victim = ft_eviction_victim(ind_core_ft, entry->table_id);
+    if (victim == NULL || victim == entry) {
+        return 0;
+    }
+
+    LOG_VERBOSE("Evicting flow " INDIGO_FLOW_ID_PRINTF_FORMAT
+                " from table %d", INDIGO_FLOW_ID_PRINTF_ARG(victim->id),
+                victim->table_id);
+    ind_core_ft->status.evictions += 1;
+    ind_core_flow_entry_delete(victim, INDIGO_FLOW_REMOVED_EVICTION, cxn_id);
+
+    return 1;
+}
+
 /**
  * Handle a flow_add message
  * @param cxn_id Connection handler for the owning connection
@@ -444,6 +536,11 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     indigo_flow_id_t  flow_id;
     uint16_t idle_timeout, hard_timeout;
     uint8_t table_id;
+    ind_core_flow_monitor_event_t event = IND_CORE_FLOW_MONITOR_EVENT_ADDED;
+    ft_entry_t *replaced = NULL;
+    indigo_fi_flow_stats_t replaced_stats;
+    indigo_fi_flow_stats_t *replaced_final = &replaced_stats;
+    int added = 0;
 
     obj = (of_flow_modify_t *)_obj;
     ver = obj->version;
@@ -481,21 +578,37 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     }
 
     /* Search table; if match found, replace entry */
-    rv = flow_mod_setup_query(obj, &query, OF_MATCH_STRICT, 1);
+    rv = ind_core_flow_mod_setup_query(obj, &query, OF_MATCH_STRICT, 1);
     if (rv != INDIGO_ERROR_NONE) {
-        LOG_ERROR("flow_mod_setup_query() failed");
+        LOG_ERROR("ind_core_flow_mod_setup_query() failed");
         goto done;
     }
 
-    /* Delete existing flow if any */
+    /* Overwrite existing flow if any, in place if forwarding allows */
     if (ft_strict_match(ind_core_ft, &query, &entry) == INDIGO_ERROR_NONE) {
-        ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_OVERWRITE, cxn_id);
+        if (flow_overwrite(entry, obj, cxn_id)) {
+            goto done;
+        }
+        /*
+         * The old flow leaves forwarding and the table now, but is only
+         * reported once the add is known to have replaced it
+         */
+        if (indigo_fwd_flow_delete(entry->id, &replaced_stats) !=
+                INDIGO_ERROR_NONE) {
+            LOG_ERROR("Error deleting flow, id " INDIGO_FLOW_ID_PRINTF_FORMAT,
+                      INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+            replaced_final = NULL;
+        }
+        ft_detach(ind_core_ft, entry);
+        replaced = entry;
+        /* Monitors see the replacement as a modify, as if in place */
+        event = IND_CORE_FLOW_MONITOR_EVENT_MODIFIED;
     }
 
     /* No match found, add as normal */
     LOG_TRACE("Adding new flow");
 
-    flow_id = flow_id_next();
+    flow_id = ind_core_flow_id_next();
 
     rv = ft_add(ind_core_ft, flow_id, obj, &entry);
     if (rv != INDIGO_ERROR_NONE) {
@@ -503,11 +616,53 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
         goto done;
     }
 
+    /*
+     * A table at its limit takes the add only if another flow can go.
+     * That flow is evicted once the new one is in forwarding, so a failed
+     * create costs the controller nothing.
+     */
+    if (ft_table_over_limit(ind_core_ft, entry->table_id) &&
+            !flow_evictable_for(entry)) {
+        LOG_VERBOSE("Table %d is full", entry->table_id);
+        ind_core_ft->status.table_full_errors += 1;
+        ind_core_flow_mod_err_msg_send(INDIGO_ERROR_RESOURCE, ver, cxn_id,
+                                       obj);
+        ft_delete(ind_core_ft, entry);
+        goto done;
+    }
+
     rv = indigo_fwd_flow_create(flow_id, (of_flow_add_t *)obj, &table_id);
+    if (rv == INDIGO_ERROR_RESOURCE && flow_evict_for(entry, cxn_id)) {
+        /* Forwarding's table is full, so room must be made before trying
+           again */
+        rv = indigo_fwd_flow_create(flow_id, (of_flow_add_t *)obj, &table_id);
+    }
     if (rv == INDIGO_ERROR_NONE) {
         LOG_TRACE("Flow table now has %d entries",
                   FT_STATUS(ind_core_ft)->current_count);
-        entry->table_id = table_id;
+        rv = ft_entry_set_table_id(ind_core_ft, entry, table_id);
+        if (rv != INDIGO_ERROR_NONE) {
+            LOG_ERROR("Failed to set table ID of flow " INDIGO_FLOW_ID_PRINTF_FORMAT,
+                      INDIGO_FLOW_ID_PRINTF_ARG(flow_id));
+            ind_core_flow_mod_err_msg_send(rv, obj->version, cxn_id,
+                                           (of_flow_modify_t *)obj);
+            /* Rejected add; no flow removed message */
+            ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_OVERWRITE,
+                                       cxn_id);
+        } else if (ft_table_over_limit(ind_core_ft, entry->table_id) &&
+                   !flow_evict_for(entry, cxn_id)) {
+            /* Only if forwarding placed it in another, full table */
+            LOG_VERBOSE("Table %d is full", entry->table_id);
+            ind_core_ft->status.table_full_errors += 1;
+            ind_core_flow_mod_err_msg_send(INDIGO_ERROR_RESOURCE, ver, cxn_id,
+                                           obj);
+            ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_OVERWRITE,
+                                       cxn_id);
+        } else {
+            added = 1;
+            ind_core_flow_monitor_notify(entry, event,
+                                         INDIGO_FLOW_REMOVED_NONE);
+        }
     } else { /* Error during insertion at forwarding layer */
        uint32_t xid;
 
@@ -515,14 +670,22 @@ ind_core_flow_add_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
        ind_core_ft->status.forwarding_add_errors += 1;
 
        of_flow_add_xid_get(obj, &xid);
-       flow_mod_err_msg_send(rv, obj->version, cxn_id,
-                             (of_flow_modify_t *)obj);
+       ind_core_flow_mod_err_msg_send(rv, obj->version, cxn_id,
+                                      (of_flow_modify_t *)obj);
 
        /* Free entry in local flow table */
        ft_delete(ind_core_ft, entry);
     }
 
 done:
+    if (replaced != NULL) {
+        /* A flow whose replacement did not go in was just deleted */
+        ind_core_flow_removed_notify(replaced, replaced_final,
+                                     added ? INDIGO_FLOW_REMOVED_OVERWRITE :
+                                     INDIGO_FLOW_REMOVED_DELETE);
+        ft_free(ind_core_ft, replaced);
+    }
+
     of_object_delete(_obj);
 
     return INDIGO_ERROR_NONE;
@@ -537,9 +700,10 @@ done:
  * @param flow_mod Request that failed
  */
 
-static void
-flow_mod_err_msg_send(indigo_error_t indigo_err, of_version_t ver,
-                      indigo_cxn_id_t cxn_id, of_flow_modify_t *flow_mod)
+void
+ind_core_flow_mod_err_msg_send(indigo_error_t indigo_err, of_version_t ver,
+                               indigo_cxn_id_t cxn_id,
+                               of_flow_modify_t *flow_mod)
 {
     unsigned char errmsgf = 0;
     unsigned code;
@@ -601,11 +765,16 @@ modify_iter_cb(void *cookie, ft_entry_t *entry)
         state->num_matched++;
         rv = indigo_fwd_flow_modify(entry->id, state->request);
         if (rv == INDIGO_ERROR_NONE) {
-            ft_entry_modify_effects(ind_core_ft, entry, state->request);
+            if (ft_entry_modify_effects(ind_core_ft, entry,
+                                        state->request) == INDIGO_ERROR_NONE) {
+                ind_core_flow_monitor_notify(
+                    entry, IND_CORE_FLOW_MONITOR_EVENT_MODIFIED,
+                    INDIGO_FLOW_REMOVED_NONE);
+            }
         } else {
             LOG_TRACE("Flow modify error: %d", rv);
-            flow_mod_err_msg_send(rv, state->request->version,
-                                  state->cxn_id, state->request);
+            ind_core_flow_mod_err_msg_send(rv, state->request->version,
+                                           state->cxn_id, state->request);
         }
     } else {
         if (state->num_matched == 0) {
@@ -645,7 +814,7 @@ ind_core_flow_modify_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     state->num_matched = 0;
     state->cxn_id = cxn_id;
 
-    rv = flow_mod_setup_query(obj, &query, OF_MATCH_NON_STRICT, 1);
+    rv = ind_core_flow_mod_setup_query(obj, &query, OF_MATCH_NON_STRICT, 1);
     if (rv != INDIGO_ERROR_NONE) {
         of_object_delete(_obj);
         INDIGO_MEM_FREE(state);
@@ -684,7 +853,7 @@ ind_core_flow_modify_strict_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     LOG_TRACE("Handling of_flow_modify_strict message.");
 
     /* Form the query */
-    rv = flow_mod_setup_query(obj, &query, OF_MATCH_STRICT, 1);
+    rv = ind_core_flow_mod_setup_query(obj, &query, OF_MATCH_STRICT, 1);
     if (rv != INDIGO_ERROR_NONE) {
         goto done;
     }
@@ -698,10 +867,15 @@ ind_core_flow_modify_strict_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
 
     rv = indigo_fwd_flow_modify(entry->id, obj);
     if (rv == INDIGO_ERROR_NONE) {
-        ft_entry_modify_effects(ind_core_ft, entry, obj);
+        if (ft_entry_modify_effects(ind_core_ft, entry,
+                                    obj) == INDIGO_ERROR_NONE) {
+            ind_core_flow_monitor_notify(entry,
+                                         IND_CORE_FLOW_MONITOR_EVENT_MODIFIED,
+                                         INDIGO_FLOW_REMOVED_NONE);
+        }
     } else {
         LOG_TRACE("Flow modify error: %d", rv);
-        flow_mod_err_msg_send(rv, obj->version, cxn_id, obj);
+        ind_core_flow_mod_err_msg_send(rv, obj->version, cxn_id, obj);
     }
 
  done:
@@ -756,8 +930,8 @@ ind_core_flow_delete_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     state->cxn_id = cxn_id;
 
     /* Form the query and call mark entries */
-    rv = flow_mod_setup_query((of_flow_modify_t *)flow_del, &query,
-                              OF_MATCH_NON_STRICT, 0);
+    rv = ind_core_flow_mod_setup_query((of_flow_modify_t *)flow_del, &query,
+                                       OF_MATCH_NON_STRICT, 0);
     if (rv != INDIGO_ERROR_NONE) {
         of_object_delete(state->request);
         INDIGO_MEM_FREE(state);
@@ -795,7 +969,8 @@ ind_core_flow_delete_strict_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     LOG_TRACE("Handling of_flow_delete_strict message: %p.", obj);
 
     /* Form the query and call mark entries */
-    rv = flow_mod_setup_query((of_flow_modify_t *)obj, &query, OF_MATCH_STRICT, 0);
+    rv = ind_core_flow_mod_setup_query((of_flow_modify_t *)obj, &query,
+                                       OF_MATCH_STRICT, 0);
     if (rv != INDIGO_ERROR_NONE) {
         of_object_delete(_obj);
         return rv;
@@ -872,20 +1047,129 @@ ind_core_get_config_request_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     return INDIGO_ERROR_NONE;
 }
 
+/**
+ * Build a flow mod of the given type that reinstalls an entry's
+ * effects, or its whole flow for a flow_add
+ *
+ * Returns NULL if out of memory.
+ */
+
+of_flow_modify_t *
+ind_core_flow_mod_from_entry(ft_entry_t *entry, of_object_id_t object_id)
+{
+    of_flow_modify_t *obj;
+    of_version_t version = entry->cold->effects.actions->version;
+    of_match_t match;
+    int rv;
+
+    if (object_id == OF_FLOW_ADD) {
+        obj = of_flow_add_new(version);
+    } else {
+        obj = of_flow_modify_strict_new(version);
+    }
+    if (obj == NULL) {
+        return NULL;
+    }
+
+    /* The flow_add accessors apply to every flow mod */
+    of_flow_add_cookie_set(obj, entry->cookie);
+    of_flow_add_priority_set(obj, entry->priority);
+    of_flow_add_idle_timeout_set(obj, entry->idle_timeout);
+    of_flow_add_hard_timeout_set(obj, entry->hard_timeout);
+    of_flow_add_flags_set(obj, entry->flags);
+    if (version >= OF_VERSION_1_1) {
+        of_flow_add_table_id_set(obj, entry->table_id);
+    }
+
+    ft_entry_match_get(entry, &match);
+    rv = of_flow_add_match_set(obj, &match);
+    if (rv == OF_ERROR_NONE) {
+        if (version == OF_VERSION_1_0) {
+            rv = of_flow_add_actions_set(obj, entry->cold->effects.actions);
+        } else {
+            rv = of_flow_add_instructions_set(
+                obj, entry->cold->effects.instructions);
+        }
+    }
+    if (rv != OF_ERROR_NONE) {
+        of_object_delete(obj);
+        return NULL;
+    }
+
+    return obj;
+}
+
 /****************************************************************/
 
+/**
+ * Fill in a flow stats entry from a flow table entry
+ *
+ * The effects are only included if they have the stats entry's version.
+ * Returns an error if the match or effects could not be set.
+ */
+
+indigo_error_t
+ind_core_flow_stats_entry_populate(of_flow_stats_entry_t *stats_entry,
+                                   ft_entry_t *entry, indigo_time_t now,
+                                   uint64_t packets, uint64_t bytes)
+{
+    uint32_t secs, nsecs;
+    of_match_t match;
+
+    calc_duration(now, entry->insert_time, &secs, &nsecs);
+
+    of_flow_stats_entry_cookie_set(stats_entry, entry->cookie);
+    of_flow_stats_entry_priority_set(stats_entry, entry->priority);
+    of_flow_stats_entry_idle_timeout_set(stats_entry, entry->idle_timeout);
+    of_flow_stats_entry_hard_timeout_set(stats_entry, entry->hard_timeout);
+
+    if (stats_entry->version >= OF_VERSION_1_3) {
+        of_flow_stats_entry_flags_set(stats_entry, entry->flags);
+    }
+
+    ft_entry_match_get(entry, &match);
+    if (of_flow_stats_entry_match_set(stats_entry, &match)) {
+        LOG_ERROR("Failed to set match in flow stats entry");
+        return INDIGO_ERROR_UNKNOWN;
+    }
+
+    if (stats_entry->version == entry->cold->effects.actions->version) {
+        if (stats_entry->version == OF_VERSION_1_0) {
+            if (of_flow_stats_entry_actions_set(
+                    stats_entry, entry->cold->effects.actions) < 0) {
+                LOG_ERROR("Failed to set actions list of flow stats entry");
+                return INDIGO_ERROR_UNKNOWN;
+            }
+        } else {
+            if (of_flow_stats_entry_instructions_set(
+                    stats_entry, entry->cold->effects.instructions) < 0) {
+                LOG_ERROR("Failed to set instructions list of flow stats entry");
+                return INDIGO_ERROR_UNKNOWN;
+            }
+        }
+    }
+
+    of_flow_stats_entry_table_id_set(stats_entry, entry->table_id);
+    of_flow_stats_entry_duration_sec_set(stats_entry, secs);
+    of_flow_stats_entry_duration_nsec_set(stats_entry, nsecs);
+    of_flow_stats_entry_packet_count_set(stats_entry, packets);
+    of_flow_stats_entry_byte_count_set(stats_entry, bytes);
+
+    return INDIGO_ERROR_NONE;
+}
+
 struct ind_core_flow_stats_state {
     indigo_cxn_id_t cxn_id;
     of_flow_stats_request_t *req;
     indigo_time_t current_time;
     of_flow_stats_reply_t *reply;
+    bool counters_read; /* Walking every flow and no counter read failed */
 };
 
-static void
+static indigo_error_t
 ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
 {
     struct ind_core_flow_stats_state *state = cookie;
-    uint32_t secs, nsecs;
     indigo_fi_flow_stats_t flow_stats;
     indigo_error_t rv;
 
@@ -902,7 +1186,7 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
                 of_flow_stats_request_delete(state->req);
                 INDIGO_MEM_FREE(state);
             }
-            return;
+            return INDIGO_ERROR_RESOURCE;
         }
 
         of_flow_stats_request_xid_get(state->req, &xid);
@@ -911,6 +1195,10 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
     }
 
     if (entry == NULL) {
+        if (state->counters_read) {
+            ind_core_counters_read(state->current_time);
+        }
+
         /* Send last reply */
         of_flow_stats_reply_flags_set(state->reply, 0);
         IND_CORE_MSG_SEND(state->cxn_id, state->reply);
@@ -918,27 +1206,30 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
         /* Clean up state */
         of_flow_stats_request_delete(state->req);
         INDIGO_MEM_FREE(state);
-        return;
+        return INDIGO_ERROR_NONE;
     }
 
     rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
+    if (rv == INDIGO_ERROR_PENDING) {
+        return rv;
+    }
     if (rv != INDIGO_ERROR_NONE) {
         LOG_ERROR("Failed to get stats for flow "INDIGO_FLOW_ID_PRINTF_FORMAT": %d",
                   entry->id, rv);
-        return;
+        state->counters_read = false;
+        return rv;
     }
+    ft_entry_counters_set(ind_core_ft, entry, flow_stats.packets,
+                          flow_stats.bytes, state->current_time);
 
     /* Skip entry if stats request version is not equal to entry version */
-    if (state->req->version != entry->effects.actions->version) {
+    if (state->req->version != entry->cold->effects.actions->version) {
         LOG_TRACE("Stats request version (%d) differs from entry version (%d). "
                   "Entry is skipped.",
-                  state->req->version, entry->effects.actions->version);
-        return;
+                  state->req->version, entry->cold->effects.actions->version);
+        return INDIGO_ERROR_NONE;
     }
 
-    /* TODO use time from flow_stats? */
-    calc_duration(state->current_time, entry->insert_time, &secs, &nsecs);
-
     /* Set up the structures to append an entry to the list */
     {
         of_list_flow_stats_entry_t list;
@@ -947,50 +1238,24 @@ ind_core_flow_stats_iter(void *cookie, ft_entry_t *entry)
         of_flow_stats_entry_init(&stats_entry, state->reply->version, -1, 1);
         if (of_list_flow_stats_entry_append_bind(&list, &stats_entry)) {
             LOG_ERROR("failed to append to flow stats list");
-            return;
-        }
-
-        of_flow_stats_entry_cookie_set(&stats_entry, entry->cookie);
-        of_flow_stats_entry_priority_set(&stats_entry, entry->priority);
-        of_flow_stats_entry_idle_timeout_set(&stats_entry, entry->idle_timeout);
-        of_flow_stats_entry_hard_timeout_set(&stats_entry, entry->hard_timeout);
-
-        if (stats_entry.version >= OF_VERSION_1_3) {
-            of_flow_stats_entry_flags_set(&stats_entry, entry->flags);
-        }
-
-        if (of_flow_stats_entry_match_set(&stats_entry, &entry->match)) {
-            LOG_ERROR("Failed to set match in flow stats entry");
-            return;
+            return INDIGO_ERROR_UNKNOWN;
         }
 
-        if (stats_entry.version == entry->effects.actions->version) {
-            if (stats_entry.version == OF_VERSION_1_0) {
-                if (of_flow_stats_entry_actions_set(
-                        &stats_entry, entry->effects.actions) < 0) {
-                    LOG_ERROR("Failed to set actions list of flow stats entry");
-                    return;
-                }
-            } else {
-                if (of_flow_stats_entry_instructions_set(
-                        &stats_entry, entry->effects.instructions) < 0) {
-                    LOG_ERROR("Failed to set instructions list of flow stats entry");
-                    return;
-                }
-            }
+        /* TODO use time from flow_stats? */
+        if (ind_core_flow_stats_entry_populate(&stats_entry, entry,
+                                               state->current_time,
+                                               entry->cold->packets,
+                                               entry->cold->bytes) < 0) {
+            return INDIGO_ERROR_UNKNOWN;
         }
-
-        of_flow_stats_entry_table_id_set(&stats_entry, entry->table_id);
-        of_flow_stats_entry_duration_sec_set(&stats_entry, secs);
-        of_flow_stats_entry_duration_nsec_set(&stats_entry, nsecs);
-        of_flow_stats_entry_packet_count_set(&stats_entry, flow_stats.packets);
-        of_flow_stats_entry_byte_count_set(&stats_entry, flow_stats.bytes);
     }
 
     if (state->reply->length > (1 << 15)) { /* Last object would get too big */
         IND_CORE_MSG_SEND(state->cxn_id, state->reply);
         state->reply = NULL;
     }
+
+    return INDIGO_ERROR_NONE;
 }
 
 /**
@@ -1039,9 +1304,10 @@ ind_core_flow_stats_request_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     state->cxn_id = cxn_id;
     state->current_time = INDIGO_CURRENT_TIME;
     state->reply = NULL;
+    state->counters_read = ft_query_all(&query);
 
-    rv = ft_spawn_iter_task(ind_core_ft, &query, ind_core_flow_stats_iter, 
-                            state, IND_SOC_DEFAULT_PRIORITY);
+    rv = ft_spawn_wait_iter_task(ind_core_ft, &query, ind_core_flow_stats_iter,
+                                 state, IND_SOC_DEFAULT_PRIORITY);
     if (rv != INDIGO_ERROR_NONE) {
         LOG_ERROR("Failed to start flow stats iter.");
         of_object_delete(_obj);
@@ -1083,9 +1349,32 @@ struct ind_core_aggregate_stats_state {
     uint32_t flows;
     indigo_cxn_id_t cxn_id;
     of_aggregate_stats_request_t *req;
+    indigo_time_t start;
+    bool counters_read; /* Walking every flow and no counter read failed */
 };
 
 static void
+ind_core_aggregate_stats_reply_send(of_aggregate_stats_request_t *req,
+                                    indigo_cxn_id_t cxn_id, uint64_t packets,
+                                    uint64_t bytes, uint32_t flows)
+{
+    uint32_t xid;
+    of_aggregate_stats_reply_t* reply;
+
+    of_aggregate_stats_request_xid_get(req, &xid);
+    reply = of_aggregate_stats_reply_new(req->version);
+    if (reply != NULL) {
+        of_aggregate_stats_reply_xid_set(reply, xid);
+        of_aggregate_stats_reply_byte_count_set(reply, bytes);
+        of_aggregate_stats_reply_packet_count_set(reply, packets);
+        of_aggregate_stats_reply_flow_count_set(reply, flows);
+        IND_CORE_MSG_SEND(cxn_id, reply);
+    } else {
+        LOG_ERROR("Failed to allocate aggregate stats reply.");
+    }
+}
+
+static indigo_error_t
 ind_core_aggregate_stats_iter(void *cookie, ft_entry_t *entry)
 {
     struct ind_core_aggregate_stats_state *state = cookie;
@@ -1094,32 +1383,33 @@ ind_core_aggregate_stats_iter(void *cookie, ft_entry_t *entry)
     if (entry != NULL) {
         indigo_fi_flow_stats_t flow_stats;
         rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
+        if (rv == INDIGO_ERROR_PENDING) {
+            return rv;
+        }
         if (rv != INDIGO_ERROR_NONE) {
             LOG_ERROR("Failed to get stats for flow "INDIGO_FLOW_ID_PRINTF_FORMAT": %d",
                       entry->id, rv);
-            return;
+            state->counters_read = false;
+            return rv;
         }
+        ft_entry_counters_set(ind_core_ft, entry, flow_stats.packets,
+                              flow_stats.bytes, INDIGO_CURRENT_TIME);
 
-        state->bytes += flow_stats.bytes;
-        state->packets += flow_stats.packets;
+        state->bytes += entry->cold->bytes;
+        state->packets += entry->cold->packets;
         state->flows += 1;
     } else {
-        uint32_t xid;
-        of_aggregate_stats_reply_t* reply;
-        of_aggregate_stats_request_xid_get(state->req, &xid);
-        reply = of_aggregate_stats_reply_new(state->req->version);
-        if (reply != NULL) {
-            of_aggregate_stats_reply_xid_set(reply, xid);
-            of_aggregate_stats_reply_byte_count_set(reply, state->bytes);
-            of_aggregate_stats_reply_packet_count_set(reply, state->packets);
-            of_aggregate_stats_reply_flow_count_set(reply, state->flows);
-            IND_CORE_MSG_SEND(state->cxn_id, reply);
-        } else {
-            LOG_ERROR("Failed to allocate aggregate stats reply.");
+        if (state->counters_read) {
+            ind_core_counters_read(state->start);
         }
+        ind_core_aggregate_stats_reply_send(state->req, state->cxn_id,
+                                            state->packets, state->bytes,
+                                            state->flows);
         of_aggregate_stats_request_delete(state->req);
         INDIGO_MEM_FREE(state);
     }
+
+    return INDIGO_ERROR_NONE;
 }
 
 /**
@@ -1158,6 +1448,24 @@ ind_core_aggregate_stats_request_handler(of_object_t *_obj,
     /* Non strict; do not check priority or overlap */
     query.mode = OF_MATCH_NON_STRICT;
 
+    /*
+     * Whole table, table and exact cookie queries are answered from the
+     * running totals when those are being refreshed or every flow's
+     * counters were read recently by another stats request
+     */
+    if (ind_core_counters_current()) {
+        ft_aggregate_t aggregate;
+        if (ft_aggregate_get(ind_core_ft, &query, &aggregate) ==
+                INDIGO_ERROR_NONE) {
+            ind_core_aggregate_stats_reply_send(obj, cxn_id,
+                                                aggregate.packets,
+                                                aggregate.bytes,
+                                                aggregate.flow_count);
+            of_object_delete(_obj);
+            return INDIGO_ERROR_NONE;
+        }
+    }
+
     state = INDIGO_MEM_ALLOC(sizeof(*state));
     if (state == NULL) {
        LOG_ERROR("Failed to allocate flow stats state object.");
@@ -1170,9 +1478,12 @@ ind_core_aggregate_stats_request_handler(of_object_t *_obj,
     state->packets = 0;
     state->bytes = 0;
     state->flows = 0;
+    state->start = INDIGO_CURRENT_TIME;
+    state->counters_read = ft_query_all(&query);
 
-    rv = ft_spawn_iter_task(ind_core_ft, &query, ind_core_aggregate_stats_iter,
-                            state, IND_SOC_DEFAULT_PRIORITY);
+    rv = ft_spawn_wait_iter_task(ind_core_ft, &query,
+                                 ind_core_aggregate_stats_iter, state,
+                                 IND_SOC_DEFAULT_PRIORITY);
     if (rv != INDIGO_ERROR_NONE) {
         LOG_ERROR("Failed to start aggregate stats iter.");
         of_object_delete(_obj);
@@ -1422,11 +1733,11 @@ ind_core_set_config_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
  * @param _obj Generic type object for the message to be coerced
  * @returns Error code
  *
- * The state manager has no specific support for experimenter messages.
- * However, the port or forwarding modules may have that support
- * independent of the state manager.  For this reason, the state
- * manager calls both the port manager and forwarding modules with
- * the request.
+ * The state manager itself only handles the flow monitor and bundle
+ * extensions (see ofstatemanager.h).  However, the port or forwarding modules may have
+ * support for others independent of the state manager.  For this reason,
+ * the state manager calls both the port manager and forwarding modules
+ * with any other request.
  *
  * Currently there is no support for asynchronous experimenter message
  * handling at this layer (so barriers currently will not track experimenter
@@ -1461,6 +1772,13 @@ ind_core_experimenter_handler(of_object_t *_obj, indigo_cxn_id_t cxn_id)
     of_version_t version;
 
     fwd_obj = (of_experimenter_t *)_obj;
+
+    if (ind_core_flow_monitor_handler(fwd_obj, cxn_id) ||
+            ind_core_bundle_handler(fwd_obj, cxn_id)) {
+        of_experimenter_delete(fwd_obj);
+        return INDIGO_ERROR_NONE;
+    }
+
     port_obj = of_object_dup(_obj);
 
     if (port_obj == NULL) {
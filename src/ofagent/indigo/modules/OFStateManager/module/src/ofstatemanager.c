@@ -41,6 +41,9 @@
 #include "ft.h"
 
 static void flow_expiration_timer(void *cookie);
+static void expire_audit_timer(void *cookie);
+static void counter_refresh_timer(void *cookie);
+static void state_save_timer(void *cookie);
 
 static void
 process_flow_removal(ft_entry_t *entry,
@@ -73,6 +76,24 @@ static uint32_t ind_core_flow_mods = 0;
 static uint32_t ind_core_packet_ins = 0;
 static uint32_t ind_core_packet_outs = 0;
 
+/**
+ * @brief Counter refresh state
+ *
+ * A refresh walks the whole flow table fetching counters from forwarding.
+ * At most one runs at a time; ind_core_counter_refreshes counts the
+ * completed ones.
+ *
+ * Flow and aggregate stats requests for all flows read every counter
+ * too. ind_core_counters_read_time is when the latest of any of these
+ * full reads to complete started, so the running totals are at least as
+ * fresh as that.
+ */
+static int ind_core_counter_refresh_running = 0;
+static uint32_t ind_core_counter_refreshes = 0;
+static indigo_time_t ind_core_counter_refresh_start;
+static int ind_core_counters_read_valid = 0;
+static indigo_time_t ind_core_counters_read_time;
+
 
 /**
  * Maintain the current connection count.
@@ -136,15 +157,17 @@ static void
 send_flow_removed_message(ft_entry_t *entry, indigo_fi_flow_removed_t reason)
 {
     of_flow_removed_t *msg;
+    of_match_t match;
     int rv = 0;
     uint32_t secs;
     uint32_t nsecs;
     indigo_time_t current;
 
     current = INDIGO_CURRENT_TIME;
+    ft_entry_match_get(entry, &match);
 
     /* TODO get version from OFConnectionManager */
-    if ((msg = of_flow_removed_new(entry->match.version)) == NULL) {
+    if ((msg = of_flow_removed_new(match.version)) == NULL) {
         return;
     }
 
@@ -164,21 +187,21 @@ send_flow_removed_message(ft_entry_t *entry, indigo_fi_flow_removed_t reason)
         of_flow_removed_hard_timeout_set(msg, entry->hard_timeout);
     }
 
-    if (of_flow_removed_match_set(msg, &entry->match)) {
+    if (of_flow_removed_match_set(msg, &match)) {
         LOG_ERROR("Failed to set match in flow removed message");
         of_object_delete(msg);
         return;
     }
 
     if (reason > INDIGO_FLOW_REMOVED_DELETE) {
-        /* Normalize entry */
+        /* Normalize entry; OFPRR_EVICTION is new in OF 1.4 */
         reason = INDIGO_FLOW_REMOVED_DELETE;
     }
     of_flow_removed_reason_set(msg, reason);
     of_flow_removed_duration_sec_set(msg, secs);
     of_flow_removed_duration_nsec_set(msg, nsecs);
-    of_flow_removed_packet_count_set(msg, entry->packets);
-    of_flow_removed_byte_count_set(msg, entry->bytes);
+    of_flow_removed_packet_count_set(msg, entry->cold->packets);
+    of_flow_removed_byte_count_set(msg, entry->cold->bytes);
 
     /* @fixme hard_timeout and table_id are not in OF 1.0 */
 
@@ -481,8 +504,9 @@ ind_core_init(ind_core_config_t *config)
         /* Default value */
         config->max_flowtable_entries = 16384;
     }
-    ft_config.strict_match_bucket_count = config->max_flowtable_entries;
-    ft_config.flow_id_bucket_count = config->max_flowtable_entries;
+    /* Indexes start small and resize with the number of flows */
+    ft_config.strict_match_bucket_count = 0;
+    ft_config.flow_id_bucket_count = 0;
 
     if ((ind_core_ft = ft_create(&ft_config)) == NULL) {
         LOG_ERROR("Unable to allocate flow table\n");
@@ -491,6 +515,14 @@ ind_core_init(ind_core_config_t *config)
 
     ind_core_connection_count = 0;
 
+    if (ind_core_flow_monitor_init() != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Unable to register for flow monitor connection changes");
+    }
+
+    if (ind_core_bundle_init() != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Unable to register for bundle connection changes");
+    }
+
     ind_core_init_done = 1;
 
     return INDIGO_ERROR_NONE;
@@ -528,32 +560,51 @@ ind_core_flow_entry_delete(ft_entry_t *entry, indigo_fi_flow_removed_t reason,
 }
 
 /**
- * @brief Process a flow removal from the local flow table
+ * @brief Record the final counters of a removed flow and notify the
+ * controller if the flow asked for it
  */
 
-static void
-process_flow_removal(ft_entry_t *entry,
-                     indigo_fi_flow_stats_t *final_stats,
-                     indigo_fi_flow_removed_t reason)
+void
+ind_core_flow_removed_notify(ft_entry_t *entry,
+                             indigo_fi_flow_stats_t *final_stats,
+                             indigo_fi_flow_removed_t reason)
 {
-    indigo_error_t rv;
-
     if (entry->flags & OF_FLOW_MOD_FLAG_SEND_FLOW_REM) {
         /* See OF spec 1.0.1, section 3.5, page 6 */
         if (reason != INDIGO_FLOW_REMOVED_OVERWRITE) {
             if (final_stats != NULL) {
                 INDIGO_ASSERT(final_stats->flow_id == entry->id);
-                entry->packets = final_stats->packets;
-                entry->bytes = final_stats->bytes;
+                ft_entry_counters_set(ind_core_ft, entry, final_stats->packets,
+                                      final_stats->bytes, INDIGO_CURRENT_TIME);
             } else {
-                entry->packets = (uint64_t)-1;
-                entry->bytes = (uint64_t)-1;
+                ft_entry_counters_set(ind_core_ft, entry, (uint64_t)-1,
+                                      (uint64_t)-1, INDIGO_CURRENT_TIME);
             }
 
             send_flow_removed_message(entry, reason);
         }
     }
 
+    /* A flow replaced by an add is reported as modified when it is added */
+    if (reason != INDIGO_FLOW_REMOVED_OVERWRITE) {
+        ind_core_flow_monitor_notify(entry, IND_CORE_FLOW_MONITOR_EVENT_REMOVED,
+                                     reason);
+    }
+}
+
+/**
+ * @brief Process a flow removal from the local flow table
+ */
+
+static void
+process_flow_removal(ft_entry_t *entry,
+                     indigo_fi_flow_stats_t *final_stats,
+                     indigo_fi_flow_removed_t reason)
+{
+    indigo_error_t rv;
+
+    ind_core_flow_removed_notify(entry, final_stats, reason);
+
     rv = ft_delete(ind_core_ft, entry);
     if (rv != INDIGO_ERROR_NONE) {
         LOG_ERROR("Error deleting flow from state mgr. id: "
@@ -600,6 +651,14 @@ indigo_core_flow_removed(indigo_fi_flow_removed_t reason,
 #define CORE_EXPIRES_FLOWS(_cfg) \
     ((_cfg)->expire_flows && ((_cfg)->stats_check_ms > 0))
 
+#define CORE_REFRESHES_COUNTERS(_cfg) ((_cfg)->counter_refresh_ms > 0)
+
+#define CORE_AUDITS_EXPIRES(_cfg) \
+    (!(_cfg)->expire_flows && ((_cfg)->expire_audit_ms > 0))
+
+#define CORE_SAVES_STATE(_cfg) \
+    ((_cfg)->state_file != NULL && ((_cfg)->state_save_ms > 0))
+
 indigo_error_t
 ind_core_enable_set(int enable)
 {
@@ -614,12 +673,36 @@ ind_core_enable_set(int enable)
                 flow_expiration_timer, NULL,
                 ind_core_config.stats_check_ms, -10);
         }
+        if (CORE_AUDITS_EXPIRES(&ind_core_config)) {
+            ind_soc_timer_event_register_with_priority(
+                expire_audit_timer, NULL,
+                ind_core_config.expire_audit_ms, -10);
+        }
+        if (CORE_REFRESHES_COUNTERS(&ind_core_config)) {
+            ind_soc_timer_event_register_with_priority(
+                counter_refresh_timer, NULL,
+                ind_core_config.counter_refresh_ms, -10);
+        }
+        if (CORE_SAVES_STATE(&ind_core_config)) {
+            ind_soc_timer_event_register_with_priority(
+                state_save_timer, NULL,
+                ind_core_config.state_save_ms, -10);
+        }
         ind_core_module_enabled = 1;
     } else if (!enable && ind_core_module_enabled) {
         LOG_INFO("Disabling OF state mgr");
         if (CORE_EXPIRES_FLOWS(&ind_core_config)) {
             ind_soc_timer_event_unregister(flow_expiration_timer, NULL);
         }
+        if (CORE_AUDITS_EXPIRES(&ind_core_config)) {
+            ind_soc_timer_event_unregister(expire_audit_timer, NULL);
+        }
+        if (CORE_REFRESHES_COUNTERS(&ind_core_config)) {
+            ind_soc_timer_event_unregister(counter_refresh_timer, NULL);
+        }
+        if (CORE_SAVES_STATE(&ind_core_config)) {
+            ind_soc_timer_event_unregister(state_save_timer, NULL);
+        }
         ind_core_module_enabled = 0;
     } else {
         LOG_VERBOSE("Redundant enable call.  Currently %s",
@@ -654,6 +737,12 @@ ind_core_finish(void)
         ind_core_enable_set(0);
     }
 
+    if (ind_core_init_done && ind_core_config.state_file != NULL) {
+        ind_core_state_save_flush(ind_core_config.state_file);
+    }
+
+    ind_core_flow_monitor_finish();
+    ind_core_bundle_finish();
     ft_destroy(ind_core_ft);
 
     ind_core_init_done = 0;
@@ -807,6 +896,40 @@ ind_core_serial_num_get(of_serial_num_t serial_num)
     return INDIGO_ERROR_NONE;
 }
 
+indigo_error_t
+ind_core_table_eviction_set(uint8_t table_id, ind_core_eviction_t eviction,
+                            int max_entries)
+{
+    ft_eviction_t ft_eviction;
+
+    if (!ind_core_init_done) {
+        return INDIGO_ERROR_INIT;
+    }
+
+    switch (eviction) {
+    case IND_CORE_EVICTION_NONE:
+        ft_eviction = FT_EVICTION_NONE;
+        break;
+    case IND_CORE_EVICTION_LRU:
+        ft_eviction = FT_EVICTION_LRU;
+        break;
+    case IND_CORE_EVICTION_PRIORITY:
+        ft_eviction = FT_EVICTION_PRIORITY;
+        break;
+    case IND_CORE_EVICTION_EXPIRE:
+        ft_eviction = FT_EVICTION_EXPIRE;
+        break;
+    default:
+        return INDIGO_ERROR_PARAM;
+    }
+
+    if (max_entries < 0) {
+        return INDIGO_ERROR_PARAM;
+    }
+
+    return ft_table_eviction_set(ind_core_ft, table_id, ft_eviction,
+                                 max_entries);
+}
 
 /**
  * Set/get the disconnected mode
@@ -936,75 +1059,248 @@ ind_core_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
 }
 
 /**
- * Timer operation to expire flows.
+ * Check the timeouts of one flow that the timing wheel reported as due.
  *
- * Calls indigo_fwd_flow_stats_get for each flow in the table. The expiration
- * is done in flow_expiration_timer_cb when the reply is received.
- *
- * Ignore this call if the module is not enabled.
+ * The entry is either deleted or rescheduled. An audit passes its period
+ * as grace_ms: timeouts are judged as of that long ago, so only flows
+ * forwarding should have expired well before now are removed, while
+ * counters are stamped with the real time. A flow that forwarding no
+ * longer has is then taken to have idled out.
  */
 static void
-flow_expiration_timer(void *cookie)
+flow_expiration_check(ft_entry_t *entry, indigo_time_t current_time,
+                      indigo_time_t grace_ms)
 {
-    ft_entry_t *entry;
-    list_links_t *cur, *next;
-    indigo_time_t current_time = INDIGO_CURRENT_TIME;
-
-    if (!ind_core_module_enabled) {
-        return;
+    indigo_error_t rv;
+    indigo_fi_flow_stats_t flow_stats;
+    bool counters_changed = false;
+    bool audit = grace_ms > 0;
+    indigo_time_t expiry_time = current_time - grace_ms;
+
+    if (entry->hard_timeout > 0) {
+        uint32_t delta;
+        delta = INDIGO_TIME_DIFF_ms(entry->insert_time,
+                                    expiry_time) / 1000;
+        if (delta >= entry->hard_timeout) {
+            LOG_TRACE("Hard TO (%d): " INDIGO_FLOW_ID_PRINTF_FORMAT,
+                      entry->hard_timeout,
+                      INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+            ind_core_ft->status.hard_expires += 1;
+            ind_core_ft->status.audit_expires += audit;
+            ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_HARD_TIMEOUT,
+                                       INDIGO_CXN_ID_UNSPECIFIED);
+            return;
+        }
     }
 
-    FT_ITER(ind_core_ft, entry, cur, next) {
-        indigo_error_t rv;
-        indigo_fi_flow_stats_t flow_stats;
-
-        if (entry->hard_timeout > 0) {
-            uint32_t delta;
-            delta = INDIGO_TIME_DIFF_ms(entry->insert_time,
-                                        current_time) / 1000;
-            if (delta >= entry->hard_timeout) {
-                LOG_TRACE("Hard TO (%d): " INDIGO_FLOW_ID_PRINTF_FORMAT,
-                          entry->hard_timeout,
-                          INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
-                ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_HARD_TIMEOUT,
-                                           INDIGO_CXN_ID_UNSPECIFIED);
-                continue;
-            }
+    /* Update local copy of counters */
+    /* Only used currently for idle timeouts */
+    if (entry->idle_timeout > 0) {
+        rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
+        if (rv == INDIGO_ERROR_NOT_FOUND && audit) {
+            LOG_VERBOSE("Idle TO missed by forwarding: "
+                        INDIGO_FLOW_ID_PRINTF_FORMAT,
+                        INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+            ind_core_ft->status.idle_expires += 1;
+            ind_core_ft->status.audit_expires += 1;
+            process_flow_removal(entry, NULL,
+                                 INDIGO_FLOW_REMOVED_IDLE_TIMEOUT);
+            return;
         }
-
-        /* Update local copy of counters */
-        /* Only used currently for idle timeouts */
-        if (entry->idle_timeout > 0) {
-            rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
-            if (rv != INDIGO_ERROR_NONE) {
+        if (rv != INDIGO_ERROR_NONE) {
+            if (rv != INDIGO_ERROR_PENDING) {
                 LOG_ERROR("Failed to get stats for flow "INDIGO_FLOW_ID_PRINTF_FORMAT": %d",
                           entry->id, rv);
-                continue;
-            }
-
-            if (entry->packets != flow_stats.packets) {
-                entry->packets = flow_stats.packets;
-                entry->last_counter_change = current_time;
-            }
-            if (entry->bytes != flow_stats.bytes) {
-                entry->bytes = flow_stats.bytes;
-                entry->last_counter_change = current_time;
             }
+            /* Retry at the active flow interval */
+            ft_expire_reschedule(ind_core_ft, entry, current_time, true);
+            return;
         }
 
-        if (entry->idle_timeout > 0) {
+        counters_changed = ft_entry_counters_set(ind_core_ft, entry,
+                                                 flow_stats.packets,
+                                                 flow_stats.bytes,
+                                                 current_time);
+
+        /* A counter refresh may have seen activity after an audit's time */
+        if (!counters_changed && entry->last_counter_change < expiry_time) {
             uint32_t delta;
             delta = INDIGO_TIME_DIFF_ms(entry->last_counter_change,
-                                        current_time) / 1000;
+                                        expiry_time) / 1000;
             if (delta >= entry->idle_timeout) {
                 LOG_TRACE("Idle TO (%d): " INDIGO_FLOW_ID_PRINTF_FORMAT,
                           entry->idle_timeout, INDIGO_FLOW_ID_PRINTF_ARG(entry->id));
+                ind_core_ft->status.idle_expires += 1;
+                ind_core_ft->status.audit_expires += audit;
                 ind_core_flow_entry_delete(entry, INDIGO_FLOW_REMOVED_IDLE_TIMEOUT,
                                            INDIGO_CXN_ID_UNSPECIFIED);
-                continue;
+                return;
             }
         }
     }
+
+    ft_expire_reschedule(ind_core_ft, entry, current_time, counters_changed);
+}
+
+/**
+ * Check the flows the timing wheel has due as of grace_ms before
+ * current_time
+ */
+static void
+flow_expiration_run(indigo_time_t current_time, indigo_time_t grace_ms)
+{
+    list_head_t due;
+
+    ft_expire_collect(ind_core_ft, current_time - grace_ms, &due);
+
+    /* Each check deletes or reschedules the entry, removing it from due */
+    while (!list_empty(&due)) {
+        ft_entry_t *entry = FT_ENTRY_CONTAINER(due.links.next, expire);
+        flow_expiration_check(entry, current_time, grace_ms);
+    }
+}
+
+/**
+ * Timer operation to expire flows.
+ *
+ * Only flows whose hard deadline or next idle check has passed are visited;
+ * see ft_expire_collect. indigo_fwd_flow_stats_get is called for due flows
+ * with an idle timeout.
+ *
+ * Ignore this call if the module is not enabled.
+ */
+static void
+flow_expiration_timer(void *cookie)
+{
+    if (!ind_core_module_enabled) {
+        return;
+    }
+
+    flow_expiration_run(INDIGO_CURRENT_TIME, 0);
+}
+
+/**
+ * Timer operation to audit flow expiry done by forwarding.
+ *
+ * Forwarding expires flows itself and reports each one through
+ * ind_core_flow_expiry_handler, so the state manager does no per-flow
+ * timeout work. The audit catches reports that were lost: it judges
+ * timeouts as of one audit period ago, so only flows that forwarding
+ * should have expired well before now are removed here. Counter activity
+ * it sees is recorded at the real time.
+ *
+ * Ignore this call if the module is not enabled.
+ */
+static void
+expire_audit_timer(void *cookie)
+{
+    indigo_time_t current_time = INDIGO_CURRENT_TIME;
+
+    if (!ind_core_module_enabled ||
+            current_time < (indigo_time_t)ind_core_config.expire_audit_ms) {
+        return;
+    }
+
+    flow_expiration_run(current_time, ind_core_config.expire_audit_ms);
+}
+
+/**
+ * Iterator callback for a counter refresh.
+ *
+ * Copies each entry's counters from forwarding, which also keeps the flow
+ * table's per-table and per-cookie totals current.
+ */
+static indigo_error_t
+counter_refresh_iter(void *cookie, ft_entry_t *entry)
+{
+    indigo_error_t rv;
+    indigo_fi_flow_stats_t flow_stats;
+
+    if (entry == NULL) {
+        ind_core_counter_refresh_running = 0;
+        ind_core_counter_refreshes++;
+        ind_core_counters_read(ind_core_counter_refresh_start);
+        return INDIGO_ERROR_NONE;
+    }
+
+    rv = indigo_fwd_flow_stats_get(entry->id, &flow_stats);
+    if (rv != INDIGO_ERROR_NONE) {
+        if (rv != INDIGO_ERROR_PENDING) {
+            LOG_TRACE("Failed to refresh stats for flow "
+                      INDIGO_FLOW_ID_PRINTF_FORMAT": %d", entry->id, rv);
+        }
+        return rv;
+    }
+
+    ft_entry_counters_set(ind_core_ft, entry, flow_stats.packets,
+                          flow_stats.bytes, INDIGO_CURRENT_TIME);
+
+    return INDIGO_ERROR_NONE;
+}
+
+/**
+ * Timer operation to refresh flow counters.
+ *
+ * Starts a walk of the flow table unless the previous one is still going.
+ */
+static void
+counter_refresh_timer(void *cookie)
+{
+    indigo_error_t rv;
+
+    if (!ind_core_module_enabled || ind_core_counter_refresh_running) {
+        return;
+    }
+
+    rv = ft_spawn_wait_iter_task(ind_core_ft, NULL, counter_refresh_iter, NULL,
+                                 -10);
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Failed to start counter refresh: %d", rv);
+        return;
+    }
+    ind_core_counter_refresh_running = 1;
+    ind_core_counter_refresh_start = INDIGO_CURRENT_TIME;
+}
+
+/**
+ * Timer operation to save the state file for warm restart.
+ *
+ * Only writes the file if the tables have changed since the last save,
+ * and then in the background.
+ */
+static void
+state_save_timer(void *cookie)
+{
+    if (!ind_core_module_enabled) {
+        return;
+    }
+
+    ind_core_state_save_check(ind_core_config.state_file);
+}
+
+int
+ind_core_counters_current(void)
+{
+    if (!ind_core_counters_read_valid) {
+        return 0;
+    }
+
+    if (CORE_REFRESHES_COUNTERS(&ind_core_config)) {
+        return 1;
+    }
+
+    return ind_core_config.counter_max_age_ms > 0 &&
+        INDIGO_TIME_DIFF_ms(ind_core_counters_read_time, INDIGO_CURRENT_TIME) <
+        ind_core_config.counter_max_age_ms;
+}
+
+void
+ind_core_counters_read(indigo_time_t start)
+{
+    if (!ind_core_counters_read_valid || start > ind_core_counters_read_time) {
+        ind_core_counters_read_time = start;
+        ind_core_counters_read_valid = 1;
+    }
 }
 
 void
@@ -1012,29 +1308,32 @@ ind_core_ft_dump(aim_pvs_t* pvs)
 {
     ft_entry_t *entry;
     list_links_t *cur, *next;
+    of_match_t match;
 
     FT_ITER(ind_core_ft, entry, cur, next) {
+        ft_entry_match_get(entry, &match);
         aim_printf(pvs, "Flow %d:\n", entry->id);
-        loci_dump_match((loci_writer_f)aim_printf, pvs, &entry->match);
+        loci_dump_match((loci_writer_f)aim_printf, pvs, &match);
         aim_printf(pvs, "cookie: 0x%016"PRIx64"\n", entry->cookie);
         aim_printf(pvs, "idle_timeout: %hu\n", entry->idle_timeout);
         aim_printf(pvs, "hard_timeout: %hu\n", entry->hard_timeout);
         aim_printf(pvs, "priority: %hu\n", entry->priority);
         aim_printf(pvs, "flags: %hu\n", entry->flags);
         aim_printf(pvs, "table_id: %hhu\n", entry->table_id);
-        aim_printf(pvs, "packets: %"PRIu64"\n", entry->packets);
-        aim_printf(pvs, "bytes: %"PRIu64"\n", entry->bytes);
+        aim_printf(pvs, "packets: %"PRIu64"\n", entry->cold->packets);
+        aim_printf(pvs, "bytes: %"PRIu64"\n", entry->cold->bytes);
 
-        if (entry->match.version == OF_VERSION_1_0) {
+        if (match.version == OF_VERSION_1_0) {
             int rv;
             of_action_t elt;
-            OF_LIST_ACTION_ITER(entry->effects.actions, &elt, rv) {
+            OF_LIST_ACTION_ITER(entry->cold->effects.actions, &elt, rv) {
                 of_object_dump((loci_writer_f)aim_printf, pvs, &elt.header);
             }
         } else {
             int rv;
             of_instruction_t inst;
-            OF_LIST_INSTRUCTION_ITER(entry->effects.instructions, &inst, rv) {
+            OF_LIST_INSTRUCTION_ITER(entry->cold->effects.instructions,
+                                     &inst, rv) {
                 of_object_dump((loci_writer_f)aim_printf, pvs, &inst.header);
             }
         }
@@ -1048,18 +1347,20 @@ ind_core_ft_show(aim_pvs_t* pvs)
 {
     ft_entry_t *entry;
     list_links_t *cur, *next;
+    of_match_t match;
 
     FT_ITER(ind_core_ft, entry, cur, next) {
+        ft_entry_match_get(entry, &match);
         aim_printf(pvs, "Flow %d: ", entry->id);
-        loci_show_match((loci_writer_f)aim_printf, pvs, &entry->match);
+        loci_show_match((loci_writer_f)aim_printf, pvs, &match);
         aim_printf(pvs, "cookie=0x%016"PRIx64" ", entry->cookie);
         aim_printf(pvs, "priority=%hu ", entry->priority);
         aim_printf(pvs, "table_id=%hhu ", entry->table_id);
 
-        if (entry->match.version == OF_VERSION_1_0) {
+        if (match.version == OF_VERSION_1_0) {
             int rv;
             of_action_t elt;
-            OF_LIST_ACTION_ITER(entry->effects.actions, &elt, rv) {
+            OF_LIST_ACTION_ITER(entry->cold->effects.actions, &elt, rv) {
                 aim_printf(pvs, "%s(", of_object_id_str[elt.header.object_id]);
                 of_object_show((loci_writer_f)aim_printf, pvs, &elt.header);
                 aim_printf(pvs, ") ");
@@ -1067,7 +1368,8 @@ ind_core_ft_show(aim_pvs_t* pvs)
         } else {
             int rv;
             of_instruction_t inst;
-            OF_LIST_INSTRUCTION_ITER(entry->effects.instructions, &inst, rv) {
+            OF_LIST_INSTRUCTION_ITER(entry->cold->effects.instructions,
+                                     &inst, rv) {
                 aim_printf(pvs, "%s(", of_object_id_str[inst.header.object_id]);
                 of_object_show((loci_writer_f)aim_printf, pvs, &inst.header);
                 aim_printf(pvs, ") ");
@@ -1078,23 +1380,76 @@ ind_core_ft_show(aim_pvs_t* pvs)
     }
 }
 
+static void
+ft_index_stats_show(aim_pvs_t *pvs, const char *name, ft_index_t *index)
+{
+    uint32_t hist[FT_INDEX_CHAIN_HIST_SIZE];
+    int idx, max_chain;
+
+    ft_index_chain_histogram(index, hist, &max_chain);
+
+    aim_printf(pvs, "%s index:\n", name);
+    aim_printf(pvs, "  Buckets:        %d", index->bucket_count);
+    if (index->old_buckets != NULL) {
+        aim_printf(pvs, " (resizing from %d, %d migrated)",
+                   index->old_bucket_count, index->migrate_idx);
+    }
+    aim_printf(pvs, "\n");
+    aim_printf(pvs, "  Grows:          %d\n", (int)index->grows);
+    aim_printf(pvs, "  Shrinks:        %d\n", (int)index->shrinks);
+    aim_printf(pvs, "  Longest chain:  %d\n", max_chain);
+    for (idx = 0; idx < FT_INDEX_CHAIN_HIST_SIZE; idx++) {
+        aim_printf(pvs, "  Chain len %d%s:   %u\n", idx,
+                   idx == FT_INDEX_CHAIN_HIST_SIZE - 1 ? "+" : " ",
+                   hist[idx]);
+    }
+}
+
 void
 ind_core_ft_stats(aim_pvs_t *pvs)
 {
     ft_instance_t ft;
+    uint64_t cold_bytes = 0;
+    int cold_chunks = 0;
+    int idx;
 
     ft = ind_core_ft;
+    for (idx = 0; idx < FT_COLD_SLAB_CLASSES; idx++) {
+        cold_bytes += ft_slab_bytes(&ft->cold_slabs[idx]);
+        cold_chunks += ft->cold_slabs[idx].chunk_count;
+    }
+
     aim_printf(pvs, "Flow table stats:\n");
     aim_printf(pvs, "  Current count:  %d\n", ft->status.current_count);
     aim_printf(pvs, "  Adds:           %d\n", (int)ft->status.adds);
     aim_printf(pvs, "  Deletes:        %d\n", (int)ft->status.deletes);
     aim_printf(pvs, "  Hard Exp:       %d\n", (int)ft->status.hard_expires);
     aim_printf(pvs, "  Idle Exp:       %d\n", (int)ft->status.idle_expires);
+    aim_printf(pvs, "  Audit Exp:      %d\n", (int)ft->status.audit_expires);
     aim_printf(pvs, "  Updates:        %d\n", (int)ft->status.updates);
+    aim_printf(pvs, "  Overwrites:     %d\n", (int)ft->status.overwrites);
+    aim_printf(pvs, "  Evictions:      %d\n", (int)ft->status.evictions);
     aim_printf(pvs, "  Full Errors:    %d\n",
                (int)ft->status.table_full_errors);
     aim_printf(pvs, "  Fwd Add Errors: %d\n",
                (int)ft->status.forwarding_add_errors);
+    aim_printf(pvs, "  Mask groups:    %d\n", ft->mask_group_count);
+    aim_printf(pvs, "  Shared effects: %d lists, %d shares\n",
+               ft->effects_count, (int)ft->status.effects_shares);
+    aim_printf(pvs, "  Entry memory:   %u bytes, %d chunks, %d bytes per entry\n",
+               (unsigned)ft_slab_bytes(&ft->entry_slab),
+               ft->entry_slab.chunk_count, ft->entry_slab.obj_size);
+    aim_printf(pvs, "  Cold memory:    %u bytes, %d chunks\n",
+               (unsigned)cold_bytes, cold_chunks);
+    aim_printf(pvs, "  Overlap checks: %d\n", (int)ft->status.overlap_checks);
+    aim_printf(pvs, "  Overlap visits: %d\n", (int)ft->status.overlap_visits);
+
+    ft_index_stats_show(pvs, "Strict match", &ft->strict_match_index);
+    ft_index_stats_show(pvs, "Flow ID", &ft->flow_id_index);
+    ft_index_stats_show(pvs, "Overlap", &ft->overlap_index);
+    ft_index_stats_show(pvs, "Cookie", &ft->cookie_index);
+    ft_index_stats_show(pvs, "Effects", &ft->effects_index);
+    ft_index_stats_show(pvs, "Out group", &ft->out_group_index);
 }
 
 
@@ -1136,6 +1491,12 @@ void ind_core_flow_expiry_handler(indigo_flow_id_t id,
     return;
   }
 
+  if (reason == INDIGO_FLOW_REMOVED_HARD_TIMEOUT) {
+    ind_core_ft->status.hard_expires += 1;
+  } else if (reason == INDIGO_FLOW_REMOVED_IDLE_TIMEOUT) {
+    ind_core_ft->status.idle_expires += 1;
+  }
+
   ind_core_flow_entry_delete(entry, reason,
                              INDIGO_CXN_ID_UNSPECIFIED);
   return;
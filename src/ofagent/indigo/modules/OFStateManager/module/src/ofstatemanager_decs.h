@@ -35,6 +35,9 @@ extern int ind_core_module_enabled;
 /* State manager configuration data, shared within module */
 extern ind_core_of_config_t ind_core_of_config;
 
+/* Configuration passed to ind_core_init */
+extern ind_core_config_t ind_core_config;
+
 /* The flow table instance visible to all parts of the module */
 extern ft_instance_t ind_core_ft;
 
@@ -55,8 +58,97 @@ extern int ind_core_send_error_msg(of_version_t version,
                                    of_object_t *bad_req,
                                    of_octets_t *octets);
 
+/**
+ * True if the flow table's running counter totals are being refreshed
+ * from forwarding, or were read in full recently enough, and may be used
+ * to answer aggregate stats requests
+ */
+
+extern int ind_core_counters_current(void);
+
+/**
+ * Record that every flow's counters were read from forwarding by a walk
+ * of the whole table that started at start
+ */
+
+extern void ind_core_counters_read(indigo_time_t start);
+
 extern void ind_core_flow_entry_delete(ft_entry_t *entry,
                                        indigo_fi_flow_removed_t reason,
                                        indigo_cxn_id_t cxn_id);
 
+extern void ind_core_flow_removed_notify(ft_entry_t *entry,
+                                         indigo_fi_flow_stats_t *final_stats,
+                                         indigo_fi_flow_removed_t reason);
+
+/* handlers.c */
+
+extern indigo_error_t ind_core_flow_mod_setup_query(of_flow_modify_t *obj,
+                                                    of_meta_match_t *query,
+                                                    int query_mode,
+                                                    int force_wildcard_port);
+
+extern indigo_flow_id_t ind_core_flow_id_next(void);
+extern void ind_core_flow_id_reserve(indigo_flow_id_t id);
+
+extern of_flow_modify_t *ind_core_flow_mod_from_entry(ft_entry_t *entry,
+                                                      of_object_id_t object_id);
+
+extern indigo_error_t
+ind_core_flow_stats_entry_populate(of_flow_stats_entry_t *stats_entry,
+                                   ft_entry_t *entry, indigo_time_t now,
+                                   uint64_t packets, uint64_t bytes);
+
+extern void ind_core_flow_mod_err_msg_send(indigo_error_t indigo_err,
+                                           of_version_t ver,
+                                           indigo_cxn_id_t cxn_id,
+                                           of_flow_modify_t *flow_mod);
+
+/* bundle.c */
+
+extern indigo_error_t ind_core_bundle_init(void);
+extern void ind_core_bundle_finish(void);
+extern int ind_core_bundle_handler(of_experimenter_t *obj,
+                                   indigo_cxn_id_t cxn_id);
+
+/* flow_monitor.c */
+
+extern indigo_error_t ind_core_flow_monitor_init(void);
+extern void ind_core_flow_monitor_finish(void);
+extern int ind_core_flow_monitor_handler(of_experimenter_t *obj,
+                                         indigo_cxn_id_t cxn_id);
+extern void ind_core_flow_monitor_notify(ft_entry_t *entry,
+                                         ind_core_flow_monitor_event_t event,
+                                         indigo_fi_flow_removed_t reason);
+
+/* group_handlers.c */
+
+extern indigo_error_t ind_core_group_get(uint32_t id, uint8_t *type,
+                                         of_list_bucket_t **buckets);
+extern indigo_error_t ind_core_group_add(uint32_t id, uint8_t type,
+                                         of_list_bucket_t *buckets);
+extern indigo_error_t ind_core_group_modify(uint32_t id, uint8_t type,
+                                            of_list_bucket_t *buckets);
+extern indigo_error_t ind_core_group_delete(uint32_t id);
+
+/* Takes a flow forwarding to a group being deleted out of the flow table */
+typedef indigo_error_t (*ind_core_group_flow_remove_f)(void *cookie,
+                                                       ft_entry_t *entry);
+extern indigo_error_t ind_core_group_delete_with_flows(
+    uint32_t id, ind_core_group_flow_remove_f remove_flow, void *cookie);
+extern int ind_core_group_buckets_forward_to(of_list_bucket_t *buckets,
+                                             uint32_t id);
+extern indigo_error_t ind_core_group_restore(uint32_t id, uint8_t type,
+                                             of_list_bucket_t *buckets);
+
+typedef void (*ind_core_group_iter_f)(void *cookie, uint32_t id, uint8_t type,
+                                      of_list_bucket_t *buckets);
+extern void ind_core_group_iter(ind_core_group_iter_f callback, void *cookie);
+extern uint64_t ind_core_group_changes(void);
+
+/* state_file.c */
+
+extern void ind_core_state_save_check(const char *path);
+extern void ind_core_state_save_flush(const char *path);
+
 #endif /* OFSTATEMANAGER_DECS_H */
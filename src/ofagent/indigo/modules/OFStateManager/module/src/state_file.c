@@ -0,0 +1,760 @@
+/****************************************************************
+ *
+ *        Copyright 2013, Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ ****************************************************************/
+
+/**
+ * @file
+ * @brief Flow and group state file for warm restart
+ *
+ * See ofstatemanager.h for the file layout. Groups and flows are stored
+ * as the OpenFlow messages that would add them, so restoring one goes
+ * through the same LOCI parsing and flow table code as a controller add;
+ * only the forwarding call differs, reconciling instead of creating. A
+ * flow forwarding no longer holds is then created as usual.
+ *
+ * A save writes a temporary file beside the state file and renames it
+ * into place, so a crash mid-save leaves the previous file intact.
+ *
+ * Periodic saves stay off the event loop's critical path: the file is
+ * encoded into memory by a task that yields between flows, then a writer
+ * thread writes, syncs and renames it. Flows changing while the task
+ * runs may or may not be in the file; they count as changes, so the next
+ * check saves again. The synchronous ind_core_state_save is for shutdown.
+ */
+
+#include "ofstatemanager_log.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <OFStateManager/ofstatemanager.h>
+#include <indigo/indigo.h>
+#include <indigo/forwarding.h>
+#include <indigo/memory.h>
+#include <loci/loci.h>
+#include "ofstatemanager_decs.h"
+#include "ofstatemanager_int.h"
+#include "ft.h"
+
+#define STATE_FILE_HEADER_LEN 16
+#define STATE_FILE_FLOW_HEADER_LEN 32
+#define STATE_FILE_RECORD_MAX_LEN 0xffff   /* An OpenFlow message length */
+
+/* A state file being encoded into memory */
+typedef struct state_file_writer_s {
+    uint8_t *data;
+    size_t len;
+    size_t size;                   /* Allocated bytes of data */
+    indigo_error_t rv;
+    uint32_t groups;
+    uint32_t flows;
+} state_file_writer_t;
+
+typedef enum state_file_save_state_e {
+    STATE_FILE_SAVE_IDLE,
+    STATE_FILE_SAVE_ENCODING,      /* The task is encoding flows */
+    STATE_FILE_SAVE_WRITING,       /* The writer thread owns the data */
+} state_file_save_state_t;
+
+/* The background save; there is at most one at a time */
+typedef struct state_file_save_s {
+    state_file_save_state_t state;
+    uintptr_t generation;          /* Of the current encoding task */
+    state_file_writer_t writer;
+    ft_iterator_t iter;
+    uint64_t changes;              /* Table changes as of the start */
+    indigo_time_t now;
+    char path[1024];
+    char tmp_path[1024];
+    pthread_t thread;
+    pthread_mutex_t lock;
+    int written;                   /* Set by the writer thread under lock */
+    indigo_error_t write_rv;       /* Also under lock */
+} state_file_save_t;
+
+static state_file_save_t state_file_save = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* The table changes as of the last save or restore */
+static uint64_t state_file_saved_changes = (uint64_t)-1;
+
+static uint64_t
+state_file_changes(void)
+{
+    ft_status_t *status = FT_STATUS(ind_core_ft);
+
+    return status->adds + status->deletes + status->updates +
+        status->overwrites + ind_core_group_changes();
+}
+
+static void
+put16(uint8_t *buf, uint16_t val)
+{
+    buf[0] = val >> 8;
+    buf[1] = val;
+}
+
+static void
+put32(uint8_t *buf, uint32_t val)
+{
+    put16(buf, val >> 16);
+    put16(buf + 2, val);
+}
+
+static void
+put64(uint8_t *buf, uint64_t val)
+{
+    put32(buf, val >> 32);
+    put32(buf + 4, val);
+}
+
+static uint16_t
+get16(const uint8_t *buf)
+{
+    return (buf[0] << 8) | buf[1];
+}
+
+static uint32_t
+get32(const uint8_t *buf)
+{
+    return ((uint32_t)get16(buf) << 16) | get16(buf + 2);
+}
+
+static uint64_t
+get64(const uint8_t *buf)
+{
+    return ((uint64_t)get32(buf) << 32) | get32(buf + 4);
+}
+
+/****************************************************************
+ * Save
+ ****************************************************************/
+
+static void
+state_file_write(state_file_writer_t *writer, const void *data, size_t len)
+{
+    uint8_t *grown;
+    size_t size;
+
+    if (writer->rv != INDIGO_ERROR_NONE) {
+        return;
+    }
+
+    if (writer->len + len > writer->size) {
+        size = writer->size ? writer->size * 2 : 64 * 1024;
+        while (size < writer->len + len) {
+            size *= 2;
+        }
+        if ((grown = INDIGO_MEM_REALLOC(writer->data, size)) == NULL) {
+            writer->rv = INDIGO_ERROR_RESOURCE;
+            return;
+        }
+        writer->data = grown;
+        writer->size = size;
+    }
+
+    INDIGO_MEM_COPY(writer->data + writer->len, data, len);
+    writer->len += len;
+}
+
+static void
+state_file_write_object(state_file_writer_t *writer, of_object_t *obj)
+{
+    state_file_write(writer, OF_OBJECT_BUFFER_INDEX(obj, 0), obj->length);
+}
+
+/* Fill in the header written by state_file_encode_start */
+static void
+state_file_header_fill(state_file_writer_t *writer)
+{
+    uint8_t *buf = writer->data;
+
+    INDIGO_MEM_SET(buf, 0, STATE_FILE_HEADER_LEN);
+    put32(buf, IND_CORE_STATE_MAGIC);
+    put16(buf + 4, IND_CORE_STATE_VERSION);
+    put32(buf + 8, writer->groups);
+    put32(buf + 12, writer->flows);
+}
+
+static void
+state_file_group_write(void *cookie, uint32_t id, uint8_t type,
+                       of_list_bucket_t *buckets)
+{
+    state_file_writer_t *writer = cookie;
+    of_group_mod_t *obj;
+    uint8_t buf[4];
+
+    if (writer->rv != INDIGO_ERROR_NONE) {
+        return;
+    }
+
+    obj = of_group_mod_new(buckets->version);
+    if (obj == NULL) {
+        writer->rv = INDIGO_ERROR_RESOURCE;
+        return;
+    }
+
+    of_group_mod_command_set(obj, OF_GROUP_ADD);
+    of_group_mod_group_type_set(obj, type);
+    of_group_mod_group_id_set(obj, id);
+    if (of_group_mod_buckets_set(obj, buckets) < 0) {
+        writer->rv = INDIGO_ERROR_RESOURCE;
+    } else {
+        put32(buf, obj->length);
+        state_file_write(writer, buf, sizeof(buf));
+        state_file_write_object(writer, obj);
+        writer->groups++;
+    }
+
+    of_object_delete(obj);
+}
+
+static void
+state_file_flow_write(state_file_writer_t *writer, ft_entry_t *entry,
+                      indigo_time_t now)
+{
+    of_flow_modify_t *obj;
+    uint8_t buf[STATE_FILE_FLOW_HEADER_LEN];
+    uint32_t age_sec = 0;
+
+    obj = ind_core_flow_mod_from_entry(entry, OF_FLOW_ADD);
+    if (obj == NULL) {
+        writer->rv = INDIGO_ERROR_RESOURCE;
+        return;
+    }
+
+    if (now > entry->insert_time) {
+        age_sec = (now - entry->insert_time) / 1000;
+    }
+
+    put64(buf, entry->id);
+    put64(buf + 8, entry->cold->packets_base);
+    put64(buf + 16, entry->cold->bytes_base);
+    put32(buf + 24, age_sec);
+    put32(buf + 28, obj->length);
+    state_file_write(writer, buf, sizeof(buf));
+    state_file_write_object(writer, obj);
+    writer->flows++;
+
+    of_object_delete(obj);
+}
+
+/* Start a file with room for the header, then write the groups */
+static void
+state_file_encode_start(state_file_writer_t *writer)
+{
+    uint8_t buf[STATE_FILE_HEADER_LEN] = { 0 };
+
+    INDIGO_MEM_SET(writer, 0, sizeof(*writer));
+
+    /* Counts are filled in once the records are written */
+    state_file_write(writer, buf, sizeof(buf));
+
+    ind_core_group_iter(state_file_group_write, writer);
+}
+
+/**
+ * Write an encoded file beside path, sync it and rename it into place.
+ * Runs on the writer thread, so it does not log.
+ */
+
+static indigo_error_t
+state_file_commit(const char *path, const char *tmp_path,
+                  const uint8_t *data, size_t len)
+{
+    FILE *file;
+    indigo_error_t rv = INDIGO_ERROR_NONE;
+
+    if ((file = fopen(tmp_path, "wb")) == NULL) {
+        return INDIGO_ERROR_UNKNOWN;
+    }
+
+    if (fwrite(data, 1, len, file) != len ||
+            fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        rv = INDIGO_ERROR_UNKNOWN;
+    }
+    if (fclose(file) != 0 && rv == INDIGO_ERROR_NONE) {
+        rv = INDIGO_ERROR_UNKNOWN;
+    }
+    if (rv == INDIGO_ERROR_NONE && rename(tmp_path, path) != 0) {
+        rv = INDIGO_ERROR_UNKNOWN;
+    }
+
+    if (rv != INDIGO_ERROR_NONE) {
+        remove(tmp_path);
+    }
+
+    return rv;
+}
+
+/* Log a save's result and, if it worked, the changes it covers */
+static indigo_error_t
+state_file_saved(const char *path, state_file_writer_t *writer,
+                 indigo_error_t rv, uint64_t changes)
+{
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_ERROR("Failed to save state file %s: %d", path, rv);
+        return rv;
+    }
+
+    state_file_saved_changes = changes;
+    LOG_VERBOSE("Saved %u groups and %u flows to %s",
+                writer->groups, writer->flows, path);
+
+    return INDIGO_ERROR_NONE;
+}
+
+static int
+state_file_tmp_path(char *tmp_path, size_t size, const char *path)
+{
+    if (snprintf(tmp_path, size, "%s.tmp", path) >= (int)size) {
+        LOG_ERROR("State file path too long: %s", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void *
+state_file_save_thread(void *arg)
+{
+    state_file_save_t *save = arg;
+    indigo_error_t rv;
+
+    rv = state_file_commit(save->path, save->tmp_path,
+                           save->writer.data, save->writer.len);
+
+    pthread_mutex_lock(&save->lock);
+    save->write_rv = rv;
+    save->written = 1;
+    pthread_mutex_unlock(&save->lock);
+
+    return NULL;
+}
+
+static void
+state_file_save_done(indigo_error_t rv)
+{
+    state_file_save_t *save = &state_file_save;
+
+    (void)state_file_saved(save->path, &save->writer, rv, save->changes);
+    INDIGO_MEM_FREE(save->writer.data);
+    save->state = STATE_FILE_SAVE_IDLE;
+}
+
+/* The flows are all encoded; hand the file to the writer thread */
+static void
+state_file_save_write(void)
+{
+    state_file_save_t *save = &state_file_save;
+
+    ft_iterator_cleanup(&save->iter);
+
+    if (save->writer.rv != INDIGO_ERROR_NONE) {
+        state_file_save_done(save->writer.rv);
+        return;
+    }
+
+    state_file_header_fill(&save->writer);
+
+    save->written = 0;
+    if (pthread_create(&save->thread, NULL, state_file_save_thread,
+                       save) != 0) {
+        LOG_ERROR("Failed to start state file writer");
+        state_file_save_done(INDIGO_ERROR_RESOURCE);
+        return;
+    }
+
+    save->state = STATE_FILE_SAVE_WRITING;
+}
+
+/* Collect the writer thread's result; with wait, block until it is done */
+static void
+state_file_save_reap(int wait)
+{
+    state_file_save_t *save = &state_file_save;
+    int written;
+
+    pthread_mutex_lock(&save->lock);
+    written = save->written;
+    pthread_mutex_unlock(&save->lock);
+
+    if (!written && !wait) {
+        return;
+    }
+
+    /* Once joined, the thread's writes are visible without the lock */
+    pthread_join(save->thread, NULL);
+    state_file_save_done(save->write_rv);
+}
+
+static ind_soc_task_status_t
+state_file_save_task(void *cookie)
+{
+    state_file_save_t *save = &state_file_save;
+    ft_entry_t *entry;
+
+    /* Stale if the save was finished by state_file_save_wait */
+    if (save->state != STATE_FILE_SAVE_ENCODING ||
+            save->generation != (uintptr_t)cookie) {
+        return IND_SOC_TASK_FINISHED;
+    }
+
+    while (save->writer.rv == INDIGO_ERROR_NONE &&
+           (entry = ft_iterator_next(&save->iter)) != NULL) {
+        state_file_flow_write(&save->writer, entry, save->now);
+        if (ind_soc_should_yield()) {
+            return IND_SOC_TASK_CONTINUE;
+        }
+    }
+
+    state_file_save_write();
+
+    return IND_SOC_TASK_FINISHED;
+}
+
+/* Finish the background save, if any, before returning */
+static void
+state_file_save_wait(void)
+{
+    state_file_save_t *save = &state_file_save;
+    ft_entry_t *entry;
+
+    if (save->state == STATE_FILE_SAVE_ENCODING) {
+        while (save->writer.rv == INDIGO_ERROR_NONE &&
+               (entry = ft_iterator_next(&save->iter)) != NULL) {
+            state_file_flow_write(&save->writer, entry, save->now);
+        }
+        state_file_save_write();
+    }
+
+    if (save->state == STATE_FILE_SAVE_WRITING) {
+        state_file_save_reap(1);
+    }
+}
+
+indigo_error_t
+ind_core_state_save(const char *path)
+{
+    state_file_writer_t writer;
+    char tmp_path[1024];
+    indigo_time_t now = INDIGO_CURRENT_TIME;
+    ft_entry_t *entry;
+    list_links_t *cur, *next;
+    uint64_t changes;
+    indigo_error_t rv;
+
+    if (!ind_core_init_done) {
+        return INDIGO_ERROR_INIT;
+    }
+
+    if (state_file_tmp_path(tmp_path, sizeof(tmp_path), path) < 0) {
+        return INDIGO_ERROR_PARAM;
+    }
+
+    /* A background save must not rename its file over this one */
+    state_file_save_wait();
+
+    changes = state_file_changes();
+
+    state_file_encode_start(&writer);
+
+    FT_ITER(ind_core_ft, entry, cur, next) {
+        if (writer.rv != INDIGO_ERROR_NONE) {
+            break;
+        }
+        state_file_flow_write(&writer, entry, now);
+    }
+
+    rv = writer.rv;
+    if (rv == INDIGO_ERROR_NONE) {
+        state_file_header_fill(&writer);
+        rv = state_file_commit(path, tmp_path, writer.data, writer.len);
+    }
+    INDIGO_MEM_FREE(writer.data);
+
+    return state_file_saved(path, &writer, rv, changes);
+}
+
+/**
+ * Start saving the state file in the background if the tables changed
+ * since it was last saved or restored. Collects the result of the last
+ * background save first; does nothing while that is still running.
+ */
+
+void
+ind_core_state_save_check(const char *path)
+{
+    state_file_save_t *save = &state_file_save;
+
+    if (!ind_core_init_done) {
+        return;
+    }
+
+    if (save->state == STATE_FILE_SAVE_WRITING) {
+        state_file_save_reap(0);
+    }
+
+    if (save->state != STATE_FILE_SAVE_IDLE ||
+            state_file_changes() == state_file_saved_changes) {
+        return;
+    }
+
+    if (state_file_tmp_path(save->tmp_path, sizeof(save->tmp_path),
+                            path) < 0) {
+        return;
+    }
+    snprintf(save->path, sizeof(save->path), "%s", path);
+
+    save->changes = state_file_changes();
+    save->now = INDIGO_CURRENT_TIME;
+    state_file_encode_start(&save->writer);
+    ft_iterator_init(&save->iter, ind_core_ft, NULL);
+    save->generation++;
+
+    if (ind_soc_task_register(state_file_save_task,
+                              (void *)save->generation,
+                              IND_SOC_DEFAULT_PRIORITY) < 0) {
+        LOG_ERROR("Failed to start saving state file %s", path);
+        ft_iterator_cleanup(&save->iter);
+        INDIGO_MEM_FREE(save->writer.data);
+        return;
+    }
+
+    save->state = STATE_FILE_SAVE_ENCODING;
+}
+
+/**
+ * Finish any background save, then save the state file now if the
+ * tables changed since
+ */
+
+void
+ind_core_state_save_flush(const char *path)
+{
+    if (!ind_core_init_done) {
+        return;
+    }
+
+    state_file_save_wait();
+
+    if (state_file_changes() != state_file_saved_changes) {
+        (void)ind_core_state_save(path);
+    }
+}
+
+/****************************************************************
+ * Restore
+ ****************************************************************/
+
+static void
+state_file_buf_free(void *buf)
+{
+    INDIGO_MEM_FREE(buf);
+}
+
+static indigo_error_t
+state_file_read(FILE *file, void *data, size_t len)
+{
+    return fread(data, 1, len, file) == len ?
+        INDIGO_ERROR_NONE : INDIGO_ERROR_PARSE;
+}
+
+/* Read a message of len bytes; NULL if it is missing or malformed */
+static of_object_t *
+state_file_read_object(FILE *file, uint32_t len)
+{
+    of_object_t *obj;
+    uint8_t *buf;
+
+    if (len < OF_MESSAGE_MIN_LENGTH || len > STATE_FILE_RECORD_MAX_LEN) {
+        return NULL;
+    }
+
+    buf = INDIGO_MEM_ALLOC(len);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    if (state_file_read(file, buf, len) != INDIGO_ERROR_NONE ||
+            (obj = of_object_new_from_message_bind(OF_BUFFER_TO_MESSAGE(buf),
+                                                   len,
+                                                   state_file_buf_free)) == NULL) {
+        INDIGO_MEM_FREE(buf);
+        return NULL;
+    }
+
+    return obj;
+}
+
+static indigo_error_t
+state_file_group_restore(of_group_mod_t *obj)
+{
+    uint32_t id;
+    uint8_t type;
+    of_list_bucket_t buckets;
+
+    if (obj->object_id != OF_GROUP_MOD) {
+        return INDIGO_ERROR_PARSE;
+    }
+
+    of_group_mod_group_id_get(obj, &id);
+    of_group_mod_group_type_get(obj, &type);
+    of_group_mod_buckets_bind(obj, &buckets);
+
+    return ind_core_group_restore(id, type, &buckets);
+}
+
+static indigo_error_t
+state_file_flow_restore(indigo_flow_id_t id, of_flow_add_t *obj,
+                        indigo_time_t insert_time,
+                        uint64_t packets_base, uint64_t bytes_base)
+{
+    ft_entry_t *entry;
+    indigo_fi_flow_stats_t flow_stats;
+    uint8_t table_id;
+    indigo_error_t rv;
+
+    if (obj->object_id != OF_FLOW_ADD) {
+        return INDIGO_ERROR_PARSE;
+    }
+
+    /* Whatever happens to this flow, its ID stays out of use */
+    ind_core_flow_id_reserve(id);
+
+    rv = ft_add(ind_core_ft, id, obj, &entry);
+    if (rv != INDIGO_ERROR_NONE) {
+        return rv;
+    }
+
+    rv = indigo_fwd_flow_reconcile(id, obj, &table_id);
+    if (rv == INDIGO_ERROR_NOT_FOUND) {
+        /* Forwarding lost it or holds it differently; install it afresh */
+        rv = indigo_fwd_flow_create(id, obj, &table_id);
+        if (rv == INDIGO_ERROR_NONE) {
+            /* Its forwarding counters start again from zero */
+            packets_base = 0;
+            bytes_base = 0;
+        }
+    }
+    if (rv != INDIGO_ERROR_NONE) {
+        ft_delete(ind_core_ft, entry);
+        return rv;
+    }
+
+    rv = ft_entry_set_table_id(ind_core_ft, entry, table_id);
+    if (rv != INDIGO_ERROR_NONE) {
+        /* Forwarding kept it, so it must go explicitly */
+        (void)indigo_fwd_flow_delete(id, &flow_stats);
+        ft_delete(ind_core_ft, entry);
+        return rv;
+    }
+
+    ft_entry_restore(ind_core_ft, entry, insert_time,
+                     packets_base, bytes_base);
+
+    return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t
+ind_core_state_restore(const char *path)
+{
+    FILE *file;
+    uint8_t buf[STATE_FILE_FLOW_HEADER_LEN];
+    uint32_t group_count = 0, flow_count = 0;
+    uint32_t groups = 0, flows = 0;
+    uint32_t i, len;
+    indigo_time_t now = INDIGO_CURRENT_TIME;
+    indigo_time_t age_ms;
+    of_object_t *obj;
+    indigo_error_t rv = INDIGO_ERROR_NONE;
+
+    if (!ind_core_init_done) {
+        return INDIGO_ERROR_INIT;
+    }
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        LOG_INFO("No state file %s to restore", path);
+        rv = INDIGO_ERROR_NOT_FOUND;
+        goto reconcile;
+    }
+
+    if (state_file_read(file, buf, STATE_FILE_HEADER_LEN) != INDIGO_ERROR_NONE ||
+            get32(buf) != IND_CORE_STATE_MAGIC ||
+            get16(buf + 4) != IND_CORE_STATE_VERSION) {
+        rv = INDIGO_ERROR_PARSE;
+        goto done;
+    }
+    group_count = get32(buf + 8);
+    flow_count = get32(buf + 12);
+
+    for (i = 0; i < group_count; i++) {
+        if (state_file_read(file, buf, 4) != INDIGO_ERROR_NONE ||
+                (obj = state_file_read_object(file, get32(buf))) == NULL) {
+            rv = INDIGO_ERROR_PARSE;
+            goto done;
+        }
+        if (state_file_group_restore(obj) == INDIGO_ERROR_NONE) {
+            groups++;
+        }
+        of_object_delete(obj);
+    }
+
+    for (i = 0; i < flow_count; i++) {
+        if (state_file_read(file, buf, STATE_FILE_FLOW_HEADER_LEN) !=
+                INDIGO_ERROR_NONE) {
+            rv = INDIGO_ERROR_PARSE;
+            goto done;
+        }
+        len = get32(buf + 28);
+        if ((obj = state_file_read_object(file, len)) == NULL) {
+            rv = INDIGO_ERROR_PARSE;
+            goto done;
+        }
+        age_ms = (indigo_time_t)get32(buf + 24) * 1000;
+        if (state_file_flow_restore(get64(buf), obj,
+                                    now > age_ms ? now - age_ms : 0,
+                                    get64(buf + 8),
+                                    get64(buf + 16)) == INDIGO_ERROR_NONE) {
+            flows++;
+        }
+        of_object_delete(obj);
+    }
+
+done:
+    fclose(file);
+    if (rv != INDIGO_ERROR_NONE) {
+        LOG_ERROR("State file %s is truncated or corrupt", path);
+    }
+
+reconcile:
+    /*
+     * Leave forwarding with exactly what was restored, unless the file
+     * gave out partway; then what it did not get to may still be wanted
+     */
+    indigo_fwd_reconcile_finish(rv != INDIGO_ERROR_PARSE);
+
+    state_file_saved_changes = state_file_changes();
+    LOG_INFO("Restored %u of %u groups and %u of %u flows from %s",
+             groups, group_count, flows, flow_count, path);
+
+    return rv;
+}
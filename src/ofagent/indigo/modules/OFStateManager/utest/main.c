@@ -37,6 +37,8 @@
 #include <string.h>
 
 #include <unistd.h>
+#include <time.h>
+#include <malloc.h>
 #include <ft.h>
 
 #include <loci/loci.h>
@@ -76,12 +78,14 @@
 /****************************************************************
  * Stubs
  ****************************************************************/
+indigo_error_t modify_error = INDIGO_ERROR_NONE;
+
 indigo_error_t
 indigo_fwd_flow_modify(indigo_cookie_t flow_id,
                        of_flow_modify_t *flow_modify)
 {
     AIM_LOG_VERBOSE("flow modify called\n");
-    return INDIGO_ERROR_NONE;
+    return modify_error;
 }
 
 indigo_error_t create_error = INDIGO_ERROR_NONE;
@@ -90,13 +94,21 @@ indigo_error_t create_error = INDIGO_ERROR_NONE;
    if (create_error == INDIGO_ERROR_NONE) \
        TEST_ASSERT((status)->current_count == (count))
 
+/* If nonnegative, the number of creates to succeed before one fails */
+int create_fail_countdown = -1;
+indigo_error_t create_fail_error = INDIGO_ERROR_UNKNOWN;
+uint8_t create_table_id = 0;
+
 indigo_error_t
 indigo_fwd_flow_create(indigo_cookie_t flow_id,
                        of_flow_add_t *flow_add,
                        uint8_t *table_id)
 {
     AIM_LOG_VERBOSE("flow create called\n");
-    *table_id = 0;
+    if (create_fail_countdown >= 0 && create_fail_countdown-- == 0) {
+        return create_fail_error;
+    }
+    *table_id = create_table_id;
     return INDIGO_ERROR_NONE;
 }
 
@@ -121,13 +133,26 @@ indigo_fwd_flow_delete(indigo_cookie_t flow_id,
     return INDIGO_ERROR_NONE;
 }
 
+indigo_error_t stats_error = INDIGO_ERROR_NONE;
+uint64_t stats_packets = 0;
+uint64_t stats_bytes = 0;
+int stats_pending = 0;          /* Calls to answer INDIGO_ERROR_PENDING */
+int stats_calls = 0;
+
 indigo_error_t indigo_fwd_flow_stats_get(
     indigo_cookie_t flow_id,
     indigo_fi_flow_stats_t *flow_stats)
 {
     AIM_LOG_VERBOSE("flow stats get called\n");
+    stats_calls++;
+    if (stats_pending > 0) {
+        stats_pending--;
+        return INDIGO_ERROR_PENDING;
+    }
     memset(flow_stats, 0, sizeof(*flow_stats));
-    return INDIGO_ERROR_NONE;
+    flow_stats->packets = stats_packets;
+    flow_stats->bytes = stats_bytes;
+    return stats_error;
 }
 
 indigo_error_t
@@ -159,6 +184,18 @@ ind_cxn_reset(indigo_cxn_id_t cxn_id)
     return;
 }
 
+/* Whether the controller connection reports its output as backed up */
+int cxn_congested = 0;
+
+int
+ind_cxn_output_congested(indigo_cxn_id_t cxn_id)
+{
+    return cxn_congested;
+}
+
+int error_msg_count = 0;
+uint16_t last_error_code;
+
 int
 indigo_cxn_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
                           uint32_t xid, uint16_t type, uint16_t code,
@@ -166,18 +203,195 @@ indigo_cxn_send_error_msg(of_version_t version, indigo_cxn_id_t cxn_id,
 {
     AIM_LOG_VERBOSE("Send error msg called for cxn id %d\n",
                       cxn_id);
+    error_msg_count++;
+    last_error_code = code;
     return INDIGO_ERROR_NONE;
 }
 
+/* Flow monitor updates sent, oldest first */
+#define MAX_MONITOR_UPDATES 16
+
+typedef struct monitor_update_s {
+    uint32_t xid;
+    uint32_t id;
+    uint16_t event;
+    uint16_t reason;
+    int flow_count;                /* Number of ofp_flow_stats */
+    uint64_t counters;             /* Sum of the flows' packets and bytes */
+} monitor_update_t;
+
+monitor_update_t monitor_updates[MAX_MONITOR_UPDATES];
+int monitor_update_count = 0;
+
+static uint32_t
+get_be(uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+
+    while (bytes-- > 0) {
+        v = (v << 8) | *p++;
+    }
+
+    return v;
+}
+
+static void
+monitor_update_record(of_experimenter_t *obj)
+{
+    monitor_update_t *update;
+    of_octets_t data;
+    uint32_t experimenter;
+    int offset;
+
+    of_experimenter_experimenter_get(obj, &experimenter);
+    of_experimenter_data_get(obj, &data);
+    if (experimenter != IND_CORE_FLOW_MONITOR_EXPERIMENTER_ID ||
+            data.bytes < IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN ||
+            monitor_update_count == MAX_MONITOR_UPDATES) {
+        return;
+    }
+
+    update = &monitor_updates[monitor_update_count++];
+    of_experimenter_xid_get(obj, &update->xid);
+    update->id = get_be(data.data, 4);
+    update->event = get_be(data.data + 4, 2);
+    update->reason = get_be(data.data + 6, 2);
+
+    /* Walk the flows by their length fields; a bad length fails the count */
+    update->flow_count = 0;
+    update->counters = 0;
+    offset = IND_CORE_FLOW_MONITOR_UPDATE_HDR_LEN;
+    while (offset + 2 <= data.bytes) {
+        int len = get_be(data.data + offset, 2);
+        if (len == 0 || offset + len > data.bytes) {
+            update->flow_count = -1;
+            return;
+        }
+        update->flow_count++;
+        if (len >= 48) {
+            /* OF 1.3 ofp_flow_stats: packet_count at 32, byte_count at 40 */
+            int i;
+            for (i = 32; i < 48; i += 4) {
+                update->counters += get_be(data.data + offset + i, 4);
+            }
+        }
+        offset += len;
+    }
+    if (offset != data.bytes) {
+        update->flow_count = -1;
+    }
+}
+
+/* Type of the last bundle control reply, or -1 */
+int bundle_reply_type = -1;
+
+static void
+bundle_reply_record(of_experimenter_t *obj)
+{
+    of_octets_t data;
+    uint32_t experimenter;
+
+    of_experimenter_experimenter_get(obj, &experimenter);
+    of_experimenter_data_get(obj, &data);
+    if (experimenter == IND_CORE_BUNDLE_EXPERIMENTER_ID &&
+            data.bytes == IND_CORE_BUNDLE_CONTROL_LEN) {
+        bundle_reply_type = get_be(data.data + 4, 2);
+    }
+}
+
+/* Counts from the last flow or aggregate stats request's replies */
+int reply_flow_count = 0;
+uint64_t reply_packets = 0;
+uint64_t reply_bytes = 0;
+
+static void
+flow_stats_reply_record(of_flow_stats_reply_t *reply)
+{
+    of_list_flow_stats_entry_t list;
+    of_flow_stats_entry_t entry;
+    uint64_t count;
+    int rv;
+
+    of_flow_stats_reply_entries_bind(reply, &list);
+    OF_LIST_FLOW_STATS_ENTRY_ITER(&list, &entry, rv) {
+        reply_flow_count++;
+        of_flow_stats_entry_packet_count_get(&entry, &count);
+        reply_packets += count;
+        of_flow_stats_entry_byte_count_get(&entry, &count);
+        reply_bytes += count;
+    }
+}
+
+static void
+aggregate_stats_reply_record(of_aggregate_stats_reply_t *reply)
+{
+    uint32_t flows;
+
+    of_aggregate_stats_reply_flow_count_get(reply, &flows);
+    of_aggregate_stats_reply_packet_count_get(reply, &reply_packets);
+    of_aggregate_stats_reply_byte_count_get(reply, &reply_bytes);
+    reply_flow_count = flows;
+}
+
 indigo_error_t
 indigo_cxn_send_controller_message(indigo_cxn_id_t cxn_id, of_object_t *obj)
 {
     AIM_LOG_VERBOSE("Send msg called for cxn id %d, obj type %d\n",
                       cxn_id, obj->object_id);
+    if (obj->object_id == OF_EXPERIMENTER) {
+        monitor_update_record(obj);
+        bundle_reply_record(obj);
+    } else if (obj->object_id == OF_FLOW_STATS_REPLY) {
+        flow_stats_reply_record(obj);
+    } else if (obj->object_id == OF_AGGREGATE_STATS_REPLY) {
+        aggregate_stats_reply_record(obj);
+    }
     of_object_delete(obj);
     return INDIGO_ERROR_NONE;
 }
 
+#define MAX_CXN_STATUS_HANDLERS 4
+indigo_cxn_status_change_f cxn_status_handlers[MAX_CXN_STATUS_HANDLERS];
+int cxn_status_handler_count = 0;
+
+indigo_error_t
+indigo_cxn_status_change_register(indigo_cxn_status_change_f handler,
+                                  void *cookie)
+{
+    if (cxn_status_handler_count == MAX_CXN_STATUS_HANDLERS) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    cxn_status_handlers[cxn_status_handler_count++] = handler;
+    return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t
+indigo_cxn_status_change_unregister(indigo_cxn_status_change_f handler,
+                                    void *cookie)
+{
+    int idx;
+
+    for (idx = 0; idx < cxn_status_handler_count; idx++) {
+        if (cxn_status_handlers[idx] == handler) {
+            cxn_status_handlers[idx] =
+                cxn_status_handlers[--cxn_status_handler_count];
+            break;
+        }
+    }
+    return INDIGO_ERROR_NONE;
+}
+
+/* Tell every registered handler that a connection changed state */
+static void
+cxn_status_change(indigo_cxn_id_t cxn_id, indigo_cxn_state_t state)
+{
+    int idx;
+
+    for (idx = 0; idx < cxn_status_handler_count; idx++) {
+        cxn_status_handlers[idx](cxn_id, NULL, state, NULL);
+    }
+}
+
 indigo_error_t
 ind_cxn_message_track_setup(indigo_cxn_id_t cxn_id, of_object_t *obj)
 {
@@ -261,16 +475,18 @@ indigo_error_t indigo_port_desc_stats_get(
     return INDIGO_ERROR_NONE;
 }
 
+indigo_error_t group_add_error = INDIGO_ERROR_NONE;
+
 indigo_error_t
 indigo_fwd_group_add(uint32_t id, uint8_t group_type, of_list_bucket_t *buckets)
 {
-    return INDIGO_ERROR_NOT_SUPPORTED;
+    return group_add_error;
 }
 
 indigo_error_t
 indigo_fwd_group_modify(uint32_t id, of_list_bucket_t *buckets)
 {
-    return INDIGO_ERROR_NOT_SUPPORTED;
+    return INDIGO_ERROR_NONE;
 }
 
 void
@@ -283,6 +499,36 @@ indigo_fwd_group_stats_get(uint32_t id, of_group_stats_entry_t *entry)
 {
 }
 
+/* Flow ID forwarding reports missing on reconcile; 0 for none */
+indigo_flow_id_t reconcile_missing_flow_id = 0;
+int reconcile_finish_count = 0;
+int reconcile_finish_purge = -1;           /* As of the last finish */
+
+indigo_error_t
+indigo_fwd_flow_reconcile(indigo_cookie_t flow_id, of_flow_add_t *flow_add,
+                          uint8_t *table_id)
+{
+    if (flow_id == reconcile_missing_flow_id) {
+        return INDIGO_ERROR_NOT_FOUND;
+    }
+    *table_id = 0;
+    return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t
+indigo_fwd_group_reconcile(uint32_t id, uint8_t group_type,
+                           of_list_bucket_t *buckets)
+{
+    return INDIGO_ERROR_NONE;
+}
+
+void
+indigo_fwd_reconcile_finish(int purge)
+{
+    reconcile_finish_count++;
+    reconcile_finish_purge = purge;
+}
+
 
 
 static int
@@ -345,13 +591,15 @@ depopulate_table(ft_instance_t ft)
 {
     int idx;
     ft_entry_t *entry;
+    of_match_t match;
     int count;
 
     count = ft->status.current_count;
     for (idx = 0; idx < count; ++idx) {
         entry = ft_lookup(ft, TEST_KEY(idx));
         TEST_ASSERT(entry != NULL);
-        TEST_ASSERT(entry->match.fields.eth_type == TEST_ETH_TYPE(idx));
+        ft_entry_match_get(entry, &match);
+        TEST_ASSERT(match.fields.eth_type == TEST_ETH_TYPE(idx));
         ft_delete_id(ft, TEST_KEY(idx));
         TEST_ASSERT(check_table_entry_states(ft) == 0);
     }
@@ -359,13 +607,29 @@ depopulate_table(ft_instance_t ft)
     return 0;
 }
 
+/* Count entries in both bucket arrays of an index */
+static int
+index_entry_count(ft_index_t *index)
+{
+    int count = 0;
+    int idx;
+
+    for (idx = 0; idx < index->bucket_count; idx++) {
+        count += list_length(&index->buckets[idx]);
+    }
+    for (idx = 0; index->old_buckets && idx < index->old_bucket_count; idx++) {
+        count += list_length(&index->old_buckets[idx]);
+    }
+
+    return count;
+}
+
 static int
 check_bucket_counts(ft_instance_t ft, int expected)
 {
     int count = 0;
     ft_entry_t *_entry;
     list_links_t *cur, *next;
-    int idx;
 
     FT_ITER(ft, _entry, cur, next) {
         (void)_entry;
@@ -374,17 +638,9 @@ check_bucket_counts(ft_instance_t ft, int expected)
     TEST_ASSERT(count == expected);
 
     /* Check the buckets */
-    count = 0;
-    for (idx = 0; idx < ft->config.flow_id_bucket_count; idx++) {
-        count += list_length(&ft->flow_id_buckets[idx]);
-    }
-    TEST_ASSERT(count == expected);
-
-    count = 0;
-    for (idx = 0; idx < ft->config.strict_match_bucket_count; idx++) {
-        count += list_length(&ft->strict_match_buckets[idx]);
-    }
-    TEST_ASSERT(count == expected);
+    TEST_ASSERT(index_entry_count(&ft->flow_id_index) == expected);
+    TEST_ASSERT(index_entry_count(&ft->strict_match_index) == expected);
+    TEST_ASSERT(index_entry_count(&ft->overlap_index) == expected);
 
     return 0;
 }
@@ -661,6 +917,70 @@ test_ft_hash(void)
     return TEST_PASS;
 }
 
+/* Indexes grow and shrink with the entry count, migrating incrementally */
+static int
+test_ft_index_resize(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = {
+        0, /* strict_match buckets */
+        0, /* flow_id buckets */
+    };
+    of_meta_match_t query;
+    ft_entry_t *entry;
+    uint32_t hist[FT_INDEX_CHAIN_HIST_SIZE];
+    int idx, total, max_chain, peak;
+
+    ft = ft_create(&config);
+    TEST_ASSERT(ft != NULL);
+    TEST_ASSERT(ft->flow_id_index.bucket_count == FT_INDEX_BUCKETS_MIN);
+
+    TEST_OK(populate_table(ft, TEST_FLOW_COUNT, &query.match));
+    TEST_ASSERT(check_bucket_counts(ft, TEST_FLOW_COUNT) == 0);
+    TEST_ASSERT(ft->flow_id_index.grows > 0);
+    TEST_ASSERT(ft->strict_match_index.grows > 0);
+    TEST_ASSERT(ft->flow_id_index.bucket_count >= TEST_FLOW_COUNT / 2);
+
+    /* Every entry is reachable by both indexes */
+    INDIGO_MEM_SET(&query, 0, sizeof(query));
+    entry = ft_lookup(ft, TEST_KEY(0));
+    TEST_ASSERT(entry != NULL);
+    ft_entry_match_get(entry, &query.match);
+    query.mode = OF_MATCH_STRICT;
+    query.check_priority = 1;
+    query.priority = entry->priority;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    query.table_id = TABLE_ID_ANY;
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        TEST_ASSERT((entry = ft_lookup(ft, TEST_KEY(idx))) != NULL);
+        query.match.fields.eth_type = TEST_ETH_TYPE(idx);
+        TEST_INDIGO_OK(ft_strict_match(ft, &query, &entry));
+        TEST_ASSERT(entry->id == TEST_KEY(idx));
+    }
+
+    /* Histogram covers every bucket */
+    ft_index_chain_histogram(&ft->flow_id_index, hist, &max_chain);
+    total = 0;
+    for (idx = 0; idx < FT_INDEX_CHAIN_HIST_SIZE; idx++) {
+        total += hist[idx];
+    }
+    TEST_ASSERT(total == ft->flow_id_index.bucket_count +
+                (ft->flow_id_index.old_buckets ?
+                 ft->flow_id_index.old_bucket_count -
+                 ft->flow_id_index.migrate_idx : 0));
+    TEST_ASSERT(max_chain > 0 && max_chain < 16);
+
+    peak = ft->flow_id_index.bucket_count;
+    TEST_OK(depopulate_table(ft));
+    TEST_ASSERT(check_bucket_counts(ft, 0) == 0);
+    TEST_ASSERT(ft->flow_id_index.shrinks > 0);
+    TEST_ASSERT(ft->flow_id_index.bucket_count < peak);
+
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
 static int
 add_flow(ft_instance_t ft, int id, ft_entry_t **entry_p)
 {
@@ -830,201 +1150,2512 @@ test_ft_iterator(void)
     return TEST_PASS;
 }
 
-struct iter_task_state {
-    ft_instance_t ft;
-    int finished;
-    int entries_seen;
-};
+/* Add an OF 1.3 flow matching eth_type and, if ipv4_mask != 0, ipv4_dst */
+static int
+add_masked_flow(ft_instance_t ft, int id, uint8_t table_id, uint16_t priority,
+                uint32_t ipv4_dst, uint32_t ipv4_mask, ft_entry_t **entry_p)
+{
+    of_flow_add_t *flow_add;
+    of_match_t match;
 
-static void
-iter_task_cb(void *cookie, ft_entry_t *entry)
+    memset(&match, 0, sizeof(match));
+    match.version = OF_VERSION_1_3;
+    match.fields.eth_type = 0x0800;
+    match.masks.eth_type = 0xffff;
+    match.fields.ipv4_dst = ipv4_dst & ipv4_mask;
+    match.masks.ipv4_dst = ipv4_mask;
+
+    flow_add = of_flow_add_new(OF_VERSION_1_3);
+    of_flow_add_table_id_set(flow_add, table_id);
+    of_flow_add_priority_set(flow_add, priority);
+    of_flow_add_cookie_set(flow_add, id);
+    TEST_OK(of_flow_add_match_set(flow_add, &match));
+    TEST_INDIGO_OK(ft_add(ft, id, flow_add, entry_p));
+    of_object_delete(flow_add);
+
+    return 0;
+}
+
+/* Check the iterator returns exactly the entries a full scan matches */
+static int
+check_query(ft_instance_t ft, of_meta_match_t *query, int expected)
 {
-    struct iter_task_state *state = cookie;
-    if (entry != NULL) {
-        state->finished = 0;
-        state->entries_seen++;
-        ASSERT(ft_delete(state->ft, entry) == 0);
-    } else {
-        state->finished = 1;
+    ft_iterator_t iter;
+    ft_entry_t *entry;
+    int count = 0;
+
+    ft_iterator_init(&iter, ft, query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_ASSERT(ft_entry_meta_match(query, entry));
+        count++;
     }
+    ft_iterator_cleanup(&iter);
+
+    TEST_ASSERT(count == count_matching(ft, query));
+    TEST_ASSERT(count == expected);
+
+    return 0;
 }
 
 static int
-test_ft_iter_task(void)
+test_ft_mask_groups(void)
 {
     ft_instance_t ft;
-    ft_config_t config = {
-        1024, /* strict_match buckets */
-        1024, /* flow_id buckets */
-    };
-    of_flow_add_t *flow_add1, *flow_add2;
-    ft_entry_t *entry1, *entry2;
-    struct iter_task_state state;
+    ft_config_t config = { 0, 0 };
+    of_meta_match_t query;
+    ft_iterator_t iter;
+    ft_entry_t *entry, *after;
+    int seen[90];
+    int i, count;
 
     ft = ft_create(&config);
 
-    flow_add1 = of_flow_add_new(OF_VERSION_1_0);
-    of_flow_add_OF_VERSION_1_0_populate(flow_add1, 1);
-    of_flow_add_flags_set(flow_add1, 0);
-
-    flow_add2 = of_flow_add_new(OF_VERSION_1_0);
-    of_flow_add_OF_VERSION_1_0_populate(flow_add2, 2);
-    of_flow_add_flags_set(flow_add2, 0);
-
-    TEST_INDIGO_OK(ft_add(ft, 1, flow_add1, &entry1));
-    TEST_INDIGO_OK(ft_add(ft, 2, flow_add2, &entry2));
-
-    state = (struct iter_task_state) { .ft = ft, .finished = -1, .entries_seen = 0 };
-    ft_spawn_iter_task(ft, NULL, iter_task_cb, &state, IND_SOC_DEFAULT_PRIORITY);
-    TEST_ASSERT(state.finished == -1);
-    TEST_ASSERT(state.entries_seen == 0);
-    TEST_ASSERT(ft->status.current_count == 2);
-    while (state.finished != 1) {
-        ind_soc_select_and_run(0);
+    /*
+     * 3 tables x 3 masks: eth_type only, ipv4_dst /16 and ipv4_dst /24.
+     * Each table holds 10 /16 flows in 10.0/8 and 10 /24 flows in 10.1/16.
+     */
+    for (i = 0; i < 90; i++) {
+        uint8_t table_id = i % 3;
+        switch ((i / 3) % 3) {
+        case 0:
+            TEST_OK(add_masked_flow(ft, i, table_id, 0, 0, 0, &entry));
+            break;
+        case 1:
+            TEST_OK(add_masked_flow(ft, i, table_id, 0, 0x0a000000 | (i << 16),
+                                    0xffff0000, &entry));
+            break;
+        case 2:
+            TEST_OK(add_masked_flow(ft, i, table_id, 0, 0x0a010000 | (i << 8),
+                                    0xffffff00, &entry));
+            break;
+        }
+        TEST_ASSERT(entry->table_id == table_id);
     }
-    TEST_ASSERT(state.finished == 1);
-    TEST_ASSERT(state.entries_seen == 2);
-    TEST_ASSERT(ft->status.current_count == 0);
+    TEST_ASSERT(ft->mask_group_count == 9);
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_NON_STRICT;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    query.table_id = TABLE_ID_ANY;
+    query.match.version = OF_VERSION_1_3;
+
+    /* Match-all query */
+    TEST_OK(check_query(ft, &query, 90));
+
+    /* All IPv4 flows, one table */
+    query.match.fields.eth_type = 0x0800;
+    query.match.masks.eth_type = 0xffff;
+    query.table_id = 1;
+    TEST_OK(check_query(ft, &query, 30));
+
+    /* One subnet; the /16 groups and the eth_type-only groups are skipped */
+    query.table_id = TABLE_ID_ANY;
+    query.match.fields.ipv4_dst = 0x0a010000;
+    query.match.masks.ipv4_dst = 0xffff0000;
+    TEST_OK(check_query(ft, &query, 30));
+
+    /* More specific than any /16 entry */
+    query.match.masks.ipv4_dst = 0xffffffff;
+    TEST_OK(check_query(ft, &query, 0));
+
+    /* Strict mode only visits groups with equal masks */
+    query.mode = OF_MATCH_STRICT;
+    query.match.fields.ipv4_dst = 0x0a010000 | (6 << 8);
+    query.match.masks.ipv4_dst = 0xffffff00;
+    TEST_OK(check_query(ft, &query, 1));
+
+    /* Moving an entry between tables moves it between groups */
+    TEST_ASSERT((entry = ft_lookup(ft, 0)) != NULL);
+    TEST_INDIGO_OK(ft_entry_set_table_id(ft, entry, 7));
+    TEST_ASSERT(entry->table_id == 7);
+    TEST_ASSERT(ft->mask_group_count == 10);
+    memset(&query.match, 0, sizeof(query.match));
+    query.match.version = OF_VERSION_1_3;
+    query.mode = OF_MATCH_NON_STRICT;
+    query.table_id = 7;
+    TEST_OK(check_query(ft, &query, 1));
+    query.table_id = 0;
+    TEST_OK(check_query(ft, &query, 29));
+
+    /* Delete by subnet while iterating; emptied groups are freed */
+    query.table_id = TABLE_ID_ANY;
+    query.match.fields.eth_type = 0x0800;
+    query.match.masks.eth_type = 0xffff;
+    query.match.fields.ipv4_dst = 0x0a000000;
+    query.match.masks.ipv4_dst = 0xff000000;
+    count = 0;
+    ft_iterator_init(&iter, ft, &query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_INDIGO_OK(ft_delete(ft, entry));
+        count++;
+    }
+    ft_iterator_cleanup(&iter);
+    TEST_ASSERT(count == 60);
+    TEST_ASSERT(ft->status.current_count == 30);
+    TEST_ASSERT(ft->mask_group_count == 4);
+
+    /* Remaining entries are all eth_type only */
+    memset(&query.match, 0, sizeof(query.match));
+    query.match.version = OF_VERSION_1_3;
+    TEST_OK(check_query(ft, &query, 30));
+
+    /*
+     * Entries leaving the group an iterator is about to return them from
+     * are still returned once: one into a group already walked, one into
+     * a group ahead.
+     */
+    memset(seen, 0, sizeof(seen));
+    count = 0;
+    ft_iterator_init(&iter, ft, &query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_ASSERT(entry->id < 90 && !seen[entry->id]);
+        seen[entry->id] = 1;
+        count++;
+        if (count == 12) {
+            TEST_ASSERT(iter.next_entry->table_id == 1);
+            TEST_INDIGO_OK(ft_entry_set_table_id(ft, iter.next_entry, 0));
+            TEST_ASSERT(iter.next_entry->table_id == 1);
+            TEST_INDIGO_OK(ft_entry_set_table_id(ft, iter.next_entry, 2));
+        }
+    }
+    ft_iterator_cleanup(&iter);
+    TEST_ASSERT(count == 30);
+
+    /* A held entry is returned again first, unless it is deleted */
+    ft_iterator_init(&iter, ft, &query);
+    TEST_ASSERT((entry = ft_iterator_next(&iter)) != NULL);
+    TEST_INDIGO_OK(ft_iterator_hold(&iter, entry));
+    TEST_ASSERT(ft_iterator_next(&iter) == entry);
+    TEST_INDIGO_OK(ft_iterator_hold(&iter, entry));
+    after = iter.next_entry;
+    TEST_INDIGO_OK(ft_delete(ft, entry));
+    TEST_ASSERT(ft_iterator_next(&iter) == after);
+    ft_iterator_cleanup(&iter);
 
     ft_destroy(ft);
-    of_object_delete(flow_add1);
-    of_object_delete(flow_add2);
 
     return TEST_PASS;
 }
 
+/* Compare ft_overlap_find with a full scan */
 static int
-test_hello(void)
+check_overlap(ft_instance_t ft, of_meta_match_t *query, int expected)
 {
-    of_hello_t *hello;
-
-    hello = of_hello_new(OF_VERSION_1_0);
-    TEST_INDIGO_OK(indigo_core_receive_controller_message(0, hello));
+    ft_entry_t *entry = NULL, *scan_entry;
+
+    TEST_ASSERT((ft_overlap_find(ft, query, &entry) == INDIGO_ERROR_NONE) ==
+                expected);
+    TEST_ASSERT((first_match(ft, query, &scan_entry) == INDIGO_ERROR_NONE) ==
+                expected);
+    if (expected) {
+        TEST_ASSERT(ft_entry_meta_match(query, entry));
+    }
 
-    return TEST_PASS;
+    return 0;
 }
 
 static int
-test_packet_out(void)
+test_ft_overlap(void)
 {
-    of_packet_out_t *pkt_out;
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_meta_match_t query;
+    ft_entry_t *entry;
+    uint64_t visits;
+    int i;
 
-    pkt_out = of_packet_out_new(OF_VERSION_1_0);
-    /* Could add params, but core doesn't do anything with them */
-    TEST_INDIGO_OK(indigo_core_receive_controller_message(0, pkt_out));
+    ft = ft_create(&config);
+
+    /*
+     * 1000 /24 flows in 10.0/16 at priorities 100..109, plus one
+     * eth_type-only flow at priority 100 in table 1.
+     */
+    for (i = 0; i < 1000; i++) {
+        uint16_t priority = 100 + i % 10;
+        uint32_t ipv4_dst = 0x0a000000 | ((i & 0xff) << 8) | (i >> 8);
+        TEST_OK(add_masked_flow(ft, i, 0, priority, ipv4_dst, 0xffffff00,
+                                &entry));
+    }
+    TEST_OK(add_masked_flow(ft, 1000, 1, 100, 0, 0, &entry));
+    TEST_OK(check_bucket_counts(ft, 1001));
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_OVERLAP;
+    query.check_priority = 1;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    query.match.version = OF_VERSION_1_3;
+    query.match.fields.eth_type = 0x0800;
+    query.match.masks.eth_type = 0xffff;
+
+    /* A host route inside an existing /24 at the same priority */
+    query.table_id = 0;
+    query.priority = 105;
+    query.match.fields.ipv4_dst = 0x0a000505;
+    query.match.masks.ipv4_dst = 0xffffffff;
+    visits = ft->status.overlap_visits;
+    TEST_OK(check_overlap(ft, &query, 1));
+    TEST_ASSERT(ft->status.overlap_visits - visits == 1);
+
+    /* Same /24 at a priority it is not installed at */
+    query.priority = 106;
+    visits = ft->status.overlap_visits;
+    TEST_OK(check_overlap(ft, &query, 0));
+    TEST_ASSERT(ft->status.overlap_visits - visits == 0);
+
+    /* Outside 10.0/16 */
+    query.priority = 105;
+    query.match.fields.ipv4_dst = 0x0b000505;
+    TEST_OK(check_overlap(ft, &query, 0));
+
+    /* A /8 covering everything scans the partition */
+    query.match.fields.ipv4_dst = 0x0a000000;
+    query.match.masks.ipv4_dst = 0xff000000;
+    TEST_OK(check_overlap(ft, &query, 1));
+
+    /* Different eth_type never overlaps */
+    query.match.fields.eth_type = 0x86dd;
+    query.match.masks.ipv4_dst = 0;
+    TEST_OK(check_overlap(ft, &query, 0));
+
+    /* Any table finds the eth_type-only flow in table 1 */
+    query.table_id = TABLE_ID_ANY;
+    query.priority = 100;
+    query.match.fields.eth_type = 0x0800;
+    query.match.fields.ipv4_dst = 0x0c000000;
+    query.match.masks.ipv4_dst = 0xff000000;
+    TEST_OK(check_overlap(ft, &query, 1));
+    query.table_id = 0;
+    TEST_OK(check_overlap(ft, &query, 0));
+
+    /* Moving the flow to table 0 moves it in the overlap index */
+    TEST_INDIGO_OK(ft_entry_set_table_id(ft, ft_lookup(ft, 1000), 0));
+    TEST_OK(check_overlap(ft, &query, 1));
+
+    for (i = 0; i <= 1000; i++) {
+        TEST_INDIGO_OK(ft_delete_id(ft, i));
+    }
+    TEST_OK(check_bucket_counts(ft, 0));
+    for (i = 0; i < FT_OVERLAP_PART_BUCKETS; i++) {
+        TEST_ASSERT(list_empty(&ft->overlap_part_buckets[i]));
+    }
+
+    ft_destroy(ft);
 
     return TEST_PASS;
 }
 
-static int
-test_packet_in(void)
+/* Make an OF 1.0 flow add outputting to port1 (twice) and port2, if not 0 */
+static of_flow_add_t *
+make_out_port_flow(of_port_no_t port1, of_port_no_t port2)
 {
-    of_packet_in_t *pkt_in;
+    of_flow_add_t *flow_add;
+    of_list_action_t *list;
+    of_action_t elt;
+    of_port_no_t ports[3] = { port1, port1, port2 };
+    int i;
 
-    pkt_in = of_packet_in_new(OF_VERSION_1_0);
-    /* Could add params, but core doesn't do anything with them */
-    TEST_INDIGO_OK(indigo_core_packet_in(pkt_in));
+    flow_add = of_flow_add_new(OF_VERSION_1_0);
+    list = of_list_action_new(OF_VERSION_1_0);
+    for (i = 0; i < 3; i++) {
+        if (ports[i] != 0) {
+            of_action_output_init(&elt.output, OF_VERSION_1_0, -1, 1);
+            ASSERT(of_list_action_append_bind(list, &elt) == 0);
+            of_action_output_port_set(&elt.output, ports[i]);
+        }
+    }
+    ASSERT(of_flow_add_actions_set(flow_add, list) == 0);
+    of_list_action_delete(list);
 
-    return TEST_PASS;
+    return flow_add;
 }
 
+/* Count iterator results for an out_port query, checking against a scan */
 static int
-test_experimenter(void)
+count_out_port(ft_instance_t ft, of_meta_match_t *query, of_port_no_t port)
 {
-    of_experimenter_t *exp;
+    ft_iterator_t iter;
+    int count = 0;
+
+    query->out_port = port;
+    ft_iterator_init(&iter, ft, query);
+    while (ft_iterator_next(&iter) != NULL) {
+        count++;
+    }
+    ft_iterator_cleanup(&iter);
+    ASSERT(count == count_matching(ft, query));
+
+    return count;
+}
+
+static int
+test_ft_out_port(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_meta_match_t query;
+    of_flow_add_t *flow_add;
+    ft_iterator_t iter;
+    ft_entry_t *entry;
+    int i, count;
+
+    ft = ft_create(&config);
+
+    /* Flow i outputs to port i % 10 + 1 and, if i is odd, port 100 */
+    for (i = 0; i < 300; i++) {
+        flow_add = make_out_port_flow(i % 10 + 1, i % 2 ? 100 : 0);
+        of_flow_add_priority_set(flow_add, i);
+        TEST_INDIGO_OK(ft_add(ft, i, flow_add, &entry));
+        of_object_delete(flow_add);
+        TEST_ASSERT(entry->out_port_count == 1 + (i & 1));
+    }
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_NON_STRICT;
+    query.table_id = TABLE_ID_ANY;
+    query.match.version = OF_VERSION_1_0;
+
+    TEST_ASSERT(count_out_port(ft, &query, 3) == 30);
+    TEST_ASSERT(count_out_port(ft, &query, 100) == 150);
+    TEST_ASSERT(count_out_port(ft, &query, 50) == 0);
+
+    /* Moving flows to another port while iterating returns each once */
+    flow_add = make_out_port_flow(200, 0);
+    query.out_port = 100;
+    count = 0;
+    ft_iterator_init(&iter, ft, &query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_INDIGO_OK(ft_entry_modify_effects(ft, entry, flow_add));
+        count++;
+    }
+    ft_iterator_cleanup(&iter);
+    of_object_delete(flow_add);
+    TEST_ASSERT(count == 150);
+    TEST_ASSERT(count_out_port(ft, &query, 100) == 0);
+    TEST_ASSERT(count_out_port(ft, &query, 200) == 150);
+    TEST_ASSERT(count_out_port(ft, &query, 3) == 30);
+    TEST_ASSERT(count_out_port(ft, &query, 4) == 0);
+
+    /* Port down: delete all flows out port 3 */
+    query.out_port = 3;
+    count = 0;
+    ft_iterator_init(&iter, ft, &query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_INDIGO_OK(ft_delete(ft, entry));
+        count++;
+    }
+    ft_iterator_cleanup(&iter);
+    TEST_ASSERT(count == 30);
+    TEST_ASSERT(count_out_port(ft, &query, 3) == 0);
+    TEST_ASSERT(ft->status.current_count == 270);
+
+    for (i = 0; i < 300; i++) {
+        ft_delete_id(ft, i);
+    }
+    for (i = 0; i < FT_OUT_PORT_BUCKETS; i++) {
+        TEST_ASSERT(list_empty(&ft->out_port_buckets[i]));
+    }
+
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+/* An OF 1.3 action list with a group action for each nonzero group ID */
+static of_list_action_t *
+make_group_actions(uint32_t group1, uint32_t group2)
+{
+    of_list_action_t *list;
+    of_action_t elt;
+    uint32_t ids[2] = { group1, group2 };
+    int i;
+
+    list = of_list_action_new(OF_VERSION_1_3);
+    for (i = 0; i < 2; i++) {
+        if (ids[i] != 0) {
+            of_action_group_init(&elt.group, OF_VERSION_1_3, -1, 1);
+            ASSERT(of_list_action_append_bind(list, &elt) == 0);
+            of_action_group_group_id_set(&elt.group, ids[i]);
+        }
+    }
+
+    return list;
+}
+
+/* Make an OF 1.3 flow add applying group1 (twice) and writing group2, if not 0 */
+static of_flow_add_t *
+make_out_group_flow(uint32_t group1, uint32_t group2)
+{
+    of_flow_add_t *flow_add;
+    of_list_instruction_t *instructions;
+    of_instruction_apply_actions_t *apply;
+    of_instruction_write_actions_t *write;
+    of_list_action_t *actions;
+
+    flow_add = of_flow_add_new(OF_VERSION_1_3);
+    instructions = of_list_instruction_new(OF_VERSION_1_3);
+
+    apply = of_instruction_apply_actions_new(OF_VERSION_1_3);
+    actions = make_group_actions(group1, group1);
+    ASSERT(of_instruction_apply_actions_actions_set(apply, actions) == 0);
+    ASSERT(of_list_append(instructions, apply) == 0);
+    of_object_delete(actions);
+    of_object_delete(apply);
+
+    if (group2 != 0) {
+        write = of_instruction_write_actions_new(OF_VERSION_1_3);
+        actions = make_group_actions(group2, 0);
+        ASSERT(of_instruction_write_actions_actions_set(write, actions) == 0);
+        ASSERT(of_list_append(instructions, write) == 0);
+        of_object_delete(actions);
+        of_object_delete(write);
+    }
+
+    ASSERT(of_flow_add_instructions_set(flow_add, instructions) == 0);
+    of_object_delete(instructions);
+
+    return flow_add;
+}
+
+static int
+test_ft_out_group(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_flow_add_t *flow_add;
+    ft_entry_t *entry;
+    int i, count;
+
+    ft = ft_create(&config);
+
+    /* Flow i applies group i % 10 + 1 and, if i is odd, writes group 100 */
+    for (i = 0; i < 300; i++) {
+        flow_add = make_out_group_flow(i % 10 + 1, i % 2 ? 100 : 0);
+        of_flow_add_priority_set(flow_add, i);
+        TEST_INDIGO_OK(ft_add(ft, i, flow_add, &entry));
+        of_object_delete(flow_add);
+        TEST_ASSERT(entry->out_group_count == 1 + (i & 1));
+    }
+
+    TEST_ASSERT(ft_out_group_entry_count(ft, 3) == 30);
+    TEST_ASSERT(ft_out_group_entry_count(ft, 100) == 150);
+    TEST_ASSERT(ft_out_group_entry_count(ft, 50) == 0);
+    TEST_ASSERT(ft_out_group_first(ft, 50) == NULL);
+    TEST_ASSERT(ft->out_group_count == 11);
+
+    /* Moving the flows to another group takes them out of the list */
+    flow_add = make_out_group_flow(200, 0);
+    count = 0;
+    while ((entry = ft_out_group_first(ft, 100)) != NULL) {
+        TEST_INDIGO_OK(ft_entry_modify_effects(ft, entry, flow_add));
+        count++;
+    }
+    of_object_delete(flow_add);
+    TEST_ASSERT(count == 150);
+    TEST_ASSERT(ft_out_group_entry_count(ft, 200) == 150);
+    TEST_ASSERT(ft_out_group_entry_count(ft, 3) == 30);
+    TEST_ASSERT(ft_out_group_entry_count(ft, 2) == 0);
+    TEST_ASSERT(ft->out_group_count == 6);
+
+    /* Group deleted: delete all flows forwarding to group 3 */
+    count = 0;
+    while ((entry = ft_out_group_first(ft, 3)) != NULL) {
+        TEST_INDIGO_OK(ft_delete(ft, entry));
+        count++;
+    }
+    TEST_ASSERT(count == 30);
+    TEST_ASSERT(ft->status.current_count == 270);
+
+    for (i = 0; i < 300; i++) {
+        ft_delete_id(ft, i);
+    }
+    TEST_ASSERT(ft->out_group_count == 0);
+
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+static int
+test_ft_effects(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_flow_add_t *flow_add;
+    ft_entry_t *entries[100];
+    ft_effects_t *effects;
+    int i;
+
+    ft = ft_create(&config);
+
+    /* 100 flows share 10 distinct action lists */
+    for (i = 0; i < 100; i++) {
+        flow_add = make_out_port_flow(i % 10 + 1, 0);
+        of_flow_add_priority_set(flow_add, i);
+        TEST_INDIGO_OK(ft_add(ft, i, flow_add, &entries[i]));
+        of_object_delete(flow_add);
+    }
+    TEST_ASSERT(ft->effects_count == 10);
+    TEST_ASSERT(ft->status.effects_shares == 90);
+    effects = entries[3]->cold->shared_effects;
+    TEST_ASSERT(effects == entries[13]->cold->shared_effects);
+    TEST_ASSERT(effects != entries[4]->cold->shared_effects);
+    TEST_ASSERT(effects->refcount == 10);
+    TEST_ASSERT(entries[3]->cold->effects.actions == effects->list.actions);
+    TEST_ASSERT(entries[3]->out_port_refs != entries[13]->out_port_refs);
+    TEST_ASSERT(entries[13]->out_port_count == 1);
+    TEST_ASSERT(entries[13]->out_port_refs[0].port == 4);
+
+    /* Equal effects keep the shared copy */
+    flow_add = make_out_port_flow(4, 0);
+    TEST_INDIGO_OK(ft_entry_modify_effects(ft, entries[3], flow_add));
+    of_object_delete(flow_add);
+    TEST_ASSERT(entries[3]->cold->shared_effects == effects);
+    TEST_ASSERT(effects->refcount == 10);
+
+    /* Moving the last references frees the list */
+    flow_add = make_out_port_flow(1, 0);
+    for (i = 3; i < 100; i += 10) {
+        TEST_INDIGO_OK(ft_entry_modify_effects(ft, entries[i], flow_add));
+        TEST_ASSERT(entries[i]->cold->shared_effects ==
+                    entries[0]->cold->shared_effects);
+    }
+    of_object_delete(flow_add);
+    TEST_ASSERT(ft->effects_count == 9);
+    TEST_ASSERT(entries[0]->cold->shared_effects->refcount == 20);
+
+    /* Different versions of the same bytes are not shared */
+    flow_add = of_flow_add_new(OF_VERSION_1_3);
+    TEST_INDIGO_OK(ft_add(ft, 100, flow_add, NULL));
+    of_object_delete(flow_add);
+    flow_add = of_flow_add_new(OF_VERSION_1_0);
+    TEST_INDIGO_OK(ft_add(ft, 101, flow_add, NULL));
+    of_object_delete(flow_add);
+    TEST_ASSERT(ft->effects_count == 11);
+    TEST_ASSERT(ft_lookup(ft, 100)->cold->shared_effects !=
+                ft_lookup(ft, 101)->cold->shared_effects);
+
+    for (i = 0; i < 102; i++) {
+        ft_delete_id(ft, i);
+    }
+    TEST_ASSERT(ft->effects_count == 0);
+
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+/* Matches that differ from variant 0 in a single field or mask */
+static void
+make_strict_key_match(of_match_t *match, int variant)
+{
+    memset(match, 0, sizeof(*match));
+    match->version = OF_VERSION_1_3;
+    match->fields.eth_type = 0x86dd;
+    match->masks.eth_type = 0xffff;
+
+    switch (variant) {
+    case 1:
+        match->fields.ipv6_dst.addr[15] = 1;
+        match->masks.ipv6_dst.addr[15] = 0xff;
+        break;
+    case 2:
+        match->fields.ipv6_dst.addr[15] = 2;
+        match->masks.ipv6_dst.addr[15] = 0xff;
+        break;
+    case 3:
+        match->masks.ipv6_dst.addr[15] = 0xff;
+        break;
+    case 4:
+        match->fields.bsn_l3_dst_class_id = 1;
+        match->masks.bsn_l3_dst_class_id = 0xffffffff;
+        break;
+    }
+}
+
+#define STRICT_KEY_VARIANTS 5
+
+static int
+test_ft_strict_key(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_meta_match_t query;
+    of_flow_add_t *flow_add;
+    of_match_t match;
+    ft_entry_t *entry;
+    int i;
+
+    ft = ft_create(&config);
+
+    for (i = 0; i < STRICT_KEY_VARIANTS; i++) {
+        make_strict_key_match(&match, i);
+        flow_add = of_flow_add_new(OF_VERSION_1_3);
+        of_flow_add_priority_set(flow_add, 10);
+        TEST_OK(of_flow_add_match_set(flow_add, &match));
+        TEST_INDIGO_OK(ft_add(ft, i, flow_add, NULL));
+        of_object_delete(flow_add);
+    }
+
+    /* Each stored match finds exactly its own entry at its own priority */
+    for (i = 0; i < STRICT_KEY_VARIANTS; i++) {
+        memset(&query, 0, sizeof(query));
+        query.mode = OF_MATCH_STRICT;
+        query.check_priority = 1;
+        query.priority = 10;
+        query.table_id = TABLE_ID_ANY;
+        query.out_port = OF_PORT_DEST_WILDCARD;
+        ft_entry_match_get(ft_lookup(ft, i), &query.match);
+
+        TEST_INDIGO_OK(ft_strict_match(ft, &query, &entry));
+        TEST_ASSERT(entry->id == i);
+        TEST_ASSERT(count_matching(ft, &query) == 1);
+
+        query.priority = 11;
+        TEST_ASSERT(ft_strict_match(ft, &query, &entry) ==
+                    INDIGO_ERROR_NOT_FOUND);
+
+        /* Like of_match_eq, the key covers the version */
+        query.priority = 10;
+        query.match.version = OF_VERSION_1_2;
+        TEST_ASSERT(count_matching(ft, &query) == 0);
+        TEST_ASSERT(ft_strict_match(ft, &query, &entry) ==
+                    INDIGO_ERROR_NOT_FOUND);
+    }
+
+    for (i = 0; i < STRICT_KEY_VARIANTS; i++) {
+        ft_delete_id(ft, i);
+    }
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+/*
+ * Exact cookie queries visit only that cookie's entries
+ */
+
+#define COOKIE_APPS 4
+#define COOKIE_FLOWS_PER_APP 300
+#define COOKIE_FLOW(app, i) (((uint64_t)(app) << 56) | (uint64_t)(i) >> 1)
+
+static int
+test_ft_cookie_index(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_meta_match_t query;
+    of_flow_add_t *flow_add;
+    ft_iterator_t iter;
+    ft_entry_t *entry;
+    int app, i, id, count;
+
+    ft = ft_create(&config);
+
+    /* Application in the top byte; two flows per low order cookie */
+    for (app = 0; app < COOKIE_APPS; app++) {
+        for (i = 0; i < COOKIE_FLOWS_PER_APP; i++) {
+            id = app * COOKIE_FLOWS_PER_APP + i;
+            flow_add = of_flow_add_new(OF_VERSION_1_3);
+            of_flow_add_priority_set(flow_add, i);
+            of_flow_add_cookie_set(flow_add, COOKIE_FLOW(app, i));
+            TEST_INDIGO_OK(ft_add(ft, id, flow_add, NULL));
+            of_object_delete(flow_add);
+        }
+    }
+    TEST_ASSERT(ft->cookie_group_count ==
+                COOKIE_APPS * COOKIE_FLOWS_PER_APP / 2);
+    TEST_ASSERT(ft->cookie_index.grows > 0);
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_NON_STRICT;
+    query.cookie_mask = (uint64_t)-1;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    query.table_id = TABLE_ID_ANY;
+
+    /* Both entries of a cookie and nothing else; delete while iterating */
+    query.cookie = COOKIE_FLOW(2, 10);
+    count = 0;
+    ft_iterator_init(&iter, ft, &query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_ASSERT(entry->cookie == query.cookie);
+        TEST_ASSERT(entry->cookie_group->cookie == query.cookie);
+        count++;
+        ft_delete(ft, entry);
+    }
+    ft_iterator_cleanup(&iter);
+    TEST_ASSERT(count == 2);
+    TEST_ASSERT(ft->cookie_group_count ==
+                COOKIE_APPS * COOKIE_FLOWS_PER_APP / 2 - 1);
+
+    /* The deleted cookie is gone; an unused one finds nothing */
+    ft_iterator_init(&iter, ft, &query);
+    TEST_ASSERT(ft_iterator_next(&iter) == NULL);
+    ft_iterator_cleanup(&iter);
+    query.cookie = COOKIE_FLOW(COOKIE_APPS, 0);
+    ft_iterator_init(&iter, ft, &query);
+    TEST_ASSERT(ft_iterator_next(&iter) == NULL);
+    ft_iterator_cleanup(&iter);
+
+    /* A prefix mask still returns the whole application */
+    query.cookie = COOKIE_FLOW(1, 0);
+    query.cookie_mask = 0xffffffff00000000ULL;
+    count = 0;
+    ft_iterator_init(&iter, ft, &query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        TEST_ASSERT(entry->cookie >> 56 == 1);
+        count++;
+    }
+    ft_iterator_cleanup(&iter);
+    TEST_ASSERT(count == COOKIE_FLOWS_PER_APP);
+    TEST_ASSERT(count_matching(ft, &query) == COOKIE_FLOWS_PER_APP);
+
+    for (id = 0; id < COOKIE_APPS * COOKIE_FLOWS_PER_APP; id++) {
+        ft_delete_id(ft, id);
+    }
+    TEST_ASSERT(ft->cookie_group_count == 0);
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+/*
+ * Running aggregates agree with a scan of the table
+ */
+
+#define AGGREGATE_FLOWS 40
+
+static void
+scan_aggregate(ft_instance_t ft, of_meta_match_t *query, ft_aggregate_t *agg)
+{
+    ft_iterator_t iter;
+    ft_entry_t *entry;
+
+    memset(agg, 0, sizeof(*agg));
+    ft_iterator_init(&iter, ft, query);
+    while ((entry = ft_iterator_next(&iter)) != NULL) {
+        agg->flow_count++;
+        agg->packets += entry->cold->packets;
+        agg->bytes += entry->cold->bytes;
+    }
+    ft_iterator_cleanup(&iter);
+}
+
+static int
+aggregate_matches_scan(ft_instance_t ft, of_meta_match_t *query)
+{
+    ft_aggregate_t running, scanned;
+
+    if (ft_aggregate_get(ft, query, &running) != INDIGO_ERROR_NONE) {
+        return 0;
+    }
+    scan_aggregate(ft, query, &scanned);
+
+    return running.flow_count == scanned.flow_count &&
+        running.packets == scanned.packets &&
+        running.bytes == scanned.bytes;
+}
+
+/* Check the whole table, tables 0-3 and cookies 0-4 */
+static int
+aggregates_match_scan(ft_instance_t ft)
+{
+    of_meta_match_t query;
+    int i;
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_NON_STRICT;
+    query.table_id = TABLE_ID_ANY;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    if (!aggregate_matches_scan(ft, &query)) {
+        return 0;
+    }
+
+    for (i = 0; i < 4; i++) {
+        query.table_id = i;
+        if (!aggregate_matches_scan(ft, &query)) {
+            return 0;
+        }
+    }
+
+    query.table_id = TABLE_ID_ANY;
+    query.cookie_mask = (uint64_t)-1;
+    for (i = 0; i < 5; i++) {
+        query.cookie = i;
+        if (!aggregate_matches_scan(ft, &query)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int
+test_ft_aggregates(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_meta_match_t query;
+    of_flow_add_t *flow_add;
+    ft_aggregate_t agg;
+    ft_entry_t *entry;
+    uint64_t packets, bytes;
+    int i;
+
+    ft = ft_create(&config);
+
+    for (i = 0; i < AGGREGATE_FLOWS; i++) {
+        flow_add = of_flow_add_new(OF_VERSION_1_3);
+        of_flow_add_priority_set(flow_add, i);
+        of_flow_add_cookie_set(flow_add, i / 10);
+        of_flow_add_table_id_set(flow_add, i / 10);
+        TEST_INDIGO_OK(ft_add(ft, i, flow_add, NULL));
+        of_object_delete(flow_add);
+    }
+    TEST_ASSERT(aggregates_match_scan(ft));
+
+    for (i = 0; i < AGGREGATE_FLOWS; i++) {
+        entry = ft_lookup(ft, i);
+        TEST_ASSERT(ft_entry_counters_set(ft, entry, i * 3 + 1, i * 300, 1));
+        TEST_ASSERT(!ft_entry_counters_set(ft, entry, i * 3 + 1, i * 300, 2));
+        TEST_ASSERT(entry->last_counter_change == 1);
+    }
+    TEST_ASSERT(aggregates_match_scan(ft));
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_NON_STRICT;
+    query.table_id = TABLE_ID_ANY;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    TEST_INDIGO_OK(ft_aggregate_get(ft, &query, &agg));
+    TEST_ASSERT(agg.flow_count == AGGREGATE_FLOWS);
+    TEST_ASSERT(agg.packets ==
+                3 * (AGGREGATE_FLOWS - 1) * AGGREGATE_FLOWS / 2 + AGGREGATE_FLOWS);
+
+    /* Counters shrinking, e.g. after a forwarding reset, are tracked too */
+    TEST_ASSERT(ft_entry_counters_set(ft, ft_lookup(ft, 7), 1, 1, 3));
+    TEST_INDIGO_OK(ft_entry_set_table_id(ft, ft_lookup(ft, 15), 3));
+    TEST_INDIGO_OK(ft_entry_clear_counters(ft, ft_lookup(ft, 25),
+                                           &packets, &bytes));
+    TEST_ASSERT(packets == 76 && bytes == 7500);
+    TEST_ASSERT(aggregates_match_scan(ft));
+
+    /* Cookie 1 loses its last entry; cookie 4 never had one */
+    for (i = 10; i < 20; i++) {
+        TEST_INDIGO_OK(ft_delete_id(ft, i));
+    }
+    query.cookie_mask = (uint64_t)-1;
+    query.cookie = 1;
+    TEST_INDIGO_OK(ft_aggregate_get(ft, &query, &agg));
+    TEST_ASSERT(agg.flow_count == 0 && agg.packets == 0 && agg.bytes == 0);
+    TEST_ASSERT(aggregates_match_scan(ft));
+
+    /* Shapes the totals cannot answer */
+    query.cookie_mask = 0xff;
+    TEST_ASSERT(ft_aggregate_get(ft, &query, &agg) ==
+                INDIGO_ERROR_NOT_SUPPORTED);
+    query.cookie_mask = (uint64_t)-1;
+    query.table_id = 0;
+    TEST_ASSERT(ft_aggregate_get(ft, &query, &agg) ==
+                INDIGO_ERROR_NOT_SUPPORTED);
+    query.cookie_mask = 0;
+    query.out_port = 1;
+    TEST_ASSERT(ft_aggregate_get(ft, &query, &agg) ==
+                INDIGO_ERROR_NOT_SUPPORTED);
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    query.match.masks.eth_type = 0xffff;
+    TEST_ASSERT(ft_aggregate_get(ft, &query, &agg) ==
+                INDIGO_ERROR_NOT_SUPPORTED);
+
+    for (i = 0; i < AGGREGATE_FLOWS; i++) {
+        ft_delete_id(ft, i);
+    }
+    query.match.masks.eth_type = 0;
+    query.table_id = TABLE_ID_ANY;
+    TEST_INDIGO_OK(ft_aggregate_get(ft, &query, &agg));
+    TEST_ASSERT(agg.flow_count == 0 && agg.packets == 0 && agg.bytes == 0);
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+/*
+ * Flow table benchmark
+ *
+ * Reports heap bytes per flow and the time per flow ID and strict match
+ * lookup. The flow count is taken from OFSTATEMANAGER_UTEST_BENCH_FLOWS,
+ * default 10000; set it to e.g. 500000 for a full-scale run.
+ */
+
+static size_t
+heap_in_use(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static double
+elapsed_ns(struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+#define EVICTION_FLOWS 100
+
+/* The eviction key of an entry, smallest evicted first */
+static uint64_t
+eviction_key(ft_eviction_t eviction, ft_entry_t *entry)
+{
+    uint64_t deadline = (uint64_t)-1;
+
+    switch (eviction) {
+    case FT_EVICTION_LRU:
+        return entry->last_counter_change;
+    case FT_EVICTION_PRIORITY:
+        return entry->priority;
+    case FT_EVICTION_EXPIRE:
+        if (entry->hard_timeout > 0) {
+            deadline = entry->insert_time + entry->hard_timeout * 1000;
+        }
+        if (entry->idle_timeout > 0 &&
+                entry->last_counter_change + entry->idle_timeout * 1000 < deadline) {
+            deadline = entry->last_counter_change + entry->idle_timeout * 1000;
+        }
+        return deadline;
+    default:
+        return 0;
+    }
+}
+
+/* Check the victim has the smallest key of the entries in its table */
+static int
+eviction_victim_check(ft_instance_t ft, uint8_t table_id)
+{
+    ft_eviction_t eviction = ft->tables[table_id].eviction;
+    ft_entry_t *victim, *entry;
+    list_links_t *cur, *next;
+
+    victim = ft_eviction_victim(ft, table_id);
+    TEST_ASSERT(victim != NULL && victim->table_id == table_id);
+    TEST_ASSERT(ft->tables[table_id].heap_count ==
+                ft->table_aggregates[table_id].flow_count);
+
+    FT_ITER(ft, entry, cur, next) {
+        if (entry->table_id == table_id) {
+            TEST_ASSERT(eviction_key(eviction, victim) <=
+                        eviction_key(eviction, entry));
+        }
+    }
+
+    return TEST_PASS;
+}
+
+static int
+test_ft_eviction(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_flow_add_t *flow_add;
+    ft_entry_t *entry, *victim;
+    uint16_t last_priority = 0;
+    int i;
+
+    ft = ft_create(&config);
+
+    /* Distinct priorities in a scrambled order; some flows never expire */
+    for (i = 0; i < EVICTION_FLOWS; i++) {
+        flow_add = of_flow_add_new(OF_VERSION_1_3);
+        of_flow_add_priority_set(flow_add, (i * 37) % EVICTION_FLOWS);
+        of_flow_add_table_id_set(flow_add, 1);
+        of_flow_add_hard_timeout_set(flow_add, i % 7);
+        of_flow_add_idle_timeout_set(flow_add, i % 5 == 0 ? 2 : 0);
+        TEST_INDIGO_OK(ft_add(ft, i, flow_add, NULL));
+        of_object_delete(flow_add);
+    }
+    TEST_ASSERT(ft_eviction_victim(ft, 1) == NULL);
+    TEST_ASSERT(!ft_table_over_limit(ft, 1));
+
+    /* Existing entries join the heap when a policy is set */
+    TEST_INDIGO_OK(ft_table_eviction_set(ft, 1, FT_EVICTION_PRIORITY,
+                                         EVICTION_FLOWS / 2));
+    TEST_ASSERT(ft_table_over_limit(ft, 1));
+    TEST_ASSERT(!ft_table_over_limit(ft, 0));
+    for (i = 0; i < 10; i++) {
+        TEST_ASSERT(eviction_victim_check(ft, 1) == TEST_PASS);
+        victim = ft_eviction_victim(ft, 1);
+        TEST_ASSERT(i == 0 || victim->priority > last_priority);
+        last_priority = victim->priority;
+        ft_delete(ft, victim);
+    }
+    TEST_ASSERT(last_priority == 9);
+
+    /* Counter changes reorder the LRU heap */
+    TEST_INDIGO_OK(ft_table_eviction_set(ft, 1, FT_EVICTION_LRU, 0));
+    TEST_ASSERT(!ft_table_over_limit(ft, 1));
+    for (i = 10; i < EVICTION_FLOWS; i++) {
+        if ((entry = ft_lookup(ft, i)) != NULL) {
+            ft_entry_counters_set(ft, entry, 1, 1, 1000 + (i * 53) % 97);
+            TEST_ASSERT(eviction_victim_check(ft, 1) == TEST_PASS);
+        }
+    }
+
+    /* Expire order; an entry moved to another table leaves the heap */
+    TEST_INDIGO_OK(ft_table_eviction_set(ft, 1, FT_EVICTION_EXPIRE, 0));
+    TEST_ASSERT(eviction_victim_check(ft, 1) == TEST_PASS);
+    victim = ft_eviction_victim(ft, 1);
+    TEST_INDIGO_OK(ft_entry_set_table_id(ft, victim, 2));
+    TEST_ASSERT(victim->evict_idx == -1);
+    TEST_ASSERT(ft_eviction_victim(ft, 1) != victim);
+    TEST_ASSERT(ft_eviction_victim(ft, 2) == NULL);
+    while (ft_eviction_victim(ft, 1) != NULL) {
+        TEST_ASSERT(eviction_victim_check(ft, 1) == TEST_PASS);
+        ft_delete(ft, ft_eviction_victim(ft, 1));
+    }
+    TEST_ASSERT(ft->table_aggregates[1].flow_count == 0);
+
+    TEST_INDIGO_OK(ft_table_eviction_set(ft, 1, FT_EVICTION_NONE, 0));
+    ft_delete(ft, victim);
+    ft_destroy(ft);
+
+    return TEST_PASS;
+}
+
+/* A chunk is released once its last object is freed */
+static int
+test_ft_slab(void)
+{
+    ft_slab_t slab;
+    void **objs;
+    int per_chunk, count, i;
+
+    ft_slab_init(&slab, 1000);
+    per_chunk = slab.objs_per_chunk;
+    count = per_chunk * 3;
+    TEST_ASSERT((objs = malloc(count * sizeof(*objs))) != NULL);
+
+    for (i = 0; i < count; i++) {
+        TEST_ASSERT((objs[i] = ft_slab_alloc(&slab)) != NULL);
+        memset(objs[i], i, 1000);
+    }
+    TEST_ASSERT(slab.chunk_count == 3);
+
+    /* Emptying the second chunk releases it; the others are kept */
+    for (i = per_chunk; i < 2 * per_chunk; i++) {
+        ft_slab_free(&slab, objs[i]);
+    }
+    TEST_ASSERT(slab.chunk_count == 2);
+    TEST_ASSERT(slab.in_use == 2 * per_chunk);
+
+    /* Freed slots in a kept chunk are reused before a new chunk */
+    ft_slab_free(&slab, objs[0]);
+    ft_slab_free(&slab, objs[count - 1]);
+    TEST_ASSERT(slab.chunk_count == 2);
+    objs[0] = ft_slab_alloc(&slab);
+    objs[count - 1] = ft_slab_alloc(&slab);
+    TEST_ASSERT(slab.chunk_count == 2);
+
+    for (i = 0; i < count; i++) {
+        if (i < per_chunk || i >= 2 * per_chunk) {
+            ft_slab_free(&slab, objs[i]);
+        }
+    }
+    TEST_ASSERT(slab.chunk_count == 0);
+    TEST_ASSERT(ft_slab_bytes(&slab) == 0);
+
+    ft_slab_cleanup(&slab);
+    free(objs);
+
+    return TEST_PASS;
+}
+
+static int
+test_ft_bench(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = { 0, 0 };
+    of_flow_add_t *flow_add_base, *flow_add;
+    of_meta_match_t query;
+    of_match_t match;
+    ft_entry_t *entry;
+    struct timespec start;
+    size_t heap_before;
+    const char *env;
+    double ns;
+    int flows = 10000;
+    int i, lookups;
+    uint32_t r = 1;
+
+    if ((env = getenv("OFSTATEMANAGER_UTEST_BENCH_FLOWS")) != NULL) {
+        flows = atoi(env);
+    }
+
+    flow_add_base = of_flow_add_new(OF_VERSION_1_0);
+    memset(&match, 0, sizeof(match));
+    match.version = OF_VERSION_1_0;
+    match.fields.eth_type = 0x0800;
+    match.masks.eth_type = 0xffff;
+    match.masks.ipv4_dst = 0xffffffff;
+
+    heap_before = heap_in_use();
+    ft = ft_create(&config);
+    for (i = 0; i < flows; i++) {
+        flow_add = of_object_dup(flow_add_base);
+        match.fields.ipv4_dst = i;
+        TEST_OK(of_flow_add_match_set(flow_add, &match));
+        of_flow_add_priority_set(flow_add, i % 100);
+        TEST_INDIGO_OK(ft_add(ft, i + 1, flow_add, &entry));
+        of_object_delete(flow_add);
+    }
+    if (heap_before != 0) {
+        printf("\n  %d flows: %.0f heap bytes per flow\n", flows,
+               (double)(heap_in_use() - heap_before) / flows);
+    }
+
+    lookups = flows > 100000 ? flows : 100000;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < lookups; i++) {
+        r = r * 1103515245 + 12345;
+        entry = ft_lookup(ft, (r >> 4) % flows + 1);
+        TEST_ASSERT(entry != NULL);
+    }
+    ns = elapsed_ns(&start);
+    printf("  ft_lookup: %.1f ns per lookup\n", ns / lookups);
+
+    memset(&query, 0, sizeof(query));
+    query.mode = OF_MATCH_STRICT;
+    query.check_priority = 1;
+    query.table_id = TABLE_ID_ANY;
+    query.out_port = OF_PORT_DEST_WILDCARD;
+    query.match = match;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < lookups; i++) {
+        int idx;
+        r = r * 1103515245 + 12345;
+        idx = (r >> 4) % flows;
+        query.match.fields.ipv4_dst = idx;
+        query.priority = idx % 100;
+        TEST_INDIGO_OK(ft_strict_match(ft, &query, &entry));
+    }
+    ns = elapsed_ns(&start);
+    printf("  ft_strict_match: %.1f ns per lookup\n", ns / lookups);
+
+    ft_destroy(ft);
+    of_flow_add_delete(flow_add_base);
+
+    return TEST_PASS;
+}
+
+struct iter_task_state {
+    ft_instance_t ft;
+    int finished;
+    int entries_seen;
+};
+
+static void
+iter_task_cb(void *cookie, ft_entry_t *entry)
+{
+    struct iter_task_state *state = cookie;
+    if (entry != NULL) {
+        state->finished = 0;
+        state->entries_seen++;
+        ASSERT(ft_delete(state->ft, entry) == 0);
+    } else {
+        state->finished = 1;
+    }
+}
+
+static int
+test_ft_iter_task(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = {
+        1024, /* strict_match buckets */
+        1024, /* flow_id buckets */
+    };
+    of_flow_add_t *flow_add1, *flow_add2;
+    ft_entry_t *entry1, *entry2;
+    struct iter_task_state state;
+
+    ft = ft_create(&config);
+
+    flow_add1 = of_flow_add_new(OF_VERSION_1_0);
+    of_flow_add_OF_VERSION_1_0_populate(flow_add1, 1);
+    of_flow_add_flags_set(flow_add1, 0);
+
+    flow_add2 = of_flow_add_new(OF_VERSION_1_0);
+    of_flow_add_OF_VERSION_1_0_populate(flow_add2, 2);
+    of_flow_add_flags_set(flow_add2, 0);
+
+    TEST_INDIGO_OK(ft_add(ft, 1, flow_add1, &entry1));
+    TEST_INDIGO_OK(ft_add(ft, 2, flow_add2, &entry2));
+
+    state = (struct iter_task_state) { .ft = ft, .finished = -1, .entries_seen = 0 };
+    ft_spawn_iter_task(ft, NULL, iter_task_cb, &state, IND_SOC_DEFAULT_PRIORITY);
+    TEST_ASSERT(state.finished == -1);
+    TEST_ASSERT(state.entries_seen == 0);
+    TEST_ASSERT(ft->status.current_count == 2);
+    while (state.finished != 1) {
+        ind_soc_select_and_run(0);
+    }
+    TEST_ASSERT(state.finished == 1);
+    TEST_ASSERT(state.entries_seen == 2);
+    TEST_ASSERT(ft->status.current_count == 0);
+
+    ft_destroy(ft);
+    of_object_delete(flow_add1);
+    of_object_delete(flow_add2);
+
+    return TEST_PASS;
+}
+
+static int
+count_list(list_head_t *head)
+{
+    return list_length(head);
+}
+
+static int
+test_ft_expire(void)
+{
+    ft_instance_t ft;
+    ft_config_t config = {
+        1024, /* strict_match buckets */
+        1024, /* flow_id buckets */
+    };
+    of_flow_add_t *flow_add;
+    ft_entry_t *hard_entry, *idle_entry, *none_entry;
+    list_head_t due;
+    indigo_time_t t0;
+
+    ft = ft_create(&config);
+
+    flow_add = of_flow_add_new(OF_VERSION_1_0);
+    of_flow_add_OF_VERSION_1_0_populate(flow_add, 1);
+    of_flow_add_flags_set(flow_add, 0);
+
+    of_flow_add_hard_timeout_set(flow_add, 5);
+    of_flow_add_idle_timeout_set(flow_add, 0);
+    TEST_INDIGO_OK(ft_add(ft, 1, flow_add, &hard_entry));
+
+    of_flow_add_hard_timeout_set(flow_add, 0);
+    of_flow_add_idle_timeout_set(flow_add, 4);
+    TEST_INDIGO_OK(ft_add(ft, 2, flow_add, &idle_entry));
+
+    of_flow_add_hard_timeout_set(flow_add, 0);
+    of_flow_add_idle_timeout_set(flow_add, 0);
+    TEST_INDIGO_OK(ft_add(ft, 3, flow_add, &none_entry));
+    TEST_ASSERT(none_entry->expire_time == 0);
+
+    /* Pretend all entries were inserted at the same time */
+    t0 = hard_entry->insert_time;
+    idle_entry->insert_time = idle_entry->last_counter_change = t0;
+    ft_expire_reschedule(ft, idle_entry, t0, true);
+    TEST_ASSERT(idle_entry->expire_time == t0 + 1000);
+
+    /* Nothing due before the first idle check */
+    ft_expire_collect(ft, t0 + 999, &due);
+    TEST_ASSERT(count_list(&due) == 0);
+
+    /* First idle check; counters did not change so check again at 4s */
+    ft_expire_collect(ft, t0 + 1000, &due);
+    TEST_ASSERT(count_list(&due) == 1);
+    TEST_ASSERT(FT_ENTRY_CONTAINER(due.links.next, expire) == idle_entry);
+    ft_expire_reschedule(ft, idle_entry, t0 + 1000, false);
+    TEST_ASSERT(list_empty(&due));
+    TEST_ASSERT(idle_entry->expire_time == t0 + 4000);
+
+    /* Idle check at 4s sees activity; next check one interval later */
+    ft_expire_collect(ft, t0 + 4000, &due);
+    TEST_ASSERT(count_list(&due) == 1);
+    idle_entry->last_counter_change = t0 + 4000;
+    ft_expire_reschedule(ft, idle_entry, t0 + 4000, true);
+    TEST_ASSERT(idle_entry->expire_time == t0 + 5000);
+
+    /* Both the hard timeout and the idle check are due at 5s */
+    ft_expire_collect(ft, t0 + 5000, &due);
+    TEST_ASSERT(count_list(&due) == 2);
+
+    /* Deleting a due entry takes it off the due list */
+    TEST_INDIGO_OK(ft_delete(ft, hard_entry));
+    TEST_ASSERT(count_list(&due) == 1);
+    ft_expire_reschedule(ft, idle_entry, t0 + 5000, false);
+    TEST_ASSERT(list_empty(&due));
+    TEST_ASSERT(idle_entry->expire_time == t0 + 8000);
+
+    /* Far deadlines wrap around the wheel without being collected early */
+    idle_entry->last_counter_change = t0 + 4000 +
+        (indigo_time_t)FT_EXPIRE_WHEEL_SLOTS * FT_EXPIRE_SLOT_MS;
+    ft_expire_reschedule(ft, idle_entry, t0 + 5000, false);
+    ft_expire_collect(ft, t0 + 8000, &due);
+    TEST_ASSERT(count_list(&due) == 0);
+
+    ft_destroy(ft);
+    of_object_delete(flow_add);
+
+    return TEST_PASS;
+}
+
+static int
+test_hello(void)
+{
+    of_hello_t *hello;
+
+    hello = of_hello_new(OF_VERSION_1_0);
+    TEST_INDIGO_OK(indigo_core_receive_controller_message(0, hello));
+
+    return TEST_PASS;
+}
+
+static int
+test_packet_out(void)
+{
+    of_packet_out_t *pkt_out;
+
+    pkt_out = of_packet_out_new(OF_VERSION_1_0);
+    /* Could add params, but core doesn't do anything with them */
+    TEST_INDIGO_OK(indigo_core_receive_controller_message(0, pkt_out));
+
+    return TEST_PASS;
+}
+
+static int
+test_packet_in(void)
+{
+    of_packet_in_t *pkt_in;
+
+    pkt_in = of_packet_in_new(OF_VERSION_1_0);
+    /* Could add params, but core doesn't do anything with them */
+    TEST_INDIGO_OK(indigo_core_packet_in(pkt_in));
+
+    return TEST_PASS;
+}
+
+static int
+test_experimenter(void)
+{
+    of_experimenter_t *exp;
+
+    exp = of_experimenter_new(OF_VERSION_1_0);
+    /* Could add params, but core doesn't do anything with them */
+    TEST_INDIGO_OK(indigo_core_receive_controller_message(0, exp));
+
+    return TEST_PASS;
+}
+
+static int
+test_desc_strings(void)
+{
+    of_desc_str_t desc_get;
+    of_desc_str_t desc_set;
+    of_serial_num_t ser_num_set;
+    of_serial_num_t ser_num_get;
+
+    INDIGO_MEM_SET(ser_num_set, 0xee, OF_SERIAL_NUM_LEN);
+    INDIGO_MEM_CLEAR(ser_num_get, OF_SERIAL_NUM_LEN);
+    TEST_INDIGO_OK(ind_core_serial_num_set(ser_num_set));
+    TEST_INDIGO_OK(ind_core_serial_num_get(ser_num_get));
+    TEST_ASSERT(INDIGO_MEM_COMPARE(ser_num_set, ser_num_get,
+                                   OF_SERIAL_NUM_LEN) == 0);
+
+    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
+    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
+    TEST_INDIGO_OK(ind_core_sw_desc_set(desc_set));
+    TEST_INDIGO_OK(ind_core_sw_desc_get(desc_get));
+    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+
+    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
+    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
+    TEST_INDIGO_OK(ind_core_hw_desc_set(desc_set));
+    TEST_INDIGO_OK(ind_core_hw_desc_get(desc_get));
+    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+
+    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
+    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
+    TEST_INDIGO_OK(ind_core_dp_desc_set(desc_set));
+    TEST_INDIGO_OK(ind_core_dp_desc_get(desc_get));
+    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+
+    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
+    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
+    TEST_INDIGO_OK(ind_core_dp_desc_set(desc_set));
+    TEST_INDIGO_OK(ind_core_dp_desc_get(desc_get));
+    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+
+    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
+    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
+    TEST_INDIGO_OK(ind_core_mfr_desc_set(desc_set));
+    TEST_INDIGO_OK(ind_core_mfr_desc_get(desc_get));
+    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+
+    return TEST_PASS;
+}
+
+static int
+delete_all_entries(ft_instance_t ft)
+{
+    of_flow_delete_t *flow_del;
+    of_match_t match;
+
+    INDIGO_MEM_CLEAR(&match, sizeof(match));
+    flow_del = of_flow_delete_new(OF_VERSION_1_0);
+    TEST_ASSERT(flow_del != NULL);
+    of_flow_delete_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
+    TEST_OK(of_flow_delete_match_set(flow_del, &match));
+    TEST_INDIGO_OK(handle_message(flow_del));
+    TEST_INDIGO_OK(do_barrier());
+
+    TEST_OK(depopulate_table(ft));
+
+    return TEST_PASS;
+}
+
+/* Add n flows, delete them all */
+int
+test_simple_add_del(void)
+{
+    of_flow_add_t *flow_add;
+    ft_status_t *status;
+    int idx;
+
+    status = FT_STATUS(ind_core_ft);
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        flow_add = of_flow_add_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_add != NULL);
+        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
+        of_flow_add_flags_set(flow_add, 0);
+        TEST_INDIGO_OK(handle_message(flow_add));
+        TEST_INDIGO_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, idx + 1);
+    }
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+/* Add n flows, delete one by one */
+int
+test_exact_add_del(void)
+{
+    of_flow_add_t *flow_add_keep[TEST_FLOW_COUNT];
+    of_flow_add_t *flow_add;
+    of_flow_delete_t *flow_del;
+    ft_status_t *status;
+    int idx;
+    of_match_t match;
+    uint16_t prio;
+
+    status = FT_STATUS(ind_core_ft);
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        flow_add = of_flow_add_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_add != NULL);
+        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
+        of_flow_add_flags_set(flow_add, 0);
+        flow_add_keep[idx] = of_object_dup(flow_add);
+        TEST_INDIGO_OK(handle_message(flow_add));
+        TEST_INDIGO_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, idx + 1);
+    }
+
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        INDIGO_MEM_CLEAR(&match, sizeof(match));
+        /* Match the source mac addr which should be diff for each entry */
+        TEST_OK(of_flow_add_match_get(flow_add_keep[idx], &match));
+        of_flow_add_priority_get(flow_add_keep[idx], &prio);
+        flow_del = of_flow_delete_strict_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_del != NULL);
+        of_flow_delete_strict_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
+        of_flow_delete_strict_priority_set(flow_del, prio);
+        TEST_OK(of_flow_delete_strict_match_set(flow_del, &match));
+        TEST_INDIGO_OK(handle_message(flow_del));
+        TEST_INDIGO_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT - (idx + 1));
+        of_flow_add_delete(flow_add_keep[idx]);
+    }
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+/* Add n flows, delete one by one */
+int
+test_modify(void)
+{
+    of_flow_add_t *flow_add_keep[TEST_FLOW_COUNT];
+    of_flow_add_t *flow_add;
+    of_flow_modify_t *flow_mod;
+    ft_status_t *status;
+    int idx;
+    of_match_t match;
+    uint16_t prio;
+
+    status = FT_STATUS(ind_core_ft);
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        flow_add = of_flow_add_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_add != NULL);
+        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
+        of_flow_add_flags_set(flow_add, 0);
+        flow_add_keep[idx] = of_object_dup(flow_add);
+        TEST_INDIGO_OK(handle_message(flow_add));
+        TEST_INDIGO_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, idx + 1);
+    }
 
-    exp = of_experimenter_new(OF_VERSION_1_0);
-    /* Could add params, but core doesn't do anything with them */
-    TEST_INDIGO_OK(indigo_core_receive_controller_message(0, exp));
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        INDIGO_MEM_CLEAR(&match, sizeof(match));
+        /* Match the source mac addr which should be diff for each entry */
+        TEST_OK(of_flow_add_match_get(flow_add_keep[idx], &match));
+        of_flow_add_priority_get(flow_add_keep[idx], &prio);
+        flow_mod = of_flow_modify_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_mod != NULL);
+        of_flow_modify_out_port_set(flow_mod, OF_PORT_DEST_WILDCARD);
+        of_flow_modify_priority_set(flow_mod, prio);
+        TEST_OK(of_flow_modify_match_set(flow_mod, &match));
+        TEST_INDIGO_OK(handle_message(flow_mod));
+        TEST_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
+        of_flow_add_delete(flow_add_keep[idx]);
+    }
+    CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
+    /* Delete all the entries */
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+/* Add n flows, delete one by one */
+int
+test_modify_strict(void)
+{
+    of_flow_add_t *flow_add_keep[TEST_FLOW_COUNT];
+    of_flow_add_t *flow_add;
+    of_flow_modify_strict_t *flow_mod;
+    ft_status_t *status;
+    int idx;
+    of_match_t match;
+    uint16_t prio;
+
+    status = FT_STATUS(ind_core_ft);
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        flow_add = of_flow_add_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_add != NULL);
+        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
+        of_flow_add_flags_set(flow_add, 0);
+        flow_add_keep[idx] = of_object_dup(flow_add);
+        TEST_INDIGO_OK(handle_message(flow_add));
+        TEST_INDIGO_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, idx + 1);
+    }
+
+    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
+        INDIGO_MEM_CLEAR(&match, sizeof(match));
+        /* Match the source mac addr which should be diff for each entry */
+        TEST_OK(of_flow_add_match_get(flow_add_keep[idx], &match));
+        of_flow_add_priority_get(flow_add_keep[idx], &prio);
+        flow_mod = of_flow_modify_strict_new(OF_VERSION_1_0);
+        TEST_ASSERT(flow_mod != NULL);
+        of_flow_modify_strict_out_port_set(flow_mod, OF_PORT_DEST_WILDCARD);
+        of_flow_modify_strict_priority_set(flow_mod, prio);
+        TEST_OK(of_flow_modify_strict_match_set(flow_mod, &match));
+        TEST_INDIGO_OK(handle_message(flow_mod));
+        TEST_INDIGO_OK(do_barrier());
+        CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
+        of_flow_add_delete(flow_add_keep[idx]);
+    }
+    CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+
+/* A flow add for test flow idx */
+static of_flow_add_t *
+new_test_flow_add(int idx)
+{
+    of_flow_add_t *flow_add;
+
+    flow_add = of_flow_add_new(OF_VERSION_1_0);
+    if (flow_add != NULL) {
+        of_flow_add_OF_VERSION_1_0_populate(flow_add, idx);
+        of_flow_add_flags_set(flow_add, 0);
+    }
+
+    return flow_add;
+}
+
+/* The installed entry with the match and priority of test flow idx */
+static ft_entry_t *
+find_test_flow(int idx)
+{
+    of_flow_add_t *flow_add;
+    of_meta_match_t query;
+    ft_entry_t *entry = NULL;
+
+    flow_add = new_test_flow_add(idx);
+    if (ind_core_flow_mod_setup_query(flow_add, &query, OF_MATCH_STRICT,
+                                      1) == INDIGO_ERROR_NONE) {
+        if (ft_strict_match(ind_core_ft, &query, &entry) != INDIGO_ERROR_NONE) {
+            entry = NULL;
+        }
+    }
+    of_object_delete(flow_add);
+
+    return entry;
+}
+
+static of_group_mod_t *
+bundle_group_mod(uint16_t command, uint32_t id)
+{
+    of_group_mod_t *group_mod;
+
+    group_mod = of_group_mod_new(OF_VERSION_1_3);
+    if (group_mod != NULL) {
+        of_group_mod_command_set(group_mod, command);
+        of_group_mod_group_type_set(group_mod, OF_GROUP_TYPE_INDIRECT);
+        of_group_mod_group_id_set(group_mod, id);
+    }
+
+    return group_mod;
+}
+
+/* Commit, roll back and reject bundles of flow and group mods */
+int
+test_bundle(void)
+{
+    ind_core_bundle_t *bundle;
+    of_flow_delete_strict_t *flow_del;
+    ft_entry_t *entry0, *entry1;
+    of_match_t match;
+    ft_status_t *status;
+    int idx;
+
+    status = FT_STATUS(ind_core_ft);
+
+    /* Three flows and a group */
+    TEST_ASSERT((bundle = ind_core_bundle_create()) != NULL);
+    for (idx = 0; idx < 3; idx++) {
+        TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(idx)));
+    }
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_ADD, 1)));
+    TEST_INDIGO_OK(ind_core_bundle_commit(bundle, 0));
+    TEST_ASSERT(status->current_count == 3);
+    TEST_INDIGO_OK(ind_core_group_get(1, NULL, NULL));
+    TEST_ASSERT((entry0 = find_test_flow(0)) != NULL);
+    TEST_ASSERT((entry1 = find_test_flow(1)) != NULL);
+
+    /* Unsupported messages are refused when staged */
+    TEST_ASSERT(ind_core_bundle_add(bundle, of_echo_request_new(OF_VERSION_1_0))
+                == INDIGO_ERROR_NOT_SUPPORTED);
+
+    /*
+     * Add, delete, replace and delete a group, then fail the last add in
+     * forwarding: everything is put back, including the same entries.
+     */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(3)));
+    TEST_ASSERT((flow_del = of_flow_delete_strict_new(OF_VERSION_1_0)) != NULL);
+    of_flow_delete_strict_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
+    of_flow_delete_strict_priority_set(flow_del, entry0->priority);
+    ft_entry_match_get(entry0, &match);
+    TEST_OK(of_flow_delete_strict_match_set(flow_del, &match));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, flow_del));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(1)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 1)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(4)));
+    entry0->cold->packets_base = 3;      /* As if overwritten with a reset */
+    create_fail_countdown = 2;
+    create_table_id = 2;
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_UNKNOWN);
+    create_fail_countdown = -1;
+    create_table_id = 0;
+    TEST_ASSERT(status->current_count == 3);
+    TEST_ASSERT(find_test_flow(0) == entry0);
+    TEST_ASSERT(find_test_flow(1) == entry1);
+    TEST_ASSERT(ft_lookup(ind_core_ft, entry0->id) == entry0);
+
+    /* The reinstalled flows count afresh in the table forwarding chose */
+    TEST_ASSERT(entry0->table_id == 2 && entry1->table_id == 2);
+    TEST_ASSERT(entry0->cold->packets_base == 0 && entry0->cold->packets == 0);
+    ft_entry_counters_set(ind_core_ft, entry0, 10, 1000, INDIGO_CURRENT_TIME);
+    TEST_ASSERT(entry0->cold->packets == 10 && entry0->cold->bytes == 1000);
+    TEST_ASSERT(find_test_flow(3) == NULL);
+    TEST_ASSERT(find_test_flow(4) == NULL);
+    TEST_INDIGO_OK(ind_core_group_get(1, NULL, NULL));
+
+    /* A group that will already exist fails validation; nothing applies */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(5)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_ADD, 2)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_ADD, 2)));
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_EXISTS);
+    TEST_ASSERT(status->current_count == 3);
+    TEST_ASSERT(ind_core_group_get(2, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+
+    /* Replace and delete in one bundle; the replacement takes a new id */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(1)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 1)));
+    TEST_INDIGO_OK(ind_core_bundle_commit(bundle, 0));
+    TEST_ASSERT(status->current_count == 3);
+    TEST_ASSERT(find_test_flow(1) != NULL);
+    TEST_ASSERT(ind_core_group_get(1, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+
+    ind_core_bundle_destroy(bundle);
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+/* A flow delete_strict for test flow idx */
+static of_flow_delete_strict_t *
+new_test_flow_delete_strict(int idx)
+{
+    of_flow_add_t *flow_add;
+    of_flow_delete_strict_t *flow_del;
+    of_match_t match;
+    uint16_t priority;
+
+    flow_add = new_test_flow_add(idx);
+    ASSERT(of_flow_add_match_get(flow_add, &match) == 0);
+    of_flow_add_priority_get(flow_add, &priority);
+    of_object_delete(flow_add);
+
+    flow_del = of_flow_delete_strict_new(OF_VERSION_1_0);
+    if (flow_del != NULL) {
+        of_flow_delete_strict_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
+        of_flow_delete_strict_priority_set(flow_del, priority);
+        ASSERT(of_flow_delete_strict_match_set(flow_del, &match) == 0);
+    }
+
+    return flow_del;
+}
+
+/* Table limits are checked when a bundle is validated and applied */
+static int
+test_bundle_table_limit(void)
+{
+    ind_core_bundle_t *bundle;
+    ft_status_t *status;
+    uint64_t evictions, table_full_errors;
+    int errors;
+
+    status = FT_STATUS(ind_core_ft);
+    evictions = status->evictions;
+    table_full_errors = status->table_full_errors;
+    TEST_ASSERT((bundle = ind_core_bundle_create()) != NULL);
+
+    /* Without a policy, adds past the limit fail validation */
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_NONE, 2));
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    errors = error_msg_count;
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(1)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(0)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(2)));
+    create_fail_countdown = 0;     /* Nothing reaches forwarding */
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_RESOURCE);
+    TEST_ASSERT(create_fail_countdown == 0);
+    create_fail_countdown = -1;
+    TEST_ASSERT(error_msg_count == errors + 1);
+    TEST_ASSERT(status->table_full_errors == table_full_errors + 1);
+    TEST_ASSERT(status->current_count == 1);
+
+    /* Flows the bundle deletes first make room */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(1)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       new_test_flow_delete_strict(0)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(2)));
+    TEST_INDIGO_OK(ind_core_bundle_commit(bundle, 0));
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(find_test_flow(0) == NULL);
+
+    /* With a policy, applying the add evicts */
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_LRU, 2));
+    ft_entry_counters_set(ind_core_ft, find_test_flow(1), 1, 100,
+                          INDIGO_CURRENT_TIME + 1000);
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(3)));
+    TEST_INDIGO_OK(ind_core_bundle_commit(bundle, 0));
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(status->evictions == evictions + 1);
+    TEST_ASSERT(find_test_flow(1) != NULL);
+    TEST_ASSERT(find_test_flow(2) == NULL);
+    TEST_ASSERT(find_test_flow(3) != NULL);
+
+    /* A rollback puts the evicted flow back */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(4)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(5)));
+    create_fail_countdown = 1;
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_UNKNOWN);
+    create_fail_countdown = -1;
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(status->evictions == evictions + 1);
+    TEST_ASSERT(find_test_flow(1) != NULL);
+    TEST_ASSERT(find_test_flow(3) != NULL);
+    TEST_ASSERT(find_test_flow(4) == NULL);
+
+    /* Flows the bundle itself adds can be evicted for later ones */
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_LRU, 1));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(4)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(5)));
+    TEST_INDIGO_OK(ind_core_bundle_commit(bundle, 0));
+    TEST_ASSERT(status->current_count == 1);
+    TEST_ASSERT(status->evictions == evictions + 2);
+    TEST_ASSERT(find_test_flow(4) == NULL);
+    TEST_ASSERT(find_test_flow(5) != NULL);
+
+    ind_core_bundle_destroy(bundle);
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_NONE, 0));
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
 
     return TEST_PASS;
 }
 
+/* A bundle experimenter message, carrying a message to add if msg is set */
+static of_experimenter_t *
+bundle_request(uint32_t subtype, uint32_t id, uint16_t type, of_object_t *msg)
+{
+    of_experimenter_t *obj;
+    uint8_t buf[IND_CORE_BUNDLE_ADD_HDR_LEN + 256];
+    of_octets_t data = { buf, IND_CORE_BUNDLE_CONTROL_LEN };
+    int i;
+
+    INDIGO_MEM_SET(buf, 0, sizeof(buf));
+    for (i = 0; i < 4; i++) {
+        buf[i] = id >> (24 - 8 * i);
+    }
+    buf[4] = type >> 8;
+    buf[5] = type;
+    buf[7] = IND_CORE_BUNDLE_FLAG_ATOMIC | IND_CORE_BUNDLE_FLAG_ORDERED;
+    if (msg != NULL) {
+        ASSERT(msg->length <= 256);
+        INDIGO_MEM_COPY(buf + IND_CORE_BUNDLE_ADD_HDR_LEN,
+                        OF_OBJECT_BUFFER_INDEX(msg, 0), msg->length);
+        data.bytes = IND_CORE_BUNDLE_ADD_HDR_LEN + msg->length;
+        of_object_delete(msg);
+    }
+
+    obj = of_experimenter_new(OF_VERSION_1_3);
+    of_experimenter_xid_set(obj, 43);
+    of_experimenter_experimenter_set(obj, IND_CORE_BUNDLE_EXPERIMENTER_ID);
+    of_experimenter_subtype_set(obj, subtype);
+    ASSERT(of_experimenter_data_set(obj, &data) == 0);
+
+    return obj;
+}
+
 static int
-test_desc_strings(void)
+bundle_control(uint32_t id, uint16_t type)
 {
-    of_desc_str_t desc_get;
-    of_desc_str_t desc_set;
-    of_serial_num_t ser_num_set;
-    of_serial_num_t ser_num_get;
+    bundle_reply_type = -1;
+    TEST_INDIGO_OK(handle_message(bundle_request(IND_CORE_BUNDLE_CONTROL,
+                                                 id, type, NULL)));
+    TEST_INDIGO_OK(do_barrier());
 
-    INDIGO_MEM_SET(ser_num_set, 0xee, OF_SERIAL_NUM_LEN);
-    INDIGO_MEM_CLEAR(ser_num_get, OF_SERIAL_NUM_LEN);
-    TEST_INDIGO_OK(ind_core_serial_num_set(ser_num_set));
-    TEST_INDIGO_OK(ind_core_serial_num_get(ser_num_get));
-    TEST_ASSERT(INDIGO_MEM_COMPARE(ser_num_set, ser_num_get,
-                                   OF_SERIAL_NUM_LEN) == 0);
+    return bundle_reply_type;
+}
 
-    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
-    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
-    TEST_INDIGO_OK(ind_core_sw_desc_set(desc_set));
-    TEST_INDIGO_OK(ind_core_sw_desc_get(desc_get));
-    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+static int
+bundle_add_message(uint32_t id, of_object_t *msg)
+{
+    TEST_INDIGO_OK(handle_message(bundle_request(IND_CORE_BUNDLE_ADD_MESSAGE,
+                                                 id, 0, msg)));
+    return do_barrier();
+}
 
-    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
-    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
-    TEST_INDIGO_OK(ind_core_hw_desc_set(desc_set));
-    TEST_INDIGO_OK(ind_core_hw_desc_get(desc_get));
-    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+/* An OpenFlow 1.3 flow add for test flow idx */
+static of_flow_add_t *
+new_test_flow_add_1_3(int idx)
+{
+    of_flow_add_t *flow_add;
+    of_match_t match;
 
-    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
-    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
-    TEST_INDIGO_OK(ind_core_dp_desc_set(desc_set));
-    TEST_INDIGO_OK(ind_core_dp_desc_get(desc_get));
-    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+    INDIGO_MEM_SET(&match, 0, sizeof(match));
+    match.version = OF_VERSION_1_3;
+    match.fields.eth_type = TEST_ETH_TYPE(idx);
+    match.masks.eth_type = 0xffff;
+
+    flow_add = of_flow_add_new(OF_VERSION_1_3);
+    if (flow_add != NULL) {
+        of_flow_add_xid_set(flow_add, 44);
+        of_flow_add_priority_set(flow_add, 100);
+        of_flow_add_buffer_id_set(flow_add, -1);
+        ASSERT(of_flow_add_match_set(flow_add, &match) == 0);
+    }
+
+    return flow_add;
+}
+
+/* Controllers open, fill, commit and discard bundles with experimenters */
+static int
+test_bundle_experimenter(void)
+{
+    ft_status_t *status;
+    int errors;
+
+    status = FT_STATUS(ind_core_ft);
+    errors = error_msg_count;
+
+    TEST_ASSERT(bundle_control(7, IND_CORE_BUNDLE_OPEN_REQUEST) ==
+                IND_CORE_BUNDLE_OPEN_REPLY);
+    TEST_ASSERT(bundle_add_message(7, new_test_flow_add_1_3(1)) == 0);
+    TEST_ASSERT(bundle_add_message(7, new_test_flow_add_1_3(2)) == 0);
+    TEST_ASSERT(error_msg_count == errors);
+    TEST_ASSERT(status->current_count == 0);
+    TEST_ASSERT(bundle_control(7, IND_CORE_BUNDLE_CLOSE_REQUEST) ==
+                IND_CORE_BUNDLE_CLOSE_REPLY);
+
+    /* A closed bundle takes no more messages, nor a second open */
+    TEST_ASSERT(bundle_add_message(7, new_test_flow_add_1_3(3)) == 0);
+    TEST_ASSERT(error_msg_count == errors + 1);
+    TEST_ASSERT(last_error_code == OF_REQUEST_FAILED_EPERM);
+    TEST_ASSERT(bundle_control(7, IND_CORE_BUNDLE_OPEN_REQUEST) == -1);
+    TEST_ASSERT(error_msg_count == errors + 2);
+
+    TEST_ASSERT(bundle_control(7, IND_CORE_BUNDLE_COMMIT_REQUEST) ==
+                IND_CORE_BUNDLE_COMMIT_REPLY);
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(bundle_control(7, IND_CORE_BUNDLE_COMMIT_REQUEST) == -1);
+    TEST_ASSERT(last_error_code == OF_REQUEST_FAILED_EPERM);
+    errors = error_msg_count;
+
+    /* Adding opens a bundle; bad messages are refused, not staged */
+    TEST_ASSERT(bundle_add_message(8, of_echo_request_new(OF_VERSION_1_3))
+                == 0);
+    TEST_ASSERT(last_error_code == OF_REQUEST_FAILED_BAD_TYPE);
+    TEST_ASSERT(bundle_add_message(8, new_test_flow_add(3)) == 0);
+    TEST_ASSERT(last_error_code == OF_REQUEST_FAILED_BAD_VERSION);
+    TEST_ASSERT(bundle_add_message(8, new_test_flow_add_1_3(3)) == 0);
+    TEST_ASSERT(error_msg_count == errors + 2);
+    TEST_ASSERT(bundle_control(8, IND_CORE_BUNDLE_DISCARD_REQUEST) ==
+                IND_CORE_BUNDLE_DISCARD_REPLY);
+    TEST_ASSERT(status->current_count == 2);
+
+    /* A failed commit sends the failed message's error and ends the bundle */
+    TEST_ASSERT(bundle_add_message(9, new_test_flow_add_1_3(3)) == 0);
+    create_fail_countdown = 0;
+    TEST_ASSERT(bundle_control(9, IND_CORE_BUNDLE_COMMIT_REQUEST) == -1);
+    create_fail_countdown = -1;
+    TEST_ASSERT(error_msg_count == errors + 4);
+    TEST_ASSERT(last_error_code == OF_REQUEST_FAILED_EPERM);
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(bundle_control(9, IND_CORE_BUNDLE_DISCARD_REQUEST) == -1);
+
+    /* Bundles go with their connection */
+    TEST_ASSERT(bundle_control(10, IND_CORE_BUNDLE_OPEN_REQUEST) ==
+                IND_CORE_BUNDLE_OPEN_REPLY);
+    cxn_status_change(0, INDIGO_CXN_S_DISCONNECTED);
+    TEST_ASSERT(bundle_control(10, IND_CORE_BUNDLE_OPEN_REQUEST) ==
+                IND_CORE_BUNDLE_OPEN_REPLY);
+    TEST_ASSERT(bundle_control(10, IND_CORE_BUNDLE_DISCARD_REQUEST) ==
+                IND_CORE_BUNDLE_DISCARD_REPLY);
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+/* Send a flow or aggregate stats request for all flows and wait for it */
+static int
+request_stats(of_object_id_t object_id)
+{
+    of_object_t *req;
+    of_match_t match;
+
+    INDIGO_MEM_CLEAR(&match, sizeof(match));
+    reply_flow_count = 0;
+    reply_packets = 0;
+    reply_bytes = 0;
+
+    if (object_id == OF_FLOW_STATS_REQUEST) {
+        req = of_flow_stats_request_new(OF_VERSION_1_0);
+        TEST_ASSERT(req != NULL);
+        of_flow_stats_request_table_id_set(req, TABLE_ID_ANY);
+        of_flow_stats_request_out_port_set(req, OF_PORT_DEST_WILDCARD);
+        TEST_OK(of_flow_stats_request_match_set(req, &match));
+    } else {
+        req = of_aggregate_stats_request_new(OF_VERSION_1_0);
+        TEST_ASSERT(req != NULL);
+        of_aggregate_stats_request_table_id_set(req, TABLE_ID_ANY);
+        of_aggregate_stats_request_out_port_set(req, OF_PORT_DEST_WILDCARD);
+        TEST_OK(of_aggregate_stats_request_match_set(req, &match));
+    }
+    TEST_INDIGO_OK(handle_message(req));
+    TEST_INDIGO_OK(do_barrier());
+
+    return TEST_PASS;
+}
+
+/* A strict-match add overwrites the flow in place when forwarding allows */
+int
+test_overwrite(void)
+{
+    of_flow_add_t *flow_add;
+    ft_entry_t *entry;
+    ft_status_t *status;
+    indigo_flow_id_t id;
+    uint64_t overwrites;
+    int calls;
+
+    status = FT_STATUS(ind_core_ft);
+    overwrites = status->overwrites;
+
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT((entry = find_test_flow(0)) != NULL);
+    id = entry->id;
+    ft_entry_counters_set(ind_core_ft, entry, 10, 1000, INDIGO_CURRENT_TIME);
+
+    /* Same entry and ID; new cookie and timeout; counters start again */
+    TEST_ASSERT((flow_add = new_test_flow_add(0)) != NULL);
+    of_flow_add_cookie_set(flow_add, 0x1234);
+    of_flow_add_idle_timeout_set(flow_add, 7);
+    TEST_INDIGO_OK(handle_message(flow_add));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(find_test_flow(0) == entry);
+    TEST_ASSERT(entry->id == id);
+    TEST_ASSERT(status->current_count == 1);
+    TEST_ASSERT(status->overwrites == overwrites + 1);
+    TEST_ASSERT(entry->cookie == 0x1234);
+    TEST_ASSERT(entry->cookie_group->cookie == 0x1234);
+    TEST_ASSERT(entry->idle_timeout == 7);
+    TEST_ASSERT(entry->cold->packets == 0 && entry->cold->bytes == 0);
+
+    /* Forwarding counts carry on; the entry counts from the overwrite */
+    TEST_ASSERT(ft_entry_counters_set(ind_core_ft, entry, 15, 1500,
+                                      INDIGO_CURRENT_TIME));
+    TEST_ASSERT(entry->cold->packets == 5 && entry->cold->bytes == 500);
+    TEST_ASSERT(entry->cookie_group->aggregate.flow_count == 1);
+    TEST_ASSERT(entry->cookie_group->aggregate.packets == 5);
+
+    /* Stats replies report the counts since the overwrite */
+    stats_packets = 20;
+    stats_bytes = 2000;
+    TEST_ASSERT(request_stats(OF_FLOW_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(reply_flow_count == 1);
+    TEST_ASSERT(reply_packets == 10 && reply_bytes == 1000);
+    TEST_ASSERT(request_stats(OF_AGGREGATE_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(reply_flow_count == 1);
+    TEST_ASSERT(reply_packets == 10 && reply_bytes == 1000);
+
+    /* Requests wait while forwarding is collecting counters */
+    stats_pending = 3;
+    TEST_ASSERT(request_stats(OF_FLOW_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(stats_pending == 0);
+    TEST_ASSERT(reply_flow_count == 1);
+    TEST_ASSERT(reply_packets == 10 && reply_bytes == 1000);
+
+    /* Aggregates reuse the counters a recent dump of every flow read */
+    ind_core_config.counter_max_age_ms = 60000;
+    TEST_ASSERT(request_stats(OF_FLOW_STATS_REQUEST) == TEST_PASS);
+    stats_packets = 50;
+    stats_bytes = 5000;
+    calls = stats_calls;
+    TEST_ASSERT(request_stats(OF_AGGREGATE_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(stats_calls == calls);
+    TEST_ASSERT(reply_flow_count == 1);
+    TEST_ASSERT(reply_packets == 10 && reply_bytes == 1000);
+    ind_core_config.counter_max_age_ms = 0;
+    TEST_ASSERT(request_stats(OF_AGGREGATE_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(stats_calls == calls + 1);
+    TEST_ASSERT(reply_packets == 40 && reply_bytes == 4000);
+    stats_packets = 20;
+    stats_bytes = 2000;
+
+    /* A forwarding counter that restarts does not wrap the counts */
+    stats_packets = 3;
+    stats_bytes = 300;
+    TEST_ASSERT(request_stats(OF_FLOW_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(reply_packets == 3 && reply_bytes == 300);
+    TEST_ASSERT(request_stats(OF_AGGREGATE_STATS_REQUEST) == TEST_PASS);
+    TEST_ASSERT(reply_packets == 3 && reply_bytes == 300);
+    stats_packets = 0;
+    stats_bytes = 0;
+
+    /* If forwarding cannot modify, the flow is deleted and added again */
+    modify_error = INDIGO_ERROR_NOT_SUPPORTED;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    modify_error = INDIGO_ERROR_NONE;
+    TEST_ASSERT((entry = find_test_flow(0)) != NULL);
+    TEST_ASSERT(entry->id != id);
+    TEST_ASSERT(status->current_count == 1);
+    TEST_ASSERT(status->overwrites == overwrites + 1);
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+static int
+test_core_eviction(void)
+{
+    ft_status_t *status;
+    uint64_t evictions;
+
+    status = FT_STATUS(ind_core_ft);
+    evictions = status->evictions;
+
+    TEST_ASSERT(ind_core_table_eviction_set(0, IND_CORE_EVICTION_LRU, -1) ==
+                INDIGO_ERROR_PARAM);
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_LRU, 2));
+
+    /* The least recently used flow makes room for the third */
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(1)));
+    TEST_INDIGO_OK(do_barrier());
+    ft_entry_counters_set(ind_core_ft, find_test_flow(0), 1, 100,
+                          INDIGO_CURRENT_TIME + 1000);
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(2)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(status->evictions == evictions + 1);
+    TEST_ASSERT(find_test_flow(0) != NULL);
+    TEST_ASSERT(find_test_flow(1) == NULL);
+    TEST_ASSERT(find_test_flow(2) != NULL);
+
+    /* A failed create evicts nothing */
+    create_fail_countdown = 0;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(1)));
+    TEST_INDIGO_OK(do_barrier());
+    create_fail_countdown = -1;
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(status->evictions == evictions + 1);
+    TEST_ASSERT(find_test_flow(0) != NULL);
+    TEST_ASSERT(find_test_flow(1) == NULL);
+    TEST_ASSERT(find_test_flow(2) != NULL);
+
+    /* With no limit, a full forwarding table still evicts */
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_LRU, 0));
+    create_fail_countdown = 0;
+    create_fail_error = INDIGO_ERROR_RESOURCE;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(3)));
+    TEST_INDIGO_OK(do_barrier());
+    create_fail_countdown = -1;
+    create_fail_error = INDIGO_ERROR_UNKNOWN;
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(status->evictions == evictions + 2);
+    TEST_ASSERT(find_test_flow(2) == NULL);
+    TEST_ASSERT(find_test_flow(3) != NULL);
+
+    TEST_INDIGO_OK(ind_core_table_eviction_set(0, IND_CORE_EVICTION_NONE, 0));
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
+
+    return TEST_PASS;
+}
+
+/* Run the event loop until n monitor updates arrive or some turns pass */
+static void
+wait_monitor_updates(int n)
+{
+    int i;
 
-    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
-    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
-    TEST_INDIGO_OK(ind_core_dp_desc_set(desc_set));
-    TEST_INDIGO_OK(ind_core_dp_desc_get(desc_get));
-    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+    for (i = 0; i < 10 && monitor_update_count < n; i++) {
+        ind_soc_select_and_run(20);
+    }
+}
 
-    INDIGO_MEM_SET(desc_set, 0xee, OF_DESC_STR_LEN);
-    INDIGO_MEM_CLEAR(desc_get, OF_DESC_STR_LEN);
-    TEST_INDIGO_OK(ind_core_mfr_desc_set(desc_set));
-    TEST_INDIGO_OK(ind_core_mfr_desc_get(desc_get));
-    TEST_ASSERT(INDIGO_MEM_COMPARE(desc_set, desc_get, OF_DESC_STR_LEN) == 0);
+/* An OF 1.3 flow monitor request */
+static of_experimenter_t *
+flow_monitor_request(uint32_t id, uint16_t command, uint16_t flags,
+                     uint8_t table_id, uint64_t cookie, uint64_t cookie_mask)
+{
+    of_experimenter_t *obj;
+    uint8_t buf[IND_CORE_FLOW_MONITOR_REQUEST_LEN];
+    of_octets_t data = { buf, sizeof(buf) };
+    int i;
 
-    return TEST_PASS;
+    INDIGO_MEM_SET(buf, 0, sizeof(buf));
+    for (i = 0; i < 4; i++) {
+        buf[i] = id >> (24 - 8 * i);
+        buf[8 + i] = 0xff;         /* out_port OFPP_ANY */
+    }
+    buf[4] = command >> 8;
+    buf[5] = command;
+    buf[6] = flags >> 8;
+    buf[7] = flags;
+    buf[12] = table_id;
+    for (i = 0; i < 8; i++) {
+        buf[16 + i] = cookie >> (56 - 8 * i);
+        buf[24 + i] = cookie_mask >> (56 - 8 * i);
+    }
+
+    obj = of_experimenter_new(OF_VERSION_1_3);
+    of_experimenter_xid_set(obj, 42);
+    of_experimenter_experimenter_set(obj,
+                                     IND_CORE_FLOW_MONITOR_EXPERIMENTER_ID);
+    of_experimenter_subtype_set(obj, IND_CORE_FLOW_MONITOR_REQUEST);
+    ASSERT(of_experimenter_data_set(obj, &data) == 0);
+
+    return obj;
 }
 
+#define MONITOR_ALL (IND_CORE_FLOW_MONITOR_FLAG_ADD |                   \
+                     IND_CORE_FLOW_MONITOR_FLAG_REMOVED |               \
+                     IND_CORE_FLOW_MONITOR_FLAG_MODIFY)
+
+/* Subscribe to the flow table, then follow its changes */
 static int
-delete_all_entries(ft_instance_t ft)
+test_flow_monitor(void)
 {
-    of_flow_delete_t *flow_del;
+    of_flow_delete_strict_t *flow_del;
+    of_experimenter_t *obj, *req;
+    of_octets_t data;
+    ft_entry_t *entry;
     of_match_t match;
+    ft_status_t *status;
+    int errors;
 
-    INDIGO_MEM_CLEAR(&match, sizeof(match));
-    flow_del = of_flow_delete_new(OF_VERSION_1_0);
-    TEST_ASSERT(flow_del != NULL);
-    of_flow_delete_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
-    TEST_OK(of_flow_delete_match_set(flow_del, &match));
+    status = FT_STATUS(ind_core_ft);
+    monitor_update_count = 0;
+
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(1)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT((entry = find_test_flow(0)) != NULL);
+    TEST_ASSERT(find_test_flow(1)->cookie != entry->cookie);
+
+    /* Counters the agent last read are not passed on as current */
+    entry->cold->packets = 10;
+    entry->cold->bytes = 1000;
+
+    /* The current flows, then the end of them, answer the request */
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        1, IND_CORE_FLOW_MONITOR_CMD_ADD,
+        IND_CORE_FLOW_MONITOR_FLAG_INITIAL | MONITOR_ALL,
+        TABLE_ID_ANY, 0, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    wait_monitor_updates(2);
+    TEST_ASSERT(monitor_update_count == 2);
+    TEST_ASSERT(monitor_updates[0].xid == 42);
+    TEST_ASSERT(monitor_updates[0].id == 1);
+    TEST_ASSERT(monitor_updates[0].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_INITIAL);
+    TEST_ASSERT(monitor_updates[0].flow_count == 2);
+    TEST_ASSERT(monitor_updates[0].counters == 0);
+    TEST_ASSERT(monitor_updates[1].xid == 42);
+    TEST_ASSERT(monitor_updates[1].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_SYNCED);
+    TEST_ASSERT(monitor_updates[1].flow_count == 0);
+
+    /* A second monitor only selects flow 0 by its cookie */
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        2, IND_CORE_FLOW_MONITOR_CMD_ADD, MONITOR_ALL,
+        TABLE_ID_ANY, entry->cookie, (uint64_t)-1)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(monitor_update_count == 2);
+
+    /* A new flow goes to the first monitor only */
+    monitor_update_count = 0;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(2)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(monitor_update_count == 1);
+    TEST_ASSERT(monitor_updates[0].id == 1);
+    TEST_ASSERT(monitor_updates[0].event == IND_CORE_FLOW_MONITOR_EVENT_ADDED);
+    TEST_ASSERT(monitor_updates[0].flow_count == 1);
+
+    /* Overwriting flow 0, in place or not, is a modify to both */
+    monitor_update_count = 0;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    modify_error = INDIGO_ERROR_NOT_SUPPORTED;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    modify_error = INDIGO_ERROR_NONE;
+    TEST_ASSERT(monitor_update_count == 4);
+    TEST_ASSERT(monitor_updates[0].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_MODIFIED);
+    TEST_ASSERT(monitor_updates[1].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_MODIFIED);
+    TEST_ASSERT(monitor_updates[2].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_MODIFIED);
+    TEST_ASSERT(monitor_updates[3].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_MODIFIED);
+
+    /* A replacement that does not go in leaves the flow deleted */
+    monitor_update_count = 0;
+    modify_error = INDIGO_ERROR_NOT_SUPPORTED;
+    create_fail_countdown = 0;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    modify_error = INDIGO_ERROR_NONE;
+    create_fail_countdown = -1;
+    TEST_ASSERT(find_test_flow(0) == NULL);
+    TEST_ASSERT(monitor_update_count == 2);
+    TEST_ASSERT(monitor_updates[0].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_REMOVED);
+    TEST_ASSERT(monitor_updates[0].reason == INDIGO_FLOW_REMOVED_DELETE);
+    TEST_ASSERT(monitor_updates[1].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_REMOVED);
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+
+    /* Deleting flow 0 is reported with the reason */
+    monitor_update_count = 0;
+    TEST_ASSERT((entry = find_test_flow(0)) != NULL);
+    TEST_ASSERT((flow_del = of_flow_delete_strict_new(OF_VERSION_1_0)) != NULL);
+    of_flow_delete_strict_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
+    of_flow_delete_strict_priority_set(flow_del, entry->priority);
+    ft_entry_match_get(entry, &match);
+    TEST_OK(of_flow_delete_strict_match_set(flow_del, &match));
     TEST_INDIGO_OK(handle_message(flow_del));
     TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(monitor_update_count == 2);
+    TEST_ASSERT(monitor_updates[0].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_REMOVED);
+    TEST_ASSERT(monitor_updates[0].reason == INDIGO_FLOW_REMOVED_DELETE);
+    TEST_ASSERT(monitor_updates[1].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_REMOVED);
+
+    /* Duplicate, unknown, short and unrecognized requests are errors */
+    errors = error_msg_count;
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        1, IND_CORE_FLOW_MONITOR_CMD_ADD, MONITOR_ALL, TABLE_ID_ANY, 0, 0)));
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        3, IND_CORE_FLOW_MONITOR_CMD_DELETE, 0, TABLE_ID_ANY, 0, 0)));
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        1, 7, MONITOR_ALL, TABLE_ID_ANY, 0, 0)));
+    req = flow_monitor_request(1, IND_CORE_FLOW_MONITOR_CMD_DELETE, 0,
+                               TABLE_ID_ANY, 0, 0);
+    of_experimenter_data_get(req, &data);
+    data.bytes -= 4;
+    obj = of_experimenter_new(OF_VERSION_1_3);
+    of_experimenter_experimenter_set(obj,
+                                     IND_CORE_FLOW_MONITOR_EXPERIMENTER_ID);
+    of_experimenter_subtype_set(obj, IND_CORE_FLOW_MONITOR_REQUEST);
+    TEST_OK(of_experimenter_data_set(obj, &data));
+    of_object_delete(req);
+    TEST_INDIGO_OK(handle_message(obj));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(error_msg_count == errors + 4);
 
-    TEST_OK(depopulate_table(ft));
+    /* Deleted and disconnected monitors hear nothing more */
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        2, IND_CORE_FLOW_MONITOR_CMD_DELETE, 0, TABLE_ID_ANY, 0, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(cxn_status_handler_count > 0);
+    cxn_status_change(0, INDIGO_CXN_S_DISCONNECTED);
+    monitor_update_count = 0;
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(monitor_update_count == 0);
+    TEST_ASSERT(error_msg_count == errors + 4);
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_ASSERT(status->current_count == 0);
 
     return TEST_PASS;
 }
 
-/* Add n flows, delete them all */
-int
-test_simple_add_del(void)
+/*
+ * An OF 1.3 flow add matching everything whose ofp_flow_stats, at 65520
+ * bytes, is too big for any flow monitor update
+ */
+static of_flow_add_t *
+new_big_flow_add(void)
 {
     of_flow_add_t *flow_add;
+    of_list_instruction_t *instructions;
+    of_instruction_apply_actions_t *apply;
+    of_list_action_t *actions;
+    of_action_t elt;
+    int i;
+
+    flow_add = of_flow_add_new(OF_VERSION_1_3);
+    of_flow_add_priority_set(flow_add, 1);
+    instructions = of_list_instruction_new(OF_VERSION_1_3);
+    apply = of_instruction_apply_actions_new(OF_VERSION_1_3);
+    actions = of_list_action_new(OF_VERSION_1_3);
+    for (i = 0; i < 4091; i++) {
+        of_action_output_init(&elt.output, OF_VERSION_1_3, -1, 1);
+        ASSERT(of_list_action_append_bind(actions, &elt) == 0);
+        of_action_output_port_set(&elt.output, 1);
+    }
+    ASSERT(of_instruction_apply_actions_actions_set(apply, actions) == 0);
+    ASSERT(of_list_append(instructions, apply) == 0);
+    ASSERT(of_flow_add_instructions_set(flow_add, instructions) == 0);
+    of_object_delete(actions);
+    of_object_delete(apply);
+    of_object_delete(instructions);
+
+    return flow_add;
+}
+
+/*
+ * INITIAL updates are sent from a task that holds off while the
+ * connection is backed up. A flow too big for any update is refused with
+ * an error, and a deleted monitor's sync stops.
+ */
+static int
+test_flow_monitor_initial(void)
+{
     ft_status_t *status;
-    int idx;
+    int errors;
 
     status = FT_STATUS(ind_core_ft);
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        flow_add = of_flow_add_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_add != NULL);
-        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
-        of_flow_add_flags_set(flow_add, 0);
-        TEST_INDIGO_OK(handle_message(flow_add));
-        TEST_INDIGO_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, idx + 1);
-    }
+    monitor_update_count = 0;
+
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(0)));
+    TEST_INDIGO_OK(handle_message(new_big_flow_add()));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(status->current_count == 2);
+    errors = error_msg_count;
+
+    /* Nothing is sent while the connection is backed up */
+    cxn_congested = 1;
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        1, IND_CORE_FLOW_MONITOR_CMD_ADD,
+        IND_CORE_FLOW_MONITOR_FLAG_INITIAL | MONITOR_ALL,
+        TABLE_ID_ANY, 0, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    wait_monitor_updates(1);
+    TEST_ASSERT(monitor_update_count == 0);
+    TEST_ASSERT(error_msg_count == errors);
+
+    /* Once it drains, the flow that fits, an error, and the end */
+    cxn_congested = 0;
+    wait_monitor_updates(2);
+    TEST_ASSERT(monitor_update_count == 2);
+    TEST_ASSERT(monitor_updates[0].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_INITIAL);
+    TEST_ASSERT(monitor_updates[0].flow_count == 1);
+    TEST_ASSERT(monitor_updates[1].event ==
+                IND_CORE_FLOW_MONITOR_EVENT_SYNCED);
+    TEST_ASSERT(error_msg_count == errors + 1);
+    TEST_ASSERT(last_error_code ==
+                OF_REQUEST_FAILED_MULTIPART_BUFFER_OVERFLOW);
+
+    /* A sync waiting on the connection stops with its monitor */
+    monitor_update_count = 0;
+    cxn_congested = 1;
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        1, IND_CORE_FLOW_MONITOR_CMD_MODIFY,
+        IND_CORE_FLOW_MONITOR_FLAG_INITIAL, TABLE_ID_ANY, 0, 0)));
+    wait_monitor_updates(1);
+    TEST_INDIGO_OK(handle_message(flow_monitor_request(
+        1, IND_CORE_FLOW_MONITOR_CMD_DELETE, 0, TABLE_ID_ANY, 0, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    cxn_congested = 0;
+    wait_monitor_updates(1);
+    TEST_ASSERT(monitor_update_count == 0);
+    TEST_ASSERT(error_msg_count == errors + 1);
 
     TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
     TEST_ASSERT(status->current_count == 0);
@@ -1032,137 +3663,415 @@ test_simple_add_del(void)
     return TEST_PASS;
 }
 
-/* Add n flows, delete one by one */
-int
-test_exact_add_del(void)
+/* A test flow add with the given timeouts */
+static of_flow_add_t *
+new_timeout_flow_add(int idx, uint16_t idle_timeout, uint16_t hard_timeout)
 {
-    of_flow_add_t *flow_add_keep[TEST_FLOW_COUNT];
     of_flow_add_t *flow_add;
-    of_flow_delete_t *flow_del;
+
+    flow_add = new_test_flow_add(idx);
+    of_flow_add_idle_timeout_set(flow_add, idle_timeout);
+    of_flow_add_hard_timeout_set(flow_add, hard_timeout);
+
+    return flow_add;
+}
+
+/*
+ * Save the tables, empty them and restore them from the file. Forwarding
+ * no longer has one of the flows, which is created again.
+ */
+static int
+test_state_file(void)
+{
+    char path[64];
     ft_status_t *status;
-    int idx;
-    of_match_t match;
-    uint16_t prio;
+    ft_entry_t *entry;
+    of_list_bucket_t *buckets;
+    indigo_flow_id_t ids[3];
+    indigo_time_t now;
+    FILE *file;
+    int finishes;
+    int i;
 
     status = FT_STATUS(ind_core_ft);
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        flow_add = of_flow_add_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_add != NULL);
-        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
-        of_flow_add_flags_set(flow_add, 0);
-        flow_add_keep[idx] = of_object_dup(flow_add);
-        TEST_INDIGO_OK(handle_message(flow_add));
-        TEST_INDIGO_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, idx + 1);
+    snprintf(path, sizeof(path), "/tmp/ofsm_utest_state.%d", (int)getpid());
+
+    for (i = 0; i < 3; i++) {
+        TEST_INDIGO_OK(handle_message(new_test_flow_add(i)));
     }
+    TEST_INDIGO_OK(do_barrier());
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT((entry = find_test_flow(i)) != NULL);
+        ids[i] = entry->id;
+    }
+    find_test_flow(0)->insert_time -= 10000;
+    find_test_flow(1)->cold->packets_base = 7;
 
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        INDIGO_MEM_CLEAR(&match, sizeof(match));
-        /* Match the source mac addr which should be diff for each entry */
-        TEST_OK(of_flow_add_match_get(flow_add_keep[idx], &match));
-        of_flow_add_priority_get(flow_add_keep[idx], &prio);
-        flow_del = of_flow_delete_strict_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_del != NULL);
-        of_flow_delete_strict_out_port_set(flow_del, OF_PORT_DEST_WILDCARD);
-        of_flow_delete_strict_priority_set(flow_del, prio);
-        TEST_OK(of_flow_delete_strict_match_set(flow_del, &match));
-        TEST_INDIGO_OK(handle_message(flow_del));
-        TEST_INDIGO_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT - (idx + 1));
-        of_flow_add_delete(flow_add_keep[idx]);
+    TEST_ASSERT((buckets = of_list_bucket_new(OF_VERSION_1_3)) != NULL);
+    TEST_INDIGO_OK(ind_core_group_add(5, OF_GROUP_TYPE_ALL, buckets));
+    of_object_delete(buckets);
+
+    TEST_INDIGO_OK(ind_core_state_save(path));
+    TEST_ASSERT(access(path, F_OK) == 0);
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_INDIGO_OK(ind_core_group_delete(5));
+    TEST_ASSERT(status->current_count == 0);
+
+    finishes = reconcile_finish_count;
+    reconcile_missing_flow_id = ids[1];
+    TEST_INDIGO_OK(ind_core_state_restore(path));
+    reconcile_missing_flow_id = 0;
+    TEST_ASSERT(reconcile_finish_count == finishes + 1);
+    TEST_ASSERT(reconcile_finish_purge == 1);
+
+    /* Same IDs and history; the missing flow is installed afresh */
+    now = INDIGO_CURRENT_TIME;
+    TEST_ASSERT(status->current_count == 3);
+    TEST_ASSERT((entry = find_test_flow(0)) != NULL);
+    TEST_ASSERT(entry->id == ids[0]);
+    TEST_ASSERT(now - entry->insert_time >= 9000);
+    TEST_ASSERT((entry = find_test_flow(1)) != NULL);
+    TEST_ASSERT(entry->id == ids[1]);
+    TEST_ASSERT(entry->cold->packets_base == 0);
+    TEST_ASSERT((entry = find_test_flow(2)) != NULL);
+    TEST_ASSERT(entry->id == ids[2]);
+    TEST_ASSERT(now - entry->insert_time < 5000);
+    TEST_INDIGO_OK(ind_core_group_get(5, NULL, NULL));
+
+    /* Only a missing flow forwarding will not take back is dropped */
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_INDIGO_OK(ind_core_group_delete(5));
+    reconcile_missing_flow_id = ids[1];
+    create_fail_countdown = 0;
+    TEST_INDIGO_OK(ind_core_state_restore(path));
+    create_fail_countdown = -1;
+    reconcile_missing_flow_id = 0;
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(find_test_flow(0) != NULL);
+    TEST_ASSERT(find_test_flow(1) == NULL);
+    TEST_ASSERT(find_test_flow(2) != NULL);
+
+    /* Unchanged tables are not saved again */
+    TEST_ASSERT(remove(path) == 0);
+    ind_core_state_save_check(path);
+    TEST_ASSERT(access(path, F_OK) != 0);
+
+    /* New flows get IDs past the restored ones */
+    TEST_INDIGO_OK(handle_message(new_test_flow_add(3)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT((entry = find_test_flow(3)) != NULL);
+    TEST_ASSERT(entry->id > ids[2]);
+
+    /* A periodic save is encoded by a task and written in the background */
+    ind_core_state_save_check(path);
+    TEST_ASSERT(access(path, F_OK) != 0);
+    for (i = 0; i < 100 && access(path, F_OK) != 0; i++) {
+        ind_soc_select_and_run(10);
     }
+    TEST_ASSERT(access(path, F_OK) == 0);
+    ind_core_state_save_check(path);
+    TEST_ASSERT(remove(path) == 0);
+    ind_core_state_save_flush(path);
+    TEST_ASSERT(access(path, F_OK) != 0);
+
+    /* Shutdown finishes a save in progress */
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    ind_core_state_save_check(path);
+    ind_core_state_save_flush(path);
+    TEST_ASSERT(access(path, F_OK) == 0);
+    TEST_INDIGO_OK(ind_core_group_delete(5));
+    TEST_INDIGO_OK(ind_core_state_restore(path));
+    TEST_ASSERT(status->current_count == 0);
+    TEST_INDIGO_OK(ind_core_group_get(5, NULL, NULL));
+
+    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    TEST_INDIGO_OK(ind_core_group_delete(5));
+
+    /*
+     * Forwarding is reconciled even without a usable file, but keeps
+     * what it has when the file is corrupt
+     */
+    TEST_ASSERT((file = fopen(path, "wb")) != NULL);
+    fputs("not a state file", file);
+    fclose(file);
+    TEST_ASSERT(ind_core_state_restore(path) == INDIGO_ERROR_PARSE);
+    TEST_ASSERT(reconcile_finish_purge == 0);
+    TEST_ASSERT(remove(path) == 0);
+    TEST_ASSERT(ind_core_state_restore(path) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(reconcile_finish_purge == 1);
+    TEST_ASSERT(reconcile_finish_count == finishes + 5);
     TEST_ASSERT(status->current_count == 0);
 
     return TEST_PASS;
 }
 
-/* Add n flows, delete one by one */
-int
-test_modify(void)
+/* Buckets for a group, one forwarding to each nonzero group ID */
+static of_list_bucket_t *
+make_group_buckets(uint32_t group1, uint32_t group2)
 {
-    of_flow_add_t *flow_add_keep[TEST_FLOW_COUNT];
-    of_flow_add_t *flow_add;
-    of_flow_modify_t *flow_mod;
-    ft_status_t *status;
-    int idx;
-    of_match_t match;
-    uint16_t prio;
+    of_list_bucket_t *buckets;
+    of_bucket_t *bucket;
+    of_list_action_t *actions;
+    uint32_t ids[2] = { group1, group2 };
+    int i;
 
-    status = FT_STATUS(ind_core_ft);
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        flow_add = of_flow_add_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_add != NULL);
-        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
-        of_flow_add_flags_set(flow_add, 0);
-        flow_add_keep[idx] = of_object_dup(flow_add);
-        TEST_INDIGO_OK(handle_message(flow_add));
-        TEST_INDIGO_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, idx + 1);
+    buckets = of_list_bucket_new(OF_VERSION_1_3);
+    for (i = 0; i < 2; i++) {
+        if (ids[i] != 0) {
+            bucket = of_bucket_new(OF_VERSION_1_3);
+            actions = make_group_actions(ids[i], 0);
+            ASSERT(of_bucket_actions_set(bucket, actions) == 0);
+            ASSERT(of_list_append(buckets, bucket) == 0);
+            of_object_delete(actions);
+            of_object_delete(bucket);
+        }
     }
 
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        INDIGO_MEM_CLEAR(&match, sizeof(match));
-        /* Match the source mac addr which should be diff for each entry */
-        TEST_OK(of_flow_add_match_get(flow_add_keep[idx], &match));
-        of_flow_add_priority_get(flow_add_keep[idx], &prio);
-        flow_mod = of_flow_modify_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_mod != NULL);
-        of_flow_modify_out_port_set(flow_mod, OF_PORT_DEST_WILDCARD);
-        of_flow_modify_priority_set(flow_mod, prio);
-        TEST_OK(of_flow_modify_match_set(flow_mod, &match));
-        TEST_INDIGO_OK(handle_message(flow_mod));
-        TEST_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
-        of_flow_add_delete(flow_add_keep[idx]);
-    }
-    CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
-    /* Delete all the entries */
-    TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
+    return buckets;
+}
+
+static void
+add_test_group(uint32_t id, uint8_t type, uint32_t group1, uint32_t group2)
+{
+    of_list_bucket_t *buckets = make_group_buckets(group1, group2);
+
+    ASSERT(ind_core_group_add(id, type, buckets) == INDIGO_ERROR_NONE);
+    of_object_delete(buckets);
+}
+
+static void
+add_test_group_flow(uint16_t priority, uint32_t group1, uint32_t group2)
+{
+    of_flow_add_t *flow_add = make_out_group_flow(group1, group2);
+
+    of_flow_add_priority_set(flow_add, priority);
+    ASSERT(handle_message(flow_add) == INDIGO_ERROR_NONE);
+    do_barrier();
+}
+
+/*
+ * Group deletes follow the references between groups and from flows:
+ * a group other groups forward to stays, deleting a group removes the
+ * flows forwarding to it, and deleting all groups goes down the chains.
+ */
+static int
+test_group_refs(void)
+{
+    ft_status_t *status = FT_STATUS(ind_core_ft);
+    of_list_bucket_t *buckets;
+    int errors;
+
+    /* L2 interface 1, L3 unicast 2 and 4 on it, ECMP 3 over both */
+    add_test_group(1, OF_GROUP_TYPE_INDIRECT, 0, 0);
+    add_test_group(2, OF_GROUP_TYPE_INDIRECT, 1, 0);
+    add_test_group(4, OF_GROUP_TYPE_INDIRECT, 1, 0);
+    add_test_group(3, OF_GROUP_TYPE_SELECT, 2, 4);
+
+    add_test_group_flow(1, 3, 0);
+    add_test_group_flow(2, 2, 0);
+    add_test_group_flow(3, 1, 3);
+    TEST_ASSERT(status->current_count == 3);
+
+    TEST_ASSERT(ind_core_group_delete(1) == INDIGO_ERROR_PARAM);
+
+    /* Refused while ECMP 3 forwards to it */
+    errors = error_msg_count;
+    handle_message(bundle_group_mod(OF_GROUP_DELETE, 2));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(error_msg_count == errors + 1);
+    TEST_INDIGO_OK(ind_core_group_get(2, NULL, NULL));
+    TEST_ASSERT(status->current_count == 3);
+
+    /* The two flows forwarding to 3 go with it; then 2 can go */
+    TEST_INDIGO_OK(handle_message(bundle_group_mod(OF_GROUP_DELETE, 3)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(ind_core_group_get(3, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(status->current_count == 1);
+
+    TEST_INDIGO_OK(handle_message(bundle_group_mod(OF_GROUP_DELETE, 2)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(ind_core_group_get(2, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(status->current_count == 0);
+
+    /* A group added after one forwarding to it is referenced too */
+    add_test_group(10, OF_GROUP_TYPE_INDIRECT, 11, 0);
+    add_test_group(11, OF_GROUP_TYPE_INDIRECT, 0, 0);
+    TEST_ASSERT(ind_core_group_delete(11) == INDIGO_ERROR_PARAM);
+
+    /* Modifying 10 away from 11 frees it */
+    buckets = make_group_buckets(4, 0);
+    TEST_INDIGO_OK(ind_core_group_modify(10, OF_GROUP_TYPE_INDIRECT, buckets));
+    of_object_delete(buckets);
+    TEST_INDIGO_OK(ind_core_group_delete(11));
+    add_test_group(11, OF_GROUP_TYPE_INDIRECT, 0, 0);
+
+    /* Delete all: the flow, then 10, 4 and 1 in that order, and 11 */
+    add_test_group_flow(4, 1, 0);
+    errors = error_msg_count;
+    TEST_INDIGO_OK(handle_message(bundle_group_mod(OF_GROUP_DELETE,
+                                                   OF_GROUP_ALL)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(error_msg_count == errors);
     TEST_ASSERT(status->current_count == 0);
+    TEST_ASSERT(ind_core_group_get(1, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(ind_core_group_get(4, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(ind_core_group_get(10, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(ind_core_group_get(11, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
 
     return TEST_PASS;
 }
 
-/* Add n flows, delete one by one */
-int
-test_modify_strict(void)
+/* Bundle group deletes check references and take the flows along */
+static int
+test_bundle_group_delete(void)
+{
+    ft_status_t *status = FT_STATUS(ind_core_ft);
+    ind_core_bundle_t *bundle;
+    of_group_mod_t *group_mod;
+    of_list_bucket_t *buckets;
+    int errors;
+
+    TEST_ASSERT((bundle = ind_core_bundle_create()) != NULL);
+
+    /* L2 interface 1, L3 unicast 2 on it, and a flow to each */
+    add_test_group(1, OF_GROUP_TYPE_INDIRECT, 0, 0);
+    add_test_group(2, OF_GROUP_TYPE_INDIRECT, 1, 0);
+    add_test_group_flow(1, 1, 0);
+    add_test_group_flow(2, 2, 0);
+    TEST_ASSERT(status->current_count == 2);
+
+    /* Refused while 2 forwards to it */
+    errors = error_msg_count;
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 1)));
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_PARAM);
+    TEST_ASSERT(error_msg_count == errors + 1);
+    TEST_ASSERT(last_error_code == OF_GROUP_MOD_FAILED_CHAINED_GROUP);
+    TEST_ASSERT(status->current_count == 2);
+
+    /* Also while a group added earlier in the bundle forwards to it */
+    group_mod = bundle_group_mod(OF_GROUP_ADD, 5);
+    buckets = make_group_buckets(2, 0);
+    TEST_OK(of_group_mod_buckets_set(group_mod, buckets));
+    of_object_delete(buckets);
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, group_mod));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 2)));
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_PARAM);
+    TEST_ASSERT(last_error_code == OF_GROUP_MOD_FAILED_CHAINED_GROUP);
+    TEST_ASSERT(ind_core_group_get(5, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+
+    /*
+     * Once an earlier modify points 2 elsewhere, 1 and its flow can go;
+     * a later failure puts both back, still referenced by 2.
+     */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_MODIFY, 2)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 1)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle, new_test_flow_add(0)));
+    create_fail_countdown = 0;
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_UNKNOWN);
+    create_fail_countdown = -1;
+    TEST_ASSERT(status->current_count == 2);
+    TEST_ASSERT(ft_out_group_entry_count(ind_core_ft, 1) == 1);
+    TEST_ASSERT(ind_core_group_delete(1) == INDIGO_ERROR_PARAM);
+
+    /* Forwarding failures map to their own codes */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_ADD, 6)));
+    group_add_error = INDIGO_ERROR_RESOURCE;
+    TEST_ASSERT(ind_core_bundle_commit(bundle, 0) == INDIGO_ERROR_RESOURCE);
+    group_add_error = INDIGO_ERROR_NONE;
+    TEST_ASSERT(last_error_code == OF_GROUP_MOD_FAILED_OUT_OF_GROUPS);
+
+    /* Deleted together, the groups take their flows with them */
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 2)));
+    TEST_INDIGO_OK(ind_core_bundle_add(bundle,
+                                       bundle_group_mod(OF_GROUP_DELETE, 1)));
+    TEST_INDIGO_OK(ind_core_bundle_commit(bundle, 0));
+    TEST_ASSERT(status->current_count == 0);
+    TEST_ASSERT(ind_core_group_get(1, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+    TEST_ASSERT(ind_core_group_get(2, NULL, NULL) == INDIGO_ERROR_NOT_FOUND);
+
+    ind_core_bundle_destroy(bundle);
+
+    return TEST_PASS;
+}
+
+/*
+ * With forwarding expiring flows, the audit only removes flows overdue
+ * by a full audit period. Run with a core configured for that.
+ */
+static int
+test_expire_audit(void)
 {
-    of_flow_add_t *flow_add_keep[TEST_FLOW_COUNT];
-    of_flow_add_t *flow_add;
-    of_flow_modify_strict_t *flow_mod;
     ft_status_t *status;
-    int idx;
-    of_match_t match;
-    uint16_t prio;
+    ft_entry_t *entry;
+    indigo_time_t start;
+    int elapsed;
 
     status = FT_STATUS(ind_core_ft);
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        flow_add = of_flow_add_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_add != NULL);
-        TEST_ASSERT(of_flow_add_OF_VERSION_1_0_populate(flow_add, idx) != 0);
-        of_flow_add_flags_set(flow_add, 0);
-        flow_add_keep[idx] = of_object_dup(flow_add);
-        TEST_INDIGO_OK(handle_message(flow_add));
-        TEST_INDIGO_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, idx + 1);
+
+    start = INDIGO_CURRENT_TIME;
+    TEST_INDIGO_OK(handle_message(new_timeout_flow_add(0, 0, 1)));
+    TEST_INDIGO_OK(handle_message(new_timeout_flow_add(1, 0, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT(status->current_count == 2);
+
+    /* Past the hard timeout, but within the grace forwarding is given */
+    while (INDIGO_TIME_DIFF_ms(start, INDIGO_CURRENT_TIME) < 1200) {
+        ind_soc_select_and_run(50);
     }
+    TEST_ASSERT(find_test_flow(0) != NULL);
+    TEST_ASSERT(status->audit_expires == 0);
 
-    for (idx = 0; idx < TEST_FLOW_COUNT; idx++) {
-        INDIGO_MEM_CLEAR(&match, sizeof(match));
-        /* Match the source mac addr which should be diff for each entry */
-        TEST_OK(of_flow_add_match_get(flow_add_keep[idx], &match));
-        of_flow_add_priority_get(flow_add_keep[idx], &prio);
-        flow_mod = of_flow_modify_strict_new(OF_VERSION_1_0);
-        TEST_ASSERT(flow_mod != NULL);
-        of_flow_modify_strict_out_port_set(flow_mod, OF_PORT_DEST_WILDCARD);
-        of_flow_modify_strict_priority_set(flow_mod, prio);
-        TEST_OK(of_flow_modify_strict_match_set(flow_mod, &match));
-        TEST_INDIGO_OK(handle_message(flow_mod));
-        TEST_INDIGO_OK(do_barrier());
-        CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
-        of_flow_add_delete(flow_add_keep[idx]);
+    /* Forwarding never reported it, so the audit does */
+    while (find_test_flow(0) != NULL &&
+           INDIGO_TIME_DIFF_ms(start, INDIGO_CURRENT_TIME) < 5000) {
+        ind_soc_select_and_run(50);
     }
-    CHECK_FLOW_COUNT(status, TEST_FLOW_COUNT);
+    elapsed = INDIGO_TIME_DIFF_ms(start, INDIGO_CURRENT_TIME);
+    TEST_ASSERT(find_test_flow(0) == NULL);
+    TEST_ASSERT(elapsed >= 1500);
+    TEST_ASSERT(status->hard_expires == 1);
+    TEST_ASSERT(status->audit_expires == 1);
+    TEST_ASSERT(find_test_flow(1) != NULL);
+
+    /* An idle flow forwarding no longer has is taken to have idled out */
+    start = INDIGO_CURRENT_TIME;
+    TEST_INDIGO_OK(handle_message(new_timeout_flow_add(2, 1, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    stats_error = INDIGO_ERROR_NOT_FOUND;
+    while (find_test_flow(2) != NULL &&
+           INDIGO_TIME_DIFF_ms(start, INDIGO_CURRENT_TIME) < 5000) {
+        ind_soc_select_and_run(50);
+    }
+    stats_error = INDIGO_ERROR_NONE;
+    TEST_ASSERT(find_test_flow(2) == NULL);
+    TEST_ASSERT(status->idle_expires == 1);
+    TEST_ASSERT(status->audit_expires == 2);
+    TEST_ASSERT(status->current_count == 1);
+
+    /* Activity the audit sees is stamped now, not an audit period ago */
+    start = INDIGO_CURRENT_TIME;
+    TEST_INDIGO_OK(handle_message(new_timeout_flow_add(3, 1, 0)));
+    TEST_INDIGO_OK(do_barrier());
+    TEST_ASSERT((entry = find_test_flow(3)) != NULL);
+    stats_packets = 1;
+    while (entry->cold->packets == 0 &&
+           INDIGO_TIME_DIFF_ms(start, INDIGO_CURRENT_TIME) < 5000) {
+        ind_soc_select_and_run(50);
+    }
+    stats_packets = 0;
+    TEST_ASSERT(entry->cold->packets == 1);
+    TEST_ASSERT(INDIGO_TIME_DIFF_ms(entry->last_counter_change,
+                                    INDIGO_CURRENT_TIME) < 250);
+    TEST_ASSERT(find_test_flow(3) == entry);
+    TEST_ASSERT(status->audit_expires == 2);
+    TEST_ASSERT(status->current_count == 2);
 
     TEST_ASSERT(delete_all_entries(ind_core_ft) == TEST_PASS);
     TEST_ASSERT(status->current_count == 0);
@@ -1170,7 +4079,6 @@ test_modify_strict(void)
     return TEST_PASS;
 }
 
-
 int
 test_flow_stats(void)
 {
@@ -1187,8 +4095,21 @@ aim_main(int argc, char* argv[])
     ind_soc_enable_set(1);
 
     RUN_TEST(ft_hash);
+    RUN_TEST(ft_index_resize);
     RUN_TEST(ft_iterator);
+    RUN_TEST(ft_mask_groups);
+    RUN_TEST(ft_overlap);
+    RUN_TEST(ft_out_port);
+    RUN_TEST(ft_out_group);
+    RUN_TEST(ft_effects);
+    RUN_TEST(ft_strict_key);
+    RUN_TEST(ft_aggregates);
+    RUN_TEST(ft_cookie_index);
+    RUN_TEST(ft_eviction);
     RUN_TEST(ft_iter_task);
+    RUN_TEST(ft_expire);
+    RUN_TEST(ft_slab);
+    RUN_TEST(ft_bench);
 
     /* Init Core */
     MEMSET(&core, 0, sizeof(core));
@@ -1208,6 +4129,16 @@ aim_main(int argc, char* argv[])
     RUN_TEST(exact_add_del);
     RUN_TEST(modify);
     RUN_TEST(modify_strict);
+    RUN_TEST(bundle);
+    RUN_TEST(bundle_table_limit);
+    RUN_TEST(bundle_experimenter);
+    RUN_TEST(overwrite);
+    RUN_TEST(core_eviction);
+    RUN_TEST(flow_monitor);
+    RUN_TEST(flow_monitor_initial);
+    RUN_TEST(state_file);
+    RUN_TEST(group_refs);
+    RUN_TEST(bundle_group_delete);
 
     /* Kill logging for OFStateManager as next tests gen errors */
     aim_log_pvs_set(aim_log_find("ofstatemanager"), NULL);
@@ -1234,6 +4165,17 @@ aim_main(int argc, char* argv[])
     TRY(ind_core_enable_set(0));
     TRY(ind_core_finish());
 
+    /* Forwarding expires flows; the core only audits */
+    core.expire_flows = 0;
+    core.expire_audit_ms = 500;
+    TRY(ind_core_init(&core));
+    TRY(ind_core_enable_set(1));
+
+    RUN_TEST(expire_audit);
+
+    TRY(ind_core_enable_set(0));
+    TRY(ind_core_finish());
+
     return global_error;
 }
 
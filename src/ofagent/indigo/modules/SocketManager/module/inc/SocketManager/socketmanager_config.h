@@ -118,6 +118,16 @@
 #define SOCKETMANAGER_CONFIG_TIMESLICE_MS 10
 #endif
 
+/**
+ * SOCKETMANAGER_CONFIG_USE_EPOLL
+ *
+ * Use epoll(7) instead of poll(2) to wait for socket events. */
+
+
+#ifndef SOCKETMANAGER_CONFIG_USE_EPOLL
+#define SOCKETMANAGER_CONFIG_USE_EPOLL 1
+#endif
+
 
 
 /**
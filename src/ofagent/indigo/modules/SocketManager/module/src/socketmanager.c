@@ -21,7 +21,10 @@
  *
  * Implementation of SocketManager functionality
  *
- * Uses the socket ID as an index.
+ * Uses the socket ID as an index into a socket map that grows on demand.
+ * Sockets are waited on with epoll(7) by default, or poll(2) when
+ * SOCKETMANAGER_CONFIG_USE_EPOLL is 0. Only sockets reported ready by the
+ * wait are visited by the scheduler.
  *
  * SocketManager implements a fixed priority scheduler. Higher priority events
  * (timer or socket) are processed before lower priority events. Events with
@@ -29,9 +32,6 @@
  * loop processes one priority level before polling for potential new high
  * priority events.
  *
- * @todo Make the max socket ID supported a parameter to the module
- * @todo Make the max timer events supported a parameter to the module
- *
  * @todo Consider supporting both periodic and single events.  Currently
  * periodic events are supported with a special one-shot, immediate
  * operation.  Other than for one-shot events, events are responsible for
@@ -57,6 +57,9 @@
 #include <AIM/aim_list.h>
 
 #include <poll.h>
+#if SOCKETMANAGER_CONFIG_USE_EPOLL
+#include <sys/epoll.h>
+#endif
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
@@ -77,32 +80,366 @@ static int module_enabled = 0;
 
 #define INVALID_SOCKET_ID -1
 
-/* Maximum simultaneous sockets to support */
-#define SOCKET_COUNT_MAX 1024
+/* Initial number of socket descriptors covered by soc_map */
+#define SOC_MAP_SIZE_MIN 64
+
 typedef struct soc_map_s {
-    short socket_id;
-    uint16_t pollfd_index;
+    int socket_id;
     int priority;
     ind_soc_socket_ready_callback_f callback;
     void *cookie;
+    short events;   /* POLLIN/POLLOUT requested by the client */
+    short revents;  /* Events reported by the last wait */
+#if !SOCKETMANAGER_CONFIG_USE_EPOLL
+    int pollfd_index;
+#endif
 } soc_map_t;
 
-/* Indexed by socket descriptor */
-static soc_map_t soc_map[SOCKET_COUNT_MAX];
+/* Indexed by socket descriptor, grown on demand */
+static soc_map_t *soc_map;
+static int soc_map_size = 0;
+static int num_sockets = 0;
 
+/*
+ * Sockets with events pending from the last wait. Only these are visited
+ * when picking a priority and running callbacks, so the per-iteration cost
+ * scales with the number of ready sockets rather than registered ones.
+ */
+static int *ready_fds;
+static int ready_fds_size = 0;
+static int num_ready_fds = 0;
+
+#if SOCKETMANAGER_CONFIG_USE_EPOLL
+static int epoll_fd = -1;
+static struct epoll_event *epoll_events;
+#else
 /* Dense array passed to poll(2) */
-static struct pollfd pollfds[SOCKET_COUNT_MAX];
+static struct pollfd *pollfds;
 static int num_pollfds = 0;
+#endif
+
+#define IS_LEGAL_SOCKET_ID(_id) ((_id) >= 0)
+#define IS_ACTIVE_SOCKET_ID(_id) \
+    (((_id) < soc_map_size) && (soc_map[_id].socket_id == (_id)))
+
+/*
+ * Make soc_map large enough to be indexed by socket_id.
+ */
+static indigo_error_t
+soc_map_reserve(int socket_id)
+{
+    soc_map_t *new_map;
+    int new_size, idx;
+
+    if (socket_id < soc_map_size) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    new_size = soc_map_size > 0 ? soc_map_size : SOC_MAP_SIZE_MIN;
+    while (new_size <= socket_id) {
+        new_size *= 2;
+    }
+
+    new_map = INDIGO_MEM_REALLOC(soc_map, new_size * sizeof(*soc_map));
+    if (new_map == NULL) {
+        LOG_ERROR("Failed to grow socket map to %d entries", new_size);
+        return INDIGO_ERROR_RESOURCE;
+    }
+
+    for (idx = soc_map_size; idx < new_size; idx++) {
+        memset(&new_map[idx], 0, sizeof(new_map[idx]));
+        new_map[idx].socket_id = INVALID_SOCKET_ID;
+    }
+
+    soc_map = new_map;
+    soc_map_size = new_size;
+
+    return INDIGO_ERROR_NONE;
+}
+
+/*
+ * Make the per-wait arrays large enough to hold every registered socket.
+ */
+static indigo_error_t
+soc_ready_reserve(int count)
+{
+    int new_size;
+    int *new_ready;
+
+    if (count <= ready_fds_size) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    new_size = ready_fds_size > 0 ? ready_fds_size : SOC_MAP_SIZE_MIN;
+    while (new_size < count) {
+        new_size *= 2;
+    }
+
+    new_ready = INDIGO_MEM_REALLOC(ready_fds, new_size * sizeof(*ready_fds));
+    if (new_ready == NULL) {
+        return INDIGO_ERROR_RESOURCE;
+    }
+    ready_fds = new_ready;
+
+#if SOCKETMANAGER_CONFIG_USE_EPOLL
+    {
+        struct epoll_event *new_events;
+        new_events = INDIGO_MEM_REALLOC(epoll_events,
+                                        new_size * sizeof(*epoll_events));
+        if (new_events == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+        epoll_events = new_events;
+    }
+#else
+    {
+        struct pollfd *new_pollfds;
+        new_pollfds = INDIGO_MEM_REALLOC(pollfds, new_size * sizeof(*pollfds));
+        if (new_pollfds == NULL) {
+            return INDIGO_ERROR_RESOURCE;
+        }
+        pollfds = new_pollfds;
+    }
+#endif
+
+    ready_fds_size = new_size;
 
-#define IS_ACTIVE_SOCKET_ID(_id) (soc_map[_id].socket_id == (_id))
-#define IS_LEGAL_SOCKET_ID(_id) (((_id) >= 0) && ((_id) < SOCKET_COUNT_MAX))
-#define POLLFD_INDEX(_id) soc_map[(_id)].pollfd_index
+    return INDIGO_ERROR_NONE;
+}
+
+/*
+ * Backend operations
+ *
+ * The backend keeps the kernel's view of each registered socket in sync
+ * with soc_map[].events and, on wait, records reported events in
+ * soc_map[].revents and appends the socket to ready_fds.
+ */
+
+/* Forget the events reported by the previous wait */
+static void
+soc_ready_clear(void)
+{
+    int idx;
+    for (idx = 0; idx < num_ready_fds; idx++) {
+        int socket_id = ready_fds[idx];
+        if (IS_ACTIVE_SOCKET_ID(socket_id)) {
+            soc_map[socket_id].revents = 0;
+        }
+    }
+    num_ready_fds = 0;
+}
+
+static void
+soc_ready_add(int socket_id, short revents)
+{
+    INDIGO_ASSERT(num_ready_fds < ready_fds_size);
+    soc_map[socket_id].revents = revents;
+    ready_fds[num_ready_fds++] = socket_id;
+}
+
+#if SOCKETMANAGER_CONFIG_USE_EPOLL
+
+static uint32_t
+soc_events_to_epoll(short events)
+{
+    return ((events & POLLIN) ? EPOLLIN : 0) |
+           ((events & POLLOUT) ? EPOLLOUT : 0);
+}
+
+static short
+soc_events_from_epoll(uint32_t events)
+{
+    return ((events & EPOLLIN) ? POLLIN : 0) |
+           ((events & EPOLLOUT) ? POLLOUT : 0) |
+           ((events & EPOLLERR) ? POLLERR : 0) |
+           ((events & EPOLLHUP) ? POLLHUP : 0);
+}
+
+static indigo_error_t
+soc_backend_init(void)
+{
+    if (epoll_fd < 0) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            LOG_ERROR("Failed to create epoll descriptor: %s", strerror(errno));
+            return INDIGO_ERROR_UNKNOWN;
+        }
+    }
+    return INDIGO_ERROR_NONE;
+}
+
+static void
+soc_backend_finish(void)
+{
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+}
+
+static indigo_error_t
+soc_backend_ctl(int op, int socket_id)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = soc_events_to_epoll(soc_map[socket_id].events);
+    ev.data.fd = socket_id;
+
+    if (epoll_ctl(epoll_fd, op, socket_id, &ev) < 0) {
+        LOG_ERROR("epoll_ctl(%d) failed for socket %d: %s",
+                  op, socket_id, strerror(errno));
+        return INDIGO_ERROR_UNKNOWN;
+    }
+
+    return INDIGO_ERROR_NONE;
+}
+
+static indigo_error_t
+soc_backend_add(int socket_id)
+{
+    return soc_backend_ctl(EPOLL_CTL_ADD, socket_id);
+}
+
+static void
+soc_backend_update(int socket_id)
+{
+    (void)soc_backend_ctl(EPOLL_CTL_MOD, socket_id);
+}
+
+static void
+soc_backend_remove(int socket_id)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+
+    /* The descriptor may already be closed, which removed it from the set */
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, socket_id, &ev) < 0 &&
+            errno != EBADF && errno != ENOENT) {
+        LOG_ERROR("epoll_ctl(DEL) failed for socket %d: %s",
+                  socket_id, strerror(errno));
+    }
+}
+
+static int
+soc_backend_wait(int timeout_ms)
+{
+    int rv, idx;
+
+    LOG_TRACE("epoll waiting on %d fds, timeout %d ms", num_sockets, timeout_ms);
+    rv = epoll_wait(epoll_fd, epoll_events,
+                    ready_fds_size > 0 ? ready_fds_size : 1, timeout_ms);
+    LOG_TRACE("epoll_wait returned %d", rv);
+
+    for (idx = 0; idx < rv; idx++) {
+        int socket_id = epoll_events[idx].data.fd;
+        if (IS_ACTIVE_SOCKET_ID(socket_id)) {
+            soc_ready_add(socket_id,
+                          soc_events_from_epoll(epoll_events[idx].events));
+        }
+    }
+
+    return rv;
+}
+
+#else /* !SOCKETMANAGER_CONFIG_USE_EPOLL */
+
+static indigo_error_t
+soc_backend_init(void)
+{
+    return INDIGO_ERROR_NONE;
+}
+
+static void
+soc_backend_finish(void)
+{
+    num_pollfds = 0;
+}
+
+static indigo_error_t
+soc_backend_add(int socket_id)
+{
+    struct pollfd *pfd;
+
+    INDIGO_ASSERT(num_pollfds < ready_fds_size);
+    soc_map[socket_id].pollfd_index = num_pollfds;
+    pfd = &pollfds[num_pollfds++];
+    pfd->fd = socket_id;
+    pfd->events = soc_map[socket_id].events;
+    pfd->revents = 0;
+
+    return INDIGO_ERROR_NONE;
+}
+
+static void
+soc_backend_update(int socket_id)
+{
+    pollfds[soc_map[socket_id].pollfd_index].events = soc_map[socket_id].events;
+}
+
+static void
+soc_backend_remove(int socket_id)
+{
+    /*
+     * Need to maintain the dense property of the pollfds array.
+     * Move the element at the end to the index being freed.
+     */
+    int dst_index = soc_map[socket_id].pollfd_index;
+
+    INDIGO_ASSERT(num_pollfds > 0);
+    if (dst_index != num_pollfds - 1) {
+        struct pollfd *src_pfd = &pollfds[num_pollfds-1];
+        soc_map[src_pfd->fd].pollfd_index = dst_index;
+        pollfds[dst_index] = *src_pfd;
+    }
+
+    num_pollfds--;
+}
+
+static int
+soc_backend_wait(int timeout_ms)
+{
+    int rv, idx;
+
+    LOG_TRACE("polling %d fds, timeout %d ms", num_pollfds, timeout_ms);
+    rv = poll(pollfds, num_pollfds, timeout_ms);
+    LOG_TRACE("poll returned %d", rv);
+
+    for (idx = 0; idx < num_pollfds && rv > 0; idx++) {
+        if (pollfds[idx].revents != 0) {
+            soc_ready_add(pollfds[idx].fd, pollfds[idx].revents);
+        }
+    }
+
+    return rv;
+}
+
+#endif /* SOCKETMANAGER_CONFIG_USE_EPOLL */
 
 /*
  * Timer event structure
  * Lookup is (callback, cookie)
+ *
+ * Timers with the same period and priority share a timer group. Since a
+ * timer is always (re)armed at the current time, appending it to its
+ * group's list keeps the list sorted by deadline. Only the head of each
+ * group is kept in a min-heap, so arm, cancel and fire are O(1) within a
+ * group and O(log g) in the number of distinct groups.
  */
+typedef struct timer_group_s {
+    list_head_t timers;  /* timer_event_t, sorted by deadline */
+    int repeat_time_ms;
+    int priority;
+    int heap_index;      /* -1 when the group is empty */
+    struct timer_group_s *next;
+} timer_group_t;
+
 typedef struct timer_event_s {
+    list_links_t links;  /* group list, or the due list while firing */
+    struct timer_event_s *hash_next;
+    timer_group_t *group;
+    int due;
     ind_soc_timer_callback_f callback;
     void *cookie;
     int repeat_time_ms;
@@ -110,14 +447,28 @@ typedef struct timer_event_s {
     indigo_time_t last_call;
 } timer_event_t;
 
-#define TIMER_EVENT_MAX 16
-static timer_event_t timer_event[TIMER_EVENT_MAX];
+#define TIMER_DEADLINE(_t) ((_t)->last_call + (_t)->repeat_time_ms)
+#define TIMER_GROUP_HEAD(_g) \
+    container_of((_g)->timers.links.next, links, timer_event_t)
+#define TIMER_GROUP_DEADLINE(_g) TIMER_DEADLINE(TIMER_GROUP_HEAD(_g))
+
+/* All timer groups */
+static timer_group_t *timer_groups;
+static int num_timer_groups = 0;
+
+/* Min-heap of non-empty groups keyed on the deadline of their first timer */
+static timer_group_t **timer_heap;
+static int timer_heap_count = 0;
+static int timer_heap_size = 0;
 
-#define TIMER_EVENT_VALID(idx) (timer_event[idx].callback != NULL)
+/* Scratch space for groups with expired timers, same size as timer_heap */
+static timer_group_t **timer_expired;
 
-#define FOREACH_TIMER_EVENT(idx)                        \
-    for ((idx) = 0; (idx) < TIMER_EVENT_MAX; (idx)++)   \
-        if (TIMER_EVENT_VALID(idx))
+/* Hash of timers on (callback, cookie) */
+#define TIMER_HASH_SIZE_MIN 16
+static timer_event_t **timer_hash;
+static int timer_hash_size = 0;
+static int num_timers = 0;
 
 /*
  * Task structure
@@ -133,48 +484,309 @@ typedef struct ind_soc_task_s {
 static list_head_t tasks;
 
 
-/* Return index for timer; -1 if not found.  Use only with valid callback */
-static int
+static uint32_t
+timer_hash_index(ind_soc_timer_callback_f callback, void *cookie, int size)
+{
+    uint64_t h = (uintptr_t)callback ^ ((uint64_t)(uintptr_t)cookie * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 32;
+    return (uint32_t)h & (size - 1);
+}
+
+/* Return the timer for (callback, cookie) or NULL if not found */
+static timer_event_t *
 timer_event_find(ind_soc_timer_callback_f callback, void *cookie)
 {
-    int idx;
+    timer_event_t *t;
+
+    if (timer_hash_size == 0) {
+        return NULL;
+    }
+
+    t = timer_hash[timer_hash_index(callback, cookie, timer_hash_size)];
+    for (; t != NULL; t = t->hash_next) {
+        if (t->callback == callback && t->cookie == cookie) {
+            return t;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Double the hash table once it averages more than one timer per bucket.
+ * Failure to grow only makes the chains longer.
+ */
+static indigo_error_t
+timer_hash_reserve(int count)
+{
+    timer_event_t **new_hash;
+    int new_size, idx;
+
+    if (timer_hash_size > 0 && count <= timer_hash_size) {
+        return INDIGO_ERROR_NONE;
+    }
+
+    new_size = timer_hash_size > 0 ? timer_hash_size * 2 : TIMER_HASH_SIZE_MIN;
+    new_hash = INDIGO_MEM_ALLOC(new_size * sizeof(*new_hash));
+    if (new_hash == NULL) {
+        return timer_hash_size > 0 ? INDIGO_ERROR_NONE : INDIGO_ERROR_RESOURCE;
+    }
+    INDIGO_MEM_CLEAR(new_hash, new_size * sizeof(*new_hash));
+
+    for (idx = 0; idx < timer_hash_size; idx++) {
+        timer_event_t *t = timer_hash[idx];
+        while (t != NULL) {
+            timer_event_t *next = t->hash_next;
+            uint32_t bucket = timer_hash_index(t->callback, t->cookie, new_size);
+            t->hash_next = new_hash[bucket];
+            new_hash[bucket] = t;
+            t = next;
+        }
+    }
+
+    INDIGO_MEM_FREE(timer_hash);
+    timer_hash = new_hash;
+    timer_hash_size = new_size;
+
+    return INDIGO_ERROR_NONE;
+}
+
+static void
+timer_hash_remove(timer_event_t *timer)
+{
+    timer_event_t **prev = &timer_hash[
+        timer_hash_index(timer->callback, timer->cookie, timer_hash_size)];
+
+    while (*prev != timer) {
+        INDIGO_ASSERT(*prev != NULL);
+        prev = &(*prev)->hash_next;
+    }
+    *prev = timer->hash_next;
+}
+
+static void
+timer_heap_swap(int a, int b)
+{
+    timer_group_t *tmp = timer_heap[a];
+    timer_heap[a] = timer_heap[b];
+    timer_heap[b] = tmp;
+    timer_heap[a]->heap_index = a;
+    timer_heap[b]->heap_index = b;
+}
+
+static void
+timer_heap_sift(int idx)
+{
+    /* Up */
+    while (idx > 0) {
+        int parent = (idx - 1) / 2;
+        if (TIMER_GROUP_DEADLINE(timer_heap[parent]) <=
+                TIMER_GROUP_DEADLINE(timer_heap[idx])) {
+            break;
+        }
+        timer_heap_swap(idx, parent);
+        idx = parent;
+    }
+
+    /* Down */
+    while (1) {
+        int smallest = idx;
+        int left = 2 * idx + 1, right = left + 1;
+        if (left < timer_heap_count &&
+                TIMER_GROUP_DEADLINE(timer_heap[left]) <
+                TIMER_GROUP_DEADLINE(timer_heap[smallest])) {
+            smallest = left;
+        }
+        if (right < timer_heap_count &&
+                TIMER_GROUP_DEADLINE(timer_heap[right]) <
+                TIMER_GROUP_DEADLINE(timer_heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == idx) {
+            break;
+        }
+        timer_heap_swap(idx, smallest);
+        idx = smallest;
+    }
+}
+
+/* Restore the heap after the head of a group changed */
+static void
+timer_heap_update(timer_group_t *group)
+{
+    int idx = group->heap_index;
+
+    if (list_empty(&group->timers)) {
+        if (idx >= 0) {
+            timer_heap_count--;
+            if (idx != timer_heap_count) {
+                timer_heap_swap(idx, timer_heap_count);
+                timer_heap_sift(idx);
+            }
+            group->heap_index = -1;
+        }
+    } else if (idx < 0) {
+        /* timer_group_get reserved a slot for every group */
+        INDIGO_ASSERT(timer_heap_count < timer_heap_size);
+        group->heap_index = timer_heap_count;
+        timer_heap[timer_heap_count++] = group;
+        timer_heap_sift(group->heap_index);
+    } else {
+        timer_heap_sift(idx);
+    }
+}
+
+/* Find or create the group for a (period, priority) pair */
+static timer_group_t *
+timer_group_get(int repeat_time_ms, int priority)
+{
+    timer_group_t *group;
 
-    FOREACH_TIMER_EVENT(idx) {
-        if ((timer_event[idx].callback == callback) &&
-                (timer_event[idx].cookie == cookie)) {
-            return idx;
+    for (group = timer_groups; group != NULL; group = group->next) {
+        if (group->repeat_time_ms == repeat_time_ms &&
+                group->priority == priority) {
+            return group;
         }
     }
 
-    return -1;
+    if (num_timer_groups >= timer_heap_size) {
+        int new_size = timer_heap_size > 0 ? timer_heap_size * 2 : 8;
+        timer_group_t **new_heap, **new_expired;
+
+        new_heap = INDIGO_MEM_ALLOC(new_size * sizeof(*new_heap));
+        new_expired = INDIGO_MEM_ALLOC(new_size * sizeof(*new_expired));
+        if (new_heap == NULL || new_expired == NULL) {
+            INDIGO_MEM_FREE(new_heap);
+            INDIGO_MEM_FREE(new_expired);
+            return NULL;
+        }
+
+        if (timer_heap_count > 0) {
+            INDIGO_MEM_COPY(new_heap, timer_heap,
+                            timer_heap_count * sizeof(*new_heap));
+        }
+        INDIGO_MEM_FREE(timer_heap);
+        INDIGO_MEM_FREE(timer_expired);
+        timer_heap = new_heap;
+        timer_expired = new_expired;
+        timer_heap_size = new_size;
+    }
+
+    group = INDIGO_MEM_ALLOC(sizeof(*group));
+    if (group == NULL) {
+        return NULL;
+    }
+
+    list_init(&group->timers);
+    group->repeat_time_ms = repeat_time_ms;
+    group->priority = priority;
+    group->heap_index = -1;
+    group->next = timer_groups;
+    timer_groups = group;
+    num_timer_groups++;
+
+    return group;
+}
+
+/* Take a timer off its group list or the due list */
+static void
+timer_disarm(timer_event_t *timer)
+{
+    timer_group_t *group = timer->group;
+    int was_head;
+
+    if (timer->due) {
+        list_remove(&timer->links);
+        timer->due = 0;
+        return;
+    }
+
+    was_head = TIMER_GROUP_HEAD(group) == timer;
+    list_remove(&timer->links);
+    if (was_head) {
+        timer_heap_update(group);
+    }
 }
 
-/* Return index of first free timer slot */
+/* Append a timer to its group with a deadline one period from now */
+static void
+timer_arm(timer_event_t *timer, indigo_time_t now)
+{
+    timer_group_t *group = timer->group;
+    int was_empty = list_empty(&group->timers);
+
+    timer->last_call = now;
+    list_push(&group->timers, &timer->links);
+    if (was_empty) {
+        timer_heap_update(group);
+    }
+}
+
+/*
+ * Collect the groups at or above min_priority whose first timer has
+ * expired, pruning heap subtrees that have not. Returns the count stored
+ * in timer_expired.
+ */
 static int
-timer_event_free_slot(void)
+timer_collect_expired(int idx, indigo_time_t now, int min_priority, int count)
+{
+    timer_group_t *group;
+
+    if (idx >= timer_heap_count) {
+        return count;
+    }
+
+    group = timer_heap[idx];
+    if (INDIGO_TIME_DIFF_ms(now, TIMER_GROUP_DEADLINE(group)) > 0) {
+        return count;
+    }
+
+    if (group->priority >= min_priority) {
+        timer_expired[count++] = group;
+    }
+
+    count = timer_collect_expired(2 * idx + 1, now, min_priority, count);
+    return timer_collect_expired(2 * idx + 2, now, min_priority, count);
+}
+
+static void
+timer_mgr_reset(void)
 {
     int idx;
 
-    for (idx = 0; idx < TIMER_EVENT_MAX; idx++) {
-        if (timer_event[idx].callback == NULL) {
-            return idx;
+    for (idx = 0; idx < timer_hash_size; idx++) {
+        while (timer_hash[idx] != NULL) {
+            timer_event_t *t = timer_hash[idx];
+            timer_hash[idx] = t->hash_next;
+            INDIGO_MEM_FREE(t);
         }
     }
+    num_timers = 0;
 
-    return -1;
+    while (timer_groups != NULL) {
+        timer_group_t *group = timer_groups;
+        timer_groups = group->next;
+        INDIGO_MEM_FREE(group);
+    }
+    num_timer_groups = 0;
+    timer_heap_count = 0;
 }
 
 static void
 soc_mgr_init(void)
 {
     int idx;
-    for (idx = 0; idx < SOCKET_COUNT_MAX; idx++) {
+    for (idx = 0; idx < soc_map_size; idx++) {
+        memset(&soc_map[idx], 0, sizeof(soc_map_t));
         soc_map[idx].socket_id = INVALID_SOCKET_ID;
     }
+    num_sockets = 0;
+    num_ready_fds = 0;
+    soc_backend_finish();
 
-    for (idx = 0; idx < TIMER_EVENT_MAX; idx++) {
-        timer_event[idx].callback = NULL;
-    }
+    timer_mgr_reset();
 
     list_init(&tasks);
 }
@@ -186,7 +798,7 @@ ind_soc_socket_register_with_priority(int socket_id,
                                       void *cookie,
                                       int priority)
 {
-    struct pollfd *pfd;
+    indigo_error_t rv;
 
     LOG_VERBOSE("Register socket %d", socket_id);
     if (!IS_LEGAL_SOCKET_ID(socket_id)) {
@@ -204,18 +816,24 @@ ind_soc_socket_register_with_priority(int socket_id,
         return INDIGO_ERROR_EXISTS;
     }
 
+    if ((rv = soc_map_reserve(socket_id)) < 0 ||
+            (rv = soc_ready_reserve(num_sockets + 1)) < 0) {
+        return rv;
+    }
+
     INDIGO_ASSERT(soc_map[socket_id].socket_id == INVALID_SOCKET_ID);
-    soc_map[socket_id].socket_id = socket_id;
-    soc_map[socket_id].pollfd_index = num_pollfds;
     soc_map[socket_id].callback = callback;
     soc_map[socket_id].cookie = cookie;
     soc_map[socket_id].priority = priority;
+    soc_map[socket_id].events = POLLIN;
+    soc_map[socket_id].revents = 0;
 
-    INDIGO_ASSERT(num_pollfds < SOCKET_COUNT_MAX);
-    pfd = &pollfds[num_pollfds++];
-    pfd->fd = socket_id;
-    pfd->events = POLLIN;
-    pfd->revents = 0;
+    if ((rv = soc_backend_add(socket_id)) < 0) {
+        return rv;
+    }
+
+    soc_map[socket_id].socket_id = socket_id;
+    num_sockets++;
 
     return INDIGO_ERROR_NONE;
 }
@@ -229,6 +847,16 @@ ind_soc_socket_register(int socket_id,
         socket_id, callback, cookie, IND_SOC_DEFAULT_PRIORITY);
 }
 
+/* Change the requested events, skipping the backend if nothing changed */
+static void
+soc_events_set(int socket_id, short events)
+{
+    if (soc_map[socket_id].events != events) {
+        soc_map[socket_id].events = events;
+        soc_backend_update(socket_id);
+    }
+}
+
 indigo_error_t
 ind_soc_data_out_ready(int socket_id)
 {
@@ -242,7 +870,7 @@ ind_soc_data_out_ready(int socket_id)
         return INDIGO_ERROR_PARAM;
     }
 
-    pollfds[POLLFD_INDEX(socket_id)].events |= POLLOUT;
+    soc_events_set(socket_id, soc_map[socket_id].events | POLLOUT);
 
     return INDIGO_ERROR_NONE;
 }
@@ -260,7 +888,7 @@ ind_soc_data_out_clear(int socket_id)
         return INDIGO_ERROR_PARAM;
     }
 
-    pollfds[POLLFD_INDEX(socket_id)].events &= ~POLLOUT;
+    soc_events_set(socket_id, soc_map[socket_id].events & ~POLLOUT);
 
     return INDIGO_ERROR_NONE;
 }
@@ -278,7 +906,7 @@ ind_soc_data_in_pause(int socket_id)
         return INDIGO_ERROR_PARAM;
     }
 
-    pollfds[POLLFD_INDEX(socket_id)].events &= ~POLLIN;
+    soc_events_set(socket_id, soc_map[socket_id].events & ~POLLIN);
 
     return INDIGO_ERROR_NONE;
 }
@@ -296,7 +924,7 @@ ind_soc_data_in_resume(int socket_id)
         return INDIGO_ERROR_PARAM;
     }
 
-    pollfds[POLLFD_INDEX(socket_id)].events |= POLLIN;
+    soc_events_set(socket_id, soc_map[socket_id].events | POLLIN);
 
     return INDIGO_ERROR_NONE;
 }
@@ -320,23 +948,11 @@ ind_soc_socket_unregister(int socket_id)
         return INDIGO_ERROR_PARAM;
     }
 
-    /*
-     * Need to maintain the dense property of the pollfds array.
-     * Move the element at the end to the index being freed.
-     */
-    INDIGO_ASSERT(num_pollfds > 0);
-    if (num_pollfds > 1) {
-        int dst_index = POLLFD_INDEX(socket_id);
-        struct pollfd *src_pfd = &pollfds[num_pollfds-1];
-        struct pollfd *dst_pfd = &pollfds[dst_index];
-        if (src_pfd != dst_pfd) {
-            soc_map[src_pfd->fd].pollfd_index = dst_index;
-            *dst_pfd = *src_pfd;
-        }
-    }
-
-    num_pollfds--;
+    soc_backend_remove(socket_id);
+    INDIGO_ASSERT(num_sockets > 0);
+    num_sockets--;
 
+    /* Clearing revents keeps a pending ready_fds entry from being run */
     memset(&soc_map[socket_id], 0, sizeof(soc_map_t));
     soc_map[socket_id].socket_id = INVALID_SOCKET_ID;
 
@@ -362,59 +978,83 @@ ind_soc_run_status_set(ind_soc_run_status_t s)
 static int
 find_next_timer_expiration(indigo_time_t now)
 {
-    int idx;
-    int next_ms = -1, elapsed, tmp_ms;
-    FOREACH_TIMER_EVENT(idx) {
-        elapsed = INDIGO_TIME_DIFF_ms(timer_event[idx].last_call, now);
-        tmp_ms = timer_event[idx].repeat_time_ms - elapsed; /* Time to next */
-        if (next_ms == -1 || tmp_ms < next_ms) {
-            next_ms = tmp_ms > 0 ? tmp_ms : 0;
-        }
+    int tmp_ms;
+
+    if (timer_heap_count == 0) {
+        return -1;
     }
-    return next_ms;
+
+    tmp_ms = INDIGO_TIME_DIFF_ms(now, TIMER_GROUP_DEADLINE(timer_heap[0]));
+    return tmp_ms > 0 ? tmp_ms : 0;
 }
 
 /*
  * Run callbacks for timer events.
+ *
+ * Expired timers are first moved to a local due list and rearmed one at a
+ * time as they fire, so callbacks may register or unregister any timer
+ * (including ones still due) and a rearmed timer does not fire twice.
+ * Each is rearmed from the time it fires, not when the batch started, so
+ * a slow callback does not leave the timers after it already due again.
  */
 static void
 process_timers(int priority)
 {
-    int idx;
     indigo_time_t now;
-    int elapsed, tmp_ms;
-    ind_soc_timer_callback_f callback;
+    list_head_t due;
+    list_links_t *cur;
+    int count, idx;
 
     now = INDIGO_CURRENT_TIME;
+    list_init(&due);
 
-    FOREACH_TIMER_EVENT(idx) {
-        if(ind_soc_run_status__ == IND_SOC_RUN_STATUS_EXIT) {
-            break;
-        }
-
-        if (timer_event[idx].priority != priority) {
+    count = timer_collect_expired(0, now, priority, 0);
+    for (idx = 0; idx < count; idx++) {
+        timer_group_t *group = timer_expired[idx];
+        if (group->priority != priority) {
             continue;
         }
+        while (!list_empty(&group->timers) &&
+               INDIGO_TIME_DIFF_ms(now, TIMER_GROUP_DEADLINE(group)) <= 0) {
+            timer_event_t *t = TIMER_GROUP_HEAD(group);
+            list_remove(&t->links);
+            list_push(&due, &t->links);
+            t->due = 1;
+        }
+        timer_heap_update(group);
+    }
 
-        elapsed = INDIGO_TIME_DIFF_ms(timer_event[idx].last_call, now);
-        tmp_ms = timer_event[idx].repeat_time_ms - elapsed; /* Time to next */
-        if (tmp_ms <= 0) {
-            timer_event[idx].last_call = now;
+    while ((cur = list_shift(&due)) != NULL) {
+        timer_event_t *t = container_of(cur, links, timer_event_t);
+        ind_soc_timer_callback_f callback = t->callback;
+        void *cookie = t->cookie;
 
-            /* The callback may change its registration, so need to track
-             * current value if this is one-shot.
-             */
+        t->due = 0;
 
-            callback = timer_event[idx].callback;
-            if (timer_event[idx].repeat_time_ms == IND_SOC_TIMER_IMMEDIATE) {
-                /* De-register one-shot immediate timers */
-                timer_event[idx].callback = NULL;
+        if (ind_soc_run_status__ == IND_SOC_RUN_STATUS_EXIT) {
+            /* Put unfired timers back at the front of their groups */
+            list_unshift(&due, cur);
+            while ((cur = list_pop(&due)) != NULL) {
+                t = container_of(cur, links, timer_event_t);
+                t->due = 0;
+                list_unshift(&t->group->timers, &t->links);
+                timer_heap_update(t->group);
             }
+            break;
+        }
 
-            before_callback();
-            callback(timer_event[idx].cookie);
-            after_callback();
+        if (t->repeat_time_ms == IND_SOC_TIMER_IMMEDIATE) {
+            /* De-register one-shot immediate timers */
+            timer_hash_remove(t);
+            num_timers--;
+            INDIGO_MEM_FREE(t);
+        } else {
+            timer_arm(t, INDIGO_CURRENT_TIME);
         }
+
+        before_callback();
+        callback(cookie);
+        after_callback();
     }
 }
 
@@ -423,7 +1063,8 @@ ind_soc_timer_event_register_with_priority(
     ind_soc_timer_callback_f callback, void *cookie,
     int repeat_time_ms, int priority)
 {
-    int idx;
+    timer_event_t *t;
+    timer_group_t *group;
 
     if (callback == NULL) {
         LOG_ERROR("Null callback for timer register");
@@ -434,22 +1075,41 @@ ind_soc_timer_event_register_with_priority(
         return INDIGO_ERROR_PARAM;
     }
     /* Allow re-registering which resets the timer */
-    if ((idx = timer_event_find(callback, cookie)) >= 0) {
+    if ((t = timer_event_find(callback, cookie)) != NULL) {
         LOG_TRACE("Resetting event timer for %p to %d", callback, repeat_time_ms);
-        timer_event[idx].repeat_time_ms = repeat_time_ms;
-        timer_event[idx].last_call = INDIGO_CURRENT_TIME;
+        if ((group = timer_group_get(repeat_time_ms, t->priority)) == NULL) {
+            LOG_ERROR("No space for timer group %d ms", repeat_time_ms);
+            return INDIGO_ERROR_RESOURCE;
+        }
+        timer_disarm(t);
+        t->repeat_time_ms = repeat_time_ms;
+        t->group = group;
+        timer_arm(t, INDIGO_CURRENT_TIME);
         return INDIGO_ERROR_NONE;
     }
-    if ((idx = timer_event_free_slot()) < 0) {
+
+    if (timer_hash_reserve(num_timers + 1) < 0 ||
+            (group = timer_group_get(repeat_time_ms, priority)) == NULL ||
+            (t = INDIGO_MEM_ALLOC(sizeof(*t))) == NULL) {
         LOG_ERROR("No space for timer event %p, %p", callback, cookie);
         return INDIGO_ERROR_RESOURCE;
     }
 
-    timer_event[idx].repeat_time_ms = repeat_time_ms;
-    timer_event[idx].callback = callback;
-    timer_event[idx].cookie = cookie;
-    timer_event[idx].last_call = INDIGO_CURRENT_TIME;
-    timer_event[idx].priority = priority;
+    t->repeat_time_ms = repeat_time_ms;
+    t->callback = callback;
+    t->cookie = cookie;
+    t->priority = priority;
+    t->group = group;
+    t->due = 0;
+
+    {
+        uint32_t bucket = timer_hash_index(callback, cookie, timer_hash_size);
+        t->hash_next = timer_hash[bucket];
+        timer_hash[bucket] = t;
+    }
+    num_timers++;
+
+    timer_arm(t, INDIGO_CURRENT_TIME);
 
     return INDIGO_ERROR_NONE;
 }
@@ -466,15 +1126,18 @@ ind_soc_timer_event_register(
 indigo_error_t
 ind_soc_timer_event_unregister(ind_soc_timer_callback_f callback, void *cookie)
 {
-    int idx;
+    timer_event_t *t;
 
-    if ((idx = timer_event_find(callback, cookie)) < 0) {
+    if ((t = timer_event_find(callback, cookie)) == NULL) {
         LOG_TRACE("Timer event %p, %p not found for unregister",
                   callback, cookie);
         return INDIGO_ERROR_NOT_FOUND;
     }
 
-    timer_event[idx].callback = NULL;
+    timer_disarm(t);
+    timer_hash_remove(t);
+    num_timers--;
+    INDIGO_MEM_FREE(t);
 
     return INDIGO_ERROR_NONE;
 }
@@ -563,6 +1226,9 @@ ind_soc_init(ind_soc_config_t *config)
     ind_cfg_register(&ind_soc_cfg_ops);
 
     soc_mgr_init();
+    if (soc_backend_init() < 0) {
+        return INDIGO_ERROR_UNKNOWN;
+    }
     init_done = 1;
     (void)config;
 
@@ -647,24 +1313,28 @@ static void
 process_sockets(int priority)
 {
     int i;
-    for (i = 0; i < num_pollfds; i++) {
-        struct pollfd *pfd = &pollfds[i];
+    for (i = 0; i < num_ready_fds; i++) {
+        int socket_id = ready_fds[i];
+        short revents;
         int read_ready, write_ready, error_seen;
 
         if (ind_soc_run_status__ == IND_SOC_RUN_STATUS_EXIT) {
             break;
         }
 
-        if (soc_map[pfd->fd].priority != priority) {
+        /* An earlier callback may have unregistered this socket */
+        if (!IS_ACTIVE_SOCKET_ID(socket_id) ||
+                soc_map[socket_id].priority != priority) {
             continue;
         }
 
-        read_ready = (pfd->revents & POLLIN) != 0;
-        write_ready = (pfd->revents & POLLOUT) != 0;
-        error_seen = (pfd->revents & POLLERR) != 0;
+        revents = soc_map[socket_id].revents;
+        read_ready = (revents & POLLIN) != 0;
+        write_ready = (revents & POLLOUT) != 0;
+        error_seen = (revents & POLLERR) != 0;
         if (read_ready || write_ready || error_seen) {
             before_callback();
-            soc_map[pfd->fd].callback(pfd->fd, soc_map[pfd->fd].cookie,
+            soc_map[socket_id].callback(socket_id, soc_map[socket_id].cookie,
                     read_ready, write_ready, error_seen);
             after_callback();
         }
@@ -694,39 +1364,32 @@ process_tasks(int priority)
 
 /*
  * This function returns the priority level the event loop should process
- * on the current iteration. It assumes poll() has been called on the global
- * pollfds array.
+ * on the current iteration. It assumes soc_backend_wait() has filled in
+ * ready_fds.
  */
 static int
 find_highest_ready_priority(void)
 {
-    int idx;
+    int idx, count;
     indigo_time_t now;
-    int elapsed, tmp_ms;
     int priority = INT_MIN;
 
     now = INDIGO_CURRENT_TIME;
 
-    for (idx = 0; idx < num_pollfds; idx++) {
-        struct pollfd *pfd = &pollfds[idx];
+    for (idx = 0; idx < num_ready_fds; idx++) {
+        int socket_id = ready_fds[idx];
 
-        if (pfd->revents == 0) {
+        if (!IS_ACTIVE_SOCKET_ID(socket_id) ||
+                soc_map[socket_id].revents == 0) {
             continue;
         }
 
-        priority = aim_imax(priority, soc_map[pfd->fd].priority);
+        priority = aim_imax(priority, soc_map[socket_id].priority);
     }
 
-    FOREACH_TIMER_EVENT(idx) {
-        if (timer_event[idx].priority <= priority) {
-            continue;
-        }
-
-        elapsed = INDIGO_TIME_DIFF_ms(timer_event[idx].last_call, now);
-        tmp_ms = timer_event[idx].repeat_time_ms - elapsed; /* Time to next */
-        if (tmp_ms <= 0) {
-            priority = timer_event[idx].priority;
-        }
+    count = timer_collect_expired(0, now, priority, 0);
+    for (idx = 0; idx < count; idx++) {
+        priority = aim_imax(priority, timer_expired[idx]->priority);
     }
 
     if (!list_empty(&tasks)) {
@@ -767,12 +1430,11 @@ ind_soc_select_and_run(int run_for_ms)
         timeout_ms = calculate_next_timeout(start, current,
                                             run_for_ms, next_timer_ms);
 
-        LOG_TRACE("polling %d fds, timeout %d ms", num_pollfds, timeout_ms);
-        rv = poll(pollfds, num_pollfds, timeout_ms);
-        LOG_TRACE("poll returned %d", rv);
+        soc_ready_clear();
+        rv = soc_backend_wait(timeout_ms);
 
         if (rv < 0 && errno != EINTR) {
-            LOG_ERROR("Error in poll: %s", strerror(errno));
+            LOG_ERROR("Error waiting for socket events: %s", strerror(errno));
             return INDIGO_ERROR_UNKNOWN;
         }
 
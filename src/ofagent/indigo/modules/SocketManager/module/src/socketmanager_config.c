@@ -78,6 +78,11 @@ socketmanager_config_settings_t socketmanager_config_settings[] =
     { __socketmanager_config_STRINGIFY_NAME(SOCKETMANAGER_CONFIG_TIMESLICE_MS), __socketmanager_config_STRINGIFY_VALUE(SOCKETMANAGER_CONFIG_TIMESLICE_MS) },
 #else
 { SOCKETMANAGER_CONFIG_TIMESLICE_MS(__socketmanager_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef SOCKETMANAGER_CONFIG_USE_EPOLL
+    { __socketmanager_config_STRINGIFY_NAME(SOCKETMANAGER_CONFIG_USE_EPOLL), __socketmanager_config_STRINGIFY_VALUE(SOCKETMANAGER_CONFIG_USE_EPOLL) },
+#else
+{ SOCKETMANAGER_CONFIG_USE_EPOLL(__socketmanager_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
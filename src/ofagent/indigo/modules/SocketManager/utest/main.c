@@ -30,6 +30,7 @@
 
 #include <SocketManager/socketmanager.h>
 #include <stdio.h>
+#include <string.h>
 #include <indigo/assert.h>
 #include <indigo/time.h>
 #include <unistd.h>
@@ -276,6 +277,55 @@ test_socket_mgmt(void)
 }
 
 
+/* Only sockets with pending events should have their callbacks run */
+#define MANY_SOCKETS 64
+static void
+test_socket_many(void)
+{
+    int read_fds[MANY_SOCKETS], write_fds[MANY_SOCKETS];
+    struct sock_counters counters[MANY_SOCKETS];
+    int i;
+
+    for (i = 0; i < MANY_SOCKETS; i++) {
+        int fds[2];
+        if (pipe(fds) < 0) {
+            perror("pipe");
+            abort();
+        }
+        read_fds[i] = fds[0];
+        write_fds[i] = fds[1];
+        INDIGO_ASSERT(ind_soc_socket_register(
+            read_fds[i], socket_callback, &counters[i]) == 0);
+    }
+
+    /* Make two sockets ready, then unregister one of them */
+    INDIGO_ASSERT(write(write_fds[3], "x", 1) == 1);
+    INDIGO_ASSERT(write(write_fds[MANY_SOCKETS-1], "x", 1) == 1);
+    INDIGO_ASSERT(ind_soc_socket_unregister(read_fds[3]) == 0);
+
+    memset(counters, 0, sizeof(counters));
+    ind_soc_select_and_run(0);
+    for (i = 0; i < MANY_SOCKETS; i++) {
+        INDIGO_ASSERT(counters[i].read == (i == MANY_SOCKETS-1));
+        INDIGO_ASSERT(counters[i].write == 0);
+    }
+
+    /* Registering it again picks up the pending byte */
+    INDIGO_ASSERT(ind_soc_socket_register(
+        read_fds[3], socket_callback, &counters[3]) == 0);
+    memset(counters, 0, sizeof(counters));
+    ind_soc_select_and_run(0);
+    for (i = 0; i < MANY_SOCKETS; i++) {
+        INDIGO_ASSERT(counters[i].read == (i == 3));
+    }
+
+    for (i = 0; i < MANY_SOCKETS; i++) {
+        INDIGO_ASSERT(ind_soc_socket_unregister(read_fds[i]) == 0);
+        close(read_fds[i]);
+        close(write_fds[i]);
+    }
+}
+
 static void
 timer_callback(void *cookie)
 {
@@ -349,6 +399,88 @@ test_immediate_timer(void)
     INDIGO_ASSERT(ind_soc_timer_event_unregister(timer_callback, &count) < 0);
 }
 
+/* Many timers, some sharing a period, should each fire at their own rate */
+static void
+test_many_timers(void)
+{
+    int fast[10], slow[100];
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        fast[i] = 0;
+        INDIGO_ASSERT(ind_soc_timer_event_register(
+            timer_callback, &fast[i], 50) == 0);
+    }
+
+    for (i = 0; i < 100; i++) {
+        slow[i] = 0;
+        INDIGO_ASSERT(ind_soc_timer_event_register(
+            timer_callback, &slow[i], 200) == 0);
+    }
+
+    /* Reset one slow timer with the fast period */
+    INDIGO_ASSERT(ind_soc_timer_event_register(
+        timer_callback, &slow[50], 50) == 0);
+
+    ind_soc_select_and_run(1000);
+
+    for (i = 0; i < 10; i++) {
+        INDIGO_ASSERT(fast[i] >= 18 && fast[i] <= 21);
+        INDIGO_ASSERT(ind_soc_timer_event_unregister(timer_callback, &fast[i]) == 0);
+    }
+
+    for (i = 0; i < 100; i++) {
+        if (i == 50) {
+            INDIGO_ASSERT(slow[i] >= 18 && slow[i] <= 21);
+        } else {
+            INDIGO_ASSERT(slow[i] >= 4 && slow[i] <= 6);
+        }
+        INDIGO_ASSERT(ind_soc_timer_event_unregister(timer_callback, &slow[i]) == 0);
+    }
+}
+
+static indigo_time_t slow_timer_calls[2];
+static int slow_timer_count;
+
+/* Takes 200ms the first time it runs */
+static void
+timer_callback_slow(void *cookie)
+{
+    if (slow_timer_count == 0) {
+        usleep(200 * 1000);
+    }
+}
+
+static void
+timer_callback_after_slow(void *cookie)
+{
+    if (slow_timer_count < 2) {
+        slow_timer_calls[slow_timer_count] = INDIGO_CURRENT_TIME;
+    }
+    slow_timer_count++;
+}
+
+/* A slow callback should not make the timers due with it fire back to back */
+static void
+test_slow_timer(void)
+{
+    slow_timer_count = 0;
+    INDIGO_ASSERT(ind_soc_timer_event_register(
+        timer_callback_slow, NULL, 100) == 0);
+    INDIGO_ASSERT(ind_soc_timer_event_register(
+        timer_callback_after_slow, NULL, 100) == 0);
+
+    while (slow_timer_count < 2) {
+        ind_soc_select_and_run(500);
+    }
+
+    INDIGO_ASSERT(INDIGO_TIME_DIFF_ms(slow_timer_calls[0],
+                                      slow_timer_calls[1]) >= 90);
+    INDIGO_ASSERT(ind_soc_timer_event_unregister(timer_callback_slow, NULL) == 0);
+    INDIGO_ASSERT(ind_soc_timer_event_unregister(
+        timer_callback_after_slow, NULL) == 0);
+}
+
 static void
 test_timer_mgmt(void)
 {
@@ -376,13 +508,9 @@ test_timer_mgmt(void)
     {
         int i, j;
 
-        for (i = 0; 1; i++) {
-            indigo_error_t err = ind_soc_timer_event_register(
-                timer_callback, (void *)(uintptr_t)i, 100);
-            if (err < 0) {
-                INDIGO_ASSERT(err == INDIGO_ERROR_RESOURCE);
-                break;
-            }
+        for (i = 0; i < 1000; i++) {
+            INDIGO_ASSERT(ind_soc_timer_event_register_with_priority(
+                timer_callback, (void *)(uintptr_t)i, 100 + i % 7, i % 3) == 0);
         }
 
         for (j = 0; 1; j++) {
@@ -651,8 +779,11 @@ main(int argc, char* argv[])
     test_timer_mgmt();
     test_periodic_timer();
     test_immediate_timer();
+    test_many_timers();
+    test_slow_timer();
     test_socket();
     test_socket_mgmt();
+    test_socket_many();
     test_task();
     test_priority();
 
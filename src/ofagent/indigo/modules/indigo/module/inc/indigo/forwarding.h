@@ -80,6 +80,11 @@ extern indigo_error_t indigo_fwd_flow_create(
  * @fixme Consider adding parameters to indicate modification that
  * should be done:  modify_effects, modify_cookie or clear_counters.
  *
+ * flow_modify may be an of_flow_add with the flow's match and priority,
+ * overwriting the flow; its timeouts then replace the flow's too. An
+ * implementation that cannot do that in place returns an error, and the
+ * flow is deleted and created again instead.
+ *
  * Ownership of the flow_modify LOXI object is maintained by the
  * caller (OF state manager).
  */
@@ -107,6 +112,10 @@ extern indigo_error_t indigo_fwd_flow_delete(
  *
  * Get the stats structure from an existing flow. The flow_stats object MUST
  * contain the flow ID.
+ *
+ * Forwarding that collects counters for all flows at once may return
+ * INDIGO_ERROR_PENDING while it does; the caller asks again later, after
+ * letting other events run.
  */
 
 extern indigo_error_t indigo_fwd_flow_stats_get(
@@ -202,6 +211,50 @@ void indigo_fwd_group_delete(uint32_t id);
  */
 void indigo_fwd_group_stats_get(uint32_t id, of_group_stats_entry_t *entry);
 
+/**
+ * Warm restart
+ *
+ * After a restart the state manager may reload the flows and groups it
+ * saved before it stopped. Each is offered to forwarding with a reconcile
+ * call rather than a create, groups first. Forwarding keeps the object if
+ * it is still installed, updating it in place if it differs. A group it
+ * no longer has is added. For a flow it no longer has, or holds under
+ * another table or priority, it returns INDIGO_ERROR_NOT_FOUND and the
+ * state manager creates the flow; forwarding counts that flow as
+ * reconciled. Once everything has been offered, reconcile_finish removes
+ * whatever forwarding holds that was not reconciled, unless the saved
+ * state could not all be read.
+ */
+
+/**
+ * @brief Reconcile a restored flow
+ * @param flow_id Flow identifier the flow was created with
+ * @param flow_add The flow as saved
+ * @param [out] table_id Table the flow is in
+ */
+extern indigo_error_t indigo_fwd_flow_reconcile(
+    indigo_cookie_t flow_id,
+    of_flow_add_t *flow_add,
+    uint8_t *table_id);
+
+/**
+ * @brief Reconcile a restored group
+ * @param id Group ID
+ * @param group_type OpenFlow group type
+ * @param buckets LOCI bucket list
+ */
+extern indigo_error_t indigo_fwd_group_reconcile(
+    uint32_t id,
+    uint8_t group_type,
+    of_list_bucket_t *buckets);
+
+/**
+ * @brief End reconciliation
+ * @param purge Remove everything not reconciled since the restart; false
+ * when the restore stopped early and left objects unoffered
+ */
+extern void indigo_fwd_reconcile_finish(int purge);
+
 /****************************************************************
  * Function provided for port manager
  ****************************************************************/
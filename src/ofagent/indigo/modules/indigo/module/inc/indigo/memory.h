@@ -42,6 +42,7 @@
 #define INDIGO_MEM_COMPARE(a, b, bytes)     memcmp(a, b, bytes)
 #define INDIGO_MEM_ALLOC(bytes)             malloc(bytes)
 #define INDIGO_MEM_FREE(ptr)                free(ptr)
+#define INDIGO_MEM_REALLOC(ptr, bytes)      realloc(ptr, bytes)
 
 #endif /* INDIGO_MEM_STDLIB */
 
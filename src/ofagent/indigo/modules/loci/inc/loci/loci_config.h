@@ -112,6 +112,16 @@
 #define LOCI_CONFIG_INCLUDE_UCLI 0
 #endif
 
+/**
+ * LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH
+ *
+ * Maximum number of free wire buffers cached per pool size class. */
+
+
+#ifndef LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH
+#define LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH 32
+#endif
+
 
 
 /**
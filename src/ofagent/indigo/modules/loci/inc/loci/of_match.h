@@ -454,6 +454,8 @@ of_match_eq(of_match_t *match1, of_match_t *match2)
 }
 
 /**
+ * Field by field reference for of_match_more_specific, below
+ *
  * Is the entry match more specific than (or equal to) the query match?
  * @param entry Match expected to be more specific (subset of query)
  * @param query Match expected to be less specific (superset of entry)
@@ -471,7 +473,7 @@ of_match_eq(of_match_t *match1, of_match_t *match2)
  */
 
 static inline int
-of_match_more_specific(of_match_t *entry, of_match_t *query)
+of_match_more_specific_by_field(of_match_t *entry, of_match_t *query)
 {
     of_match_fields_t *q_m, *e_m;  /* Short hand for masks, fields */
     of_match_fields_t *q_f, *e_f;
@@ -884,6 +886,8 @@ of_match_more_specific(of_match_t *entry, of_match_t *query)
 
 
 /**
+ * Field by field reference for of_match_overlap, below
+ *
  * Do two entries overlap?
  * @param match1 One match struct
  * @param match2 Another match struct
@@ -892,7 +896,7 @@ of_match_more_specific(of_match_t *entry, of_match_t *query)
  */
 
 static inline int
-of_match_overlap(of_match_t *match1, of_match_t *match2)
+of_match_overlap_by_field(of_match_t *match1, of_match_t *match2)
 {
     of_match_fields_t *m1, *m2;  /* Short hand for masks, fields */
     of_match_fields_t *f1, *f2;
@@ -1171,4 +1175,146 @@ of_match_overlap(of_match_t *match1, of_match_t *match2)
     return 1; /* No field differentiates matches */
 }
 
+/****************************************************************
+ * Wide word match comparisons
+ *
+ * Every field test above is a bitwise test on the field's bytes, so the
+ * same tests can be run over the whole of_match_fields_t a vector at a
+ * time: AVX2 when the compiler targets it, then SSE2, then 64-bit words
+ * for the tail (or everything, on other targets).  This relies on the
+ * same assumption as of_match_eq: structs are memset to 0 on init, so
+ * padding bytes in masks are 0 and never differentiate.
+ ****************************************************************/
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define OF_MATCH_FIELDS_BYTES sizeof(of_match_fields_t)
+
+static inline uint64_t
+of_match_word_get(const uint8_t *base, int offset)
+{
+    uint64_t word;
+
+    MEMCPY(&word, base + offset, sizeof(word));
+
+    return word;
+}
+
+/**
+ * Is the entry match more specific than (or equal to) the query match?
+ * @param entry Match expected to be more specific (subset of query)
+ * @param query Match expected to be less specific (superset of entry)
+ * @returns Boolean; same result as of_match_more_specific_by_field
+ *
+ * A bit differentiates if the query masks it and either the entry does
+ * not, or the values differ.
+ */
+
+static inline int
+of_match_more_specific(of_match_t *entry, of_match_t *query)
+{
+    const uint8_t *e_m = (const uint8_t *)&entry->masks;
+    const uint8_t *q_m = (const uint8_t *)&query->masks;
+    const uint8_t *e_f = (const uint8_t *)&entry->fields;
+    const uint8_t *q_f = (const uint8_t *)&query->fields;
+    int offset = 0;
+
+#if defined(__AVX2__)
+    for (; offset + 32 <= (int)OF_MATCH_FIELDS_BYTES; offset += 32) {
+        __m256i em = _mm256_loadu_si256((const __m256i *)(e_m + offset));
+        __m256i qm = _mm256_loadu_si256((const __m256i *)(q_m + offset));
+        __m256i ef = _mm256_loadu_si256((const __m256i *)(e_f + offset));
+        __m256i qf = _mm256_loadu_si256((const __m256i *)(q_f + offset));
+        __m256i diff = _mm256_or_si256(_mm256_andnot_si256(em, qm),
+            _mm256_and_si256(_mm256_xor_si256(ef, qf), qm));
+        if (!_mm256_testz_si256(diff, diff)) {
+            return 0;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; offset + 16 <= (int)OF_MATCH_FIELDS_BYTES; offset += 16) {
+        __m128i em = _mm_loadu_si128((const __m128i *)(e_m + offset));
+        __m128i qm = _mm_loadu_si128((const __m128i *)(q_m + offset));
+        __m128i ef = _mm_loadu_si128((const __m128i *)(e_f + offset));
+        __m128i qf = _mm_loadu_si128((const __m128i *)(q_f + offset));
+        __m128i diff = _mm_or_si128(_mm_andnot_si128(em, qm),
+            _mm_and_si128(_mm_xor_si128(ef, qf), qm));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) !=
+                0xffff) {
+            return 0;
+        }
+    }
+#endif
+    for (; offset < (int)OF_MATCH_FIELDS_BYTES; offset += 8) {
+        uint64_t qm = of_match_word_get(q_m, offset);
+        if ((~of_match_word_get(e_m, offset) & qm) ||
+            ((of_match_word_get(e_f, offset) ^
+              of_match_word_get(q_f, offset)) & qm)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Do two entries overlap?
+ * @param match1 One match struct
+ * @param match2 Another match struct
+ * @returns Boolean; same result as of_match_overlap_by_field
+ *
+ * A bit differentiates if both matches mask it and the values differ.
+ */
+
+static inline int
+of_match_overlap(of_match_t *match1, of_match_t *match2)
+{
+    const uint8_t *m1 = (const uint8_t *)&match1->masks;
+    const uint8_t *m2 = (const uint8_t *)&match2->masks;
+    const uint8_t *f1 = (const uint8_t *)&match1->fields;
+    const uint8_t *f2 = (const uint8_t *)&match2->fields;
+    int offset = 0;
+
+#if defined(__AVX2__)
+    for (; offset + 32 <= (int)OF_MATCH_FIELDS_BYTES; offset += 32) {
+        __m256i diff = _mm256_and_si256(
+            _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)(m1 + offset)),
+                _mm256_loadu_si256((const __m256i *)(m2 + offset))),
+            _mm256_xor_si256(
+                _mm256_loadu_si256((const __m256i *)(f1 + offset)),
+                _mm256_loadu_si256((const __m256i *)(f2 + offset))));
+        if (!_mm256_testz_si256(diff, diff)) {
+            return 0;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; offset + 16 <= (int)OF_MATCH_FIELDS_BYTES; offset += 16) {
+        __m128i diff = _mm_and_si128(
+            _mm_and_si128(_mm_loadu_si128((const __m128i *)(m1 + offset)),
+                          _mm_loadu_si128((const __m128i *)(m2 + offset))),
+            _mm_xor_si128(_mm_loadu_si128((const __m128i *)(f1 + offset)),
+                          _mm_loadu_si128((const __m128i *)(f2 + offset))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) !=
+                0xffff) {
+            return 0;
+        }
+    }
+#endif
+    for (; offset < (int)OF_MATCH_FIELDS_BYTES; offset += 8) {
+        if (of_match_word_get(m1, offset) & of_match_word_get(m2, offset) &
+            (of_match_word_get(f1, offset) ^ of_match_word_get(f2, offset))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 #endif /* Match header file */
@@ -140,9 +140,21 @@ extern int of_object_buffer_bind(of_object_t *obj, uint8_t *buf,
  * NULL.  The ref_count of the wire buffer is not changed.
  */
 extern void of_object_wire_buffer_steal(of_object_t *obj, uint8_t **buffer);
+
+/**
+ * Steal a wire buffer from an object, keeping track of its pool class.
+ * @param obj The object whose buffer is being removed
+ * @param buffer[out] A handle for the pointer to the uint8_t * returned
+ * @param pool_class[out] Size class to pass to of_wire_buffer_data_free
+ */
+extern void of_object_wire_buffer_steal_pooled(of_object_t *obj,
+                                               uint8_t **buffer,
+                                               int *pool_class);
 extern int of_object_append_buffer(of_object_t *dst, of_object_t *src);
 
 extern of_object_t *of_object_new_from_message(of_message_t msg, int len);
+extern of_object_t *of_object_new_from_message_bind(of_message_t msg, int len,
+                                                    of_buffer_free_f buf_free);
 
 /* Delete an OpenFlow object without reference to its type */
 extern void of_object_delete(of_object_t *obj);
@@ -18,9 +18,9 @@
  *
  ****************************************************************/
 
-/* Maximum length of an OpenFlow message. All wire buffers allocated for
- * new objects (that don't come from a message) are this length to avoid
- * needing to grow the buffers. */
+/* Maximum length of an OpenFlow message. Wire buffers allocated for new
+ * objects start at the object's fixed length and are grown on demand up
+ * to this length. */
 #define OF_WIRE_BUFFER_MAX_LENGTH 65535
 
 /**
@@ -36,6 +36,8 @@ typedef struct of_wire_buffer_s {
     int current_bytes;
     /** If not NULL, use this to dealloc buf */
     of_buffer_free_f free;
+    /** Pool size class of buf, or -1 if buf did not come from the pool */
+    int pool_class;
 } of_wire_buffer_t;
 
 /**
@@ -125,37 +127,38 @@ typedef struct of_wire_object_s {
  */
 #define OF_WIRE_BUFFER_MIN_ALLOC_BYTES 128
 
+/**
+ * Number of wire buffer pool size classes.  Class n holds buffers of
+ * OF_WIRE_BUFFER_MIN_ALLOC_BYTES << n bytes; the largest class covers
+ * OF_WIRE_BUFFER_MAX_LENGTH.
+ */
+#define OF_WIRE_BUFFER_POOL_CLASSES 10
+
+/**
+ * Wire buffer pool counters
+ */
+typedef struct of_wire_buffer_pool_stats_s {
+    /** Allocations satisfied from a pool free list */
+    uint64_t hits;
+    /** Allocations that fell through to MALLOC */
+    uint64_t misses;
+    /** Buffers returned to a pool free list */
+    uint64_t recycled;
+    /** Buffers released with FREE because the pool was full */
+    uint64_t released;
+    /** Data buffers moved to a larger size class */
+    uint64_t grows;
+} of_wire_buffer_pool_stats_t;
+
 /**
  * Allocate a wire buffer object and the underlying data buffer.
  * The wire buffer is initally empty (current_bytes == 0).
  * @param a_bytes The number of bytes to allocate.
  * @returns A wire buffer object if successful or NULL
+ *
+ * The data buffer is taken from the size class pool and is zeroed.
  */
-static inline of_wire_buffer_t *
-of_wire_buffer_new(int a_bytes)
-{
-    of_wire_buffer_t *wbuf;
-
-    wbuf = (of_wire_buffer_t *)MALLOC(sizeof(of_wire_buffer_t));
-    if (wbuf == NULL) {
-        return NULL;
-    }
-    MEMSET(wbuf, 0, sizeof(of_wire_buffer_t));
-
-    if (a_bytes < OF_WIRE_BUFFER_MIN_ALLOC_BYTES) {
-        a_bytes = OF_WIRE_BUFFER_MIN_ALLOC_BYTES;
-    }
-
-    if ((wbuf->buf = (uint8_t *)MALLOC(a_bytes)) == NULL) {
-        FREE(wbuf);
-        return NULL;
-    }
-    MEMSET(wbuf->buf, 0, a_bytes);
-    wbuf->current_bytes = 0;
-    wbuf->alloc_bytes = a_bytes;
-
-    return (of_wire_buffer_t *)wbuf;
-}
+extern of_wire_buffer_t *of_wire_buffer_new(int a_bytes);
 
 /**
  * Allocate a wire buffer object and bind it to an existing buffer.
@@ -164,40 +167,49 @@ of_wire_buffer_new(int a_bytes)
  * @param buf_free  Function called to deallocate buf.
  * @returns A wire buffer object if successful or NULL
  */
-static inline of_wire_buffer_t *
-of_wire_buffer_new_bind(uint8_t *buf, int bytes, of_buffer_free_f buf_free)
-{
-    of_wire_buffer_t *wbuf;
+extern of_wire_buffer_t *of_wire_buffer_new_bind(uint8_t *buf, int bytes,
+                                                 of_buffer_free_f buf_free);
 
-    wbuf = (of_wire_buffer_t *)MALLOC(sizeof(of_wire_buffer_t));
-    if (wbuf == NULL) {
-        return NULL;
-    }
+/**
+ * Free a wire buffer object and its data buffer.  Pooled data buffers
+ * are returned to the pool.
+ */
+extern void of_wire_buffer_free(of_wire_buffer_t *wbuf);
 
-    wbuf->buf = buf;
-    wbuf->free = buf_free;
-    wbuf->current_bytes = bytes;
-    wbuf->alloc_bytes = bytes;
+/**
+ * Make sure the wire buffer has room for at least bytes bytes.
+ * @param wbuf Pointer to the wire buffer structure
+ * @param bytes Total number of bytes the buffer must be able to hold
+ * @returns OF_ERROR_NONE or OF_ERROR_RESOURCE
+ *
+ * If the buffer is too small its contents are moved to a larger pooled
+ * buffer; any pointers previously taken into the data are invalidated.
+ */
+extern int of_wire_buffer_reserve(of_wire_buffer_t *wbuf, int bytes);
 
-    return (of_wire_buffer_t *)wbuf;
-}
+/**
+ * Copy out the wire buffer pool counters.
+ */
+extern void of_wire_buffer_pool_stats_get(of_wire_buffer_pool_stats_t *stats);
 
-static inline void
-of_wire_buffer_free(of_wire_buffer_t *wbuf)
-{
-    if (wbuf == NULL) return;
-
-    if (wbuf->buf != NULL) {
-        if (wbuf->free != NULL) {
-            wbuf->free(wbuf->buf);
-        } else {
-            FREE(wbuf->buf);
-        }
-    }
+/**
+ * Release all buffers cached in the wire buffer pool.
+ */
+extern void of_wire_buffer_pool_purge(void);
 
-    FREE(wbuf);
-}
+/**
+ * Release a data buffer taken with of_wire_buffer_steal_pooled.
+ * @param buf The data buffer
+ * @param pool_class The size class reported when the buffer was taken
+ *
+ * Buffers with a pool class of -1 are released with FREE.
+ */
+extern void of_wire_buffer_data_free(uint8_t *buf, int pool_class);
 
+/**
+ * Take ownership of the data buffer and free the wire buffer object.
+ * The caller releases the data with FREE; it does not return to the pool.
+ */
 static inline void
 of_wire_buffer_steal(of_wire_buffer_t *wbuf, uint8_t **buffer)
 {
@@ -207,9 +219,24 @@ of_wire_buffer_steal(of_wire_buffer_t *wbuf, uint8_t **buffer)
     of_wire_buffer_free(wbuf);
 }
 
+/**
+ * Take ownership of the data buffer and free the wire buffer object.
+ * The caller releases the data with of_wire_buffer_data_free, passing
+ * back *pool_class, so pooled buffers are recycled.  Buffers that did
+ * not come from the pool report a class of -1.
+ */
+static inline void
+of_wire_buffer_steal_pooled(of_wire_buffer_t *wbuf, uint8_t **buffer,
+                            int *pool_class)
+{
+    *pool_class = wbuf->free == NULL ? wbuf->pool_class : -1;
+    of_wire_buffer_steal(wbuf, buffer);
+}
+
 /**
  * Increase the currently used length of the wire buffer.
- * Will fail an assertion if the allocated length is not long enough.
+ * Reallocates the data buffer if the allocated length is not long enough;
+ * fails an assertion if that allocation fails.
  *
  * @param wbuf Pointer to the wire buffer structure
  * @param bytes Total number of bytes buffer should grow to
@@ -219,7 +246,11 @@ static inline void
 of_wire_buffer_grow(of_wire_buffer_t *wbuf, int bytes)
 {
     ASSERT(wbuf != NULL);
-    ASSERT(wbuf->alloc_bytes >= bytes);
+    if (bytes > wbuf->alloc_bytes &&
+            of_wire_buffer_reserve(wbuf, bytes) < 0) {
+        ASSERT(0);
+        return;
+    }
     if (bytes > wbuf->current_bytes) {
         wbuf->current_bytes = bytes;
     }
@@ -85669,8 +85669,8 @@ of_aggregate_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_AGGREGATE_STATS_REPLY] + of_object_extra_len[version][OF_AGGREGATE_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_aggregate_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_aggregate_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -85859,8 +85859,8 @@ of_aggregate_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_AGGREGATE_STATS_REQUEST] + of_object_extra_len[version][OF_AGGREGATE_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_aggregate_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_aggregate_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -86055,8 +86055,8 @@ of_async_get_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ASYNC_GET_REPLY] + of_object_extra_len[version][OF_ASYNC_GET_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_async_get_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_async_get_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -86245,8 +86245,8 @@ of_async_get_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ASYNC_GET_REQUEST] + of_object_extra_len[version][OF_ASYNC_GET_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_async_get_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_async_get_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -86435,8 +86435,8 @@ of_async_set_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ASYNC_SET] + of_object_extra_len[version][OF_ASYNC_SET];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_async_set_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_async_set_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -86625,8 +86625,8 @@ of_bad_action_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BAD_ACTION_ERROR_MSG] + of_object_extra_len[version][OF_BAD_ACTION_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bad_action_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bad_action_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -86815,8 +86815,8 @@ of_bad_instruction_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BAD_INSTRUCTION_ERROR_MSG] + of_object_extra_len[version][OF_BAD_INSTRUCTION_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bad_instruction_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bad_instruction_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -87005,8 +87005,8 @@ of_bad_match_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BAD_MATCH_ERROR_MSG] + of_object_extra_len[version][OF_BAD_MATCH_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bad_match_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bad_match_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -87195,8 +87195,8 @@ of_bad_request_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BAD_REQUEST_ERROR_MSG] + of_object_extra_len[version][OF_BAD_REQUEST_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bad_request_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bad_request_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -87385,8 +87385,8 @@ of_barrier_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BARRIER_REPLY] + of_object_extra_len[version][OF_BARRIER_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_barrier_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_barrier_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -87575,8 +87575,8 @@ of_barrier_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BARRIER_REQUEST] + of_object_extra_len[version][OF_BARRIER_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_barrier_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_barrier_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -87793,8 +87793,8 @@ of_bsn_bw_clear_data_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_BW_CLEAR_DATA_REPLY] + of_object_extra_len[version][OF_BSN_BW_CLEAR_DATA_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_bw_clear_data_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_bw_clear_data_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -88011,8 +88011,8 @@ of_bsn_bw_clear_data_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_BW_CLEAR_DATA_REQUEST] + of_object_extra_len[version][OF_BSN_BW_CLEAR_DATA_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_bw_clear_data_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_bw_clear_data_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -88229,8 +88229,8 @@ of_bsn_bw_enable_get_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_BW_ENABLE_GET_REPLY] + of_object_extra_len[version][OF_BSN_BW_ENABLE_GET_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_bw_enable_get_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_bw_enable_get_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -88447,8 +88447,8 @@ of_bsn_bw_enable_get_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_BW_ENABLE_GET_REQUEST] + of_object_extra_len[version][OF_BSN_BW_ENABLE_GET_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_bw_enable_get_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_bw_enable_get_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -88665,8 +88665,8 @@ of_bsn_bw_enable_set_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_BW_ENABLE_SET_REPLY] + of_object_extra_len[version][OF_BSN_BW_ENABLE_SET_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_bw_enable_set_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_bw_enable_set_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -88883,8 +88883,8 @@ of_bsn_bw_enable_set_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_BW_ENABLE_SET_REQUEST] + of_object_extra_len[version][OF_BSN_BW_ENABLE_SET_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_bw_enable_set_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_bw_enable_set_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -89080,8 +89080,8 @@ of_bsn_flow_idle_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_FLOW_IDLE] + of_object_extra_len[version][OF_BSN_FLOW_IDLE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_flow_idle_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_flow_idle_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -89277,8 +89277,8 @@ of_bsn_flow_idle_enable_get_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_FLOW_IDLE_ENABLE_GET_REPLY] + of_object_extra_len[version][OF_BSN_FLOW_IDLE_ENABLE_GET_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_flow_idle_enable_get_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_flow_idle_enable_get_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -89474,8 +89474,8 @@ of_bsn_flow_idle_enable_get_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_FLOW_IDLE_ENABLE_GET_REQUEST] + of_object_extra_len[version][OF_BSN_FLOW_IDLE_ENABLE_GET_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_flow_idle_enable_get_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_flow_idle_enable_get_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -89671,8 +89671,8 @@ of_bsn_flow_idle_enable_set_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_FLOW_IDLE_ENABLE_SET_REPLY] + of_object_extra_len[version][OF_BSN_FLOW_IDLE_ENABLE_SET_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_flow_idle_enable_set_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_flow_idle_enable_set_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -89868,8 +89868,8 @@ of_bsn_flow_idle_enable_set_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_FLOW_IDLE_ENABLE_SET_REQUEST] + of_object_extra_len[version][OF_BSN_FLOW_IDLE_ENABLE_SET_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_flow_idle_enable_set_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_flow_idle_enable_set_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -90086,8 +90086,8 @@ of_bsn_get_interfaces_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_INTERFACES_REPLY] + of_object_extra_len[version][OF_BSN_GET_INTERFACES_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_interfaces_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_interfaces_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -90304,8 +90304,8 @@ of_bsn_get_interfaces_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_INTERFACES_REQUEST] + of_object_extra_len[version][OF_BSN_GET_INTERFACES_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_interfaces_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_interfaces_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -90501,8 +90501,8 @@ of_bsn_get_ip_mask_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_IP_MASK_REPLY] + of_object_extra_len[version][OF_BSN_GET_IP_MASK_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_ip_mask_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_ip_mask_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -90698,8 +90698,8 @@ of_bsn_get_ip_mask_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_IP_MASK_REQUEST] + of_object_extra_len[version][OF_BSN_GET_IP_MASK_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_ip_mask_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_ip_mask_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -90895,8 +90895,8 @@ of_bsn_get_l2_table_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_L2_TABLE_REPLY] + of_object_extra_len[version][OF_BSN_GET_L2_TABLE_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_l2_table_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_l2_table_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -91092,8 +91092,8 @@ of_bsn_get_l2_table_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_L2_TABLE_REQUEST] + of_object_extra_len[version][OF_BSN_GET_L2_TABLE_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_l2_table_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_l2_table_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -91310,8 +91310,8 @@ of_bsn_get_mirroring_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_MIRRORING_REPLY] + of_object_extra_len[version][OF_BSN_GET_MIRRORING_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_mirroring_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_mirroring_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -91528,8 +91528,8 @@ of_bsn_get_mirroring_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_GET_MIRRORING_REQUEST] + of_object_extra_len[version][OF_BSN_GET_MIRRORING_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_get_mirroring_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_get_mirroring_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -91698,8 +91698,8 @@ of_bsn_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_HEADER] + of_object_extra_len[version][OF_BSN_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -91890,8 +91890,8 @@ of_bsn_hybrid_get_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_HYBRID_GET_REPLY] + of_object_extra_len[version][OF_BSN_HYBRID_GET_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_hybrid_get_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_hybrid_get_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -92087,8 +92087,8 @@ of_bsn_hybrid_get_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_HYBRID_GET_REQUEST] + of_object_extra_len[version][OF_BSN_HYBRID_GET_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_hybrid_get_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_hybrid_get_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -92305,8 +92305,8 @@ of_bsn_pdu_rx_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_PDU_RX_REPLY] + of_object_extra_len[version][OF_BSN_PDU_RX_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_pdu_rx_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_pdu_rx_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -92523,8 +92523,8 @@ of_bsn_pdu_rx_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_PDU_RX_REQUEST] + of_object_extra_len[version][OF_BSN_PDU_RX_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_pdu_rx_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_pdu_rx_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -92741,8 +92741,8 @@ of_bsn_pdu_rx_timeout_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_PDU_RX_TIMEOUT] + of_object_extra_len[version][OF_BSN_PDU_RX_TIMEOUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_pdu_rx_timeout_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_pdu_rx_timeout_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -92959,8 +92959,8 @@ of_bsn_pdu_tx_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_PDU_TX_REPLY] + of_object_extra_len[version][OF_BSN_PDU_TX_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_pdu_tx_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_pdu_tx_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -93177,8 +93177,8 @@ of_bsn_pdu_tx_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_PDU_TX_REQUEST] + of_object_extra_len[version][OF_BSN_PDU_TX_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_pdu_tx_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_pdu_tx_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -93374,8 +93374,8 @@ of_bsn_set_ip_mask_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SET_IP_MASK] + of_object_extra_len[version][OF_BSN_SET_IP_MASK];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_set_ip_mask_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_set_ip_mask_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -93571,8 +93571,8 @@ of_bsn_set_l2_table_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SET_L2_TABLE_REPLY] + of_object_extra_len[version][OF_BSN_SET_L2_TABLE_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_set_l2_table_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_set_l2_table_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -93768,8 +93768,8 @@ of_bsn_set_l2_table_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SET_L2_TABLE_REQUEST] + of_object_extra_len[version][OF_BSN_SET_L2_TABLE_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_set_l2_table_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_set_l2_table_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -93986,8 +93986,8 @@ of_bsn_set_mirroring_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SET_MIRRORING] + of_object_extra_len[version][OF_BSN_SET_MIRRORING];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_set_mirroring_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_set_mirroring_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -94204,8 +94204,8 @@ of_bsn_set_pktin_suppression_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SET_PKTIN_SUPPRESSION_REPLY] + of_object_extra_len[version][OF_BSN_SET_PKTIN_SUPPRESSION_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_set_pktin_suppression_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_set_pktin_suppression_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -94422,8 +94422,8 @@ of_bsn_set_pktin_suppression_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SET_PKTIN_SUPPRESSION_REQUEST] + of_object_extra_len[version][OF_BSN_SET_PKTIN_SUPPRESSION_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_set_pktin_suppression_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_set_pktin_suppression_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -94619,8 +94619,8 @@ of_bsn_shell_command_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SHELL_COMMAND] + of_object_extra_len[version][OF_BSN_SHELL_COMMAND];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_shell_command_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_shell_command_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -94816,8 +94816,8 @@ of_bsn_shell_output_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SHELL_OUTPUT] + of_object_extra_len[version][OF_BSN_SHELL_OUTPUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_shell_output_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_shell_output_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -95013,8 +95013,8 @@ of_bsn_shell_status_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_SHELL_STATUS] + of_object_extra_len[version][OF_BSN_SHELL_STATUS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_shell_status_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_shell_status_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -95231,8 +95231,8 @@ of_bsn_virtual_port_create_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VIRTUAL_PORT_CREATE_REPLY] + of_object_extra_len[version][OF_BSN_VIRTUAL_PORT_CREATE_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_virtual_port_create_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_virtual_port_create_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -95449,8 +95449,8 @@ of_bsn_virtual_port_create_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VIRTUAL_PORT_CREATE_REQUEST] + of_object_extra_len[version][OF_BSN_VIRTUAL_PORT_CREATE_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_virtual_port_create_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_virtual_port_create_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -95667,8 +95667,8 @@ of_bsn_virtual_port_remove_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VIRTUAL_PORT_REMOVE_REPLY] + of_object_extra_len[version][OF_BSN_VIRTUAL_PORT_REMOVE_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_virtual_port_remove_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_virtual_port_remove_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -95885,8 +95885,8 @@ of_bsn_virtual_port_remove_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VIRTUAL_PORT_REMOVE_REQUEST] + of_object_extra_len[version][OF_BSN_VIRTUAL_PORT_REMOVE_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_virtual_port_remove_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_virtual_port_remove_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -96075,8 +96075,8 @@ of_desc_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_DESC_STATS_REPLY] + of_object_extra_len[version][OF_DESC_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_desc_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_desc_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -96265,8 +96265,8 @@ of_desc_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_DESC_STATS_REQUEST] + of_object_extra_len[version][OF_DESC_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_desc_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_desc_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -96455,8 +96455,8 @@ of_echo_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ECHO_REPLY] + of_object_extra_len[version][OF_ECHO_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_echo_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_echo_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -96645,8 +96645,8 @@ of_echo_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ECHO_REQUEST] + of_object_extra_len[version][OF_ECHO_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_echo_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_echo_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -96815,8 +96815,8 @@ of_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ERROR_MSG] + of_object_extra_len[version][OF_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -97000,8 +97000,8 @@ of_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_EXPERIMENTER] + of_object_extra_len[version][OF_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -97190,8 +97190,8 @@ of_experimenter_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_EXPERIMENTER_ERROR_MSG] + of_object_extra_len[version][OF_EXPERIMENTER_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_experimenter_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_experimenter_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -97380,8 +97380,8 @@ of_experimenter_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_EXPERIMENTER_STATS_REPLY] + of_object_extra_len[version][OF_EXPERIMENTER_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_experimenter_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_experimenter_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -97570,8 +97570,8 @@ of_experimenter_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_EXPERIMENTER_STATS_REQUEST] + of_object_extra_len[version][OF_EXPERIMENTER_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_experimenter_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_experimenter_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -97760,8 +97760,8 @@ of_features_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FEATURES_REPLY] + of_object_extra_len[version][OF_FEATURES_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_features_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_features_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -97950,8 +97950,8 @@ of_features_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FEATURES_REQUEST] + of_object_extra_len[version][OF_FEATURES_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_features_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_features_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -98140,8 +98140,8 @@ of_flow_add_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_ADD] + of_object_extra_len[version][OF_FLOW_ADD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_add_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_add_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -98336,8 +98336,8 @@ of_flow_delete_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_DELETE] + of_object_extra_len[version][OF_FLOW_DELETE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_delete_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_delete_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -98532,8 +98532,8 @@ of_flow_delete_strict_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_DELETE_STRICT] + of_object_extra_len[version][OF_FLOW_DELETE_STRICT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_delete_strict_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_delete_strict_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -98708,8 +98708,8 @@ of_flow_mod_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_MOD] + of_object_extra_len[version][OF_FLOW_MOD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_mod_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_mod_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -98899,8 +98899,8 @@ of_flow_mod_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_MOD_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_FLOW_MOD_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_mod_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_mod_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -99089,8 +99089,8 @@ of_flow_modify_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_MODIFY] + of_object_extra_len[version][OF_FLOW_MODIFY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_modify_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_modify_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -99285,8 +99285,8 @@ of_flow_modify_strict_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_MODIFY_STRICT] + of_object_extra_len[version][OF_FLOW_MODIFY_STRICT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_modify_strict_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_modify_strict_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -99481,8 +99481,8 @@ of_flow_removed_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_REMOVED] + of_object_extra_len[version][OF_FLOW_REMOVED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_removed_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_removed_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -99677,8 +99677,8 @@ of_flow_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_STATS_REPLY] + of_object_extra_len[version][OF_FLOW_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -99867,8 +99867,8 @@ of_flow_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_STATS_REQUEST] + of_object_extra_len[version][OF_FLOW_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -100063,8 +100063,8 @@ of_get_config_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GET_CONFIG_REPLY] + of_object_extra_len[version][OF_GET_CONFIG_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_get_config_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_get_config_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -100253,8 +100253,8 @@ of_get_config_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GET_CONFIG_REQUEST] + of_object_extra_len[version][OF_GET_CONFIG_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_get_config_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_get_config_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -100443,8 +100443,8 @@ of_group_desc_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_DESC_STATS_REPLY] + of_object_extra_len[version][OF_GROUP_DESC_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_desc_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_desc_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -100633,8 +100633,8 @@ of_group_desc_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_DESC_STATS_REQUEST] + of_object_extra_len[version][OF_GROUP_DESC_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_desc_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_desc_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -100823,8 +100823,8 @@ of_group_features_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_FEATURES_STATS_REPLY] + of_object_extra_len[version][OF_GROUP_FEATURES_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_features_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_features_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -101013,8 +101013,8 @@ of_group_features_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_FEATURES_STATS_REQUEST] + of_object_extra_len[version][OF_GROUP_FEATURES_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_features_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_features_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -101203,8 +101203,8 @@ of_group_mod_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_MOD] + of_object_extra_len[version][OF_GROUP_MOD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_mod_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_mod_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -101393,8 +101393,8 @@ of_group_mod_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_MOD_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_GROUP_MOD_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_mod_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_mod_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -101583,8 +101583,8 @@ of_group_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_STATS_REPLY] + of_object_extra_len[version][OF_GROUP_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -101773,8 +101773,8 @@ of_group_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_STATS_REQUEST] + of_object_extra_len[version][OF_GROUP_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -101963,8 +101963,8 @@ of_hello_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_HELLO] + of_object_extra_len[version][OF_HELLO];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_hello_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_hello_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -102153,8 +102153,8 @@ of_hello_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_HELLO_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_HELLO_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_hello_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_hello_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -102343,8 +102343,8 @@ of_meter_config_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_CONFIG_STATS_REPLY] + of_object_extra_len[version][OF_METER_CONFIG_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_config_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_config_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -102533,8 +102533,8 @@ of_meter_config_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_CONFIG_STATS_REQUEST] + of_object_extra_len[version][OF_METER_CONFIG_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_config_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_config_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -102723,8 +102723,8 @@ of_meter_features_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_FEATURES_STATS_REPLY] + of_object_extra_len[version][OF_METER_FEATURES_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_features_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_features_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -102913,8 +102913,8 @@ of_meter_features_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_FEATURES_STATS_REQUEST] + of_object_extra_len[version][OF_METER_FEATURES_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_features_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_features_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -103103,8 +103103,8 @@ of_meter_mod_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_MOD] + of_object_extra_len[version][OF_METER_MOD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_mod_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_mod_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -103293,8 +103293,8 @@ of_meter_mod_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_MOD_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_METER_MOD_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_mod_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_mod_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -103483,8 +103483,8 @@ of_meter_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_STATS_REPLY] + of_object_extra_len[version][OF_METER_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -103673,8 +103673,8 @@ of_meter_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_STATS_REQUEST] + of_object_extra_len[version][OF_METER_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -103870,8 +103870,8 @@ of_nicira_controller_role_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_NICIRA_CONTROLLER_ROLE_REPLY] + of_object_extra_len[version][OF_NICIRA_CONTROLLER_ROLE_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_nicira_controller_role_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_nicira_controller_role_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -104067,8 +104067,8 @@ of_nicira_controller_role_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_NICIRA_CONTROLLER_ROLE_REQUEST] + of_object_extra_len[version][OF_NICIRA_CONTROLLER_ROLE_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_nicira_controller_role_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_nicira_controller_role_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -104237,8 +104237,8 @@ of_nicira_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_NICIRA_HEADER] + of_object_extra_len[version][OF_NICIRA_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_nicira_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_nicira_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -104422,8 +104422,8 @@ of_packet_in_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PACKET_IN] + of_object_extra_len[version][OF_PACKET_IN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_packet_in_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_packet_in_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -104618,8 +104618,8 @@ of_packet_out_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PACKET_OUT] + of_object_extra_len[version][OF_PACKET_OUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_packet_out_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_packet_out_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -104808,8 +104808,8 @@ of_port_desc_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_DESC_STATS_REPLY] + of_object_extra_len[version][OF_PORT_DESC_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_desc_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_desc_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -104998,8 +104998,8 @@ of_port_desc_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_DESC_STATS_REQUEST] + of_object_extra_len[version][OF_PORT_DESC_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_desc_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_desc_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -105188,8 +105188,8 @@ of_port_mod_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_MOD] + of_object_extra_len[version][OF_PORT_MOD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_mod_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_mod_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -105378,8 +105378,8 @@ of_port_mod_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_MOD_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_PORT_MOD_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_mod_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_mod_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -105568,8 +105568,8 @@ of_port_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_STATS_REPLY] + of_object_extra_len[version][OF_PORT_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -105758,8 +105758,8 @@ of_port_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_STATS_REQUEST] + of_object_extra_len[version][OF_PORT_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -105948,8 +105948,8 @@ of_port_status_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_STATUS] + of_object_extra_len[version][OF_PORT_STATUS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_status_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_status_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -106138,8 +106138,8 @@ of_queue_get_config_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_GET_CONFIG_REPLY] + of_object_extra_len[version][OF_QUEUE_GET_CONFIG_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_get_config_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_get_config_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -106328,8 +106328,8 @@ of_queue_get_config_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_GET_CONFIG_REQUEST] + of_object_extra_len[version][OF_QUEUE_GET_CONFIG_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_get_config_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_get_config_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -106518,8 +106518,8 @@ of_queue_op_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_OP_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_QUEUE_OP_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_op_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_op_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -106708,8 +106708,8 @@ of_queue_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_STATS_REPLY] + of_object_extra_len[version][OF_QUEUE_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -106898,8 +106898,8 @@ of_queue_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_STATS_REQUEST] + of_object_extra_len[version][OF_QUEUE_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -107088,8 +107088,8 @@ of_role_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ROLE_REPLY] + of_object_extra_len[version][OF_ROLE_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_role_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_role_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -107278,8 +107278,8 @@ of_role_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ROLE_REQUEST] + of_object_extra_len[version][OF_ROLE_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_role_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_role_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -107468,8 +107468,8 @@ of_role_request_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ROLE_REQUEST_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_ROLE_REQUEST_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_role_request_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_role_request_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -107658,8 +107658,8 @@ of_set_config_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_SET_CONFIG] + of_object_extra_len[version][OF_SET_CONFIG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_set_config_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_set_config_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -107828,8 +107828,8 @@ of_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_STATS_REPLY] + of_object_extra_len[version][OF_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -107993,8 +107993,8 @@ of_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_STATS_REQUEST] + of_object_extra_len[version][OF_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -108178,8 +108178,8 @@ of_switch_config_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_SWITCH_CONFIG_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_SWITCH_CONFIG_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_switch_config_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_switch_config_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -108368,8 +108368,8 @@ of_table_features_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURES_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_TABLE_FEATURES_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_features_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_features_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -108558,8 +108558,8 @@ of_table_features_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURES_STATS_REPLY] + of_object_extra_len[version][OF_TABLE_FEATURES_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_features_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_features_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -108748,8 +108748,8 @@ of_table_features_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURES_STATS_REQUEST] + of_object_extra_len[version][OF_TABLE_FEATURES_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_features_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_features_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -108938,8 +108938,8 @@ of_table_mod_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_MOD] + of_object_extra_len[version][OF_TABLE_MOD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_mod_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_mod_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -109128,8 +109128,8 @@ of_table_mod_failed_error_msg_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_MOD_FAILED_ERROR_MSG] + of_object_extra_len[version][OF_TABLE_MOD_FAILED_ERROR_MSG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_mod_failed_error_msg_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_mod_failed_error_msg_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -109318,8 +109318,8 @@ of_table_stats_reply_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_STATS_REPLY] + of_object_extra_len[version][OF_TABLE_STATS_REPLY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_stats_reply_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_stats_reply_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -109508,8 +109508,8 @@ of_table_stats_request_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_STATS_REQUEST] + of_object_extra_len[version][OF_TABLE_STATS_REQUEST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_stats_request_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_stats_request_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -109678,8 +109678,8 @@ of_action_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION] + of_object_extra_len[version][OF_ACTION];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -109788,8 +109788,8 @@ of_action_bsn_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_BSN] + of_object_extra_len[version][OF_ACTION_BSN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_bsn_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_bsn_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -109915,8 +109915,8 @@ of_action_bsn_mirror_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_BSN_MIRROR] + of_object_extra_len[version][OF_ACTION_BSN_MIRROR];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_bsn_mirror_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_bsn_mirror_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110047,8 +110047,8 @@ of_action_bsn_set_tunnel_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_BSN_SET_TUNNEL_DST] + of_object_extra_len[version][OF_ACTION_BSN_SET_TUNNEL_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_bsn_set_tunnel_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_bsn_set_tunnel_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110176,8 +110176,8 @@ of_action_copy_ttl_in_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_COPY_TTL_IN] + of_object_extra_len[version][OF_ACTION_COPY_TTL_IN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_copy_ttl_in_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_copy_ttl_in_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110305,8 +110305,8 @@ of_action_copy_ttl_out_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_COPY_TTL_OUT] + of_object_extra_len[version][OF_ACTION_COPY_TTL_OUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_copy_ttl_out_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_copy_ttl_out_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110434,8 +110434,8 @@ of_action_dec_mpls_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_DEC_MPLS_TTL] + of_object_extra_len[version][OF_ACTION_DEC_MPLS_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_dec_mpls_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_dec_mpls_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110563,8 +110563,8 @@ of_action_dec_nw_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_DEC_NW_TTL] + of_object_extra_len[version][OF_ACTION_DEC_NW_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_dec_nw_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_dec_nw_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110692,8 +110692,8 @@ of_action_enqueue_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ENQUEUE] + of_object_extra_len[version][OF_ACTION_ENQUEUE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_enqueue_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_enqueue_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110821,8 +110821,8 @@ of_action_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_EXPERIMENTER] + of_object_extra_len[version][OF_ACTION_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -110950,8 +110950,8 @@ of_action_group_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_GROUP] + of_object_extra_len[version][OF_ACTION_GROUP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_group_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_group_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111064,8 +111064,8 @@ of_action_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_HEADER] + of_object_extra_len[version][OF_ACTION_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111173,8 +111173,8 @@ of_action_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID] + of_object_extra_len[version][OF_ACTION_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111283,8 +111283,8 @@ of_action_id_bsn_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_BSN] + of_object_extra_len[version][OF_ACTION_ID_BSN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_bsn_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_bsn_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111410,8 +111410,8 @@ of_action_id_bsn_mirror_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_BSN_MIRROR] + of_object_extra_len[version][OF_ACTION_ID_BSN_MIRROR];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_bsn_mirror_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_bsn_mirror_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111542,8 +111542,8 @@ of_action_id_bsn_set_tunnel_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_BSN_SET_TUNNEL_DST] + of_object_extra_len[version][OF_ACTION_ID_BSN_SET_TUNNEL_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_bsn_set_tunnel_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_bsn_set_tunnel_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111671,8 +111671,8 @@ of_action_id_copy_ttl_in_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_COPY_TTL_IN] + of_object_extra_len[version][OF_ACTION_ID_COPY_TTL_IN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_copy_ttl_in_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_copy_ttl_in_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111800,8 +111800,8 @@ of_action_id_copy_ttl_out_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_COPY_TTL_OUT] + of_object_extra_len[version][OF_ACTION_ID_COPY_TTL_OUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_copy_ttl_out_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_copy_ttl_out_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -111929,8 +111929,8 @@ of_action_id_dec_mpls_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_DEC_MPLS_TTL] + of_object_extra_len[version][OF_ACTION_ID_DEC_MPLS_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_dec_mpls_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_dec_mpls_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112058,8 +112058,8 @@ of_action_id_dec_nw_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_DEC_NW_TTL] + of_object_extra_len[version][OF_ACTION_ID_DEC_NW_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_dec_nw_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_dec_nw_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112187,8 +112187,8 @@ of_action_id_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_EXPERIMENTER] + of_object_extra_len[version][OF_ACTION_ID_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112316,8 +112316,8 @@ of_action_id_group_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_GROUP] + of_object_extra_len[version][OF_ACTION_ID_GROUP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_group_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_group_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112430,8 +112430,8 @@ of_action_id_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_HEADER] + of_object_extra_len[version][OF_ACTION_ID_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112539,8 +112539,8 @@ of_action_id_nicira_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_NICIRA] + of_object_extra_len[version][OF_ACTION_ID_NICIRA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_nicira_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_nicira_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112666,8 +112666,8 @@ of_action_id_nicira_dec_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_NICIRA_DEC_TTL] + of_object_extra_len[version][OF_ACTION_ID_NICIRA_DEC_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_nicira_dec_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_nicira_dec_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112795,8 +112795,8 @@ of_action_id_output_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_OUTPUT] + of_object_extra_len[version][OF_ACTION_ID_OUTPUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_output_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_output_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -112924,8 +112924,8 @@ of_action_id_pop_mpls_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_POP_MPLS] + of_object_extra_len[version][OF_ACTION_ID_POP_MPLS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_pop_mpls_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_pop_mpls_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113053,8 +113053,8 @@ of_action_id_pop_pbb_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_POP_PBB] + of_object_extra_len[version][OF_ACTION_ID_POP_PBB];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_pop_pbb_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_pop_pbb_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113182,8 +113182,8 @@ of_action_id_pop_vlan_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_POP_VLAN] + of_object_extra_len[version][OF_ACTION_ID_POP_VLAN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_pop_vlan_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_pop_vlan_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113311,8 +113311,8 @@ of_action_id_push_mpls_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_PUSH_MPLS] + of_object_extra_len[version][OF_ACTION_ID_PUSH_MPLS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_push_mpls_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_push_mpls_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113440,8 +113440,8 @@ of_action_id_push_pbb_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_PUSH_PBB] + of_object_extra_len[version][OF_ACTION_ID_PUSH_PBB];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_push_pbb_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_push_pbb_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113569,8 +113569,8 @@ of_action_id_push_vlan_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_PUSH_VLAN] + of_object_extra_len[version][OF_ACTION_ID_PUSH_VLAN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_push_vlan_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_push_vlan_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113698,8 +113698,8 @@ of_action_id_set_field_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_SET_FIELD] + of_object_extra_len[version][OF_ACTION_ID_SET_FIELD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_set_field_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_set_field_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113827,8 +113827,8 @@ of_action_id_set_mpls_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_SET_MPLS_TTL] + of_object_extra_len[version][OF_ACTION_ID_SET_MPLS_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_set_mpls_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_set_mpls_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -113956,8 +113956,8 @@ of_action_id_set_nw_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_SET_NW_TTL] + of_object_extra_len[version][OF_ACTION_ID_SET_NW_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_set_nw_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_set_nw_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114085,8 +114085,8 @@ of_action_id_set_queue_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_ID_SET_QUEUE] + of_object_extra_len[version][OF_ACTION_ID_SET_QUEUE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_id_set_queue_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_id_set_queue_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114199,8 +114199,8 @@ of_action_nicira_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_NICIRA] + of_object_extra_len[version][OF_ACTION_NICIRA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_nicira_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_nicira_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114326,8 +114326,8 @@ of_action_nicira_dec_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_NICIRA_DEC_TTL] + of_object_extra_len[version][OF_ACTION_NICIRA_DEC_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_nicira_dec_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_nicira_dec_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114455,8 +114455,8 @@ of_action_output_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_OUTPUT] + of_object_extra_len[version][OF_ACTION_OUTPUT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_output_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_output_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114584,8 +114584,8 @@ of_action_pop_mpls_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_POP_MPLS] + of_object_extra_len[version][OF_ACTION_POP_MPLS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_pop_mpls_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_pop_mpls_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114713,8 +114713,8 @@ of_action_pop_pbb_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_POP_PBB] + of_object_extra_len[version][OF_ACTION_POP_PBB];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_pop_pbb_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_pop_pbb_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114842,8 +114842,8 @@ of_action_pop_vlan_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_POP_VLAN] + of_object_extra_len[version][OF_ACTION_POP_VLAN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_pop_vlan_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_pop_vlan_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -114971,8 +114971,8 @@ of_action_push_mpls_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_PUSH_MPLS] + of_object_extra_len[version][OF_ACTION_PUSH_MPLS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_push_mpls_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_push_mpls_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115100,8 +115100,8 @@ of_action_push_pbb_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_PUSH_PBB] + of_object_extra_len[version][OF_ACTION_PUSH_PBB];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_push_pbb_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_push_pbb_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115229,8 +115229,8 @@ of_action_push_vlan_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_PUSH_VLAN] + of_object_extra_len[version][OF_ACTION_PUSH_VLAN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_push_vlan_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_push_vlan_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115358,8 +115358,8 @@ of_action_set_dl_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_DL_DST] + of_object_extra_len[version][OF_ACTION_SET_DL_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_dl_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_dl_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115487,8 +115487,8 @@ of_action_set_dl_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_DL_SRC] + of_object_extra_len[version][OF_ACTION_SET_DL_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_dl_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_dl_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115616,8 +115616,8 @@ of_action_set_field_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_FIELD] + of_object_extra_len[version][OF_ACTION_SET_FIELD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_field_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_field_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115745,8 +115745,8 @@ of_action_set_mpls_label_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_MPLS_LABEL] + of_object_extra_len[version][OF_ACTION_SET_MPLS_LABEL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_mpls_label_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_mpls_label_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -115874,8 +115874,8 @@ of_action_set_mpls_tc_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_MPLS_TC] + of_object_extra_len[version][OF_ACTION_SET_MPLS_TC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_mpls_tc_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_mpls_tc_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116003,8 +116003,8 @@ of_action_set_mpls_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_MPLS_TTL] + of_object_extra_len[version][OF_ACTION_SET_MPLS_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_mpls_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_mpls_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116132,8 +116132,8 @@ of_action_set_nw_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_NW_DST] + of_object_extra_len[version][OF_ACTION_SET_NW_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_nw_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_nw_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116261,8 +116261,8 @@ of_action_set_nw_ecn_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_NW_ECN] + of_object_extra_len[version][OF_ACTION_SET_NW_ECN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_nw_ecn_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_nw_ecn_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116390,8 +116390,8 @@ of_action_set_nw_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_NW_SRC] + of_object_extra_len[version][OF_ACTION_SET_NW_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_nw_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_nw_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116519,8 +116519,8 @@ of_action_set_nw_tos_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_NW_TOS] + of_object_extra_len[version][OF_ACTION_SET_NW_TOS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_nw_tos_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_nw_tos_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116648,8 +116648,8 @@ of_action_set_nw_ttl_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_NW_TTL] + of_object_extra_len[version][OF_ACTION_SET_NW_TTL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_nw_ttl_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_nw_ttl_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116777,8 +116777,8 @@ of_action_set_queue_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_QUEUE] + of_object_extra_len[version][OF_ACTION_SET_QUEUE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_queue_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_queue_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -116906,8 +116906,8 @@ of_action_set_tp_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_TP_DST] + of_object_extra_len[version][OF_ACTION_SET_TP_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_tp_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_tp_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117035,8 +117035,8 @@ of_action_set_tp_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_TP_SRC] + of_object_extra_len[version][OF_ACTION_SET_TP_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_tp_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_tp_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117164,8 +117164,8 @@ of_action_set_vlan_pcp_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_VLAN_PCP] + of_object_extra_len[version][OF_ACTION_SET_VLAN_PCP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_vlan_pcp_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_vlan_pcp_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117293,8 +117293,8 @@ of_action_set_vlan_vid_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_SET_VLAN_VID] + of_object_extra_len[version][OF_ACTION_SET_VLAN_VID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_set_vlan_vid_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_set_vlan_vid_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117422,8 +117422,8 @@ of_action_strip_vlan_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_ACTION_STRIP_VLAN] + of_object_extra_len[version][OF_ACTION_STRIP_VLAN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_action_strip_vlan_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_action_strip_vlan_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117546,8 +117546,8 @@ of_bsn_interface_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_INTERFACE] + of_object_extra_len[version][OF_BSN_INTERFACE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_interface_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_interface_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117654,8 +117654,8 @@ of_bsn_vport_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VPORT] + of_object_extra_len[version][OF_BSN_VPORT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_vport_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_vport_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117760,8 +117760,8 @@ of_bsn_vport_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VPORT_HEADER] + of_object_extra_len[version][OF_BSN_VPORT_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_vport_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_vport_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117873,8 +117873,8 @@ of_bsn_vport_q_in_q_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BSN_VPORT_Q_IN_Q] + of_object_extra_len[version][OF_BSN_VPORT_Q_IN_Q];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bsn_vport_q_in_q_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bsn_vport_q_in_q_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -117993,8 +117993,8 @@ of_bucket_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BUCKET] + of_object_extra_len[version][OF_BUCKET];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bucket_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bucket_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118114,8 +118114,8 @@ of_bucket_counter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_BUCKET_COUNTER] + of_object_extra_len[version][OF_BUCKET_COUNTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_bucket_counter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_bucket_counter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118222,8 +118222,8 @@ of_experimenter_stats_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_EXPERIMENTER_STATS_HEADER] + of_object_extra_len[version][OF_EXPERIMENTER_STATS_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_experimenter_stats_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_experimenter_stats_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118337,8 +118337,8 @@ of_flow_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_FLOW_STATS_ENTRY] + of_object_extra_len[version][OF_FLOW_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_flow_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_flow_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118466,8 +118466,8 @@ of_group_desc_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_DESC_STATS_ENTRY] + of_object_extra_len[version][OF_GROUP_DESC_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_desc_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_desc_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118589,8 +118589,8 @@ of_group_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_GROUP_STATS_ENTRY] + of_object_extra_len[version][OF_GROUP_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_group_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_group_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118700,8 +118700,8 @@ of_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_HEADER] + of_object_extra_len[version][OF_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118803,8 +118803,8 @@ of_hello_elem_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_HELLO_ELEM] + of_object_extra_len[version][OF_HELLO_ELEM];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_hello_elem_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_hello_elem_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -118913,8 +118913,8 @@ of_hello_elem_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_HELLO_ELEM_HEADER] + of_object_extra_len[version][OF_HELLO_ELEM_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_hello_elem_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_hello_elem_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119037,8 +119037,8 @@ of_hello_elem_versionbitmap_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_HELLO_ELEM_VERSIONBITMAP] + of_object_extra_len[version][OF_HELLO_ELEM_VERSIONBITMAP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_hello_elem_versionbitmap_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_hello_elem_versionbitmap_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119151,8 +119151,8 @@ of_instruction_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION] + of_object_extra_len[version][OF_INSTRUCTION];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119276,8 +119276,8 @@ of_instruction_apply_actions_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_APPLY_ACTIONS] + of_object_extra_len[version][OF_INSTRUCTION_APPLY_ACTIONS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_apply_actions_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_apply_actions_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119405,8 +119405,8 @@ of_instruction_clear_actions_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_CLEAR_ACTIONS] + of_object_extra_len[version][OF_INSTRUCTION_CLEAR_ACTIONS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_clear_actions_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_clear_actions_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119534,8 +119534,8 @@ of_instruction_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_EXPERIMENTER] + of_object_extra_len[version][OF_INSTRUCTION_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119663,8 +119663,8 @@ of_instruction_goto_table_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_GOTO_TABLE] + of_object_extra_len[version][OF_INSTRUCTION_GOTO_TABLE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_goto_table_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_goto_table_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119777,8 +119777,8 @@ of_instruction_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_HEADER] + of_object_extra_len[version][OF_INSTRUCTION_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -119901,8 +119901,8 @@ of_instruction_meter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_METER] + of_object_extra_len[version][OF_INSTRUCTION_METER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_meter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_meter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120030,8 +120030,8 @@ of_instruction_write_actions_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_WRITE_ACTIONS] + of_object_extra_len[version][OF_INSTRUCTION_WRITE_ACTIONS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_write_actions_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_write_actions_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120159,8 +120159,8 @@ of_instruction_write_metadata_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_INSTRUCTION_WRITE_METADATA] + of_object_extra_len[version][OF_INSTRUCTION_WRITE_METADATA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_instruction_write_metadata_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_instruction_write_metadata_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120283,8 +120283,8 @@ of_match_v1_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_MATCH_V1] + of_object_extra_len[version][OF_MATCH_V1];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_match_v1_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_match_v1_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120401,8 +120401,8 @@ of_match_v2_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_MATCH_V2] + of_object_extra_len[version][OF_MATCH_V2];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_match_v2_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_match_v2_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120524,8 +120524,8 @@ of_match_v3_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_MATCH_V3] + of_object_extra_len[version][OF_MATCH_V3];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_match_v3_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_match_v3_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120636,8 +120636,8 @@ of_meter_band_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_BAND] + of_object_extra_len[version][OF_METER_BAND];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_band_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_band_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120761,8 +120761,8 @@ of_meter_band_drop_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_BAND_DROP] + of_object_extra_len[version][OF_METER_BAND_DROP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_band_drop_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_band_drop_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -120890,8 +120890,8 @@ of_meter_band_dscp_remark_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_BAND_DSCP_REMARK] + of_object_extra_len[version][OF_METER_BAND_DSCP_REMARK];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_band_dscp_remark_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_band_dscp_remark_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121019,8 +121019,8 @@ of_meter_band_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_BAND_EXPERIMENTER] + of_object_extra_len[version][OF_METER_BAND_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_band_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_band_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121133,8 +121133,8 @@ of_meter_band_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_BAND_HEADER] + of_object_extra_len[version][OF_METER_BAND_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_band_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_band_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121252,8 +121252,8 @@ of_meter_band_stats_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_BAND_STATS] + of_object_extra_len[version][OF_METER_BAND_STATS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_band_stats_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_band_stats_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121370,8 +121370,8 @@ of_meter_config_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_CONFIG] + of_object_extra_len[version][OF_METER_CONFIG];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_config_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_config_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121488,8 +121488,8 @@ of_meter_features_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_FEATURES] + of_object_extra_len[version][OF_METER_FEATURES];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_features_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_features_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121608,8 +121608,8 @@ of_meter_stats_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_METER_STATS] + of_object_extra_len[version][OF_METER_STATS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_meter_stats_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_meter_stats_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121719,8 +121719,8 @@ of_oxm_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM] + of_object_extra_len[version][OF_OXM];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121843,8 +121843,8 @@ of_oxm_arp_op_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_OP] + of_object_extra_len[version][OF_OXM_ARP_OP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_op_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_op_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -121969,8 +121969,8 @@ of_oxm_arp_op_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_OP_MASKED] + of_object_extra_len[version][OF_OXM_ARP_OP_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_op_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_op_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122095,8 +122095,8 @@ of_oxm_arp_sha_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_SHA] + of_object_extra_len[version][OF_OXM_ARP_SHA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_sha_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_sha_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122221,8 +122221,8 @@ of_oxm_arp_sha_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_SHA_MASKED] + of_object_extra_len[version][OF_OXM_ARP_SHA_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_sha_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_sha_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122347,8 +122347,8 @@ of_oxm_arp_spa_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_SPA] + of_object_extra_len[version][OF_OXM_ARP_SPA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_spa_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_spa_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122473,8 +122473,8 @@ of_oxm_arp_spa_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_SPA_MASKED] + of_object_extra_len[version][OF_OXM_ARP_SPA_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_spa_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_spa_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122599,8 +122599,8 @@ of_oxm_arp_tha_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_THA] + of_object_extra_len[version][OF_OXM_ARP_THA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_tha_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_tha_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122725,8 +122725,8 @@ of_oxm_arp_tha_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_THA_MASKED] + of_object_extra_len[version][OF_OXM_ARP_THA_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_tha_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_tha_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122851,8 +122851,8 @@ of_oxm_arp_tpa_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_TPA] + of_object_extra_len[version][OF_OXM_ARP_TPA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_tpa_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_tpa_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -122977,8 +122977,8 @@ of_oxm_arp_tpa_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ARP_TPA_MASKED] + of_object_extra_len[version][OF_OXM_ARP_TPA_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_arp_tpa_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_arp_tpa_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123103,8 +123103,8 @@ of_oxm_bsn_global_vrf_allowed_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_GLOBAL_VRF_ALLOWED] + of_object_extra_len[version][OF_OXM_BSN_GLOBAL_VRF_ALLOWED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_global_vrf_allowed_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_global_vrf_allowed_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123229,8 +123229,8 @@ of_oxm_bsn_global_vrf_allowed_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_GLOBAL_VRF_ALLOWED_MASKED] + of_object_extra_len[version][OF_OXM_BSN_GLOBAL_VRF_ALLOWED_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_global_vrf_allowed_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_global_vrf_allowed_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123355,8 +123355,8 @@ of_oxm_bsn_in_ports_128_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_IN_PORTS_128] + of_object_extra_len[version][OF_OXM_BSN_IN_PORTS_128];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_in_ports_128_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_in_ports_128_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123481,8 +123481,8 @@ of_oxm_bsn_in_ports_128_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_IN_PORTS_128_MASKED] + of_object_extra_len[version][OF_OXM_BSN_IN_PORTS_128_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_in_ports_128_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_in_ports_128_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123607,8 +123607,8 @@ of_oxm_bsn_l3_dst_class_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_L3_DST_CLASS_ID] + of_object_extra_len[version][OF_OXM_BSN_L3_DST_CLASS_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_l3_dst_class_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_l3_dst_class_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123733,8 +123733,8 @@ of_oxm_bsn_l3_dst_class_id_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_L3_DST_CLASS_ID_MASKED] + of_object_extra_len[version][OF_OXM_BSN_L3_DST_CLASS_ID_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_l3_dst_class_id_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_l3_dst_class_id_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123859,8 +123859,8 @@ of_oxm_bsn_l3_interface_class_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_L3_INTERFACE_CLASS_ID] + of_object_extra_len[version][OF_OXM_BSN_L3_INTERFACE_CLASS_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_l3_interface_class_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_l3_interface_class_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -123985,8 +123985,8 @@ of_oxm_bsn_l3_interface_class_id_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_L3_INTERFACE_CLASS_ID_MASKED] + of_object_extra_len[version][OF_OXM_BSN_L3_INTERFACE_CLASS_ID_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_l3_interface_class_id_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_l3_interface_class_id_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124111,8 +124111,8 @@ of_oxm_bsn_l3_src_class_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_L3_SRC_CLASS_ID] + of_object_extra_len[version][OF_OXM_BSN_L3_SRC_CLASS_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_l3_src_class_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_l3_src_class_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124237,8 +124237,8 @@ of_oxm_bsn_l3_src_class_id_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_L3_SRC_CLASS_ID_MASKED] + of_object_extra_len[version][OF_OXM_BSN_L3_SRC_CLASS_ID_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_l3_src_class_id_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_l3_src_class_id_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124363,8 +124363,8 @@ of_oxm_bsn_lag_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_LAG_ID] + of_object_extra_len[version][OF_OXM_BSN_LAG_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_lag_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_lag_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124489,8 +124489,8 @@ of_oxm_bsn_lag_id_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_LAG_ID_MASKED] + of_object_extra_len[version][OF_OXM_BSN_LAG_ID_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_lag_id_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_lag_id_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124615,8 +124615,8 @@ of_oxm_bsn_vrf_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_VRF] + of_object_extra_len[version][OF_OXM_BSN_VRF];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_vrf_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_vrf_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124741,8 +124741,8 @@ of_oxm_bsn_vrf_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_BSN_VRF_MASKED] + of_object_extra_len[version][OF_OXM_BSN_VRF_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_bsn_vrf_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_bsn_vrf_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124867,8 +124867,8 @@ of_oxm_eth_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ETH_DST] + of_object_extra_len[version][OF_OXM_ETH_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_eth_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_eth_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -124993,8 +124993,8 @@ of_oxm_eth_dst_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ETH_DST_MASKED] + of_object_extra_len[version][OF_OXM_ETH_DST_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_eth_dst_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_eth_dst_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125119,8 +125119,8 @@ of_oxm_eth_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ETH_SRC] + of_object_extra_len[version][OF_OXM_ETH_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_eth_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_eth_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125245,8 +125245,8 @@ of_oxm_eth_src_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ETH_SRC_MASKED] + of_object_extra_len[version][OF_OXM_ETH_SRC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_eth_src_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_eth_src_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125371,8 +125371,8 @@ of_oxm_eth_type_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ETH_TYPE] + of_object_extra_len[version][OF_OXM_ETH_TYPE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_eth_type_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_eth_type_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125497,8 +125497,8 @@ of_oxm_eth_type_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ETH_TYPE_MASKED] + of_object_extra_len[version][OF_OXM_ETH_TYPE_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_eth_type_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_eth_type_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125610,8 +125610,8 @@ of_oxm_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_HEADER] + of_object_extra_len[version][OF_OXM_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125731,8 +125731,8 @@ of_oxm_icmpv4_code_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV4_CODE] + of_object_extra_len[version][OF_OXM_ICMPV4_CODE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv4_code_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv4_code_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125857,8 +125857,8 @@ of_oxm_icmpv4_code_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV4_CODE_MASKED] + of_object_extra_len[version][OF_OXM_ICMPV4_CODE_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv4_code_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv4_code_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -125983,8 +125983,8 @@ of_oxm_icmpv4_type_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV4_TYPE] + of_object_extra_len[version][OF_OXM_ICMPV4_TYPE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv4_type_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv4_type_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126109,8 +126109,8 @@ of_oxm_icmpv4_type_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV4_TYPE_MASKED] + of_object_extra_len[version][OF_OXM_ICMPV4_TYPE_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv4_type_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv4_type_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126235,8 +126235,8 @@ of_oxm_icmpv6_code_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV6_CODE] + of_object_extra_len[version][OF_OXM_ICMPV6_CODE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv6_code_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv6_code_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126361,8 +126361,8 @@ of_oxm_icmpv6_code_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV6_CODE_MASKED] + of_object_extra_len[version][OF_OXM_ICMPV6_CODE_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv6_code_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv6_code_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126487,8 +126487,8 @@ of_oxm_icmpv6_type_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV6_TYPE] + of_object_extra_len[version][OF_OXM_ICMPV6_TYPE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv6_type_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv6_type_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126613,8 +126613,8 @@ of_oxm_icmpv6_type_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_ICMPV6_TYPE_MASKED] + of_object_extra_len[version][OF_OXM_ICMPV6_TYPE_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_icmpv6_type_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_icmpv6_type_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126739,8 +126739,8 @@ of_oxm_in_phy_port_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IN_PHY_PORT] + of_object_extra_len[version][OF_OXM_IN_PHY_PORT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_in_phy_port_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_in_phy_port_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126865,8 +126865,8 @@ of_oxm_in_phy_port_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IN_PHY_PORT_MASKED] + of_object_extra_len[version][OF_OXM_IN_PHY_PORT_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_in_phy_port_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_in_phy_port_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -126991,8 +126991,8 @@ of_oxm_in_port_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IN_PORT] + of_object_extra_len[version][OF_OXM_IN_PORT];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_in_port_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_in_port_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127117,8 +127117,8 @@ of_oxm_in_port_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IN_PORT_MASKED] + of_object_extra_len[version][OF_OXM_IN_PORT_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_in_port_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_in_port_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127243,8 +127243,8 @@ of_oxm_ip_dscp_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IP_DSCP] + of_object_extra_len[version][OF_OXM_IP_DSCP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ip_dscp_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ip_dscp_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127369,8 +127369,8 @@ of_oxm_ip_dscp_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IP_DSCP_MASKED] + of_object_extra_len[version][OF_OXM_IP_DSCP_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ip_dscp_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ip_dscp_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127495,8 +127495,8 @@ of_oxm_ip_ecn_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IP_ECN] + of_object_extra_len[version][OF_OXM_IP_ECN];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ip_ecn_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ip_ecn_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127621,8 +127621,8 @@ of_oxm_ip_ecn_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IP_ECN_MASKED] + of_object_extra_len[version][OF_OXM_IP_ECN_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ip_ecn_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ip_ecn_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127747,8 +127747,8 @@ of_oxm_ip_proto_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IP_PROTO] + of_object_extra_len[version][OF_OXM_IP_PROTO];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ip_proto_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ip_proto_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127873,8 +127873,8 @@ of_oxm_ip_proto_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IP_PROTO_MASKED] + of_object_extra_len[version][OF_OXM_IP_PROTO_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ip_proto_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ip_proto_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -127999,8 +127999,8 @@ of_oxm_ipv4_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV4_DST] + of_object_extra_len[version][OF_OXM_IPV4_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv4_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv4_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128125,8 +128125,8 @@ of_oxm_ipv4_dst_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV4_DST_MASKED] + of_object_extra_len[version][OF_OXM_IPV4_DST_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv4_dst_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv4_dst_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128251,8 +128251,8 @@ of_oxm_ipv4_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV4_SRC] + of_object_extra_len[version][OF_OXM_IPV4_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv4_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv4_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128377,8 +128377,8 @@ of_oxm_ipv4_src_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV4_SRC_MASKED] + of_object_extra_len[version][OF_OXM_IPV4_SRC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv4_src_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv4_src_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128503,8 +128503,8 @@ of_oxm_ipv6_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_DST] + of_object_extra_len[version][OF_OXM_IPV6_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128629,8 +128629,8 @@ of_oxm_ipv6_dst_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_DST_MASKED] + of_object_extra_len[version][OF_OXM_IPV6_DST_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_dst_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_dst_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128755,8 +128755,8 @@ of_oxm_ipv6_flabel_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_FLABEL] + of_object_extra_len[version][OF_OXM_IPV6_FLABEL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_flabel_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_flabel_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -128881,8 +128881,8 @@ of_oxm_ipv6_flabel_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_FLABEL_MASKED] + of_object_extra_len[version][OF_OXM_IPV6_FLABEL_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_flabel_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_flabel_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129007,8 +129007,8 @@ of_oxm_ipv6_nd_sll_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_ND_SLL] + of_object_extra_len[version][OF_OXM_IPV6_ND_SLL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_nd_sll_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_nd_sll_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129133,8 +129133,8 @@ of_oxm_ipv6_nd_sll_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_ND_SLL_MASKED] + of_object_extra_len[version][OF_OXM_IPV6_ND_SLL_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_nd_sll_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_nd_sll_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129259,8 +129259,8 @@ of_oxm_ipv6_nd_target_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_ND_TARGET] + of_object_extra_len[version][OF_OXM_IPV6_ND_TARGET];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_nd_target_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_nd_target_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129385,8 +129385,8 @@ of_oxm_ipv6_nd_target_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_ND_TARGET_MASKED] + of_object_extra_len[version][OF_OXM_IPV6_ND_TARGET_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_nd_target_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_nd_target_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129511,8 +129511,8 @@ of_oxm_ipv6_nd_tll_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_ND_TLL] + of_object_extra_len[version][OF_OXM_IPV6_ND_TLL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_nd_tll_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_nd_tll_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129637,8 +129637,8 @@ of_oxm_ipv6_nd_tll_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_ND_TLL_MASKED] + of_object_extra_len[version][OF_OXM_IPV6_ND_TLL_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_nd_tll_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_nd_tll_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129763,8 +129763,8 @@ of_oxm_ipv6_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_SRC] + of_object_extra_len[version][OF_OXM_IPV6_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -129889,8 +129889,8 @@ of_oxm_ipv6_src_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_IPV6_SRC_MASKED] + of_object_extra_len[version][OF_OXM_IPV6_SRC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_ipv6_src_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_ipv6_src_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130015,8 +130015,8 @@ of_oxm_metadata_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_METADATA] + of_object_extra_len[version][OF_OXM_METADATA];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_metadata_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_metadata_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130141,8 +130141,8 @@ of_oxm_metadata_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_METADATA_MASKED] + of_object_extra_len[version][OF_OXM_METADATA_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_metadata_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_metadata_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130267,8 +130267,8 @@ of_oxm_tunnel_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_TUNNEL_ID] + of_object_extra_len[version][OF_OXM_TUNNEL_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_tunnel_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_tunnel_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130393,8 +130393,8 @@ of_oxm_tunnel_id_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_TUNNEL_ID_MASKED] + of_object_extra_len[version][OF_OXM_TUNNEL_ID_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_tunnel_id_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_tunnel_id_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130519,8 +130519,8 @@ of_oxm_mpls_label_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_MPLS_LABEL] + of_object_extra_len[version][OF_OXM_MPLS_LABEL];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_mpls_label_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_mpls_label_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130645,8 +130645,8 @@ of_oxm_mpls_label_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_MPLS_LABEL_MASKED] + of_object_extra_len[version][OF_OXM_MPLS_LABEL_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_mpls_label_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_mpls_label_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130771,8 +130771,8 @@ of_oxm_mpls_tc_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_MPLS_TC] + of_object_extra_len[version][OF_OXM_MPLS_TC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_mpls_tc_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_mpls_tc_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -130897,8 +130897,8 @@ of_oxm_mpls_tc_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_MPLS_TC_MASKED] + of_object_extra_len[version][OF_OXM_MPLS_TC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_mpls_tc_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_mpls_tc_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131023,8 +131023,8 @@ of_oxm_sctp_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_SCTP_DST] + of_object_extra_len[version][OF_OXM_SCTP_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_sctp_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_sctp_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131149,8 +131149,8 @@ of_oxm_sctp_dst_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_SCTP_DST_MASKED] + of_object_extra_len[version][OF_OXM_SCTP_DST_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_sctp_dst_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_sctp_dst_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131275,8 +131275,8 @@ of_oxm_sctp_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_SCTP_SRC] + of_object_extra_len[version][OF_OXM_SCTP_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_sctp_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_sctp_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131401,8 +131401,8 @@ of_oxm_sctp_src_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_SCTP_SRC_MASKED] + of_object_extra_len[version][OF_OXM_SCTP_SRC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_sctp_src_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_sctp_src_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131527,8 +131527,8 @@ of_oxm_tcp_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_TCP_DST] + of_object_extra_len[version][OF_OXM_TCP_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_tcp_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_tcp_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131653,8 +131653,8 @@ of_oxm_tcp_dst_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_TCP_DST_MASKED] + of_object_extra_len[version][OF_OXM_TCP_DST_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_tcp_dst_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_tcp_dst_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131779,8 +131779,8 @@ of_oxm_tcp_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_TCP_SRC] + of_object_extra_len[version][OF_OXM_TCP_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_tcp_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_tcp_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -131905,8 +131905,8 @@ of_oxm_tcp_src_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_TCP_SRC_MASKED] + of_object_extra_len[version][OF_OXM_TCP_SRC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_tcp_src_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_tcp_src_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132031,8 +132031,8 @@ of_oxm_udp_dst_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_UDP_DST] + of_object_extra_len[version][OF_OXM_UDP_DST];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_udp_dst_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_udp_dst_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132157,8 +132157,8 @@ of_oxm_udp_dst_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_UDP_DST_MASKED] + of_object_extra_len[version][OF_OXM_UDP_DST_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_udp_dst_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_udp_dst_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132283,8 +132283,8 @@ of_oxm_udp_src_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_UDP_SRC] + of_object_extra_len[version][OF_OXM_UDP_SRC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_udp_src_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_udp_src_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132409,8 +132409,8 @@ of_oxm_udp_src_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_UDP_SRC_MASKED] + of_object_extra_len[version][OF_OXM_UDP_SRC_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_udp_src_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_udp_src_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132535,8 +132535,8 @@ of_oxm_vlan_pcp_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_VLAN_PCP] + of_object_extra_len[version][OF_OXM_VLAN_PCP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_vlan_pcp_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_vlan_pcp_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132661,8 +132661,8 @@ of_oxm_vlan_pcp_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_VLAN_PCP_MASKED] + of_object_extra_len[version][OF_OXM_VLAN_PCP_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_vlan_pcp_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_vlan_pcp_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132787,8 +132787,8 @@ of_oxm_vlan_vid_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_VLAN_VID] + of_object_extra_len[version][OF_OXM_VLAN_VID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_vlan_vid_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_vlan_vid_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -132913,8 +132913,8 @@ of_oxm_vlan_vid_masked_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_OXM_VLAN_VID_MASKED] + of_object_extra_len[version][OF_OXM_VLAN_VID_MASKED];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_oxm_vlan_vid_masked_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_oxm_vlan_vid_masked_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133038,8 +133038,8 @@ of_packet_queue_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PACKET_QUEUE] + of_object_extra_len[version][OF_PACKET_QUEUE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_packet_queue_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_packet_queue_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133159,8 +133159,8 @@ of_port_desc_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_DESC] + of_object_extra_len[version][OF_PORT_DESC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_desc_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_desc_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133277,8 +133277,8 @@ of_port_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_PORT_STATS_ENTRY] + of_object_extra_len[version][OF_PORT_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_port_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_port_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133385,8 +133385,8 @@ of_queue_prop_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_PROP] + of_object_extra_len[version][OF_QUEUE_PROP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_prop_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_prop_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133510,8 +133510,8 @@ of_queue_prop_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_PROP_EXPERIMENTER] + of_object_extra_len[version][OF_QUEUE_PROP_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_prop_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_prop_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133624,8 +133624,8 @@ of_queue_prop_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_PROP_HEADER] + of_object_extra_len[version][OF_QUEUE_PROP_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_prop_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_prop_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133748,8 +133748,8 @@ of_queue_prop_max_rate_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_PROP_MAX_RATE] + of_object_extra_len[version][OF_QUEUE_PROP_MAX_RATE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_prop_max_rate_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_prop_max_rate_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -133877,8 +133877,8 @@ of_queue_prop_min_rate_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_PROP_MIN_RATE] + of_object_extra_len[version][OF_QUEUE_PROP_MIN_RATE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_prop_min_rate_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_prop_min_rate_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134001,8 +134001,8 @@ of_queue_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_QUEUE_STATS_ENTRY] + of_object_extra_len[version][OF_QUEUE_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_queue_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_queue_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134109,8 +134109,8 @@ of_table_feature_prop_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134234,8 +134234,8 @@ of_table_feature_prop_apply_actions_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_APPLY_ACTIONS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_APPLY_ACTIONS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_apply_actions_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_apply_actions_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134363,8 +134363,8 @@ of_table_feature_prop_apply_actions_miss_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_APPLY_ACTIONS_MISS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_APPLY_ACTIONS_MISS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_apply_actions_miss_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_apply_actions_miss_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134492,8 +134492,8 @@ of_table_feature_prop_apply_setfield_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_APPLY_SETFIELD] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_APPLY_SETFIELD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_apply_setfield_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_apply_setfield_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134621,8 +134621,8 @@ of_table_feature_prop_apply_setfield_miss_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_APPLY_SETFIELD_MISS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_APPLY_SETFIELD_MISS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_apply_setfield_miss_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_apply_setfield_miss_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134750,8 +134750,8 @@ of_table_feature_prop_experimenter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_EXPERIMENTER] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_EXPERIMENTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_experimenter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_experimenter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134864,8 +134864,8 @@ of_table_feature_prop_header_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_HEADER] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_HEADER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_header_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_header_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -134988,8 +134988,8 @@ of_table_feature_prop_instructions_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_INSTRUCTIONS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_INSTRUCTIONS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_instructions_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_instructions_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135117,8 +135117,8 @@ of_table_feature_prop_instructions_miss_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_INSTRUCTIONS_MISS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_INSTRUCTIONS_MISS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_instructions_miss_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_instructions_miss_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135246,8 +135246,8 @@ of_table_feature_prop_match_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_MATCH] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_MATCH];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_match_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_match_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135375,8 +135375,8 @@ of_table_feature_prop_next_tables_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_NEXT_TABLES] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_NEXT_TABLES];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_next_tables_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_next_tables_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135504,8 +135504,8 @@ of_table_feature_prop_next_tables_miss_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_NEXT_TABLES_MISS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_NEXT_TABLES_MISS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_next_tables_miss_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_next_tables_miss_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135633,8 +135633,8 @@ of_table_feature_prop_wildcards_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_WILDCARDS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_WILDCARDS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_wildcards_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_wildcards_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135762,8 +135762,8 @@ of_table_feature_prop_write_actions_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_WRITE_ACTIONS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_WRITE_ACTIONS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_write_actions_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_write_actions_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -135891,8 +135891,8 @@ of_table_feature_prop_write_actions_miss_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_WRITE_ACTIONS_MISS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_WRITE_ACTIONS_MISS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_write_actions_miss_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_write_actions_miss_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136020,8 +136020,8 @@ of_table_feature_prop_write_setfield_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_WRITE_SETFIELD] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_WRITE_SETFIELD];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_write_setfield_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_write_setfield_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136149,8 +136149,8 @@ of_table_feature_prop_write_setfield_miss_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURE_PROP_WRITE_SETFIELD_MISS] + of_object_extra_len[version][OF_TABLE_FEATURE_PROP_WRITE_SETFIELD_MISS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_feature_prop_write_setfield_miss_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_feature_prop_write_setfield_miss_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136275,8 +136275,8 @@ of_table_features_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_FEATURES] + of_object_extra_len[version][OF_TABLE_FEATURES];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_features_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_features_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136396,8 +136396,8 @@ of_table_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_TABLE_STATS_ENTRY] + of_object_extra_len[version][OF_TABLE_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_table_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_table_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136514,8 +136514,8 @@ of_uint32_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_UINT32] + of_object_extra_len[version][OF_UINT32];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_uint32_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_uint32_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136632,8 +136632,8 @@ of_uint8_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_UINT8] + of_object_extra_len[version][OF_UINT8];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_uint8_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_uint8_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136740,8 +136740,8 @@ of_list_action_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_ACTION] + of_object_extra_len[version][OF_LIST_ACTION];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_action_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_action_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136843,8 +136843,8 @@ of_list_action_id_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_ACTION_ID] + of_object_extra_len[version][OF_LIST_ACTION_ID];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_action_id_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_action_id_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -136946,8 +136946,8 @@ of_list_bsn_interface_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_BSN_INTERFACE] + of_object_extra_len[version][OF_LIST_BSN_INTERFACE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_bsn_interface_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_bsn_interface_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137049,8 +137049,8 @@ of_list_bucket_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_BUCKET] + of_object_extra_len[version][OF_LIST_BUCKET];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_bucket_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_bucket_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137152,8 +137152,8 @@ of_list_bucket_counter_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_BUCKET_COUNTER] + of_object_extra_len[version][OF_LIST_BUCKET_COUNTER];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_bucket_counter_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_bucket_counter_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137255,8 +137255,8 @@ of_list_flow_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_FLOW_STATS_ENTRY] + of_object_extra_len[version][OF_LIST_FLOW_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_flow_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_flow_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137358,8 +137358,8 @@ of_list_group_desc_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_GROUP_DESC_STATS_ENTRY] + of_object_extra_len[version][OF_LIST_GROUP_DESC_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_group_desc_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_group_desc_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137461,8 +137461,8 @@ of_list_group_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_GROUP_STATS_ENTRY] + of_object_extra_len[version][OF_LIST_GROUP_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_group_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_group_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137564,8 +137564,8 @@ of_list_hello_elem_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_HELLO_ELEM] + of_object_extra_len[version][OF_LIST_HELLO_ELEM];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_hello_elem_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_hello_elem_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137667,8 +137667,8 @@ of_list_instruction_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_INSTRUCTION] + of_object_extra_len[version][OF_LIST_INSTRUCTION];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_instruction_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_instruction_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137770,8 +137770,8 @@ of_list_meter_band_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_METER_BAND] + of_object_extra_len[version][OF_LIST_METER_BAND];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_meter_band_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_meter_band_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137873,8 +137873,8 @@ of_list_meter_band_stats_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_METER_BAND_STATS] + of_object_extra_len[version][OF_LIST_METER_BAND_STATS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_meter_band_stats_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_meter_band_stats_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -137976,8 +137976,8 @@ of_list_meter_stats_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_METER_STATS] + of_object_extra_len[version][OF_LIST_METER_STATS];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_meter_stats_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_meter_stats_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138079,8 +138079,8 @@ of_list_oxm_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_OXM] + of_object_extra_len[version][OF_LIST_OXM];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_oxm_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_oxm_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138182,8 +138182,8 @@ of_list_packet_queue_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_PACKET_QUEUE] + of_object_extra_len[version][OF_LIST_PACKET_QUEUE];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_packet_queue_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_packet_queue_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138285,8 +138285,8 @@ of_list_port_desc_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_PORT_DESC] + of_object_extra_len[version][OF_LIST_PORT_DESC];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_port_desc_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_port_desc_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138388,8 +138388,8 @@ of_list_port_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_PORT_STATS_ENTRY] + of_object_extra_len[version][OF_LIST_PORT_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_port_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_port_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138491,8 +138491,8 @@ of_list_queue_prop_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_QUEUE_PROP] + of_object_extra_len[version][OF_LIST_QUEUE_PROP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_queue_prop_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_queue_prop_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138594,8 +138594,8 @@ of_list_queue_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_QUEUE_STATS_ENTRY] + of_object_extra_len[version][OF_LIST_QUEUE_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_queue_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_queue_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138697,8 +138697,8 @@ of_list_table_feature_prop_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_TABLE_FEATURE_PROP] + of_object_extra_len[version][OF_LIST_TABLE_FEATURE_PROP];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_table_feature_prop_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_table_feature_prop_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138800,8 +138800,8 @@ of_list_table_features_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_TABLE_FEATURES] + of_object_extra_len[version][OF_LIST_TABLE_FEATURES];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_table_features_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_table_features_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -138903,8 +138903,8 @@ of_list_table_stats_entry_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_TABLE_STATS_ENTRY] + of_object_extra_len[version][OF_LIST_TABLE_STATS_ENTRY];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_table_stats_entry_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_table_stats_entry_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -139006,8 +139006,8 @@ of_list_uint32_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_UINT32] + of_object_extra_len[version][OF_LIST_UINT32];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_uint32_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_uint32_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
@@ -139109,8 +139109,8 @@ of_list_uint8_new_(of_version_t version)
 
     bytes = of_object_fixed_len[version][OF_LIST_UINT8] + of_object_extra_len[version][OF_LIST_UINT8];
 
-    /* Allocate a maximum-length wire buffer assuming we'll be appending to it. */
-    if ((obj = (of_list_uint8_t *)of_object_new(OF_WIRE_BUFFER_MAX_LENGTH)) == NULL) {
+    /* Allocate a wire buffer sized for the object; it grows on append. */
+    if ((obj = (of_list_uint8_t *)of_object_new(bytes)) == NULL) {
         return NULL;
     }
 
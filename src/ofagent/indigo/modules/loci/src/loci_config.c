@@ -71,6 +71,11 @@ loci_config_settings_t loci_config_settings[] =
     { __loci_config_STRINGIFY_NAME(LOCI_CONFIG_INCLUDE_UCLI), __loci_config_STRINGIFY_VALUE(LOCI_CONFIG_INCLUDE_UCLI) },
 #else
 { LOCI_CONFIG_INCLUDE_UCLI(__loci_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH
+    { __loci_config_STRINGIFY_NAME(LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH), __loci_config_STRINGIFY_VALUE(LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH) },
+#else
+{ LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH(__loci_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -30,7 +30,8 @@ loci_object_track_t loci_global_tracking;
  * Create a generic new object and possibly underlying wire buffer
  * @param bytes The number of bytes to allocate in the underlying buffer
  *
- * If bytes <= 0, do not allocate a wire buffer.
+ * If bytes < 0, do not allocate a wire buffer.  A zero length object
+ * (such as an empty list) still gets a minimum sized buffer to grow into.
  *
  * Note that this is an internal function.  The class specific
  * new functions should be called to properly initialize and track an
@@ -47,7 +48,7 @@ of_object_new(int bytes)
     }
     MEMSET(obj, 0, sizeof(of_generic_t));
 
-    if (bytes > 0) {
+    if (bytes >= 0) {
         if ((obj->wire_object.wbuf = of_wire_buffer_new(bytes)) == NULL) {
             FREE(obj);
             return NULL;
@@ -121,7 +122,7 @@ of_object_dup_(of_object_t *src)
 
     MEMSET(dst, 0, sizeof(*dst));
 
-    /* Allocate a minimal wire buffer assuming we will not write to it. */
+    /* Allocate a minimal wire buffer; it is grown if written past the end. */
     if ((dst->wire_object.wbuf = of_wire_buffer_new(src->length)) == NULL) {
         FREE(dst);
         return NULL;
@@ -246,6 +247,23 @@ of_object_track_report(loci_writer_f writer, void* cookie)
 
 of_object_t *
 of_object_new_from_message(of_message_t msg, int len)
+{
+    return of_object_new_from_message_bind(msg, len, OF_MESSAGE_FREE_FUNCTION);
+}
+
+/**
+ * Generic new from message call with a caller supplied free function
+ * @param msg The message to bind
+ * @param len The length of the message
+ * @param buf_free Applied to msg when the object is deleted; if NULL,
+ * FREE is used
+ *
+ * On failure NULL is returned and msg is still owned by the caller.
+ */
+
+of_object_t *
+of_object_new_from_message_bind(of_message_t msg, int len,
+                                of_buffer_free_f buf_free)
 {
     of_object_id_t object_id;
     of_object_t *obj;
@@ -271,7 +289,7 @@ of_object_new_from_message(of_message_t msg, int len)
     of_object_init_map[object_id](obj, version, 0, 0);
 
     if (of_object_buffer_bind(obj, OF_MESSAGE_TO_BUFFER(msg), len, 
-                              OF_MESSAGE_FREE_FUNCTION) < 0) {
+                              buf_free) < 0) {
         FREE(obj);
         return NULL;
     }
@@ -389,13 +407,22 @@ object_child_attach(of_object_t *parent, of_object_t *child,
  * @param obj The object being checked
  * @param new_len The desired length
  * @return Boolean
+ *
+ * The wire buffer is reallocated if needed, up to the maximum message
+ * length.
  */
 
 int
 of_object_can_grow(of_object_t *obj, int new_len)
 {
-    return OF_OBJECT_ABSOLUTE_OFFSET(obj, new_len) <=
-        WBUF_ALLOC_BYTES(obj->wire_object.wbuf);
+    of_wire_buffer_t *wbuf = obj->wire_object.wbuf;
+    int abs_len = OF_OBJECT_ABSOLUTE_OFFSET(obj, new_len);
+
+    if (abs_len > OF_WIRE_BUFFER_MAX_LENGTH) {
+        return 0;
+    }
+
+    return of_wire_buffer_reserve(wbuf, abs_len) == OF_ERROR_NONE;
 }
 
 /**
@@ -617,6 +644,15 @@ of_object_wire_buffer_steal(of_object_t *obj, uint8_t **buffer)
     obj->wire_object.wbuf = NULL;
 }
 
+void
+of_object_wire_buffer_steal_pooled(of_object_t *obj, uint8_t **buffer,
+                                   int *pool_class)
+{
+    ASSERT(obj != NULL);
+    of_wire_buffer_steal_pooled(obj->wire_object.wbuf, buffer, pool_class);
+    obj->wire_object.wbuf = NULL;
+}
+
 /*
  * Set member:
  *    get_wbuf_extent
@@ -11,6 +11,7 @@
  *
  ****************************************************************/
 
+#include <loci/loci_config.h>
 #include <loci/loci.h>
 
 #if 0
@@ -114,6 +115,11 @@ of_wire_buffer_replace_data(of_wire_buffer_t *wbuf,
     /* Doesn't make sense; mismatch in current buffer info */
     ASSERT(old_len + offset <= wbuf->current_bytes);
 
+    if (of_wire_buffer_reserve(wbuf, cur_bytes + (new_len - old_len)) < 0) {
+        ASSERT(0);
+        return;
+    }
+
     wbuf->current_bytes += (new_len - old_len); // may decrease size
 
     if ((old_len + offset < cur_bytes) && (old_len != new_len)) {
@@ -129,3 +135,264 @@ of_wire_buffer_replace_data(of_wire_buffer_t *wbuf,
 
     ASSERT(wbuf->current_bytes == cur_bytes + (new_len - old_len));
 }
+
+/****************************************************************
+ *
+ * Wire buffer pool
+ *
+ * Data buffers are allocated in power of two size classes starting at
+ * OF_WIRE_BUFFER_MIN_ALLOC_BYTES.  Freed buffers are kept on a per class
+ * free list (linked through the first bytes of the buffer) up to
+ * LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH entries.  Wire buffer control blocks
+ * are recycled the same way.
+ *
+ * LOCI objects are only manipulated from one thread, so the pool is
+ * not locked.
+ *
+ ****************************************************************/
+
+#define WBUF_POOL_CLASS_BYTES(cls) (OF_WIRE_BUFFER_MIN_ALLOC_BYTES << (cls))
+
+typedef struct wbuf_pool_entry_s {
+    struct wbuf_pool_entry_s *next;
+} wbuf_pool_entry_t;
+
+static struct {
+    wbuf_pool_entry_t *bufs[OF_WIRE_BUFFER_POOL_CLASSES];
+    int buf_count[OF_WIRE_BUFFER_POOL_CLASSES];
+    wbuf_pool_entry_t *wbufs;
+    int wbuf_count;
+} wbuf_pool;
+
+static of_wire_buffer_pool_stats_t wbuf_pool_stats;
+
+/* Return the smallest size class holding bytes, or -1 if none does */
+static int
+wbuf_pool_class(int bytes)
+{
+    int cls;
+
+    for (cls = 0; cls < OF_WIRE_BUFFER_POOL_CLASSES; cls++) {
+        if (bytes <= WBUF_POOL_CLASS_BYTES(cls)) {
+            return cls;
+        }
+    }
+
+    return -1;
+}
+
+/* Allocate a data buffer of at least bytes; not zeroed */
+static uint8_t *
+wbuf_pool_data_alloc(int bytes, int *cls_out, int *alloc_out)
+{
+    wbuf_pool_entry_t *entry;
+    int cls;
+
+    cls = wbuf_pool_class(bytes);
+    *cls_out = cls;
+
+    if (cls < 0) {
+        wbuf_pool_stats.misses++;
+        *alloc_out = bytes;
+        return (uint8_t *)MALLOC(bytes);
+    }
+
+    *alloc_out = WBUF_POOL_CLASS_BYTES(cls);
+
+    if ((entry = wbuf_pool.bufs[cls]) != NULL) {
+        wbuf_pool.bufs[cls] = entry->next;
+        wbuf_pool.buf_count[cls]--;
+        wbuf_pool_stats.hits++;
+        return (uint8_t *)entry;
+    }
+
+    wbuf_pool_stats.misses++;
+    return (uint8_t *)MALLOC(*alloc_out);
+}
+
+/* Return a data buffer to its size class, or free it */
+static void
+wbuf_pool_data_free(uint8_t *buf, int cls)
+{
+    wbuf_pool_entry_t *entry;
+
+    if (cls >= 0 &&
+            wbuf_pool.buf_count[cls] < LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH) {
+        entry = (wbuf_pool_entry_t *)buf;
+        entry->next = wbuf_pool.bufs[cls];
+        wbuf_pool.bufs[cls] = entry;
+        wbuf_pool.buf_count[cls]++;
+        wbuf_pool_stats.recycled++;
+        return;
+    }
+
+    wbuf_pool_stats.released++;
+    FREE(buf);
+}
+
+/* Release the data buffer of wbuf according to where it came from */
+static void
+wbuf_data_release(of_wire_buffer_t *wbuf)
+{
+    if (wbuf->buf == NULL) {
+        return;
+    }
+
+    if (wbuf->free != NULL) {
+        wbuf->free(wbuf->buf);
+    } else if (wbuf->pool_class >= 0) {
+        wbuf_pool_data_free(wbuf->buf, wbuf->pool_class);
+    } else {
+        FREE(wbuf->buf);
+    }
+}
+
+static of_wire_buffer_t *
+wbuf_ctrl_alloc(void)
+{
+    wbuf_pool_entry_t *entry;
+
+    if ((entry = wbuf_pool.wbufs) != NULL) {
+        wbuf_pool.wbufs = entry->next;
+        wbuf_pool.wbuf_count--;
+        return (of_wire_buffer_t *)entry;
+    }
+
+    return (of_wire_buffer_t *)MALLOC(sizeof(of_wire_buffer_t));
+}
+
+static void
+wbuf_ctrl_free(of_wire_buffer_t *wbuf)
+{
+    wbuf_pool_entry_t *entry;
+
+    if (wbuf_pool.wbuf_count < LOCI_CONFIG_WIRE_BUFFER_POOL_DEPTH) {
+        entry = (wbuf_pool_entry_t *)wbuf;
+        entry->next = wbuf_pool.wbufs;
+        wbuf_pool.wbufs = entry;
+        wbuf_pool.wbuf_count++;
+        return;
+    }
+
+    FREE(wbuf);
+}
+
+of_wire_buffer_t *
+of_wire_buffer_new(int a_bytes)
+{
+    of_wire_buffer_t *wbuf;
+
+    if ((wbuf = wbuf_ctrl_alloc()) == NULL) {
+        return NULL;
+    }
+    MEMSET(wbuf, 0, sizeof(of_wire_buffer_t));
+
+    if (a_bytes < OF_WIRE_BUFFER_MIN_ALLOC_BYTES) {
+        a_bytes = OF_WIRE_BUFFER_MIN_ALLOC_BYTES;
+    }
+
+    wbuf->buf = wbuf_pool_data_alloc(a_bytes, &wbuf->pool_class,
+                                     &wbuf->alloc_bytes);
+    if (wbuf->buf == NULL) {
+        wbuf_ctrl_free(wbuf);
+        return NULL;
+    }
+    MEMSET(wbuf->buf, 0, wbuf->alloc_bytes);
+    wbuf->current_bytes = 0;
+
+    return wbuf;
+}
+
+of_wire_buffer_t *
+of_wire_buffer_new_bind(uint8_t *buf, int bytes, of_buffer_free_f buf_free)
+{
+    of_wire_buffer_t *wbuf;
+
+    if ((wbuf = wbuf_ctrl_alloc()) == NULL) {
+        return NULL;
+    }
+
+    wbuf->buf = buf;
+    wbuf->free = buf_free;
+    wbuf->current_bytes = bytes;
+    wbuf->alloc_bytes = bytes;
+    wbuf->pool_class = -1;
+
+    return wbuf;
+}
+
+void
+of_wire_buffer_free(of_wire_buffer_t *wbuf)
+{
+    if (wbuf == NULL) return;
+
+    wbuf_data_release(wbuf);
+    wbuf_ctrl_free(wbuf);
+}
+
+int
+of_wire_buffer_reserve(of_wire_buffer_t *wbuf, int bytes)
+{
+    uint8_t *buf;
+    int cls, alloc_bytes;
+
+    ASSERT(wbuf != NULL);
+
+    if (bytes <= wbuf->alloc_bytes) {
+        return OF_ERROR_NONE;
+    }
+
+    if ((buf = wbuf_pool_data_alloc(bytes, &cls, &alloc_bytes)) == NULL) {
+        return OF_ERROR_RESOURCE;
+    }
+
+    /* Bytes past the current extent must read back as zero */
+    if (wbuf->current_bytes > 0) {
+        MEMCPY(buf, wbuf->buf, wbuf->current_bytes);
+    }
+    MEMSET(&buf[wbuf->current_bytes], 0, alloc_bytes - wbuf->current_bytes);
+
+    wbuf_data_release(wbuf);
+    wbuf->buf = buf;
+    wbuf->free = NULL;
+    wbuf->pool_class = cls;
+    wbuf->alloc_bytes = alloc_bytes;
+    wbuf_pool_stats.grows++;
+
+    return OF_ERROR_NONE;
+}
+
+void
+of_wire_buffer_data_free(uint8_t *buf, int pool_class)
+{
+    if (buf != NULL) {
+        wbuf_pool_data_free(buf, pool_class);
+    }
+}
+
+void
+of_wire_buffer_pool_stats_get(of_wire_buffer_pool_stats_t *stats)
+{
+    *stats = wbuf_pool_stats;
+}
+
+void
+of_wire_buffer_pool_purge(void)
+{
+    wbuf_pool_entry_t *entry;
+    int cls;
+
+    for (cls = 0; cls < OF_WIRE_BUFFER_POOL_CLASSES; cls++) {
+        while ((entry = wbuf_pool.bufs[cls]) != NULL) {
+            wbuf_pool.bufs[cls] = entry->next;
+            FREE(entry);
+        }
+        wbuf_pool.buf_count[cls] = 0;
+    }
+
+    while ((entry = wbuf_pool.wbufs) != NULL) {
+        wbuf_pool.wbufs = entry->next;
+        FREE(entry);
+    }
+    wbuf_pool.wbuf_count = 0;
+}
@@ -29,10 +29,324 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 
+#define TEST_ASSERT(cond) do {                                          \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n",            \
+                    __FILE__, __LINE__, #cond);                         \
+            exit(1);                                                    \
+        }                                                               \
+    } while (0)
+
+/* New objects start small and grow as data is appended */
+static void
+test_wire_buffer_grow(void)
+{
+    of_packet_out_t *obj;
+    of_list_action_t *actions;
+    of_action_output_t *output;
+    of_octets_t data, data_out;
+    uint8_t payload[1500];
+    int i;
+
+    obj = of_packet_out_new(OF_VERSION_1_3);
+    TEST_ASSERT(obj != NULL);
+    TEST_ASSERT(WBUF_ALLOC_BYTES(OF_OBJECT_TO_WBUF(obj)) <
+                OF_WIRE_BUFFER_MAX_LENGTH);
+
+    actions = of_list_action_new(OF_VERSION_1_3);
+    output = of_action_output_new(OF_VERSION_1_3);
+    TEST_ASSERT(actions != NULL && output != NULL);
+    for (i = 0; i < 100; i++) {
+        of_action_output_port_set(output, i);
+        TEST_ASSERT(of_list_action_append(actions, (of_action_t *)output) ==
+                    OF_ERROR_NONE);
+    }
+    TEST_ASSERT(actions->length == 100 * output->length);
+    TEST_ASSERT(of_packet_out_actions_set(obj, actions) == OF_ERROR_NONE);
+
+    for (i = 0; i < (int)sizeof(payload); i++) {
+        payload[i] = i;
+    }
+    data.data = payload;
+    data.bytes = sizeof(payload);
+    TEST_ASSERT(of_packet_out_data_set(obj, &data) == OF_ERROR_NONE);
+
+    of_packet_out_data_get(obj, &data_out);
+    TEST_ASSERT(data_out.bytes == sizeof(payload));
+    TEST_ASSERT(memcmp(data_out.data, payload, sizeof(payload)) == 0);
+    TEST_ASSERT(WBUF_CURRENT_BYTES(OF_OBJECT_TO_WBUF(obj)) == obj->length);
+
+    of_object_delete((of_object_t *)output);
+    of_object_delete((of_object_t *)actions);
+    of_object_delete((of_object_t *)obj);
+}
+
+/* Lists stop growing at the maximum message length */
+static void
+test_wire_buffer_max_length(void)
+{
+    of_list_action_t *actions;
+    of_action_output_t *output;
+    int count = 0;
+
+    actions = of_list_action_new(OF_VERSION_1_3);
+    output = of_action_output_new(OF_VERSION_1_3);
+    TEST_ASSERT(actions != NULL && output != NULL);
+
+    while (of_list_action_append(actions, (of_action_t *)output) ==
+           OF_ERROR_NONE) {
+        count++;
+    }
+    TEST_ASSERT(count == OF_WIRE_BUFFER_MAX_LENGTH / output->length);
+
+    of_object_delete((of_object_t *)output);
+    of_object_delete((of_object_t *)actions);
+}
+
+/* Freed buffers are reused by the next allocation of the same size */
+static void
+test_wire_buffer_pool(void)
+{
+    of_wire_buffer_pool_stats_t before, after;
+    of_echo_request_t *obj;
+    uint8_t *buf;
+    int pool_class;
+
+    obj = of_echo_request_new(OF_VERSION_1_3);
+    TEST_ASSERT(obj != NULL);
+    of_object_delete((of_object_t *)obj);
+
+    of_wire_buffer_pool_stats_get(&before);
+    obj = of_echo_request_new(OF_VERSION_1_3);
+    TEST_ASSERT(obj != NULL);
+    of_wire_buffer_pool_stats_get(&after);
+    TEST_ASSERT(after.hits == before.hits + 1);
+    TEST_ASSERT(after.misses == before.misses);
+
+    /* A stolen buffer goes back to the pool when released */
+    of_object_wire_buffer_steal_pooled((of_object_t *)obj, &buf, &pool_class);
+    TEST_ASSERT(pool_class == 0);
+    of_object_delete((of_object_t *)obj);
+    of_wire_buffer_data_free(buf, pool_class);
+
+    of_wire_buffer_pool_stats_get(&before);
+    obj = of_echo_request_new(OF_VERSION_1_3);
+    TEST_ASSERT(obj != NULL);
+    of_wire_buffer_pool_stats_get(&after);
+    TEST_ASSERT(after.hits == before.hits + 1);
+    of_object_delete((of_object_t *)obj);
+
+    of_wire_buffer_pool_purge();
+}
+
+/* Mark the bytes of of_match_fields_t that belong to a field */
+static void
+match_field_bytes(uint8_t *map)
+{
+    of_match_fields_t *f = (of_match_fields_t *)map;
+
+#define SET_FIELD_BYTES(name) memset(&f->name, 0xff, sizeof(f->name))
+    memset(map, 0, sizeof(*f));
+    SET_FIELD_BYTES(in_port);
+    SET_FIELD_BYTES(in_phy_port);
+    SET_FIELD_BYTES(metadata);
+    SET_FIELD_BYTES(eth_dst);
+    SET_FIELD_BYTES(eth_src);
+    SET_FIELD_BYTES(eth_type);
+    SET_FIELD_BYTES(vlan_vid);
+    SET_FIELD_BYTES(vlan_pcp);
+    SET_FIELD_BYTES(ip_dscp);
+    SET_FIELD_BYTES(ip_ecn);
+    SET_FIELD_BYTES(ip_proto);
+    SET_FIELD_BYTES(ipv4_src);
+    SET_FIELD_BYTES(ipv4_dst);
+    SET_FIELD_BYTES(tcp_dst);
+    SET_FIELD_BYTES(tcp_src);
+    SET_FIELD_BYTES(udp_dst);
+    SET_FIELD_BYTES(udp_src);
+    SET_FIELD_BYTES(sctp_dst);
+    SET_FIELD_BYTES(sctp_src);
+    SET_FIELD_BYTES(icmpv4_type);
+    SET_FIELD_BYTES(icmpv4_code);
+    SET_FIELD_BYTES(arp_op);
+    SET_FIELD_BYTES(arp_spa);
+    SET_FIELD_BYTES(arp_tpa);
+    SET_FIELD_BYTES(arp_sha);
+    SET_FIELD_BYTES(arp_tha);
+    SET_FIELD_BYTES(ipv6_src);
+    SET_FIELD_BYTES(ipv6_dst);
+    SET_FIELD_BYTES(ipv6_flabel);
+    SET_FIELD_BYTES(icmpv6_type);
+    SET_FIELD_BYTES(icmpv6_code);
+    SET_FIELD_BYTES(ipv6_nd_target);
+    SET_FIELD_BYTES(ipv6_nd_sll);
+    SET_FIELD_BYTES(ipv6_nd_tll);
+    SET_FIELD_BYTES(mpls_label);
+    SET_FIELD_BYTES(mpls_tc);
+    SET_FIELD_BYTES(bsn_in_ports_128);
+    SET_FIELD_BYTES(bsn_lag_id);
+    SET_FIELD_BYTES(bsn_vrf);
+    SET_FIELD_BYTES(bsn_global_vrf_allowed);
+    SET_FIELD_BYTES(bsn_l3_interface_class_id);
+    SET_FIELD_BYTES(bsn_l3_src_class_id);
+    SET_FIELD_BYTES(bsn_l3_dst_class_id);
+#ifdef OFDPA_FIXUP
+    SET_FIELD_BYTES(tunnel_id);
+#endif
+#undef SET_FIELD_BYTES
+}
+
+/*
+ * Build a random entry and a query related to it: the query masks a
+ * subset of the entry's bits and agrees on them, then some of the time
+ * one byte of either match is perturbed. Padding stays zero.
+ */
+static void
+random_match_pair(const uint8_t *map, of_match_t *entry, of_match_t *query)
+{
+    uint8_t *e_m = (uint8_t *)&entry->masks, *e_f = (uint8_t *)&entry->fields;
+    uint8_t *q_m = (uint8_t *)&query->masks, *q_f = (uint8_t *)&query->fields;
+    uint8_t bit;
+    int idx;
+
+    memset(entry, 0, sizeof(*entry));
+    memset(query, 0, sizeof(*query));
+    entry->version = query->version = OF_VERSION_1_3;
+
+    for (idx = 0; idx < (int)sizeof(of_match_fields_t); idx++) {
+        if (!map[idx] || rand() % 8 != 0) {
+            continue;
+        }
+        e_m[idx] = rand();
+        e_f[idx] = rand();
+        q_m[idx] = e_m[idx] & rand();
+        q_f[idx] = (e_f[idx] & q_m[idx]) | (rand() & ~q_m[idx]);
+    }
+
+    if (rand() % 2) {
+        do {
+            idx = rand() % sizeof(of_match_fields_t);
+        } while (!map[idx] || (rand() % 4 != 0 && !q_m[idx]));
+        /* Prefer flipping a value bit both matches mask */
+        bit = e_m[idx] & q_m[idx] & -(e_m[idx] & q_m[idx]);
+        if (bit == 0) {
+            bit = 1 << (rand() % 8);
+        }
+        switch (rand() % 4) {
+        case 0: e_m[idx] ^= 1 << (rand() % 8); break;
+        case 1: e_f[idx] ^= bit; break;
+        case 2: q_m[idx] ^= 1 << (rand() % 8); break;
+        case 3: q_f[idx] ^= bit; break;
+        }
+    }
+}
+
+/* The wide word comparisons agree with the field by field versions */
+static void
+test_match_compare_random(void)
+{
+    uint8_t map[sizeof(of_match_fields_t)];
+    of_match_t entry, query;
+    int i, rv, more_specific = 0, overlap = 0;
+
+    match_field_bytes(map);
+    srand(1);
+
+    for (i = 0; i < 100000; i++) {
+        random_match_pair(map, &entry, &query);
+
+        rv = of_match_more_specific(&entry, &query);
+        TEST_ASSERT(rv == of_match_more_specific_by_field(&entry, &query));
+        more_specific += rv;
+        TEST_ASSERT(of_match_more_specific(&query, &entry) ==
+                    of_match_more_specific_by_field(&query, &entry));
+
+        rv = of_match_overlap(&entry, &query);
+        TEST_ASSERT(rv == of_match_overlap_by_field(&entry, &query));
+        overlap += rv;
+        TEST_ASSERT(of_match_overlap(&query, &entry) == rv);
+    }
+
+    /* Both outcomes were exercised */
+    TEST_ASSERT(more_specific > 1000 && more_specific < 99000);
+    TEST_ASSERT(overlap > 1000 && overlap < 99000);
+}
+
+static double
+elapsed_ns(struct timespec *start)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1e9 +
+        (end.tv_nsec - start->tv_nsec);
+}
+
+#define BENCH_PAIRS 1024
+#define BENCH_ROUNDS 200
+
+/*
+ * Time the wide word and field by field comparisons on the same pairs.
+ * Run with LOCI_UTEST_BENCH set in the environment.
+ */
+static void
+bench_match_compare(void)
+{
+    uint8_t map[sizeof(of_match_fields_t)];
+    of_match_t *entries, *queries;
+    struct timespec start;
+    volatile int sink = 0;
+    double by_field, wide;
+    int i, round;
+
+    entries = malloc(BENCH_PAIRS * sizeof(*entries));
+    queries = malloc(BENCH_PAIRS * sizeof(*queries));
+    TEST_ASSERT(entries != NULL && queries != NULL);
+
+    match_field_bytes(map);
+    srand(2);
+    for (i = 0; i < BENCH_PAIRS; i++) {
+        random_match_pair(map, &entries[i], &queries[i]);
+    }
+
+#define BENCH(fn, result) do {                                          \
+        clock_gettime(CLOCK_MONOTONIC, &start);                         \
+        for (round = 0; round < BENCH_ROUNDS; round++) {                \
+            for (i = 0; i < BENCH_PAIRS; i++) {                         \
+                sink += fn(&entries[i], &queries[i]);                   \
+            }                                                           \
+        }                                                               \
+        result = elapsed_ns(&start) / (BENCH_ROUNDS * BENCH_PAIRS);     \
+    } while (0)
+
+    BENCH(of_match_more_specific_by_field, by_field);
+    BENCH(of_match_more_specific, wide);
+    printf("  of_match_more_specific: %.1f ns by field, %.1f ns wide\n",
+           by_field, wide);
+
+    BENCH(of_match_overlap_by_field, by_field);
+    BENCH(of_match_overlap, wide);
+    printf("  of_match_overlap: %.1f ns by field, %.1f ns wide\n",
+           by_field, wide);
+#undef BENCH
+
+    free(entries);
+    free(queries);
+}
+
 int main(int argc, char* argv[])
 {
-    printf("loci Utest Is Empty\n");
+    test_wire_buffer_grow();
+    test_wire_buffer_max_length();
+    test_wire_buffer_pool();
+    test_match_compare_random();
+
+    /* Timing is noisy and slow; only on request */
+    if (getenv("LOCI_UTEST_BENCH") != NULL) {
+        bench_match_compare();
+    }
     return 0;
 }
@@ -44,6 +44,9 @@
 
 #define IND_OFDPA_NANO_SEC 1000000000
 
+/* Flow stats snapshot freshness; 0 looks up each flow individually */
+#define IND_OFDPA_FLOW_STATS_TTL_MS_DEFAULT 1000
+
 
 typedef struct  indTableNameList
 {
@@ -51,6 +54,11 @@ typedef struct  indTableNameList
   char *name;
 } indTableNameList_t;
 
+extern indTableNameList_t tableNameList[];
+extern const uint32_t tableNameListSize;
+
+#define TABLE_NAME_LIST_SIZE tableNameListSize
+
 typedef struct indPacketOutActions_s
 {
   uint32_t outputPort;
@@ -168,6 +176,20 @@ typedef enum ind_ofdpa_fields_s
 extern ind_ofdpa_fields_t ind_ofdpa_match_fields_bitmask;
 indigo_error_t indigoConvertOfdpaRv(OFDPA_ERROR_t result);
 
+/* Flow stats snapshot; see ind_ofdpa_stats.c */
+indigo_error_t ind_ofdpa_flow_stats_get(uint64_t cookie, ofdpaFlowEntryStats_t *flowStats);
+void ind_ofdpa_flow_stats_invalidate(uint64_t cookie);
+void ind_ofdpa_flow_stats_ttl_set(uint32_t ttl_ms);
+uint32_t ind_ofdpa_flow_stats_ttl_get(void);
+
+/* Instruction translation cache; see ind_ofdpa_xlate.c */
+int ind_ofdpa_xlate_cache_get(of_list_instruction_t *insts, int tunnel, ofdpaFlowEntry_t *flow);
+void ind_ofdpa_xlate_cache_put(of_list_instruction_t *insts, int tunnel, ofdpaFlowEntry_t *flow);
+
+/* Warm restart reconciliation; see ind_ofdpa_reconcile.c */
+void ind_ofdpa_reconcile_flow_mark(uint64_t cookie);
+void ind_ofdpa_reconcile_group_mark(uint32_t groupId);
+
 void ind_ofdpa_port_event_receive(void);
 void ind_ofdpa_flow_event_receive(void);
 void ind_ofdpa_pkt_receive(void);
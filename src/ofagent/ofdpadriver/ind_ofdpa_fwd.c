@@ -65,7 +65,7 @@ indTableNameList_t tableNameList[] =
   {OFDPA_FLOW_TABLE_ID_ACL_POLICY,        "ACL Policy"}
 };
 
-#define TABLE_NAME_LIST_SIZE (sizeof(tableNameList)/sizeof(tableNameList[0]))
+const uint32_t tableNameListSize = sizeof(tableNameList)/sizeof(tableNameList[0]);
 
 static indigo_error_t ind_ofdpa_match_fields_prerequisite_validate(const of_match_t *match, OFDPA_FLOW_TABLE_ID_t tableId)
 {
@@ -1318,6 +1318,32 @@ ind_ofdpa_instructions_get(of_flow_modify_t *flow_mod, ofdpaFlowEntry_t *flow)
   return INDIGO_ERROR_NONE;
 }
 
+/* Translate the instructions into a flow whose flowData is still zero,
+   copying an earlier translation of the same instructions if cached */
+static indigo_error_t
+ind_ofdpa_instructions_cached_get(of_flow_modify_t *flow_mod, ofdpaFlowEntry_t *flow)
+{
+  of_list_instruction_t insts;
+  indigo_error_t err;
+  int tunnel;
+
+  of_flow_modify_instructions_bind(flow_mod, &insts);
+  tunnel = (ind_ofdpa_match_fields_bitmask & IND_OFDPA_TUNNEL_ID) != 0;
+
+  if (ind_ofdpa_xlate_cache_get(&insts, tunnel, flow))
+  {
+    return INDIGO_ERROR_NONE;
+  }
+
+  err = ind_ofdpa_instructions_get(flow_mod, flow);
+  if (err == INDIGO_ERROR_NONE)
+  {
+    ind_ofdpa_xlate_cache_put(&insts, tunnel, flow);
+  }
+
+  return err;
+}
+
 static indigo_error_t ind_ofdpa_packet_out_actions_get(of_list_action_t *of_list_actions, 
                                                        indPacketOutActions_t *packetOutActions)
 {
@@ -1390,44 +1416,40 @@ indigo_error_t indigo_fwd_forwarding_features_get(of_features_reply_t *features_
 }
 
 
-indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
-                                      of_flow_add_t *flow_add,
-                                      uint8_t *table_id)
+/* Translate a flow add into the OF-DPA flow entry it installs */
+static indigo_error_t ind_ofdpa_flow_translate(indigo_cookie_t flow_id,
+                                               of_flow_add_t *flow_add,
+                                               ofdpaFlowEntry_t *flow,
+                                               uint8_t *table_id)
 {
   indigo_error_t err = INDIGO_ERROR_NONE;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
-  ofdpaFlowEntry_t flow;
-  ofdpaFlowEntryStats_t  flowStats;
   uint16_t priority;
   uint16_t idle_timeout, hard_timeout; 
   of_match_t of_match;
 
-  LOG_TRACE("Flow create called");
-
   if (flow_add->version < OF_VERSION_1_3) 
   {
     LOG_INFO("OpenFlow version 0x%x unsupported", flow_add->version);
     return INDIGO_ERROR_VERSION;
   }
 
-  memset(&flowStats, 0, sizeof(flowStats));
-  memset(&flow, 0, sizeof(flow));
+  memset(flow, 0, sizeof(*flow));
     
-  flow.cookie = flow_id;
+  flow->cookie = flow_id;
 
   /* Get the Flow Table ID */
   of_flow_add_table_id_get(flow_add, table_id);
-  flow.tableId = (uint32_t)*table_id;
+  flow->tableId = (uint32_t)*table_id;
 
   /* ofdpa Flow priority */
   of_flow_add_priority_get(flow_add, &priority);
-  flow.priority = (uint32_t)priority;
+  flow->priority = (uint32_t)priority;
 
   /* Get the idle time and hard time */
   (void)of_flow_modify_idle_timeout_get((of_flow_modify_t *)flow_add, &idle_timeout);
   (void)of_flow_modify_hard_timeout_get((of_flow_modify_t *)flow_add, &hard_timeout);
-  flow.idle_time = (uint32_t)idle_timeout;
-  flow.hard_time = (uint32_t)hard_timeout;
+  flow->idle_time = (uint32_t)idle_timeout;
+  flow->hard_time = (uint32_t)hard_timeout;
 
   memset(&of_match, 0, sizeof(of_match));
   ind_ofdpa_match_fields_bitmask = 0; /* Set the bit mask to 0 before being set in of_flow_add_match_get() */
@@ -1437,20 +1459,41 @@ indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
     return INDIGO_ERROR_UNKNOWN;
   }
 
+  /* Get the instructions set from the LOCI flow add object; this needs
+     the match bitmask but goes before the match fields, see
+     ind_ofdpa_instructions_cached_get */
+  err = ind_ofdpa_instructions_cached_get(flow_add, flow);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to get flow instructions. (err = %d)", err);
+    return err; 
+  }
+
   /* Get the match fields and masks from LOCI match structure */
-  err = ind_ofdpa_match_fields_masks_get(&of_match, &flow);
+  err = ind_ofdpa_match_fields_masks_get(&of_match, flow);
   if (err != INDIGO_ERROR_NONE)
   {
     LOG_INFO("Error getting match fields and masks. (err = %d)", err);
     return err;
   }
-  
-  /* Get the instructions set from the LOCI flow add object */
-  err = ind_ofdpa_instructions_get(flow_add, &flow); 
+
+  return INDIGO_ERROR_NONE;
+}
+
+indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
+                                      of_flow_add_t *flow_add,
+                                      uint8_t *table_id)
+{
+  indigo_error_t err = INDIGO_ERROR_NONE;
+  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  ofdpaFlowEntry_t flow;
+
+  LOG_TRACE("Flow create called");
+
+  err = ind_ofdpa_flow_translate(flow_id, flow_add, &flow, table_id);
   if (err != INDIGO_ERROR_NONE)
   {
-    LOG_ERROR("Failed to get flow instructions. (err = %d)", err);
-    return err; 
+    return err;
   }
 
   /* Submit the changes to ofdpa */
@@ -1462,12 +1505,80 @@ indigo_error_t indigo_fwd_flow_create(indigo_cookie_t flow_id,
   else
   {
     LOG_INFO("Flow added successfully. (ofdpa_rv = %d)", ofdpa_rv);
+    /* Drop anything recorded for an earlier flow with this cookie */
+    ind_ofdpa_flow_stats_invalidate(flow_id);
   }
   
 
   return (indigoConvertOfdpaRv(ofdpa_rv));
 }
 
+/* A restored flow is left alone if OF-DPA still holds it as translated;
+   if only its instructions or timeouts differ it is modified in place.
+   Otherwise it is reported NOT_FOUND for the state manager to create, and
+   is marked now so reconcile_finish keeps the flow that create installs */
+indigo_error_t indigo_fwd_flow_reconcile(indigo_cookie_t flow_id,
+                                         of_flow_add_t *flow_add,
+                                         uint8_t *table_id)
+{
+  indigo_error_t err = INDIGO_ERROR_NONE;
+  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
+  ofdpaFlowEntry_t flow;
+  ofdpaFlowEntry_t hwFlow;
+  ofdpaFlowEntryStats_t flowStats;
+
+  LOG_TRACE("Flow reconcile called");
+
+  err = ind_ofdpa_flow_translate(flow_id, flow_add, &flow, table_id);
+  if (err != INDIGO_ERROR_NONE)
+  {
+    return err;
+  }
+
+  memset(&hwFlow, 0, sizeof(hwFlow));
+  memset(&flowStats, 0, sizeof(flowStats));
+  ofdpa_rv = ofdpaFlowByCookieGet(flow_id, &hwFlow, &flowStats);
+  if (ofdpa_rv != OFDPA_E_NONE)
+  {
+    LOG_TRACE("Restored flow not in OF-DPA. (ofdpa_rv = %d)", ofdpa_rv);
+    ind_ofdpa_reconcile_flow_mark(flow_id);
+    return INDIGO_ERROR_NOT_FOUND;
+  }
+
+  /* The match is part of flowData, so a different match or table is a
+     different flow; only the rest can be modified. The old flow goes so
+     that the created one is the only flow with this cookie */
+  if (hwFlow.tableId != flow.tableId || hwFlow.priority != flow.priority)
+  {
+    LOG_TRACE("Restored flow differs from OF-DPA's in table or priority.");
+    ofdpa_rv = ofdpaFlowDelete(&hwFlow);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      LOG_ERROR("Failed to delete replaced flow. (ofdpa_rv = %d)", ofdpa_rv);
+      return (indigoConvertOfdpaRv(ofdpa_rv));
+    }
+    ind_ofdpa_reconcile_flow_mark(flow_id);
+    return INDIGO_ERROR_NOT_FOUND;
+  }
+
+  if (memcmp(&hwFlow.flowData, &flow.flowData, sizeof(flow.flowData)) != 0 ||
+      hwFlow.idle_time != flow.idle_time ||
+      hwFlow.hard_time != flow.hard_time)
+  {
+    ofdpa_rv = ofdpaFlowModify(&flow);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      LOG_ERROR("Failed to modify restored flow. (ofdpa_rv = %d)", ofdpa_rv);
+      return (indigoConvertOfdpaRv(ofdpa_rv));
+    }
+    LOG_TRACE("Restored flow modified.");
+  }
+
+  ind_ofdpa_reconcile_flow_mark(flow_id);
+
+  return INDIGO_ERROR_NONE;
+}
+
 indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
                                       of_flow_modify_t *flow_modify)
 {
@@ -1476,6 +1587,7 @@ indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
   ofdpaFlowEntryStats_t flowStats;
   OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;  
   of_match_t of_match;
+  uint16_t idle_timeout, hard_timeout;
 
   LOG_TRACE("Flow modify called");	
 
@@ -1485,6 +1597,17 @@ indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
     return INDIGO_ERROR_VERSION;
   }
 
+  (void)of_flow_modify_idle_timeout_get(flow_modify, &idle_timeout);
+  (void)of_flow_modify_hard_timeout_get(flow_modify, &hard_timeout);
+
+  /* A modified flow keeps its install time, which the hard timeout of an
+     overwriting add must count from; have that add recreate the flow */
+  if (flow_modify->object_id == OF_FLOW_ADD && hard_timeout != 0)
+  {
+    LOG_TRACE("Overwrite with hard timeout; not modifying in place");
+    return INDIGO_ERROR_NOT_SUPPORTED;
+  }
+
   memset(&flow, 0, sizeof(flow));
   memset(&flowStats, 0, sizeof(flowStats));
 
@@ -1512,6 +1635,14 @@ indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
   
   memset(&flow.flowData, 0, sizeof(flow.flowData));
 
+  /* Get the modified instructions set from the LOCI flow add object */
+  err = ind_ofdpa_instructions_cached_get(flow_modify, &flow);
+  if (err != INDIGO_ERROR_NONE)  
+  {
+    LOG_ERROR("Failed to get flow instructions. (err = %d)", err);
+    return err;
+  } 
+
   /* Get the match fields and masks from LOCI match structure */
   err = ind_ofdpa_match_fields_masks_get(&of_match, &flow);
   if (err != INDIGO_ERROR_NONE)
@@ -1520,13 +1651,12 @@ indigo_error_t indigo_fwd_flow_modify(indigo_cookie_t flow_id,
     return err;
   }
 
-  /* Get the modified instructions set from the LOCI flow add object */
-  err = ind_ofdpa_instructions_get(flow_modify, &flow);
-  if (err != INDIGO_ERROR_NONE)  
+  /* An overwriting add replaces the timeouts as well */
+  if (flow_modify->object_id == OF_FLOW_ADD)
   {
-    LOG_ERROR("Failed to get flow instructions. (err = %d)", err);
-    return err;
-  } 
+    flow.idle_time = (uint32_t)idle_timeout;
+    flow.hard_time = (uint32_t)hard_timeout;
+  }
 
   /* Submit the changes to ofdpa */
   ofdpa_rv = ofdpaFlowModify(&flow);
@@ -1584,6 +1714,7 @@ indigo_error_t indigo_fwd_flow_delete(indigo_cookie_t flow_id,
   else
   {
     LOG_TRACE("Flow deleted successfully. (ofdpa_rv = %d)", ofdpa_rv);
+    ind_ofdpa_flow_stats_invalidate(flow_id);
   }
 
   return (indigoConvertOfdpaRv(ofdpa_rv));;
@@ -1592,34 +1723,36 @@ indigo_error_t indigo_fwd_flow_delete(indigo_cookie_t flow_id,
 indigo_error_t indigo_fwd_flow_stats_get(indigo_cookie_t flow_id,
                                          indigo_fi_flow_stats_t *flow_stats)
 {
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_NONE;
-  ofdpaFlowEntry_t flow;
+  indigo_error_t err;
   ofdpaFlowEntryStats_t flowStats;
 
-  memset(&flow, 0, sizeof(flow));
   memset(&flowStats, 0, sizeof(flowStats));
 
-  /* Get the flow and flow stats from flow id */	
-  ofdpa_rv = ofdpaFlowByCookieGet(flow_id, &flow, &flowStats);
-  if (ofdpa_rv == OFDPA_E_NONE)
+  /* Get the flow stats from flow id, via the shared snapshot */
+  err = ind_ofdpa_flow_stats_get(flow_id, &flowStats);
+  if (err == INDIGO_ERROR_NONE)
   {
     flow_stats->flow_id = flow_id;
     flow_stats->duration_ns = (flowStats.durationSec) * (IND_OFDPA_NANO_SEC); /* Convert to nsecs */
     flow_stats->packets = flowStats.receivedPackets;
     flow_stats->bytes = flowStats.receivedBytes;
 
-    LOG_INFO("Flow stats get successful. (ofdpa_rv = %d)", ofdpa_rv);
+    LOG_INFO("Flow stats get successful.");
+  }
+  else if (err == INDIGO_ERROR_PENDING)
+  {
+    LOG_TRACE("Flow stats being collected; ask again.");
   }
-  else if (ofdpa_rv == OFDPA_E_NOT_FOUND)
+  else if (err == INDIGO_ERROR_NOT_FOUND)
   {
-    LOG_ERROR("Request to get stats of a non-existent flow. (ofdpa_rv = %d)", ofdpa_rv);
+    LOG_ERROR("Request to get stats of a non-existent flow. (err = %d)", err);
   }
   else
   {
-    LOG_ERROR("Failed to get flow stats. (ofdpa_rv = %d)", ofdpa_rv);
+    LOG_ERROR("Failed to get flow stats. (err = %d)", err);
   }
 
-  return (indigoConvertOfdpaRv(ofdpa_rv));
+  return err;
 }
 
 void indigo_fwd_table_mod(of_table_mod_t *of_table_mod,
@@ -1759,28 +1892,35 @@ indigo_error_t indigo_fwd_expiration_enable_get(int *is_enabled)
   return INDIGO_ERROR_NOT_SUPPORTED;
 }
 
+/* Flow timeouts are programmed into OF-DPA at flow create; its aging
+   events are the only expiry the state manager sees, apart from the
+   occasional audit for lost events.  Events are reported per table. */
 void ind_ofdpa_flow_event_receive(void)
 {
   ofdpaFlowEvent_t flowEventData;
+  uint32_t i;
 
   LOG_TRACE("Reading Flow Events");
 
-  memset(&flowEventData, 0, sizeof(flowEventData));
-  flowEventData.flowMatch.tableId = OFDPA_FLOW_TABLE_ID_VLAN;
-
-  while (ofdpaFlowEventNextGet(&flowEventData) == OFDPA_E_NONE)
+  for (i = 0; i < TABLE_NAME_LIST_SIZE; i++)
   {
-    if (flowEventData.eventMask & OFDPA_FLOW_EVENT_HARD_TIMEOUT)
-    {
-      LOG_INFO("Received flow event on hard timeout.");
-      ind_core_flow_expiry_handler(flowEventData.flowMatch.cookie,
-                                   INDIGO_FLOW_REMOVED_HARD_TIMEOUT);
-    }
-    else
+    memset(&flowEventData, 0, sizeof(flowEventData));
+    flowEventData.flowMatch.tableId = tableNameList[i].type;
+
+    while (ofdpaFlowEventNextGet(&flowEventData) == OFDPA_E_NONE)
     {
-      LOG_INFO("Received flow event on idle timeout.");
-      ind_core_flow_expiry_handler(flowEventData.flowMatch.cookie,
-                                   INDIGO_FLOW_REMOVED_IDLE_TIMEOUT);
+      if (flowEventData.eventMask & OFDPA_FLOW_EVENT_HARD_TIMEOUT)
+      {
+        LOG_INFO("Received flow event on hard timeout.");
+        ind_core_flow_expiry_handler(flowEventData.flowMatch.cookie,
+                                     INDIGO_FLOW_REMOVED_HARD_TIMEOUT);
+      }
+      else
+      {
+        LOG_INFO("Received flow event on idle timeout.");
+        ind_core_flow_expiry_handler(flowEventData.flowMatch.cookie,
+                                     INDIGO_FLOW_REMOVED_IDLE_TIMEOUT);
+      }
     }
   }
   return;
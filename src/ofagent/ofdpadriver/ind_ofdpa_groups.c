@@ -136,153 +136,165 @@ ind_ofdpa_translate_group_actions(of_list_action_t *actions,
     return INDIGO_ERROR_NONE;
 }
 
+/* Translate one OpenFlow bucket into the OF-DPA bucket at bucket_index */
 static indigo_error_t
-ind_ofdpa_translate_group_buckets(uint32_t group_id, 
-                                  of_list_bucket_t *of_buckets,
-                                  uint16_t command)
+ind_ofdpa_translate_group_bucket(uint32_t group_id,
+                                 of_bucket_t *of_bucket,
+                                 uint16_t bucket_index,
+                                 uint32_t *group_action_bitmap,
+                                 ofdpaGroupBucketEntry_t *group_bucket_entry)
 {
   indigo_error_t err;
-  uint16_t bucket_index = 0;
   of_list_action_t of_actions;
-  of_bucket_t of_bucket;
   ind_ofdpa_group_bucket_t group_bucket;
-  int rv;
   uint32_t group_type;
-  uint32_t group_action_bitmap = 0;
-  ofdpaGroupEntry_t group_entry;
-  ofdpaGroupBucketEntry_t group_bucket_entry;
-  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_FAIL;
-  int group_added = 0;
 
-  OF_LIST_BUCKET_ITER(of_buckets, &of_bucket, rv) 
-  {
-    of_bucket_actions_bind(&of_bucket, &of_actions);
+  of_bucket_actions_bind(of_bucket, &of_actions);
 
-    memset(&group_bucket, 0, sizeof(group_bucket));
+  memset(&group_bucket, 0, sizeof(group_bucket));
 
-    err = ind_ofdpa_translate_group_actions(
-        &of_actions, &group_bucket, &group_action_bitmap);
-    if (err < 0) 
-    {
-      LOG_ERROR("Error in translating group actions");
-      if (group_added == 1) 
-      {
-        /* Delete the added group */
-        (void)ofdpaGroupDelete(group_id);
-      }
-      return err;
-    }
+  err = ind_ofdpa_translate_group_actions(
+      &of_actions, &group_bucket, group_action_bitmap);
+  if (err < 0) 
+  {
+    LOG_ERROR("Error in translating group actions");
+    return err;
+  }
 
-    ofdpaGroupTypeGet(group_id, &group_type);
+  ofdpaGroupTypeGet(group_id, &group_type);
 
-    memset(&group_bucket_entry, 0, sizeof(group_bucket_entry));
-    group_bucket_entry.groupId = group_id;
-    group_bucket_entry.bucketIndex = bucket_index;
+  memset(group_bucket_entry, 0, sizeof(*group_bucket_entry));
+  group_bucket_entry->groupId = group_id;
+  group_bucket_entry->bucketIndex = bucket_index;
 
-    err = INDIGO_ERROR_NONE;
+  err = INDIGO_ERROR_NONE;
 
-    switch (group_type)
-    {
-      case OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE:
-        if((group_action_bitmap | IND_OFDPA_L2INTERFACE_BITMAP) != IND_OFDPA_L2INTERFACE_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
-        group_bucket_entry.bucketData.l2Interface.outputPort = group_bucket.outputPort;
-        group_bucket_entry.bucketData.l2Interface.popVlanTag = group_bucket.popVlanTag;
+  switch (group_type)
+  {
+    case OFDPA_GROUP_ENTRY_TYPE_L2_INTERFACE:
+      if((*group_action_bitmap | IND_OFDPA_L2INTERFACE_BITMAP) != IND_OFDPA_L2INTERFACE_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
+        break;
+      }
+      group_bucket_entry->bucketData.l2Interface.outputPort = group_bucket.outputPort;
+      group_bucket_entry->bucketData.l2Interface.popVlanTag = group_bucket.popVlanTag;
+
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L2_REWRITE:
+      if((*group_action_bitmap | IND_OFDPA_L2REWRITE_BITMAP) != IND_OFDPA_L2REWRITE_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L2_REWRITE:
-        if((group_action_bitmap | IND_OFDPA_L2REWRITE_BITMAP) != IND_OFDPA_L2REWRITE_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l2Rewrite.vlanId = group_bucket.vlanId;
 
-        group_bucket_entry.bucketData.l2Rewrite.vlanId = group_bucket.vlanId;
+      memcpy(&group_bucket_entry->bucketData.l2Rewrite.srcMac,
+             &group_bucket.srcMac, sizeof(group_bucket_entry->bucketData.l2Rewrite.srcMac));
 
-        memcpy(&group_bucket_entry.bucketData.l2Rewrite.srcMac,
-               &group_bucket.srcMac, sizeof(group_bucket_entry.bucketData.l2Rewrite.srcMac));
+      memcpy(&group_bucket_entry->bucketData.l2Rewrite.dstMac,
+             &group_bucket.dstMac, sizeof(group_bucket_entry->bucketData.l2Rewrite.dstMac));
 
-        memcpy(&group_bucket_entry.bucketData.l2Rewrite.dstMac,
-               &group_bucket.dstMac, sizeof(group_bucket_entry.bucketData.l2Rewrite.dstMac));
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L3_UNICAST:
+      if((*group_action_bitmap | IND_OFDPA_L3UNICAST_BITMAP) != IND_OFDPA_L3UNICAST_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L3_UNICAST:
-        if((group_action_bitmap | IND_OFDPA_L3UNICAST_BITMAP) != IND_OFDPA_L3UNICAST_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l3Unicast.vlanId = group_bucket.vlanId;
 
-        group_bucket_entry.bucketData.l3Unicast.vlanId = group_bucket.vlanId;
+      memcpy(&group_bucket_entry->bucketData.l3Unicast.srcMac,
+             &group_bucket.srcMac, sizeof(group_bucket_entry->bucketData.l3Unicast.srcMac));
 
-        memcpy(&group_bucket_entry.bucketData.l3Unicast.srcMac,
-               &group_bucket.srcMac, sizeof(group_bucket_entry.bucketData.l3Unicast.srcMac));
+      memcpy(&group_bucket_entry->bucketData.l3Unicast.dstMac,
+             &group_bucket.dstMac, sizeof(group_bucket_entry->bucketData.l3Unicast.dstMac));
 
-        memcpy(&group_bucket_entry.bucketData.l3Unicast.dstMac,
-               &group_bucket.dstMac, sizeof(group_bucket_entry.bucketData.l3Unicast.dstMac));
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L3_INTERFACE:
+      if((*group_action_bitmap | IND_OFDPA_L3INTERFACE_BITMAP) != IND_OFDPA_L3INTERFACE_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L3_INTERFACE:
-        if((group_action_bitmap | IND_OFDPA_L3INTERFACE_BITMAP) != IND_OFDPA_L3INTERFACE_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l3Interface.vlanId = group_bucket.vlanId;
 
-        group_bucket_entry.bucketData.l3Interface.vlanId = group_bucket.vlanId;
+      memcpy(&group_bucket_entry->bucketData.l3Interface.srcMac,
+             &group_bucket.srcMac, sizeof(group_bucket_entry->bucketData.l3Interface.srcMac));
 
-        memcpy(&group_bucket_entry.bucketData.l3Interface.srcMac,
-               &group_bucket.srcMac, sizeof(group_bucket_entry.bucketData.l3Interface.srcMac));
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
+    case OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY:
+      if((*group_action_bitmap | IND_OFDPA_L2OVERLAY_BITMAP) != IND_OFDPA_L2OVERLAY_BITMAP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L2_OVERLAY:
-        if((group_action_bitmap | IND_OFDPA_L2OVERLAY_BITMAP) != IND_OFDPA_L2OVERLAY_BITMAP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->bucketData.l2Overlay.outputPort = group_bucket.outputPort;
+      break;
 
-        group_bucket_entry.bucketData.l2Overlay.outputPort = group_bucket.outputPort;
+    case OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST:
+    case OFDPA_GROUP_ENTRY_TYPE_L3_ECMP:
+      if((*group_action_bitmap | IND_OFDPA_REFGROUP) != IND_OFDPA_REFGROUP)
+      {
+        err = INDIGO_ERROR_COMPAT;
         break;
+      }
 
-      case OFDPA_GROUP_ENTRY_TYPE_L2_MULTICAST:
-      case OFDPA_GROUP_ENTRY_TYPE_L2_FLOOD:
-      case OFDPA_GROUP_ENTRY_TYPE_L3_MULTICAST:
-      case OFDPA_GROUP_ENTRY_TYPE_L3_ECMP:
-        if((group_action_bitmap | IND_OFDPA_REFGROUP) != IND_OFDPA_REFGROUP)
-        {
-          err = INDIGO_ERROR_COMPAT;
-          break;
-        }
+      group_bucket_entry->referenceGroupId = group_bucket.referenceGroupId;
+      break;
 
-        group_bucket_entry.referenceGroupId = group_bucket.referenceGroupId;
-        break;
+    default:
+      err = INDIGO_ERROR_PARAM;
+      LOG_ERROR("Invalid Group Type");
+      break;
+  }
 
-      default:
-        err = INDIGO_ERROR_PARAM;
-        LOG_ERROR("Invalid Group Type");
-        break;
-    }
+  if (err == INDIGO_ERROR_COMPAT)
+  {
+    LOG_ERROR("Incompatible fields for Group Type");
+  }
+
+  return err;
+}
+
+static indigo_error_t
+ind_ofdpa_translate_group_buckets(uint32_t group_id, 
+                                  of_list_bucket_t *of_buckets,
+                                  uint16_t command)
+{
+  indigo_error_t err;
+  uint16_t bucket_index = 0;
+  of_bucket_t of_bucket;
+  int rv;
+  uint32_t group_action_bitmap = 0;
+  ofdpaGroupEntry_t group_entry;
+  ofdpaGroupBucketEntry_t group_bucket_entry;
+  OFDPA_ERROR_t ofdpa_rv = OFDPA_E_FAIL;
+  int group_added = 0;
 
+  OF_LIST_BUCKET_ITER(of_buckets, &of_bucket, rv) 
+  {
+    err = ind_ofdpa_translate_group_bucket(group_id, &of_bucket, bucket_index,
+                                           &group_action_bitmap,
+                                           &group_bucket_entry);
     if (err != INDIGO_ERROR_NONE)
     {
-      if (err == INDIGO_ERROR_COMPAT)
-      {
-        LOG_ERROR("Incompatible fields for Group Type");
-      }
       if (group_added == 1) 
       {
         /* Delete the added group */
@@ -387,6 +399,81 @@ void indigo_fwd_group_delete(uint32_t id)
 #endif
 }
 
+/* Whether OF-DPA's buckets for a group are the OpenFlow buckets translated;
+   a bucket that cannot be read or translated counts as a difference */
+static int
+ind_ofdpa_group_buckets_same(uint32_t id, of_list_bucket_t *buckets,
+                             uint32_t bucket_count)
+{
+  uint16_t bucket_index = 0;
+  of_bucket_t of_bucket;
+  int rv;
+  uint32_t group_action_bitmap = 0;
+  ofdpaGroupBucketEntry_t group_bucket_entry;
+  ofdpaGroupBucketEntry_t hw_bucket_entry;
+
+  OF_LIST_BUCKET_ITER(buckets, &of_bucket, rv)
+  {
+    if (ind_ofdpa_translate_group_bucket(id, &of_bucket, bucket_index,
+                                         &group_action_bitmap,
+                                         &group_bucket_entry) != INDIGO_ERROR_NONE)
+    {
+      return 0;
+    }
+
+    memset(&hw_bucket_entry, 0, sizeof(hw_bucket_entry));
+    if (ofdpaGroupBucketEntryGet(id, bucket_index, &hw_bucket_entry) != OFDPA_E_NONE ||
+        hw_bucket_entry.referenceGroupId != group_bucket_entry.referenceGroupId ||
+        memcmp(&hw_bucket_entry.bucketData, &group_bucket_entry.bucketData,
+               sizeof(group_bucket_entry.bucketData)) != 0)
+    {
+      return 0;
+    }
+
+    bucket_index++;
+  }
+
+  return bucket_index == bucket_count;
+}
+
+/* A restored group that OF-DPA no longer has is added again, and one whose
+   buckets differ is modified to the restored buckets */
+indigo_error_t indigo_fwd_group_reconcile(uint32_t id, uint8_t group_type,
+                                          of_list_bucket_t *buckets)
+{
+  indigo_error_t err;
+  OFDPA_ERROR_t ofdpa_rv;
+  ofdpaGroupEntryStats_t groupStats;
+
+  memset(&groupStats, 0, sizeof(groupStats));
+  ofdpa_rv = ofdpaGroupStatsGet(id, &groupStats);
+  if (ofdpa_rv != OFDPA_E_NONE)
+  {
+    LOG_TRACE("Restored group 0x%x not in OF-DPA; adding it. (ofdpa_rv = %d)",
+              id, ofdpa_rv);
+    err = indigo_fwd_group_add(id, group_type, buckets);
+  }
+  else if (!ind_ofdpa_group_buckets_same(id, buckets, groupStats.bucketCount))
+  {
+    LOG_TRACE("Restored group 0x%x differs from OF-DPA's; modifying it.", id);
+    err = indigo_fwd_group_modify(id, buckets);
+  }
+  else
+  {
+    err = INDIGO_ERROR_NONE;
+  }
+
+  if (err != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to reconcile restored group 0x%x. (err = %d)", id, err);
+    return err;
+  }
+
+  ind_ofdpa_reconcile_group_mark(id);
+
+  return INDIGO_ERROR_NONE;
+}
+
 void indigo_fwd_group_stats_get(uint32_t id, of_group_stats_entry_t *entry)
 {
   OFDPA_ERROR_t ofdpa_rv;
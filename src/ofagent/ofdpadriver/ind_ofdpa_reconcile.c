@@ -0,0 +1,240 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename   ind_ofdpa_reconcile.c
+*
+* @purpose    Warm restart reconciliation with OF-DPA
+*
+* @component  OF-DPA
+*
+* @comments   After a restart the state manager offers each flow and
+*             group it restored through the reconcile calls, which mark
+*             the ones OF-DPA keeps, whether still held or installed
+*             again.  Once all have been offered,
+*             indigo_fwd_reconcile_finish walks the OF-DPA flow and group
+*             tables and deletes whatever was not marked, so OF-DPA ends
+*             up holding exactly the restored state.  If the restore did
+*             not get through the state file, nothing is deleted.
+*
+* @end
+*
+**********************************************************************/
+#include <stdlib.h>
+#include <indigo/memory.h>
+#include <indigo/forwarding.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+#define IND_OFDPA_RECONCILE_MIN_ALLOC 256
+
+typedef struct ind_ofdpa_reconcile_set_s
+{
+  uint64_t *keys;
+  uint32_t  count;
+  uint32_t  alloc;
+} ind_ofdpa_reconcile_set_t;
+
+static ind_ofdpa_reconcile_set_t reconciled_flows;
+static ind_ofdpa_reconcile_set_t reconciled_groups;
+
+static void ind_ofdpa_reconcile_set_add(ind_ofdpa_reconcile_set_t *set,
+                                        uint64_t key)
+{
+  uint64_t *keys;
+  uint32_t alloc;
+
+  if (set->count == set->alloc)
+  {
+    alloc = set->alloc ? set->alloc * 2 : IND_OFDPA_RECONCILE_MIN_ALLOC;
+    keys = INDIGO_MEM_REALLOC(set->keys, alloc * sizeof(*keys));
+    if (keys == NULL)
+    {
+      /* The entry is then deleted at finish and must be re-pushed */
+      LOG_ERROR("Failed to grow reconciled set.");
+      return;
+    }
+    set->keys = keys;
+    set->alloc = alloc;
+  }
+
+  set->keys[set->count++] = key;
+}
+
+static int ind_ofdpa_reconcile_key_cmp(const void *a, const void *b)
+{
+  uint64_t ka = *(const uint64_t *)a;
+  uint64_t kb = *(const uint64_t *)b;
+
+  return (ka > kb) - (ka < kb);
+}
+
+static int ind_ofdpa_reconcile_set_has(ind_ofdpa_reconcile_set_t *set,
+                                       uint64_t key)
+{
+  if (set->count == 0)
+  {
+    return 0;
+  }
+
+  return bsearch(&key, set->keys, set->count, sizeof(*set->keys),
+                 ind_ofdpa_reconcile_key_cmp) != NULL;
+}
+
+static void ind_ofdpa_reconcile_set_free(ind_ofdpa_reconcile_set_t *set)
+{
+  INDIGO_MEM_FREE(set->keys);
+  memset(set, 0, sizeof(*set));
+}
+
+void ind_ofdpa_reconcile_flow_mark(uint64_t cookie)
+{
+  ind_ofdpa_reconcile_set_add(&reconciled_flows, cookie);
+}
+
+void ind_ofdpa_reconcile_group_mark(uint32_t groupId)
+{
+  ind_ofdpa_reconcile_set_add(&reconciled_groups, groupId);
+}
+
+/* Delete the flows in every table that were not reconciled */
+static uint32_t ind_ofdpa_reconcile_flows_purge(void)
+{
+  OFDPA_ERROR_t ofdpa_rv;
+  ofdpaFlowEntry_t flow;
+  ofdpaFlowEntry_t nextFlow;
+  uint32_t deleted = 0;
+  uint32_t i;
+
+  for (i = 0; i < TABLE_NAME_LIST_SIZE; i++)
+  {
+    memset(&flow, 0, sizeof(flow));
+    flow.tableId = tableNameList[i].type;
+
+    /* Walking on from a deleted entry is supported */
+    while (ofdpaFlowNextGet(&flow, &nextFlow) == OFDPA_E_NONE)
+    {
+      flow = nextFlow;
+
+      if (ind_ofdpa_reconcile_set_has(&reconciled_flows, flow.cookie))
+      {
+        continue;
+      }
+
+      ofdpa_rv = ofdpaFlowDelete(&flow);
+      if (ofdpa_rv != OFDPA_E_NONE)
+      {
+        LOG_ERROR("Failed to delete stale flow cookie 0x%llx. (ofdpa_rv = %d)",
+                  (unsigned long long)flow.cookie, ofdpa_rv);
+        continue;
+      }
+      ind_ofdpa_flow_stats_invalidate(flow.cookie);
+      deleted++;
+    }
+  }
+
+  return deleted;
+}
+
+/* One pass deleting the groups that were not reconciled; a group still
+   referenced by another fails until its referrers are gone */
+static uint32_t ind_ofdpa_reconcile_groups_pass(uint32_t *remaining)
+{
+  ofdpaGroupEntry_t group;
+  ofdpaGroupEntryStats_t groupStats;
+  uint32_t deleted = 0;
+  int more;
+
+  *remaining = 0;
+
+  /* NextGet returns the group after the one given; ID 0 is looked up */
+  memset(&group, 0, sizeof(group));
+  memset(&groupStats, 0, sizeof(groupStats));
+  more = (ofdpaGroupStatsGet(group.groupId, &groupStats) == OFDPA_E_NONE);
+  if (!more)
+  {
+    more = (ofdpaGroupNextGet(group.groupId, &group) == OFDPA_E_NONE);
+  }
+
+  while (more)
+  {
+    if (!ind_ofdpa_reconcile_set_has(&reconciled_groups, group.groupId))
+    {
+      if (ofdpaGroupDelete(group.groupId) == OFDPA_E_NONE)
+      {
+        deleted++;
+      }
+      else
+      {
+        (*remaining)++;
+      }
+    }
+    more = (ofdpaGroupNextGet(group.groupId, &group) == OFDPA_E_NONE);
+  }
+
+  return deleted;
+}
+
+void indigo_fwd_reconcile_finish(int purge)
+{
+  uint32_t flows_deleted;
+  uint32_t groups_deleted = 0;
+  uint32_t deleted;
+  uint32_t remaining;
+
+  if (!purge)
+  {
+    LOG_ERROR("Restore incomplete; keeping unreconciled OF-DPA flows and groups.");
+    LOG_INFO("Reconcile kept %u flows and %u groups.",
+             reconciled_flows.count, reconciled_groups.count);
+    ind_ofdpa_reconcile_set_free(&reconciled_flows);
+    ind_ofdpa_reconcile_set_free(&reconciled_groups);
+    return;
+  }
+
+  if (reconciled_flows.count != 0)
+  {
+    qsort(reconciled_flows.keys, reconciled_flows.count,
+          sizeof(*reconciled_flows.keys), ind_ofdpa_reconcile_key_cmp);
+  }
+  if (reconciled_groups.count != 0)
+  {
+    qsort(reconciled_groups.keys, reconciled_groups.count,
+          sizeof(*reconciled_groups.keys), ind_ofdpa_reconcile_key_cmp);
+  }
+
+  /* Flows first, as they may reference groups */
+  flows_deleted = ind_ofdpa_reconcile_flows_purge();
+
+  do
+  {
+    deleted = ind_ofdpa_reconcile_groups_pass(&remaining);
+    groups_deleted += deleted;
+  } while (deleted != 0 && remaining != 0);
+
+  if (remaining != 0)
+  {
+    LOG_ERROR("%u stale groups could not be deleted.", remaining);
+  }
+
+  LOG_INFO("Reconcile kept %u flows and %u groups; deleted %u flows and %u groups.",
+           reconciled_flows.count, reconciled_groups.count,
+           flows_deleted, groups_deleted);
+
+  ind_ofdpa_reconcile_set_free(&reconciled_flows);
+  ind_ofdpa_reconcile_set_free(&reconciled_groups);
+}
@@ -0,0 +1,353 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename   ind_ofdpa_stats.c
+*
+* @purpose    Flow statistics snapshot shared by flow stats, aggregate
+*             stats and idle timeout checks
+*
+* @component  OF-DPA
+*
+* @comments   Indigo asks for the counters of one flow at a time, and a
+*             flow stats or aggregate request asks for every matching
+*             flow in turn.  Rather than look each flow up by cookie,
+*             a sweep walks all flow tables once and records the
+*             counters of every flow by cookie.  Requests within the
+*             TTL of the sweep's completion are answered from the
+*             snapshot, whether from a stats request or an idle check.
+*
+*             The sweep is a socket manager task that yields between
+*             flows and fills a second snapshot, which replaces the
+*             current one when it completes.  A request finding the
+*             snapshot stale starts a sweep if none is running and gets
+*             INDIGO_ERROR_PENDING; the state manager asks again once
+*             other events have run.  Only a flow missing from a fresh
+*             snapshot, added since its sweep, is looked up by cookie.
+*
+* @end
+*
+**********************************************************************/
+#include <indigo/memory.h>
+#include <indigo/time.h>
+#include <SocketManager/socketmanager.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+#define IND_OFDPA_STATS_SNAPSHOT_MIN_SLOTS 1024
+
+typedef enum
+{
+  IND_OFDPA_STATS_SLOT_EMPTY = 0,
+  IND_OFDPA_STATS_SLOT_VALID,
+  IND_OFDPA_STATS_SLOT_DELETED
+} ind_ofdpa_stats_slot_state_t;
+
+typedef struct ind_ofdpa_stats_slot_s
+{
+  uint64_t              cookie;
+  ofdpaFlowEntryStats_t stats;
+  uint8_t               state;
+} ind_ofdpa_stats_slot_t;
+
+typedef struct ind_ofdpa_stats_snapshot_s
+{
+  ind_ofdpa_stats_slot_t *slots;
+  uint32_t                slot_count;   /* Power of 2 */
+  uint32_t                flow_count;
+  indigo_time_t           taken;        /* When the sweep completed */
+  int                     valid;
+} ind_ofdpa_stats_snapshot_t;
+
+typedef struct ind_ofdpa_stats_sweep_s
+{
+  ind_ofdpa_stats_snapshot_t next;      /* Replaces snapshot when done */
+  uint32_t                   table_idx; /* Into tableNameList */
+  ofdpaFlowEntry_t           cursor;    /* Last flow visited */
+  int                        running;
+} ind_ofdpa_stats_sweep_t;
+
+static ind_ofdpa_stats_snapshot_t snapshot;
+static ind_ofdpa_stats_sweep_t sweep;
+static uint32_t snapshot_ttl_ms = IND_OFDPA_FLOW_STATS_TTL_MS_DEFAULT;
+
+static uint32_t ind_ofdpa_stats_cookie_hash(uint64_t cookie)
+{
+  cookie ^= cookie >> 33;
+  cookie *= 0xff51afd7ed558ccdULL;
+  cookie ^= cookie >> 33;
+  return (uint32_t)cookie;
+}
+
+static ind_ofdpa_stats_slot_t *ind_ofdpa_stats_slot_find(ind_ofdpa_stats_snapshot_t *snap,
+                                                         uint64_t cookie)
+{
+  ind_ofdpa_stats_slot_t *slot;
+  uint32_t idx;
+
+  if (snap->slots == NULL)
+  {
+    return NULL;
+  }
+
+  idx = ind_ofdpa_stats_cookie_hash(cookie) & (snap->slot_count - 1);
+  for (;;)
+  {
+    slot = &snap->slots[idx];
+    if (slot->state == IND_OFDPA_STATS_SLOT_EMPTY)
+    {
+      return NULL;
+    }
+    if (slot->state == IND_OFDPA_STATS_SLOT_VALID && slot->cookie == cookie)
+    {
+      return slot;
+    }
+    idx = (idx + 1) & (snap->slot_count - 1);
+  }
+}
+
+static void ind_ofdpa_stats_slot_insert(ind_ofdpa_stats_slot_t *slots,
+                                        uint32_t slot_count,
+                                        uint64_t cookie,
+                                        ofdpaFlowEntryStats_t *stats)
+{
+  uint32_t idx;
+
+  idx = ind_ofdpa_stats_cookie_hash(cookie) & (slot_count - 1);
+  while (slots[idx].state == IND_OFDPA_STATS_SLOT_VALID)
+  {
+    idx = (idx + 1) & (slot_count - 1);
+  }
+
+  slots[idx].cookie = cookie;
+  slots[idx].stats = *stats;
+  slots[idx].state = IND_OFDPA_STATS_SLOT_VALID;
+}
+
+/* Double the slot array, keeping the valid slots; load stays under 1/2 */
+static indigo_error_t ind_ofdpa_stats_snapshot_grow(ind_ofdpa_stats_snapshot_t *snap)
+{
+  ind_ofdpa_stats_slot_t *slots;
+  uint32_t slot_count;
+  uint32_t i;
+
+  slot_count = snap->slot_count * 2;
+  slots = INDIGO_MEM_ALLOC(slot_count * sizeof(*slots));
+  if (slots == NULL)
+  {
+    return INDIGO_ERROR_RESOURCE;
+  }
+  INDIGO_MEM_SET(slots, 0, slot_count * sizeof(*slots));
+
+  for (i = 0; i < snap->slot_count; i++)
+  {
+    if (snap->slots[i].state == IND_OFDPA_STATS_SLOT_VALID)
+    {
+      ind_ofdpa_stats_slot_insert(slots, slot_count, snap->slots[i].cookie,
+                                  &snap->slots[i].stats);
+    }
+  }
+
+  INDIGO_MEM_FREE(snap->slots);
+  snap->slots = slots;
+  snap->slot_count = slot_count;
+
+  return INDIGO_ERROR_NONE;
+}
+
+/* Position the sweep cursor before the first flow of a table */
+static void ind_ofdpa_stats_sweep_table_start(uint32_t table_idx)
+{
+  sweep.table_idx = table_idx;
+  if (table_idx < TABLE_NAME_LIST_SIZE)
+  {
+    memset(&sweep.cursor, 0, sizeof(sweep.cursor));
+    sweep.cursor.tableId = tableNameList[table_idx].type;
+  }
+}
+
+/* Replace the snapshot with the one the sweep filled, keeping its slots */
+static void ind_ofdpa_stats_sweep_finish(void)
+{
+  ind_ofdpa_stats_snapshot_t old = snapshot;
+  indigo_time_t started = sweep.next.taken;
+
+  snapshot = sweep.next;
+  snapshot.taken = INDIGO_CURRENT_TIME;
+  snapshot.valid = 1;
+
+  sweep.next = old;
+  sweep.next.valid = 0;
+  sweep.running = 0;
+
+  LOG_VERBOSE("Flow stats sweep of %u flows took %d ms.", snapshot.flow_count,
+              INDIGO_TIME_DIFF_ms(started, snapshot.taken));
+}
+
+/* Record the counters of flows until the tables are done or time is up */
+static ind_soc_task_status_t ind_ofdpa_stats_sweep_task(void *cookie)
+{
+  OFDPA_ERROR_t ofdpa_rv;
+  ofdpaFlowEntry_t nextFlow;
+  ofdpaFlowEntryStats_t flowStats;
+
+  while (sweep.table_idx < TABLE_NAME_LIST_SIZE)
+  {
+    if (ind_soc_should_yield())
+    {
+      return IND_SOC_TASK_CONTINUE;
+    }
+
+    if (ofdpaFlowNextGet(&sweep.cursor, &nextFlow) != OFDPA_E_NONE)
+    {
+      ind_ofdpa_stats_sweep_table_start(sweep.table_idx + 1);
+      continue;
+    }
+    sweep.cursor = nextFlow;
+
+    memset(&flowStats, 0, sizeof(flowStats));
+    ofdpa_rv = ofdpaFlowStatsGet(&sweep.cursor, &flowStats);
+    if (ofdpa_rv != OFDPA_E_NONE)
+    {
+      /* Removed since the sweep got here; a lookup will miss and look up */
+      LOG_TRACE("No stats for flow cookie 0x%llx. (ofdpa_rv = %d)",
+                (unsigned long long)sweep.cursor.cookie, ofdpa_rv);
+      continue;
+    }
+
+    if ((sweep.next.flow_count + 1) * 2 > sweep.next.slot_count &&
+        ind_ofdpa_stats_snapshot_grow(&sweep.next) != INDIGO_ERROR_NONE)
+    {
+      /* The flows it could not record are looked up by cookie */
+      LOG_ERROR("Failed to grow flow stats snapshot; keeping %u flows.",
+                sweep.next.flow_count);
+      break;
+    }
+
+    ind_ofdpa_stats_slot_insert(sweep.next.slots, sweep.next.slot_count,
+                                sweep.cursor.cookie, &flowStats);
+    sweep.next.flow_count++;
+  }
+
+  ind_ofdpa_stats_sweep_finish();
+
+  return IND_SOC_TASK_FINISHED;
+}
+
+/* Start a sweep of the flow tables unless one is already running */
+static indigo_error_t ind_ofdpa_stats_sweep_start(void)
+{
+  indigo_error_t rv;
+
+  if (sweep.running)
+  {
+    return INDIGO_ERROR_NONE;
+  }
+
+  if (sweep.next.slots == NULL)
+  {
+    sweep.next.slot_count = IND_OFDPA_STATS_SNAPSHOT_MIN_SLOTS;
+    sweep.next.slots = INDIGO_MEM_ALLOC(sweep.next.slot_count * sizeof(*sweep.next.slots));
+    if (sweep.next.slots == NULL)
+    {
+      LOG_ERROR("Failed to allocate flow stats snapshot.");
+      return INDIGO_ERROR_RESOURCE;
+    }
+  }
+  INDIGO_MEM_SET(sweep.next.slots, 0, sweep.next.slot_count * sizeof(*sweep.next.slots));
+  sweep.next.flow_count = 0;
+  sweep.next.valid = 0;
+
+  /* Until the sweep completes, when it started */
+  sweep.next.taken = INDIGO_CURRENT_TIME;
+  ind_ofdpa_stats_sweep_table_start(0);
+
+  rv = ind_soc_task_register(ind_ofdpa_stats_sweep_task, NULL,
+                             IND_SOC_DEFAULT_PRIORITY);
+  if (rv != INDIGO_ERROR_NONE)
+  {
+    LOG_ERROR("Failed to start flow stats sweep. (rv = %d)", rv);
+    return rv;
+  }
+  sweep.running = 1;
+
+  return INDIGO_ERROR_NONE;
+}
+
+void ind_ofdpa_flow_stats_ttl_set(uint32_t ttl_ms)
+{
+  snapshot_ttl_ms = ttl_ms;
+  snapshot.valid = 0;
+}
+
+uint32_t ind_ofdpa_flow_stats_ttl_get(void)
+{
+  return snapshot_ttl_ms;
+}
+
+void ind_ofdpa_flow_stats_invalidate(uint64_t cookie)
+{
+  ind_ofdpa_stats_slot_t *slot;
+
+  if ((slot = ind_ofdpa_stats_slot_find(&snapshot, cookie)) != NULL)
+  {
+    slot->state = IND_OFDPA_STATS_SLOT_DELETED;
+  }
+  if (sweep.running &&
+      (slot = ind_ofdpa_stats_slot_find(&sweep.next, cookie)) != NULL)
+  {
+    slot->state = IND_OFDPA_STATS_SLOT_DELETED;
+  }
+}
+
+indigo_error_t ind_ofdpa_flow_stats_get(uint64_t cookie,
+                                        ofdpaFlowEntryStats_t *flowStats)
+{
+  ind_ofdpa_stats_slot_t *slot;
+  ofdpaFlowEntry_t flow;
+  indigo_time_t now;
+  int age_ms;
+
+  if (snapshot_ttl_ms != 0)
+  {
+    now = INDIGO_CURRENT_TIME;
+    age_ms = INDIGO_TIME_DIFF_ms(snapshot.taken, now);
+    if (!snapshot.valid || age_ms >= (int)snapshot_ttl_ms)
+    {
+      /* Answered from the next snapshot; only if there can be none
+         is the flow looked up below */
+      if (ind_ofdpa_stats_sweep_start() == INDIGO_ERROR_NONE)
+      {
+        return INDIGO_ERROR_PENDING;
+      }
+    }
+    else if ((slot = ind_ofdpa_stats_slot_find(&snapshot, cookie)) != NULL)
+    {
+      /* Counters are as of the sweep; the duration is brought up to now */
+      *flowStats = slot->stats;
+      if (age_ms > 0)
+      {
+        flowStats->durationSec += age_ms / 1000;
+      }
+      return INDIGO_ERROR_NONE;
+    }
+  }
+
+  /* Disabled, no sweep possible, or a flow added since the sweep */
+  memset(&flow, 0, sizeof(flow));
+  return indigoConvertOfdpaRv(ofdpaFlowByCookieGet(cookie, &flow, flowStats));
+}
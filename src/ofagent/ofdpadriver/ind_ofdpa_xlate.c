@@ -0,0 +1,125 @@
+/*********************************************************************
+*
+* (C) Copyright Broadcom Corporation 2013-2014
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+**********************************************************************
+*
+* @filename   ind_ofdpa_xlate.c
+*
+* @purpose    Cache of instruction list translations
+*
+* @component  OF-DPA
+*
+* @comments   Flows commonly share a few distinct instruction lists.
+*             Translating a list fills in the non-match fields of the
+*             flow's table entry and depends only on the table, the list
+*             bytes and whether the flow matches a tunnel ID.  The cache
+*             keeps the translated entry for recently seen lists so
+*             later flows copy it instead of walking the list again.
+*
+* @end
+*
+**********************************************************************/
+#include <indigo/memory.h>
+#include <ind_ofdpa_util.h>
+#include <ind_ofdpa_log.h>
+
+#define IND_OFDPA_XLATE_CACHE_SLOTS 256   /* Power of 2 */
+
+typedef struct ind_ofdpa_xlate_slot_s
+{
+  uint8_t              *insts;        /* Wire bytes of the instruction list */
+  uint32_t              length;
+  uint32_t              hash;
+  OFDPA_FLOW_TABLE_ID_t tableId;
+  int                   tunnel;
+  ofdpaFlowEntry_t      flow;         /* flowData holds the translation */
+} ind_ofdpa_xlate_slot_t;
+
+static ind_ofdpa_xlate_slot_t xlate_cache[IND_OFDPA_XLATE_CACHE_SLOTS];
+
+static uint32_t ind_ofdpa_xlate_hash(of_list_instruction_t *insts,
+                                     OFDPA_FLOW_TABLE_ID_t tableId,
+                                     int tunnel)
+{
+  uint8_t *data = OF_OBJECT_BUFFER_INDEX(insts, 0);
+  uint32_t h = 2166136261u;
+  int i;
+
+  for (i = 0; i < insts->length; i++)
+  {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  h = (h ^ (uint32_t)tableId) * 16777619u;
+  h = (h ^ (uint32_t)tunnel) * 16777619u;
+
+  return h;
+}
+
+static ind_ofdpa_xlate_slot_t *ind_ofdpa_xlate_slot(uint32_t hash)
+{
+  return &xlate_cache[hash & (IND_OFDPA_XLATE_CACHE_SLOTS - 1)];
+}
+
+int ind_ofdpa_xlate_cache_get(of_list_instruction_t *insts, int tunnel,
+                              ofdpaFlowEntry_t *flow)
+{
+  ind_ofdpa_xlate_slot_t *slot;
+  uint32_t hash;
+
+  hash = ind_ofdpa_xlate_hash(insts, flow->tableId, tunnel);
+  slot = ind_ofdpa_xlate_slot(hash);
+
+  if (slot->insts == NULL ||
+      slot->hash != hash ||
+      slot->tableId != flow->tableId ||
+      slot->tunnel != tunnel ||
+      slot->length != insts->length ||
+      memcmp(slot->insts, OF_OBJECT_BUFFER_INDEX(insts, 0), insts->length) != 0)
+  {
+    return 0;
+  }
+
+  memcpy(&flow->flowData, &slot->flow.flowData, sizeof(flow->flowData));
+
+  return 1;
+}
+
+void ind_ofdpa_xlate_cache_put(of_list_instruction_t *insts, int tunnel,
+                               ofdpaFlowEntry_t *flow)
+{
+  ind_ofdpa_xlate_slot_t *slot;
+  uint8_t *bytes;
+  uint32_t hash;
+
+  hash = ind_ofdpa_xlate_hash(insts, flow->tableId, tunnel);
+  slot = ind_ofdpa_xlate_slot(hash);
+
+  /* Replace whatever the slot held; a failed allocation just skips caching */
+  bytes = INDIGO_MEM_REALLOC(slot->insts, insts->length ? insts->length : 1);
+  if (bytes == NULL)
+  {
+    LOG_TRACE("Failed to cache instruction translation.");
+    return;
+  }
+
+  memcpy(bytes, OF_OBJECT_BUFFER_INDEX(insts, 0), insts->length);
+  slot->insts = bytes;
+  slot->length = insts->length;
+  slot->hash = hash;
+  slot->tableId = flow->tableId;
+  slot->tunnel = tunnel;
+  slot->flow = *flow;
+}